@@ -0,0 +1,162 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * Code block allocation benchmark.
+ *
+ * An image is compressed with small code blocks and several quality layers,
+ * so that the tile holds a large number of code blocks, and the resulting code stream
+ * is then decompressed. Global operator new is replaced in order to count heap allocations
+ * made by the library in each phase; allocations per code block and wall time are reported.
+ *
+ * Usage: bench_block_alloc [width [num_threads [repeats [cblk_size]]]]
+ */
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#include "bench_common.h"
+
+static std::atomic<uint64_t> numAllocations(0);
+
+void* operator new(size_t size)
+{
+	numAllocations.fetch_add(1, std::memory_order_relaxed);
+	auto p = std::malloc(size ? size : 1);
+	if(!p)
+		throw std::bad_alloc();
+	return p;
+}
+void operator delete(void* p) noexcept
+{
+	std::free(p);
+}
+void operator delete(void* p, [[maybe_unused]] size_t size) noexcept
+{
+	std::free(p);
+}
+
+struct Result
+{
+	uint64_t allocations = 0;
+	double ms = 0;
+};
+
+static bool decompress(std::vector<uint8_t>& in, Result& result)
+{
+	grk_decompress_parameters params;
+	grk_decompress_set_default_params(&params);
+	grk_stream_params streamParams;
+	grk_set_default_stream_params(&streamParams);
+	streamParams.buf = in.data();
+	streamParams.buf_len = in.size();
+	uint64_t before = numAllocations.load();
+	grk_bench::Timer timer;
+	auto codec = grk_decompress_init(&streamParams, &params.core);
+	if(!codec)
+		return false;
+	grk_header_info headerInfo;
+	memset(&headerInfo, 0, sizeof(headerInfo));
+	bool rc = grk_decompress_read_header(codec, &headerInfo) && grk_decompress(codec, nullptr);
+	grk_object_unref(codec);
+	result.ms = timer.elapsedMs();
+	result.allocations = numAllocations.load() - before;
+
+	return rc;
+}
+
+static void print(const char* phase, const Result& result, uint64_t numBlocks)
+{
+	printf("%-12s %14llu %14.2f %10.1f\n", phase, (unsigned long long)result.allocations,
+		   (double)result.allocations / (double)numBlocks, result.ms);
+}
+
+int main(int argc, char** argv)
+{
+	uint32_t w = 2048, numThreads = 0, repeats = 3, cblkSize = 16;
+	if(argc >= 2)
+		w = (uint32_t)std::max(64, atoi(argv[1]));
+	if(argc >= 3)
+		numThreads = (uint32_t)atoi(argv[2]);
+	if(argc >= 4)
+		repeats = (uint32_t)std::max(1, atoi(argv[3]));
+	if(argc >= 5)
+		cblkSize = (uint32_t)std::clamp(atoi(argv[4]), 4, 64);
+	const uint32_t h = w;
+	const uint16_t numComps = 3;
+	grk_bench::init(numThreads);
+
+	grk_cparameters params;
+	grk_compress_set_default_params(&params);
+	params.cod_format = GRK_FMT_J2K;
+	params.cblockw_init = cblkSize;
+	params.cblockh_init = cblkSize;
+	params.numlayers = 3;
+	params.layer_rate[0] = 40;
+	params.layer_rate[1] = 20;
+	params.layer_rate[2] = 10;
+	params.allocationByRateDistoration = true;
+	// every sub-band sample belongs to exactly one code block, so
+	// this is a close lower bound on the number of code blocks
+	const uint64_t numBlocks = (uint64_t)w * h * numComps / ((uint64_t)cblkSize * cblkSize);
+
+	std::vector<uint8_t> out((size_t)w * h * numComps + (1 << 20));
+	Result compressResult, decompressResult;
+	uint64_t len = 0;
+	for(uint32_t i = 0; i < repeats; ++i)
+	{
+		// compression modifies image samples, so each run gets a fresh image
+		auto image = grk_bench::createImage(w, h, numComps, 8);
+		if(!image)
+			return EXIT_FAILURE;
+		uint64_t before = numAllocations.load();
+		grk_bench::Timer timer;
+		len = grk_bench::compress(image, &params, out);
+		double ms = timer.elapsedMs();
+		uint64_t allocations = numAllocations.load() - before;
+		grk_object_unref(&image->obj);
+		if(!len)
+		{
+			fprintf(stderr, "compression failed\n");
+			return EXIT_FAILURE;
+		}
+		if(i == 0 || ms < compressResult.ms)
+			compressResult = {allocations, ms};
+	}
+	out.resize(len);
+	for(uint32_t i = 0; i < repeats; ++i)
+	{
+		Result result;
+		if(!decompress(out, result))
+		{
+			fprintf(stderr, "decompression failed\n");
+			return EXIT_FAILURE;
+		}
+		if(i == 0 || result.ms < decompressResult.ms)
+			decompressResult = result;
+	}
+	grk_deinitialize();
+
+	printf("%u x %u x %u, %u x %u code blocks (about %llu), %u layers, best of %u\n", w, h,
+		   numComps, cblkSize, cblkSize, (unsigned long long)numBlocks, params.numlayers, repeats);
+	printf("%-12s %14s %14s %10s\n", "phase", "allocations", "per block", "ms");
+	print("compress", compressResult, numBlocks);
+	print("decompress", decompressResult, numBlocks);
+
+	return EXIT_SUCCESS;
+}
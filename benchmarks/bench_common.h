@@ -0,0 +1,127 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "grok.h"
+
+namespace grk_bench
+{
+inline void quietCallback([[maybe_unused]] const char* msg, [[maybe_unused]] void* client_data) {}
+inline void errorCallback(const char* msg, [[maybe_unused]] void* client_data)
+{
+	fprintf(stderr, "%s\n", msg);
+}
+
+/**
+ * Initialize library, and silence info and warning messages
+ */
+inline void init(uint32_t numThreads)
+{
+	grk_initialize(nullptr, numThreads, false);
+	grk_set_msg_handlers(quietCallback, nullptr, quietCallback, nullptr, errorCallback, nullptr);
+}
+
+/**
+ * Create image filled with deterministic synthetic content:
+ * smooth gradients, texture and noise, so that rate control has work to do
+ */
+inline grk_image* createImage(uint32_t w, uint32_t h, uint16_t numComps, uint8_t prec,
+							  uint8_t dy = 1, uint8_t dx = 1)
+{
+	std::vector<grk_image_comp> comps(numComps);
+	for(uint16_t i = 0; i < numComps; ++i)
+	{
+		auto c = comps.data() + i;
+		memset(c, 0, sizeof(grk_image_comp));
+		bool subsampled = i > 0 && numComps == 3;
+		c->dx = subsampled ? dx : 1;
+		c->dy = subsampled ? dy : 1;
+		c->w = (w + c->dx - 1) / c->dx;
+		c->h = (h + c->dy - 1) / c->dy;
+		c->prec = prec;
+		c->sgnd = false;
+	}
+	auto image = grk_image_new(numComps, comps.data(),
+							   numComps == 3 ? GRK_CLRSPC_SRGB : GRK_CLRSPC_GRAY, true);
+	if(!image)
+		return nullptr;
+	const int32_t maxVal = (1 << prec) - 1;
+	uint32_t seed = 12345;
+	for(uint16_t compno = 0; compno < numComps; ++compno)
+	{
+		auto comp = image->comps + compno;
+		auto data = (int32_t*)comp->data;
+		for(uint32_t y = 0; y < comp->h; ++y)
+		{
+			for(uint32_t x = 0; x < comp->w; ++x)
+			{
+				seed = seed * 1103515245 + 12345;
+				double v = 0.5 + 0.25 * sin(x / (17.0 + compno)) * cos(y / 23.0) +
+						   0.15 * (double)((x ^ y) & 63) / 63.0 +
+						   0.05 * (double)((seed >> 16) & 0xFF) / 255.0;
+				int32_t s = (int32_t)(v * maxVal);
+				data[(size_t)y * comp->stride + x] = s < 0 ? 0 : (s > maxVal ? maxVal : s);
+			}
+		}
+	}
+
+	return image;
+}
+
+/**
+ * Compress image to memory buffer
+ * @return compressed length, or zero on failure
+ */
+inline uint64_t compress(grk_image* image, grk_cparameters* params, std::vector<uint8_t>& out)
+{
+	grk_stream_params streamParams;
+	grk_set_default_stream_params(&streamParams);
+	streamParams.buf = out.data();
+	streamParams.buf_len = out.size();
+	auto codec = grk_compress_init(&streamParams, params, image);
+	if(!codec)
+		return 0;
+	uint64_t len = grk_compress(codec, nullptr);
+	grk_object_unref(codec);
+
+	return len;
+}
+
+class Timer
+{
+  public:
+	Timer() : start_(std::chrono::high_resolution_clock::now()) {}
+	double elapsedMs(void) const
+	{
+		std::chrono::duration<double, std::milli> d =
+			std::chrono::high_resolution_clock::now() - start_;
+		return d.count();
+	}
+
+  private:
+	std::chrono::time_point<std::chrono::high_resolution_clock> start_;
+};
+
+} // namespace grk_bench
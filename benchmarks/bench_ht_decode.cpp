@@ -0,0 +1,329 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * HTJ2K block decoder micro-benchmark and bit exactness check.
+ *
+ * A corpus of HT code blocks is generated by encoding synthetic sub-band samples,
+ * for several block sizes, bit depths and sample distributions. Every code block is
+ * decoded by the generic decoder, which must reproduce the encoded samples, and by
+ * each SIMD decoder supported by this CPU: the SSSE3 and AVX2 decoders on x86, and the
+ * Highway decoder for every compiled target. SIMD output is compared bit for bit with
+ * generic output. Then each corpus is decoded repeatedly, and per block decode time
+ * and throughput are reported for each decoder.
+ *
+ * Usage: bench_ht_decode [iterations]
+ */
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <hwy/targets.h>
+
+#include "bench_common.h"
+#include "Logger.h"
+#include "ojph_mem.h"
+#include "ojph_block_decoder.h"
+#include "ojph_block_encoder.h"
+
+// block coder logs through the library logger
+grk::Logger grk::Logger::logger_;
+
+typedef bool (*ht_decode_fn)(uint8_t* coded_data, uint32_t* decoded_data, uint32_t missing_msbs,
+							 uint32_t num_passes, uint32_t lengths1, uint32_t lengths2,
+							 uint32_t width, uint32_t height, uint32_t stride, bool stripe_causal);
+
+// decoders may read this many bytes before and after the code block
+const uint32_t pad = 16;
+
+enum Distribution
+{
+	SPARSE, // mostly zero, as in high frequency sub-bands
+	LAPLACIAN, // typical sub-band statistics
+	DENSE // uniform over full range
+};
+const char* distNames[] = {"sparse", "laplacian", "dense"};
+
+struct CodeBlock
+{
+	uint32_t len;
+	std::vector<uint8_t> data; // code block, with padding on both sides
+	std::vector<int32_t> samples; // original samples
+};
+
+struct Corpus
+{
+	uint32_t w;
+	uint32_t h;
+	uint32_t missingMsbs;
+	Distribution dist;
+	std::vector<CodeBlock> blocks;
+	std::string name(void) const
+	{
+		return std::to_string(w) + "x" + std::to_string(h) + " " +
+			   std::to_string(missingMsbs + 1) + "b " + distNames[dist];
+	}
+};
+
+static uint32_t seed = 12345;
+static uint32_t nextRand(void)
+{
+	seed = seed * 1103515245 + 12345;
+	return seed >> 8;
+}
+static double nextUniform(void)
+{
+	return (nextRand() + 0.5) / (double)(1 << 24);
+}
+
+/**
+ * Generate and HT encode corpus blocks
+ */
+static bool generate(Corpus& corpus, uint32_t numBlocks)
+{
+	const uint32_t w = corpus.w, h = corpus.h;
+	const uint32_t maxMag = (1U << (corpus.missingMsbs + 1)) - 1;
+	const int32_t shift = 31 - (int32_t)(corpus.missingMsbs + 1);
+	std::vector<uint32_t> buf((size_t)w * h);
+	for(uint32_t b = 0; b < numBlocks; ++b)
+	{
+		CodeBlock block;
+		block.samples.resize((size_t)w * h);
+		double scale = (double)maxMag / (4 + b % 8);
+		for(size_t i = 0; i < buf.size(); ++i)
+		{
+			double mag = 0;
+			switch(corpus.dist)
+			{
+				case SPARSE:
+					if(nextRand() % 16 == 0)
+						mag = 1 + nextUniform() * scale;
+					break;
+				case LAPLACIAN:
+					mag = -log(nextUniform()) * scale / 8;
+					break;
+				case DENSE:
+					mag = nextUniform() * maxMag;
+					break;
+			}
+			uint32_t val = (std::min)((uint32_t)mag, maxMag);
+			bool negative = val && (nextRand() & 1);
+			block.samples[i] = negative ? -(int32_t)val : (int32_t)val;
+			buf[i] = (negative ? 0x80000000 : 0) | (val << shift);
+		}
+		ojph::mem_elastic_allocator allocator(1 << 20);
+		ojph::coded_lists* coded = nullptr;
+		uint32_t lengths[2] = {0, 0};
+		ojph::local::ojph_encode_codeblock(buf.data(), corpus.missingMsbs, 1, w, h, w, lengths,
+										   &allocator, coded);
+		if(!coded || !lengths[0])
+			return false;
+		block.len = lengths[0];
+		block.data.resize(block.len + 2 * pad);
+		memcpy(block.data.data() + pad, coded->buf, block.len);
+		corpus.blocks.push_back(std::move(block));
+	}
+
+	return true;
+}
+
+/**
+ * Decode all corpus blocks
+ *
+ * @return false if a block fails to decode
+ */
+static bool decodeAll(ht_decode_fn decode, Corpus& corpus, uint32_t* out, uint32_t stride)
+{
+	const size_t blockSize = (size_t)stride * ((corpus.h + 3) & ~3U);
+	for(size_t i = 0; i < corpus.blocks.size(); ++i)
+	{
+		auto& block = corpus.blocks[i];
+		if(!decode(block.data.data() + pad, out + i * blockSize, corpus.missingMsbs, 1, block.len,
+				   0, corpus.w, corpus.h, stride, false))
+			return false;
+	}
+
+	return true;
+}
+
+/**
+ * Check that decoded samples match encoded samples
+ */
+static bool verify(Corpus& corpus, const uint32_t* out, uint32_t stride)
+{
+	const size_t blockSize = (size_t)stride * ((corpus.h + 3) & ~3U);
+	const uint32_t p = 30 - corpus.missingMsbs;
+	for(size_t i = 0; i < corpus.blocks.size(); ++i)
+	{
+		auto& samples = corpus.blocks[i].samples;
+		for(uint32_t y = 0; y < corpus.h; ++y)
+		{
+			for(uint32_t x = 0; x < corpus.w; ++x)
+			{
+				uint32_t v = out[i * blockSize + y * stride + x];
+				int32_t mag = (int32_t)((v & 0x7FFFFFFF) >> p);
+				if((v & 0x80000000 ? -mag : mag) != samples[(size_t)y * corpus.w + x])
+					return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+static bool equal(Corpus& corpus, const uint32_t* a, const uint32_t* b, uint32_t stride)
+{
+	const size_t blockSize = (size_t)stride * ((corpus.h + 3) & ~3U);
+	for(size_t i = 0; i < corpus.blocks.size(); ++i)
+	{
+		for(uint32_t y = 0; y < corpus.h; ++y)
+		{
+			size_t off = i * blockSize + y * stride;
+			if(memcmp(a + off, b + off, corpus.w * sizeof(uint32_t)))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+struct Decoder
+{
+	std::string name;
+	ht_decode_fn decode;
+	int64_t hwyTarget; // Highway target, or zero for hand written decoders
+};
+
+int main(int argc, char** argv)
+{
+	uint32_t iterations = 20;
+	if(argc >= 2)
+		iterations = (uint32_t)atoi(argv[1]);
+	grk::Logger::logger_.error_handler = grk_bench::errorCallback;
+
+	std::vector<Decoder> decoders;
+	decoders.push_back({"generic", ojph::local::ojph_decode_codeblock, 0});
+#if HWY_ARCH_X86
+	if(hwy::SupportedTargets() & HWY_SSSE3)
+		decoders.push_back({"ssse3", ojph::local::ojph_decode_codeblock_ssse3, 0});
+	if(hwy::SupportedTargets() & HWY_AVX2)
+		decoders.push_back({"avx2", ojph::local::ojph_decode_codeblock_avx2, 0});
+#endif
+	for(int64_t target : hwy::SupportedAndGeneratedTargets())
+		decoders.push_back({std::string("hwy ") + hwy::TargetName(target),
+							ojph::local::ojph_decode_codeblock_hwy, target});
+
+	// block sizes include odd and maximum widths, to exercise row tails
+	const uint32_t sizes[][2] = {{64, 64}, {32, 32}, {16, 16}, {64, 16},
+								 {4, 4},   {37, 21}, {15, 32}, {1024, 4}};
+	// 16 bit path is used up to 13 missing MSBs, and 32 bit path above
+	const uint32_t missingMsbs[] = {7, 13, 20};
+	std::vector<Corpus> corpora;
+	for(auto& size : sizes)
+	{
+		for(uint32_t msbs : missingMsbs)
+		{
+			for(auto dist : {SPARSE, LAPLACIAN, DENSE})
+			{
+				Corpus corpus;
+				corpus.w = size[0];
+				corpus.h = size[1];
+				corpus.missingMsbs = msbs;
+				corpus.dist = dist;
+				if(!generate(corpus, std::max<uint32_t>(16, 65536 / (size[0] * size[1]))))
+				{
+					fprintf(stderr, "%s: encoding failed\n", corpus.name().c_str());
+					return EXIT_FAILURE;
+				}
+				corpora.push_back(std::move(corpus));
+			}
+		}
+	}
+
+	// check decoders against generic decoder
+	for(auto& corpus : corpora)
+	{
+		const uint32_t stride = (corpus.w + 3) & ~3U;
+		const size_t len = corpus.blocks.size() * stride * ((corpus.h + 3) & ~3U);
+		std::vector<uint32_t> ref(len), out(len);
+		if(!decodeAll(decoders[0].decode, corpus, ref.data(), stride) ||
+		   !verify(corpus, ref.data(), stride))
+		{
+			fprintf(stderr, "%s: generic decoder does not reproduce samples\n",
+					corpus.name().c_str());
+			return EXIT_FAILURE;
+		}
+		for(size_t d = 1; d < decoders.size(); ++d)
+		{
+			if(decoders[d].hwyTarget)
+				hwy::SetSupportedTargetsForTest(decoders[d].hwyTarget);
+			std::fill(out.begin(), out.end(), 0xDEADBEEF);
+			bool rc = decodeAll(decoders[d].decode, corpus, out.data(), stride) &&
+					  equal(corpus, ref.data(), out.data(), stride);
+			hwy::SetSupportedTargetsForTest(0);
+			if(!rc)
+			{
+				fprintf(stderr, "%s: %s decoder does not match generic decoder\n",
+						corpus.name().c_str(), decoders[d].name.c_str());
+				return EXIT_FAILURE;
+			}
+		}
+	}
+	printf("all decoders match generic decoder on %zu corpora\n\n", corpora.size());
+
+	// time decoders: ns per block, and Msamples/s
+	printf("%-22s", "corpus");
+	for(auto& d : decoders)
+		printf(" %14s", d.name.c_str());
+	printf("\n");
+	std::vector<double> totalMs(decoders.size(), 0);
+	uint64_t totalSamples = 0;
+	for(auto& corpus : corpora)
+	{
+		const uint32_t stride = (corpus.w + 3) & ~3U;
+		std::vector<uint32_t> out(corpus.blocks.size() * stride * ((corpus.h + 3) & ~3U));
+		printf("%-22s", corpus.name().c_str());
+		for(size_t d = 0; d < decoders.size(); ++d)
+		{
+			if(decoders[d].hwyTarget)
+				hwy::SetSupportedTargetsForTest(decoders[d].hwyTarget);
+			double best = 0;
+			for(uint32_t r = 0; r < 3; ++r)
+			{
+				grk_bench::Timer timer;
+				for(uint32_t it = 0; it < iterations; ++it)
+					decodeAll(decoders[d].decode, corpus, out.data(), stride);
+				double ms = timer.elapsedMs();
+				best = r == 0 ? ms : (std::min)(best, ms);
+			}
+			hwy::SetSupportedTargetsForTest(0);
+			totalMs[d] += best;
+			printf(" %11.0f ns",
+				   best * 1e6 / ((double)iterations * (double)corpus.blocks.size()));
+		}
+		printf("\n");
+		totalSamples += (uint64_t)iterations * corpus.blocks.size() * corpus.w * corpus.h;
+	}
+	printf("%-22s", "Msamples/s");
+	for(size_t d = 0; d < decoders.size(); ++d)
+		printf(" %14.1f", (double)totalSamples / (totalMs[d] * 1000));
+	printf("\n%-22s", "speedup");
+	for(size_t d = 0; d < decoders.size(); ++d)
+		printf(" %13.2fx", totalMs[0] / totalMs[d]);
+	printf("\n");
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,304 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * HTJ2K block encoder micro-benchmark, bit exactness check and frame rate benchmark.
+ *
+ * Synthetic sub-band samples are generated for several block sizes, bit depths and
+ * sample distributions. Every block is encoded by the generic encoder and by the Highway
+ * encoder for every compiled target, and code blocks are compared byte for byte.
+ * Then per block encode time and throughput are reported for each encoder.
+ * Finally, 4K 4:2:2 10 bit frames are compressed with HT block coding through the
+ * library, which selects the encoder at run time, and frames per second are reported.
+ *
+ * Usage: bench_ht_encode [iterations [num_threads [frames]]]
+ */
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+#include <hwy/targets.h>
+
+#include "bench_common.h"
+#include "Logger.h"
+#include "ojph_mem.h"
+#include "ojph_block_encoder.h"
+
+// block coder logs through the library logger
+grk::Logger grk::Logger::logger_;
+
+typedef void (*ht_encode_fn)(uint32_t* buf, uint32_t missing_msbs, uint32_t num_passes,
+							 uint32_t width, uint32_t height, uint32_t stride, uint32_t* lengths,
+							 ojph::mem_elastic_allocator* elastic, ojph::coded_lists*& coded);
+
+enum Distribution
+{
+	SPARSE, // mostly zero, as in high frequency sub-bands
+	LAPLACIAN, // typical sub-band statistics
+	DENSE // uniform over full range
+};
+const char* distNames[] = {"sparse", "laplacian", "dense"};
+
+struct Corpus
+{
+	uint32_t w;
+	uint32_t h;
+	uint32_t missingMsbs;
+	Distribution dist;
+	uint32_t numBlocks;
+	std::vector<uint32_t> samples; // sign-magnitude samples of all blocks
+	std::string name(void) const
+	{
+		return std::to_string(w) + "x" + std::to_string(h) + " " +
+			   std::to_string(missingMsbs + 1) + "b " + distNames[dist];
+	}
+};
+
+static uint32_t seed = 12345;
+static uint32_t nextRand(void)
+{
+	seed = seed * 1103515245 + 12345;
+	return seed >> 8;
+}
+static double nextUniform(void)
+{
+	return (nextRand() + 0.5) / (double)(1 << 24);
+}
+
+/**
+ * Generate corpus samples in sign-magnitude form, as passed to the block encoder
+ */
+static void generate(Corpus& corpus, uint32_t numBlocks)
+{
+	const uint32_t maxMag = (uint32_t)((1ULL << (corpus.missingMsbs + 1)) - 1);
+	const int32_t shift = 31 - (int32_t)(corpus.missingMsbs + 1);
+	const size_t blockSize = (size_t)corpus.w * corpus.h;
+	corpus.numBlocks = numBlocks;
+	corpus.samples.resize(blockSize * numBlocks);
+	for(uint32_t b = 0; b < numBlocks; ++b)
+	{
+		double scale = (double)maxMag / (4 + b % 8);
+		for(size_t i = 0; i < blockSize; ++i)
+		{
+			double mag = 0;
+			switch(corpus.dist)
+			{
+				case SPARSE:
+					if(nextRand() % 16 == 0)
+						mag = 1 + nextUniform() * scale;
+					break;
+				case LAPLACIAN:
+					mag = -log(nextUniform()) * scale / 8;
+					break;
+				case DENSE:
+					mag = nextUniform() * maxMag;
+					break;
+			}
+			uint32_t val = (uint32_t)(std::min)(mag, (double)maxMag);
+			bool negative = val && (nextRand() & 1);
+			corpus.samples[b * blockSize + i] = (negative ? 0x80000000 : 0) | (val << shift);
+		}
+	}
+}
+
+/**
+ * Encode all corpus blocks
+ *
+ * @param out if not null, receives concatenated code blocks
+ * @return total length of code blocks
+ */
+static size_t encodeAll(ht_encode_fn encode, Corpus& corpus, std::vector<uint8_t>* out)
+{
+	const size_t blockSize = (size_t)corpus.w * corpus.h;
+	// elastic allocator only releases memory on destruction
+	ojph::mem_elastic_allocator allocator(1 << 20);
+	size_t total = 0;
+	for(uint32_t b = 0; b < corpus.numBlocks; ++b)
+	{
+		ojph::coded_lists* coded = nullptr;
+		uint32_t lengths[2] = {0, 0};
+		encode(corpus.samples.data() + b * blockSize, corpus.missingMsbs, 1, corpus.w, corpus.h,
+			   corpus.w, lengths, &allocator, coded);
+		if(out)
+			out->insert(out->end(), coded->buf, coded->buf + lengths[0]);
+		total += lengths[0];
+	}
+
+	return total;
+}
+
+struct Encoder
+{
+	std::string name;
+	ht_encode_fn encode;
+	int64_t hwyTarget; // Highway target, or zero for generic encoder
+};
+
+/**
+ * Compress 4K 4:2:2 10 bit frames with HT block coding
+ *
+ * @return frames per second, or zero on failure
+ */
+static double frameRate(bool irreversible, uint32_t frames, size_t* frameLen)
+{
+	const uint32_t w = 3840, h = 2160;
+	grk_cparameters params;
+	grk_compress_set_default_params(&params);
+	params.cod_format = GRK_FMT_J2K;
+	params.cblk_sty = GRK_CBLKSTY_HT;
+	params.irreversible = irreversible;
+	params.numresolution = 6;
+	std::vector<uint8_t> out((size_t)w * h * 4 + (1 << 20));
+	double best = 0;
+	for(uint32_t i = 0; i < frames; ++i)
+	{
+		// compression modifies image samples, so each frame gets a fresh image
+		auto image = grk_bench::createImage(w, h, 3, 10, 1, 2);
+		if(!image)
+			return 0;
+		grk_bench::Timer timer;
+		uint64_t len = grk_bench::compress(image, &params, out);
+		double ms = timer.elapsedMs();
+		grk_object_unref(&image->obj);
+		if(!len)
+			return 0;
+		*frameLen = (size_t)len;
+		best = i == 0 ? ms : (std::min)(best, ms);
+	}
+
+	return 1000.0 / best;
+}
+
+int main(int argc, char** argv)
+{
+	uint32_t iterations = 20, numThreads = 0, frames = 5;
+	if(argc >= 2)
+		iterations = (uint32_t)atoi(argv[1]);
+	if(argc >= 3)
+		numThreads = (uint32_t)atoi(argv[2]);
+	if(argc >= 4)
+		frames = (uint32_t)(std::max)(1, atoi(argv[3]));
+	grk::Logger::logger_.error_handler = grk_bench::errorCallback;
+
+	std::vector<Encoder> encoders;
+	encoders.push_back({"generic", ojph::local::ojph_encode_codeblock, 0});
+	for(int64_t target : hwy::SupportedAndGeneratedTargets())
+		encoders.push_back({std::string("hwy ") + hwy::TargetName(target),
+							ojph::local::ojph_encode_codeblock_hwy, target});
+
+	// block sizes include odd and maximum widths, and single rows and columns,
+	// to exercise row tails and missing second rows
+	const uint32_t sizes[][2] = {{64, 64}, {32, 32}, {16, 16}, {64, 16}, {4, 4},   {37, 21},
+								 {15, 32}, {1024, 4}, {1, 1},  {3, 5},   {2, 1}, {1, 7}};
+	// 10 bit samples typically have 9 or 10 missing MSBs
+	const uint32_t missingMsbs[] = {0, 9, 13, 20, 29};
+	std::vector<Corpus> corpora;
+	for(auto& size : sizes)
+	{
+		for(uint32_t msbs : missingMsbs)
+		{
+			for(auto dist : {SPARSE, LAPLACIAN, DENSE})
+			{
+				Corpus corpus;
+				corpus.w = size[0];
+				corpus.h = size[1];
+				corpus.missingMsbs = msbs;
+				corpus.dist = dist;
+				generate(corpus, std::max<uint32_t>(16, 65536 / (size[0] * size[1])));
+				corpora.push_back(std::move(corpus));
+			}
+		}
+	}
+
+	// check encoders against generic encoder
+	for(auto& corpus : corpora)
+	{
+		std::vector<uint8_t> ref;
+		encodeAll(encoders[0].encode, corpus, &ref);
+		for(size_t e = 1; e < encoders.size(); ++e)
+		{
+			std::vector<uint8_t> out;
+			hwy::SetSupportedTargetsForTest(encoders[e].hwyTarget);
+			encodeAll(encoders[e].encode, corpus, &out);
+			hwy::SetSupportedTargetsForTest(0);
+			if(out != ref)
+			{
+				fprintf(stderr, "%s: %s encoder does not match generic encoder\n",
+						corpus.name().c_str(), encoders[e].name.c_str());
+				return EXIT_FAILURE;
+			}
+		}
+	}
+	printf("all encoders match generic encoder on %zu corpora\n\n", corpora.size());
+
+	// time encoders: ns per block, and Msamples/s
+	printf("%-22s", "corpus");
+	for(auto& e : encoders)
+		printf(" %14s", e.name.c_str());
+	printf("\n");
+	std::vector<double> totalMs(encoders.size(), 0);
+	uint64_t totalSamples = 0;
+	for(auto& corpus : corpora)
+	{
+		printf("%-22s", corpus.name().c_str());
+		for(size_t e = 0; e < encoders.size(); ++e)
+		{
+			if(encoders[e].hwyTarget)
+				hwy::SetSupportedTargetsForTest(encoders[e].hwyTarget);
+			double best = 0;
+			for(uint32_t r = 0; r < 3; ++r)
+			{
+				grk_bench::Timer timer;
+				for(uint32_t it = 0; it < iterations; ++it)
+					encodeAll(encoders[e].encode, corpus, nullptr);
+				double ms = timer.elapsedMs();
+				best = r == 0 ? ms : (std::min)(best, ms);
+			}
+			hwy::SetSupportedTargetsForTest(0);
+			totalMs[e] += best;
+			printf(" %11.0f ns", best * 1e6 / ((double)iterations * corpus.numBlocks));
+		}
+		printf("\n");
+		totalSamples += (uint64_t)iterations * corpus.numBlocks * corpus.w * corpus.h;
+	}
+	printf("%-22s", "Msamples/s");
+	for(size_t e = 0; e < encoders.size(); ++e)
+		printf(" %14.1f", (double)totalSamples / (totalMs[e] * 1000));
+	printf("\n%-22s", "speedup");
+	for(size_t e = 0; e < encoders.size(); ++e)
+		printf(" %13.2fx", totalMs[0] / totalMs[e]);
+	printf("\n\n");
+
+	// frame rate through the library
+	grk_bench::init(numThreads);
+	printf("3840 x 2160 4:2:2 10 bit HT compression, best of %u frames\n", frames);
+	printf("%-12s %12s %10s\n", "transform", "frame (KB)", "fps");
+	const char* transforms[] = {"5/3", "9/7"};
+	for(uint32_t irreversible = 0; irreversible < 2; ++irreversible)
+	{
+		size_t frameLen = 0;
+		double fps = frameRate(irreversible, frames, &frameLen);
+		if(fps == 0)
+		{
+			fprintf(stderr, "%s: compression failed\n", transforms[irreversible]);
+			return EXIT_FAILURE;
+		}
+		printf("%-12s %12zu %10.2f\n", transforms[irreversible], frameLen / 1024, fps);
+	}
+	grk_deinitialize();
+
+	return EXIT_SUCCESS;
+}
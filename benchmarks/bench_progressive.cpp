@@ -0,0 +1,167 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+/**
+ * Progressive decompression benchmark.
+ *
+ * An image is compressed with several quality layers in LRCP order, and the code stream
+ * is then fed to a progressive decompressor in equal chunks, as if it were arriving over
+ * a slow link. After each chunk the image is reconstructed, and compared with a
+ * decompression from scratch of the same prefix of the code stream. Update time for the
+ * progressive decompressor, which only decodes code blocks that have received new data,
+ * is reported alongside the time taken to decompress the prefix from scratch.
+ *
+ * Usage: bench_progressive [width [num_threads [num_chunks]]]
+ */
+#include <algorithm>
+#include <cstdlib>
+
+#include "bench_common.h"
+
+static bool sameImage(grk_image* a, grk_image* b)
+{
+	if(!a || !b || a->numcomps != b->numcomps)
+		return false;
+	for(uint16_t compno = 0; compno < a->numcomps; ++compno)
+	{
+		auto ca = a->comps + compno;
+		auto cb = b->comps + compno;
+		if(ca->w != cb->w || ca->h != cb->h)
+			return false;
+		for(uint32_t y = 0; y < ca->h; ++y)
+		{
+			if(memcmp(ca->data + (size_t)y * ca->stride, cb->data + (size_t)y * cb->stride,
+					  ca->w * sizeof(int32_t)) != 0)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+/**
+ * Decompress code stream prefix from scratch, and compare with progressive image
+ *
+ * @return decompression time in ms, or a negative value on mismatch
+ */
+static double decompressPrefix(std::vector<uint8_t>& in, size_t len, grk_image* progressive)
+{
+	grk_decompress_parameters params;
+	grk_decompress_set_default_params(&params);
+	grk_stream_params streamParams;
+	grk_set_default_stream_params(&streamParams);
+	streamParams.buf = in.data();
+	streamParams.buf_len = len;
+	grk_bench::Timer timer;
+	auto codec = grk_decompress_init(&streamParams, &params.core);
+	if(!codec)
+		return -1;
+	grk_header_info headerInfo;
+	memset(&headerInfo, 0, sizeof(headerInfo));
+	bool rc = grk_decompress_read_header(codec, &headerInfo) && grk_decompress(codec, nullptr);
+	double ms = timer.elapsedMs();
+	rc = rc && sameImage(grk_decompress_get_composited_image(codec), progressive);
+	grk_object_unref(codec);
+
+	return rc ? ms : -1;
+}
+
+int main(int argc, char** argv)
+{
+	uint32_t w = 2048, numThreads = 0, numChunks = 8;
+	if(argc >= 2)
+		w = (uint32_t)std::max(64, atoi(argv[1]));
+	if(argc >= 3)
+		numThreads = (uint32_t)atoi(argv[2]);
+	if(argc >= 4)
+		numChunks = (uint32_t)std::max(1, atoi(argv[3]));
+	const uint32_t h = w;
+	const uint16_t numComps = 3;
+	grk_bench::init(numThreads);
+
+	grk_cparameters params;
+	grk_compress_set_default_params(&params);
+	params.cod_format = GRK_FMT_J2K;
+	params.prog_order = GRK_LRCP;
+	params.numlayers = 6;
+	const double rates[] = {320, 160, 80, 40, 20, 10};
+	for(uint16_t i = 0; i < params.numlayers; ++i)
+		params.layer_rate[i] = rates[i];
+	params.allocationByRateDistoration = true;
+	auto image = grk_bench::createImage(w, h, numComps, 8);
+	if(!image)
+		return EXIT_FAILURE;
+	std::vector<uint8_t> stream((size_t)w * h * numComps + (1 << 20));
+	uint64_t len = grk_bench::compress(image, &params, stream);
+	grk_object_unref(&image->obj);
+	if(!len)
+	{
+		fprintf(stderr, "compression failed\n");
+		return EXIT_FAILURE;
+	}
+	stream.resize(len);
+
+	grk_decompress_parameters decompressParams;
+	grk_decompress_set_default_params(&decompressParams);
+	auto codec = grk_decompress_progressive_init(&decompressParams.core);
+	if(!codec)
+		return EXIT_FAILURE;
+	printf("%u x %u x %u, %u layers LRCP, %llu bytes in %u chunks\n", w, h, numComps,
+		   params.numlayers, (unsigned long long)len, numChunks);
+	printf("%12s %16s %16s\n", "bytes", "progressive (ms)", "scratch (ms)");
+	double totalProgressive = 0, totalScratch = 0;
+	bool headerRead = false;
+	size_t fed = 0;
+	for(uint32_t i = 1; i <= numChunks; ++i)
+	{
+		size_t end = (size_t)(len * i / numChunks);
+		grk_decompress_progressive_feed(codec, stream.data() + fed, end - fed);
+		fed = end;
+		grk_bench::Timer timer;
+		if(!headerRead)
+		{
+			grk_header_info headerInfo;
+			memset(&headerInfo, 0, sizeof(headerInfo));
+			headerRead = grk_decompress_read_header(codec, &headerInfo);
+		}
+		// main header may not have been fully received yet
+		if(!headerRead || !grk_decompress(codec, nullptr))
+		{
+			printf("%12zu %16s\n", fed, "-");
+			continue;
+		}
+		double ms = timer.elapsedMs();
+		auto progressive = grk_decompress_get_composited_image(codec);
+		double scratchMs = decompressPrefix(stream, fed, progressive);
+		if(scratchMs < 0)
+		{
+			fprintf(stderr, "%zu bytes: progressive image does not match decompression from "
+							"scratch\n",
+					fed);
+			return EXIT_FAILURE;
+		}
+		totalProgressive += ms;
+		totalScratch += scratchMs;
+		printf("%12zu %16.1f %16.1f\n", fed, ms, scratchMs);
+	}
+	grk_object_unref(codec);
+	grk_deinitialize();
+	printf("%12s %16.1f %16.1f\n", "total", totalProgressive, totalScratch);
+
+	return EXIT_SUCCESS;
+}
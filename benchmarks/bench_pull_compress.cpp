@@ -0,0 +1,199 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * Pull based compression input benchmark.
+ *
+ * Samples are generated on demand by a pull callback, in native 8 or 16 bit format,
+ * so the library only holds the tiles in flight. First, code streams compressed from
+ * pulled interleaved and planar samples are checked against code streams compressed
+ * from full image planes holding the same samples. Then a large tiled RGB image is
+ * compressed both ways, and time and peak resident memory are reported.
+ * Pulled input runs first, since peak resident memory never decreases.
+ *
+ * Usage: bench_pull_compress [width [num_threads [tile_size]]]
+ */
+#include <algorithm>
+#include <cstdlib>
+#include <sys/resource.h>
+
+#include "bench_common.h"
+
+struct Source
+{
+	uint8_t prec;
+	uint16_t numComps;
+	uint8_t bytesPerSample;
+	bool interleaved;
+};
+
+/**
+ * Deterministic synthetic sample, so that pulled and planar images match
+ */
+static int32_t sample(uint32_t x, uint32_t y, uint16_t compno, uint8_t prec)
+{
+	uint32_t hash = (x * 73856093u) ^ (y * 19349663u) ^ (compno * 83492791u);
+	hash ^= hash >> 13;
+	hash *= 0x5bd1e995;
+	hash ^= hash >> 15;
+	double v = 0.5 + 0.25 * sin(x / (17.0 + compno)) * cos(y / 23.0) +
+			   0.15 * (double)((x ^ y) & 63) / 63.0 + 0.05 * (double)(hash & 0xFF) / 255.0;
+	const int32_t maxVal = (1 << prec) - 1;
+
+	return std::clamp((int32_t)(v * maxVal), 0, maxVal);
+}
+
+static bool pull(grk_io_pull_request* request, void* user_data)
+{
+	auto source = (Source*)user_data;
+	uint16_t compBegin = source->interleaved ? 0 : request->compno;
+	uint16_t compEnd = source->interleaved ? source->numComps : (uint16_t)(request->compno + 1);
+	for(uint32_t y = request->y0; y < request->y1; ++y)
+	{
+		auto row = request->data + (y - request->y0) * request->stride;
+		size_t i = 0;
+		for(uint32_t x = request->x0; x < request->x1; ++x)
+		{
+			for(uint16_t compno = compBegin; compno < compEnd; ++compno, ++i)
+			{
+				int32_t s = sample(x, y, compno, source->prec);
+				if(source->bytesPerSample == 1)
+					row[i] = (uint8_t)s;
+				else
+					((uint16_t*)row)[i] = (uint16_t)s;
+			}
+		}
+	}
+
+	return true;
+}
+
+static grk_image* createImage(uint32_t w, uint32_t h, uint16_t numComps, uint8_t prec,
+							  bool allocData)
+{
+	std::vector<grk_image_comp> comps(numComps);
+	for(auto& c : comps)
+	{
+		memset(&c, 0, sizeof(grk_image_comp));
+		c.dx = 1;
+		c.dy = 1;
+		c.w = w;
+		c.h = h;
+		c.prec = prec;
+	}
+	auto image = grk_image_new(numComps, comps.data(),
+							   numComps == 3 ? GRK_CLRSPC_SRGB : GRK_CLRSPC_GRAY, allocData);
+	if(!image || !allocData)
+		return image;
+	for(uint16_t compno = 0; compno < numComps; ++compno)
+	{
+		auto comp = image->comps + compno;
+		for(uint32_t y = 0; y < h; ++y)
+			for(uint32_t x = 0; x < w; ++x)
+				comp->data[(size_t)y * comp->stride + x] = sample(x, y, compno, prec);
+	}
+
+	return image;
+}
+
+/**
+ * Compress synthetic image, pulled if source is not null
+ *
+ * @return compressed length, or zero on failure
+ */
+static uint64_t compress(uint32_t w, uint32_t tileSize, Source* source, uint16_t numComps,
+						 uint8_t prec, std::vector<uint8_t>& out)
+{
+	grk_cparameters params;
+	grk_compress_set_default_params(&params);
+	params.cod_format = GRK_FMT_J2K;
+	params.tile_size_on = true;
+	params.t_width = tileSize;
+	params.t_height = tileSize;
+	if(source)
+	{
+		params.io_pull_callback = pull;
+		params.io_pull_user_data = source;
+		params.io_pull_bytes_per_sample = source->bytesPerSample;
+		params.io_pull_interleaved = source->interleaved;
+	}
+	auto image = createImage(w, w, numComps, prec, !source);
+	if(!image)
+		return 0;
+	uint64_t len = grk_bench::compress(image, &params, out);
+	grk_object_unref(&image->obj);
+
+	return len;
+}
+
+static double peakResidentMB(void)
+{
+	struct rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+
+	return (double)usage.ru_maxrss / 1024.0;
+}
+
+int main(int argc, char** argv)
+{
+	uint32_t w = 4096, numThreads = 0, tileSize = 1024;
+	if(argc >= 2)
+		w = (uint32_t)std::max(64, atoi(argv[1]));
+	if(argc >= 3)
+		numThreads = (uint32_t)atoi(argv[2]);
+	if(argc >= 4)
+		tileSize = (uint32_t)std::max(64, atoi(argv[3]));
+	grk_bench::init(numThreads);
+
+	// check pulled input against planar input, with partial tiles at right and bottom edges
+	Source checks[] = {{8, 3, 1, true}, {12, 3, 2, false}, {8, 1, 1, false}};
+	for(auto& source : checks)
+	{
+		std::vector<uint8_t> ref(1 << 22), out(1 << 22);
+		uint64_t refLen = compress(500, 128, nullptr, source.numComps, source.prec, ref);
+		uint64_t len = compress(500, 128, &source, source.numComps, source.prec, out);
+		if(!refLen || refLen != len || memcmp(ref.data(), out.data(), len) != 0)
+		{
+			fprintf(stderr, "%u bit %s: pulled code stream does not match planar code stream\n",
+					source.prec, source.interleaved ? "interleaved" : "planar");
+			return EXIT_FAILURE;
+		}
+	}
+	printf("pulled code streams match planar code streams\n\n");
+
+	Source source = {8, 3, 1, true};
+	std::vector<uint8_t> out((size_t)w * w * 3 + (1 << 20));
+	double baseMB = peakResidentMB();
+	printf("%u x %u x 3, 8 bit, %u x %u tiles, lossless\n", w, w, tileSize, tileSize);
+	printf("%-12s %12s %16s\n", "input", "ms", "peak RSS (MB)");
+	const char* names[] = {"pulled", "planes"};
+	for(uint32_t i = 0; i < 2; ++i)
+	{
+		grk_bench::Timer timer;
+		uint64_t len = compress(w, tileSize, i == 0 ? &source : nullptr, 3, 8, out);
+		double ms = timer.elapsedMs();
+		if(!len)
+		{
+			fprintf(stderr, "%s: compression failed\n", names[i]);
+			return EXIT_FAILURE;
+		}
+		printf("%-12s %12.1f %16.1f\n", names[i], ms, peakResidentMB() - baseMB);
+	}
+	grk_deinitialize();
+
+	return EXIT_SUCCESS;
+}
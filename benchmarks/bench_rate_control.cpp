@@ -0,0 +1,127 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * Compare rate control algorithms: wall time, and achieved size against target size,
+ * for an increasing number of quality layers. Per-tile and image-wide rate control
+ * are then compared on a tiled image.
+ *
+ * Usage: bench_rate_control [width height [num_threads]]
+ */
+#include <cstdlib>
+#include <initializer_list>
+
+#include "bench_common.h"
+
+int main(int argc, char** argv)
+{
+	uint32_t w = 2048, h = 2048, numThreads = 0;
+	if(argc >= 3)
+	{
+		w = (uint32_t)atoi(argv[1]);
+		h = (uint32_t)atoi(argv[2]);
+	}
+	if(argc >= 4)
+		numThreads = (uint32_t)atoi(argv[3]);
+	grk_bench::init(numThreads);
+	const uint64_t rawBytes = (uint64_t)w * h * 3;
+	std::vector<uint8_t> out(rawBytes + (1 << 20));
+	const char* names[] = {"bisect", "pcrd_opt", "pcrd_incremental", "pcrd_global"};
+
+	printf("%-18s %7s %11s %12s %12s %8s\n", "algorithm", "layers", "time (ms)", "target (B)",
+		   "actual (B)", "actual%");
+	for(uint16_t numLayers : std::initializer_list<uint16_t>{1, 4, 12, 24, 48})
+	{
+		for(uint32_t algo = GRK_RATE_CONTROL_BISECT; algo <= GRK_RATE_CONTROL_PCRD_INCREMENTAL;
+			++algo)
+		{
+			grk_cparameters params;
+			grk_compress_set_default_params(&params);
+			params.cod_format = GRK_FMT_J2K;
+			params.irreversible = true;
+			params.allocationByRateDistoration = true;
+			params.rateControlAlgorithm = (GRK_RATE_CONTROL_ALGORITHM)algo;
+			params.numlayers = numLayers;
+			// compression ratios from 200 down to 10, evenly spaced in the log domain
+			for(uint16_t i = 0; i < numLayers; ++i)
+			{
+				double t = numLayers == 1 ? 1.0 : (double)i / (numLayers - 1);
+				params.layer_rate[i] = 200.0 * pow(10.0 / 200.0, t);
+			}
+			uint64_t target = (uint64_t)((double)rawBytes / params.layer_rate[numLayers - 1]);
+			// single tile compression works in place on image data, so image must be re-created
+			auto image = grk_bench::createImage(w, h, 3, 8);
+			if(!image)
+				return EXIT_FAILURE;
+			grk_bench::Timer timer;
+			uint64_t len = grk_bench::compress(image, &params, out);
+			double ms = timer.elapsedMs();
+			grk_object_unref(&image->obj);
+			if(!len)
+			{
+				fprintf(stderr, "%s: compression failed\n", names[algo]);
+				continue;
+			}
+			printf("%-18s %7u %11.1f %12llu %12llu %7.2f%%\n", names[algo], numLayers, ms,
+				   (unsigned long long)target, (unsigned long long)len,
+				   100.0 * (double)len / (double)target);
+		}
+	}
+	printf("\n%-18s %7s %11s %12s %12s %8s\n", "algorithm (tiled)", "layers", "time (ms)",
+		   "target (B)", "actual (B)", "actual%");
+	for(uint16_t numLayers : std::initializer_list<uint16_t>{1, 12})
+	{
+		for(uint32_t algo = GRK_RATE_CONTROL_PCRD_INCREMENTAL;
+			algo <= GRK_RATE_CONTROL_PCRD_GLOBAL; ++algo)
+		{
+			grk_cparameters params;
+			grk_compress_set_default_params(&params);
+			params.cod_format = GRK_FMT_J2K;
+			params.irreversible = true;
+			params.allocationByRateDistoration = true;
+			params.rateControlAlgorithm = (GRK_RATE_CONTROL_ALGORITHM)algo;
+			params.tile_size_on = true;
+			params.t_width = 256;
+			params.t_height = 256;
+			params.numlayers = numLayers;
+			for(uint16_t i = 0; i < numLayers; ++i)
+			{
+				double t = numLayers == 1 ? 1.0 : (double)i / (numLayers - 1);
+				params.layer_rate[i] = 200.0 * pow(10.0 / 200.0, t);
+			}
+			uint64_t target = (uint64_t)((double)rawBytes / params.layer_rate[numLayers - 1]);
+			auto image = grk_bench::createImage(w, h, 3, 8);
+			if(!image)
+				return EXIT_FAILURE;
+			grk_bench::Timer timer;
+			uint64_t len = grk_bench::compress(image, &params, out);
+			double ms = timer.elapsedMs();
+			grk_object_unref(&image->obj);
+			if(!len)
+			{
+				fprintf(stderr, "%s: compression failed\n", names[algo]);
+				continue;
+			}
+			printf("%-18s %7u %11.1f %12llu %12llu %7.2f%%\n", names[algo], numLayers, ms,
+				   (unsigned long long)target, (unsigned long long)len,
+				   100.0 * (double)len / (double)target);
+		}
+	}
+	grk_deinitialize();
+
+	return EXIT_SUCCESS;
+}
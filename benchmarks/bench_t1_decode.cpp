@@ -0,0 +1,138 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * Code block decompression benchmark: T1 plus dequantization into the tile window.
+ *
+ * Single resolution images are compressed for each code block size, with Part 1 and HT
+ * block coding, reversible and irreversible. Without wavelet transform, decompression
+ * time is dominated by block decoding and post processing. Reversible decompressions
+ * are checked against the original image.
+ *
+ * Usage: bench_t1_decode [width [num_threads [iterations]]]
+ */
+#include <algorithm>
+#include <cstdlib>
+
+#include "bench_common.h"
+
+/**
+ * Decompress code stream
+ *
+ * @return decompression time in ms, or negative value on failure
+ */
+static double decompress(std::vector<uint8_t>& in, grk_image* original)
+{
+	grk_decompress_parameters params;
+	grk_decompress_set_default_params(&params);
+	grk_stream_params streamParams;
+	grk_set_default_stream_params(&streamParams);
+	streamParams.buf = in.data();
+	streamParams.buf_len = in.size();
+	grk_bench::Timer timer;
+	auto codec = grk_decompress_init(&streamParams, &params.core);
+	if(!codec)
+		return -1;
+	grk_header_info headerInfo;
+	memset(&headerInfo, 0, sizeof(headerInfo));
+	bool rc = grk_decompress_read_header(codec, &headerInfo) && grk_decompress(codec, nullptr);
+	double ms = timer.elapsedMs();
+	auto image = rc ? grk_decompress_get_composited_image(codec) : nullptr;
+	if(image && original)
+	{
+		auto c = image->comps;
+		auto o = original->comps;
+		for(uint32_t y = 0; rc && y < c->h; ++y)
+			rc = memcmp(c->data + (size_t)y * c->stride, o->data + (size_t)y * o->stride,
+						c->w * sizeof(int32_t)) == 0;
+	}
+	grk_object_unref(codec);
+
+	return rc ? ms : -1;
+}
+
+int main(int argc, char** argv)
+{
+	uint32_t w = 2048, numThreads = 1, iterations = 5;
+	if(argc >= 2)
+		w = (uint32_t)std::max(64, atoi(argv[1]));
+	if(argc >= 3)
+		numThreads = (uint32_t)atoi(argv[2]);
+	if(argc >= 4)
+		iterations = (uint32_t)std::max(1, atoi(argv[3]));
+	const uint32_t h = w;
+	grk_bench::init(numThreads);
+
+	auto image = grk_bench::createImage(w, h, 1, 8);
+	if(!image)
+		return EXIT_FAILURE;
+
+	const uint32_t sizes[][2] = {{64, 64}, {32, 32}, {16, 16}, {128, 32}, {256, 16}};
+	printf("%u x %u, single resolution, %u thread(s), best of %u\n", w, h, numThreads,
+		   iterations);
+	printf("%10s %12s %12s %12s %12s\n", "block", "part1 rev", "part1 irrev", "HT rev",
+		   "HT irrev");
+	printf("%10s %12s %12s %12s %12s\n", "", "(MS/s)", "(MS/s)", "(MS/s)", "(MS/s)");
+	for(auto& size : sizes)
+	{
+		printf("%6u x %-3u", size[0], size[1]);
+		for(bool ht : {false, true})
+		{
+			for(bool irreversible : {false, true})
+			{
+				grk_cparameters params;
+				grk_compress_set_default_params(&params);
+				params.cod_format = GRK_FMT_J2K;
+				params.numresolution = 1;
+				params.cblockw_init = size[0];
+				params.cblockh_init = size[1];
+				params.irreversible = irreversible;
+				if(ht)
+					params.cblk_sty = GRK_CBLKSTY_HT;
+				// compression modifies image samples, so compress a fresh copy
+				auto copy = grk_bench::createImage(w, h, 1, 8);
+				std::vector<uint8_t> stream((size_t)w * h * 2 + (1 << 20));
+				uint64_t len = copy ? grk_bench::compress(copy, &params, stream) : 0;
+				if(copy)
+					grk_object_unref(&copy->obj);
+				if(!len)
+				{
+					fprintf(stderr, "\ncompression failed\n");
+					return EXIT_FAILURE;
+				}
+				stream.resize(len);
+				double best = 0;
+				for(uint32_t i = 0; i < iterations; ++i)
+				{
+					double ms = decompress(stream, irreversible ? nullptr : image);
+					if(ms < 0)
+					{
+						fprintf(stderr, "\ndecompression failed or does not match original\n");
+						return EXIT_FAILURE;
+					}
+					best = i == 0 ? ms : std::min(best, ms);
+				}
+				printf(" %12.1f", (double)w * h / (best * 1000.0));
+			}
+		}
+		printf("\n");
+	}
+	grk_object_unref(&image->obj);
+	grk_deinitialize();
+
+	return EXIT_SUCCESS;
+}
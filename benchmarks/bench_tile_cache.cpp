@@ -0,0 +1,173 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * Tile cache benchmark.
+ *
+ * A tiled image is compressed, and a viewer panning across it is simulated with a sequence
+ * of overlapping decompress windows. Each window is decompressed by a single decompressor
+ * with LRU tile cache, which only decompresses tiles that are not already cached, and by a
+ * new decompressor without tile cache, as a tile server would do without caching.
+ * Windows from the cached decompressor are checked against a full decompression.
+ *
+ * Usage: bench_tile_cache [width [num_threads [budget_MB]]]
+ */
+#include <algorithm>
+#include <cstdlib>
+
+#include "bench_common.h"
+
+static grk_codec* openDecompressor(std::vector<uint8_t>& in, GRK_TILE_CACHE_STRATEGY strategy,
+								   uint64_t budget)
+{
+	grk_decompress_parameters params;
+	grk_decompress_set_default_params(&params);
+	params.core.tileCacheStrategy = strategy;
+	params.core.tileCacheBudget = budget;
+	grk_stream_params streamParams;
+	grk_set_default_stream_params(&streamParams);
+	streamParams.buf = in.data();
+	streamParams.buf_len = in.size();
+	auto codec = grk_decompress_init(&streamParams, &params.core);
+	if(!codec)
+		return nullptr;
+	grk_header_info headerInfo;
+	memset(&headerInfo, 0, sizeof(headerInfo));
+	if(!grk_decompress_read_header(codec, &headerInfo))
+	{
+		grk_object_unref(codec);
+		return nullptr;
+	}
+
+	return codec;
+}
+
+/**
+ * Compare window with same region of full image
+ */
+static bool sameRegion(grk_image* window, grk_image* full)
+{
+	if(!window || !full || window->numcomps != full->numcomps)
+		return false;
+	for(uint16_t compno = 0; compno < window->numcomps; ++compno)
+	{
+		auto cw = window->comps + compno;
+		auto cf = full->comps + compno;
+		for(uint32_t y = 0; y < cw->h; ++y)
+		{
+			auto src = cf->data + (size_t)(y + cw->y0) * cf->stride + cw->x0;
+			if(memcmp(cw->data + (size_t)y * cw->stride, src, cw->w * sizeof(int32_t)) != 0)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+int main(int argc, char** argv)
+{
+	uint32_t w = 4096, numThreads = 0;
+	uint64_t budgetMB = 64;
+	if(argc >= 2)
+		w = (uint32_t)std::max(1024, atoi(argv[1]));
+	if(argc >= 3)
+		numThreads = (uint32_t)atoi(argv[2]);
+	if(argc >= 4)
+		budgetMB = (uint64_t)std::max(1, atoi(argv[3]));
+	const uint32_t h = w;
+	const uint16_t numComps = 3;
+	const uint32_t tileSize = 256;
+	grk_bench::init(numThreads);
+
+	grk_cparameters params;
+	grk_compress_set_default_params(&params);
+	params.cod_format = GRK_FMT_J2K;
+	params.tile_size_on = true;
+	params.t_width = tileSize;
+	params.t_height = tileSize;
+	auto image = grk_bench::createImage(w, h, numComps, 8);
+	if(!image)
+		return EXIT_FAILURE;
+	std::vector<uint8_t> stream((size_t)w * h * numComps * 2 + (1 << 20));
+	uint64_t len = grk_bench::compress(image, &params, stream);
+	grk_object_unref(&image->obj);
+	if(!len)
+	{
+		fprintf(stderr, "compression failed\n");
+		return EXIT_FAILURE;
+	}
+	stream.resize(len);
+
+	auto full = openDecompressor(stream, GRK_TILE_CACHE_NONE, 0);
+	if(!full || !grk_decompress(full, nullptr))
+		return EXIT_FAILURE;
+	auto fullImage = grk_decompress_get_composited_image(full);
+	auto cached = openDecompressor(stream, GRK_TILE_CACHE_LRU, budgetMB << 20);
+	if(!cached)
+		return EXIT_FAILURE;
+
+	// pan diagonally, a quarter of the window at a time, then back again
+	const uint32_t win = 1024, step = win / 4;
+	std::vector<std::pair<uint32_t, uint32_t>> origins;
+	for(uint32_t o = 0; o + win <= std::min(w, h); o += step)
+		origins.push_back({o, o / 2});
+	std::vector<std::pair<uint32_t, uint32_t>> back(origins.rbegin(), origins.rend());
+	origins.insert(origins.end(), back.begin(), back.end());
+
+	printf("%u x %u x %u, %u x %u tiles, %u x %u window, %llu MB budget\n", w, h, numComps,
+		   tileSize, tileSize, win, win, (unsigned long long)budgetMB);
+	printf("%12s %12s %12s\n", "window", "cached (ms)", "uncached (ms)");
+	double totalCached = 0, totalUncached = 0;
+	for(size_t i = 0; i < origins.size(); ++i)
+	{
+		auto x0 = (float)origins[i].first;
+		auto y0 = (float)origins[i].second;
+		grk_bench::Timer timer;
+		if(!grk_decompress_set_window(cached, x0, y0, x0 + win, y0 + win) ||
+		   !grk_decompress(cached, nullptr))
+			return EXIT_FAILURE;
+		double cachedMs = timer.elapsedMs();
+		if(!sameRegion(grk_decompress_get_composited_image(cached), fullImage))
+		{
+			fprintf(stderr, "window %zu does not match full decompression\n", i);
+			return EXIT_FAILURE;
+		}
+
+		timer = grk_bench::Timer();
+		auto uncached = openDecompressor(stream, GRK_TILE_CACHE_NONE, 0);
+		if(!uncached || !grk_decompress_set_window(uncached, x0, y0, x0 + win, y0 + win) ||
+		   !grk_decompress(uncached, nullptr))
+			return EXIT_FAILURE;
+		double uncachedMs = timer.elapsedMs();
+		grk_object_unref(uncached);
+
+		totalCached += cachedMs;
+		totalUncached += uncachedMs;
+		printf("%12zu %12.1f %12.1f\n", i, cachedMs, uncachedMs);
+	}
+	grk_tile_cache_stats stats;
+	grk_decompress_get_tile_cache_stats(cached, &stats);
+	printf("%12s %12.1f %12.1f\n", "total", totalCached, totalUncached);
+	printf("tile cache: %llu hits, %llu misses, %llu evictions, %llu MB cached\n",
+		   (unsigned long long)stats.hits, (unsigned long long)stats.misses,
+		   (unsigned long long)stats.evictions, (unsigned long long)(stats.bytes >> 20));
+	grk_object_unref(cached);
+	grk_object_unref(full);
+	grk_deinitialize();
+
+	return EXIT_SUCCESS;
+}
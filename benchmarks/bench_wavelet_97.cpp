@@ -0,0 +1,121 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * Inverse 9/7 lifting micro-benchmark, run once for every SIMD target
+ * compiled in and supported by this CPU. For each target, lines are transformed
+ * four at a time (partial decompression) and full vector width at a time
+ * (full tile decompression).
+ *
+ * Usage: bench_wavelet_97 [line_length [num_lines [iterations]]]
+ */
+#undef HWY_TARGET_INCLUDE
+#define HWY_TARGET_INCLUDE "bench_wavelet_97.cpp"
+#include <hwy/foreach_target.h>
+#include <hwy/highway.h>
+#include "wavelet/WaveletReverse97-inl.h"
+
+#include "bench_common.h"
+
+HWY_BEFORE_NAMESPACE();
+namespace grk
+{
+namespace HWY_NAMESPACE
+{
+	/**
+	 * Inverse transform numLines lines of length len (even parity), width lines at a time
+	 * @return elapsed time in ms
+	 */
+	static double bench_97(float* buf, uint32_t len, uint32_t numLines, uint32_t iterations,
+						   bool fullWidth, uint32_t* width)
+	{
+		*width = fullWidth ? (uint32_t)hwy_num_lanes_97() : 4;
+		const uint32_t w = *width;
+		const uint32_t sn = (len + 1) / 2;
+		const uint32_t dn = len / 2;
+		grk_bench::Timer timer;
+		for(uint32_t it = 0; it < iterations; ++it)
+		{
+			for(uint32_t line = 0; line < numLines; line += w)
+			{
+				// low band at even elements, high band at odd elements
+				hwy_decompress_step1_97(buf, sn, w, 1.230174105f);
+				hwy_decompress_step1_97(buf + w, dn, w, 1.625732422f);
+				hwy_decompress_step2_97(buf + w, buf + w, sn, (std::min)(sn, dn), w,
+										-0.443506852f);
+				hwy_decompress_step2_97(buf, buf + 2 * w, dn, (std::min)(dn, sn - 1), w,
+										-0.882911075f);
+				hwy_decompress_step2_97(buf + w, buf + w, sn, (std::min)(sn, dn), w,
+										0.052980118f);
+				hwy_decompress_step2_97(buf, buf + 2 * w, dn, (std::min)(dn, sn - 1), w,
+										1.586134342f);
+			}
+		}
+
+		return timer.elapsedMs();
+	}
+} // namespace HWY_NAMESPACE
+} // namespace grk
+HWY_AFTER_NAMESPACE();
+
+#if HWY_ONCE
+#include <cstdlib>
+#include <hwy/aligned_allocator.h>
+
+namespace grk
+{
+HWY_EXPORT(bench_97);
+} // namespace grk
+
+int main(int argc, char** argv)
+{
+	uint32_t len = 4096, numLines = 4096, iterations = 4;
+	if(argc >= 2)
+		len = (uint32_t)atoi(argv[1]);
+	if(argc >= 3)
+		numLines = (uint32_t)atoi(argv[2]);
+	if(argc >= 4)
+		iterations = (uint32_t)atoi(argv[3]);
+	if(len < 4)
+		len = 4;
+	// large enough for the widest target: 2048 bit vectors
+	const size_t maxWidth = 64;
+	auto buf = hwy::AllocateAligned<float>(len * maxWidth);
+	for(size_t i = 0; i < len * maxWidth; ++i)
+		buf[i] = (float)((i * 2654435761U) & 0xFF) - 128.0f;
+
+	const double numSamples = (double)len * numLines * iterations;
+	printf("%-12s %6s %11s %14s\n", "target", "lines", "time (ms)", "Msamples/s");
+	for(int64_t target : hwy::SupportedAndGeneratedTargets())
+	{
+		hwy::SetSupportedTargetsForTest(target);
+		for(bool fullWidth : {false, true})
+		{
+			uint32_t width = 0;
+			for(size_t i = 0; i < len * maxWidth; ++i)
+				buf[i] = (float)((i * 2654435761U) & 0xFF) - 128.0f;
+			double ms = HWY_DYNAMIC_DISPATCH(grk::bench_97)(buf.get(), len, numLines, iterations,
+															fullWidth, &width);
+			printf("%-12s %6u %11.1f %14.1f\n", hwy::TargetName(target), width, ms,
+				   numSamples / (ms * 1000.0));
+		}
+	}
+	hwy::SetSupportedTargetsForTest(0);
+
+	return EXIT_SUCCESS;
+}
+#endif
@@ -0,0 +1,198 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * Compare two pass and fused inverse wavelet transforms on large single tile images.
+ *
+ * Images have smooth content, so that the wavelet transform, rather than
+ * block decoding, dominates decompression time. Fused output is first checked
+ * against two pass output, for both 5/3 and 9/7 transforms and for odd image
+ * origins, and then whole image decompression is timed for each strategy.
+ *
+ * Usage: bench_wavelet_fused [width height [num_threads [repeats]]]
+ */
+#include <algorithm>
+#include <cstdlib>
+
+#include "bench_common.h"
+
+static grk_image* createSmoothImage(uint32_t w, uint32_t h, uint32_t x0, uint32_t y0)
+{
+	auto image = grk_bench::createImage(w, h, 1, 12);
+	if(!image)
+		return nullptr;
+	image->x0 = x0;
+	image->y0 = y0;
+	image->x1 = x0 + w;
+	image->y1 = y0 + h;
+	auto comp = image->comps;
+	comp->x0 = x0;
+	comp->y0 = y0;
+	auto data = (int32_t*)comp->data;
+	for(uint32_t y = 0; y < h; ++y)
+	{
+		for(uint32_t x = 0; x < w; ++x)
+		{
+			double v =
+				0.5 + 0.3 * sin(x / 97.0) * cos(y / 131.0) + 0.15 * (double)(x + y) / (w + h);
+			data[(size_t)y * comp->stride + x] = (int32_t)(v * 4095);
+		}
+	}
+
+	return image;
+}
+
+static bool compressSmooth(uint32_t w, uint32_t h, uint32_t x0, uint32_t y0, bool irreversible,
+						   std::vector<uint8_t>& out)
+{
+	auto image = createSmoothImage(w, h, x0, y0);
+	if(!image)
+		return false;
+	grk_cparameters params;
+	grk_compress_set_default_params(&params);
+	params.cod_format = GRK_FMT_J2K;
+	params.irreversible = irreversible;
+	params.numresolution = 7;
+	if(irreversible)
+	{
+		params.allocationByRateDistoration = true;
+		params.numlayers = 1;
+		params.layer_rate[0] = 20;
+	}
+	out.resize((size_t)w * h * 2 + (1 << 20));
+	uint64_t len = grk_bench::compress(image, &params, out);
+	grk_object_unref(&image->obj);
+	out.resize(len);
+
+	return len != 0;
+}
+
+/**
+ * Decompress code stream with given wavelet strategy
+ *
+ * @return decompressed samples, or empty vector on failure
+ */
+static std::vector<int32_t> decompress(std::vector<uint8_t>& in, GRK_WAVELET_STRATEGY strategy,
+									   double* ms)
+{
+	std::vector<int32_t> rc;
+	grk_decompress_parameters params;
+	grk_decompress_set_default_params(&params);
+	params.core.waveletStrategy = strategy;
+	grk_stream_params streamParams;
+	grk_set_default_stream_params(&streamParams);
+	streamParams.buf = in.data();
+	streamParams.buf_len = in.size();
+	grk_bench::Timer timer;
+	auto codec = grk_decompress_init(&streamParams, &params.core);
+	if(!codec)
+		return rc;
+	grk_header_info headerInfo;
+	memset(&headerInfo, 0, sizeof(headerInfo));
+	if(grk_decompress_read_header(codec, &headerInfo) && grk_decompress(codec, nullptr))
+	{
+		if(ms)
+			*ms = timer.elapsedMs();
+		auto image = grk_decompress_get_composited_image(codec);
+		auto comp = image->comps;
+		auto data = (int32_t*)comp->data;
+		rc.resize((size_t)comp->w * comp->h);
+		for(uint32_t y = 0; y < comp->h; ++y)
+			memcpy(rc.data() + (size_t)y * comp->w, data + (size_t)y * comp->stride,
+				   comp->w * sizeof(int32_t));
+	}
+	grk_object_unref(codec);
+
+	return rc;
+}
+
+int main(int argc, char** argv)
+{
+	uint32_t w = 8192, h = 8192, numThreads = 0, repeats = 3;
+	if(argc >= 3)
+	{
+		w = (uint32_t)atoi(argv[1]);
+		h = (uint32_t)atoi(argv[2]);
+	}
+	if(argc >= 4)
+		numThreads = (uint32_t)atoi(argv[3]);
+	if(argc >= 5)
+		repeats = (uint32_t)atoi(argv[4]);
+	grk_bench::init(numThreads);
+	const char* transforms[] = {"5/3", "9/7"};
+
+	// check fused transform against two pass transform
+	const uint32_t origins[][2] = {{0, 0}, {1, 0}, {0, 1}, {3, 5}};
+	for(uint32_t irreversible = 0; irreversible < 2; ++irreversible)
+	{
+		for(const auto& origin : origins)
+		{
+			std::vector<uint8_t> code;
+			if(!compressSmooth(1021, 779, origin[0], origin[1], irreversible, code))
+			{
+				fprintf(stderr, "%s: compression failed\n", transforms[irreversible]);
+				return EXIT_FAILURE;
+			}
+			auto twoPass = decompress(code, GRK_WAVELET_TWO_PASS, nullptr);
+			auto fused = decompress(code, GRK_WAVELET_FUSED, nullptr);
+			if(twoPass.empty() || twoPass != fused)
+			{
+				fprintf(stderr, "%s: fused transform mismatch for origin (%u,%u)\n",
+						transforms[irreversible], origin[0], origin[1]);
+				return EXIT_FAILURE;
+			}
+		}
+	}
+	printf("fused transform matches two pass transform\n\n");
+
+	const GRK_WAVELET_STRATEGY strategies[] = {GRK_WAVELET_TWO_PASS, GRK_WAVELET_FUSED,
+											   GRK_WAVELET_AUTO};
+	const char* names[] = {"two pass", "fused", "auto"};
+	printf("%u x %u single tile, best of %u\n", w, h, repeats);
+	printf("%-10s %-10s %12s %9s\n", "transform", "strategy", "time (ms)", "speedup");
+	for(uint32_t irreversible = 0; irreversible < 2; ++irreversible)
+	{
+		std::vector<uint8_t> code;
+		if(!compressSmooth(w, h, 0, 0, irreversible, code))
+		{
+			fprintf(stderr, "%s: compression failed\n", transforms[irreversible]);
+			return EXIT_FAILURE;
+		}
+		double baseline = 0;
+		for(uint32_t i = 0; i < 3; ++i)
+		{
+			double best = 0;
+			for(uint32_t r = 0; r < repeats; ++r)
+			{
+				double ms = 0;
+				if(decompress(code, strategies[i], &ms).empty())
+				{
+					fprintf(stderr, "%s: decompression failed\n", transforms[irreversible]);
+					return EXIT_FAILURE;
+				}
+				best = r == 0 ? ms : (std::min)(best, ms);
+			}
+			if(i == 0)
+				baseline = best;
+			printf("%-10s %-10s %12.1f %8.2fx\n", transforms[irreversible], names[i], best,
+				   baseline / best);
+		}
+	}
+	grk_deinitialize();
+
+	return EXIT_SUCCESS;
+}
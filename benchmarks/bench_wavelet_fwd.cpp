@@ -0,0 +1,319 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/**
+ * Forward 5/3 and 9/7 wavelet micro-benchmark and bit exactness check.
+ *
+ * For every SIMD target compiled in and supported by this CPU, one decomposition level
+ * is first computed over a range of small image sizes and all four parities, and compared
+ * bit for bit with the scalar lifting implementation. Then a large image is transformed
+ * and timed. Exits with failure if any target does not match the scalar implementation.
+ *
+ * Usage: bench_wavelet_fwd [width [height [iterations]]]
+ */
+#undef HWY_TARGET_INCLUDE
+#define HWY_TARGET_INCLUDE "bench_wavelet_fwd.cpp"
+#include <hwy/foreach_target.h>
+#include <hwy/highway.h>
+#include "wavelet/WaveletFwd-inl.h"
+
+#include "bench_common.h"
+
+HWY_BEFORE_NAMESPACE();
+namespace grk
+{
+namespace HWY_NAMESPACE
+{
+	/**
+	 * One level of forward transform of w x h image, in place, as
+	 * done by the compressor: vertical pass, then horizontal pass.
+	 * tmp holds at least max(w,h) * hwy_fwd_num_cols() samples.
+	 */
+	template<typename T, class V, class H>
+	static void fwd_2d(T* img, T* tmp, uint32_t w, uint32_t h, uint32_t stride, bool evenRow,
+					   bool evenCol, V vert, H horiz)
+	{
+		const uint32_t pllCols = (uint32_t)hwy_fwd_num_cols();
+		const uint32_t sn = (h + (evenCol ? 1 : 0)) >> 1;
+		for(uint32_t j = 0; j < w; j += pllCols)
+		{
+			const uint32_t cols = (std::min)(pllCols, w - j);
+			for(uint32_t k = 0; k < h; ++k)
+			{
+				uint32_t band = (k & 1) ^ (evenCol ? 0 : 1);
+				T* dest = tmp + (size_t)((band ? sn : 0) + (k >> 1)) * pllCols;
+				memcpy(dest, img + (size_t)k * stride + j, cols * sizeof(T));
+				memset(dest + cols, 0, (pllCols - cols) * sizeof(T));
+			}
+			vert(tmp, sn, h - sn, evenCol, pllCols);
+			for(uint32_t k = 0; k < h; ++k)
+				memcpy(img + (size_t)k * stride + j, tmp + (size_t)k * pllCols, cols * sizeof(T));
+		}
+		for(uint32_t k = 0; k < h; ++k)
+			horiz(img + (size_t)k * stride, tmp, w, evenRow);
+	}
+	static void fwd_2d_53(int32_t* img, int32_t* tmp, uint32_t w, uint32_t h, uint32_t stride,
+						  bool evenRow, bool evenCol)
+	{
+		fwd_2d(img, tmp, w, h, stride, evenRow, evenCol, hwy_fwd_v_53, hwy_fwd_h_53);
+	}
+	static void fwd_2d_97(float* img, float* tmp, uint32_t w, uint32_t h, uint32_t stride,
+						  bool evenRow, bool evenCol)
+	{
+		fwd_2d(img, tmp, w, h, stride, evenRow, evenCol, hwy_fwd_v_97, hwy_fwd_h_97);
+	}
+	static size_t num_cols(void)
+	{
+		return hwy_fwd_num_cols();
+	}
+} // namespace HWY_NAMESPACE
+} // namespace grk
+HWY_AFTER_NAMESPACE();
+
+#if HWY_ONCE
+#include <cstdlib>
+#include <hwy/aligned_allocator.h>
+
+namespace grk
+{
+HWY_EXPORT(fwd_2d_53);
+HWY_EXPORT(fwd_2d_97);
+HWY_EXPORT(num_cols);
+
+/*
+ Scalar reference: lifting on interleaved line, followed by
+ deinterleaving into low band then high band
+ */
+static const float ref_alpha = -1.586134342f;
+static const float ref_beta = -0.052980118f;
+static const float ref_gamma = 0.882911075f;
+static const float ref_delta = 0.443506852f;
+static const float ref_K = 1.230174105f;
+static const float ref_invK = (float)(1.0 / 1.230174105);
+
+template<typename T>
+static void ref_deinterleave(const T* a, T* b, uint32_t len, bool even)
+{
+	const uint32_t sn = (len + (even ? 1 : 0)) >> 1;
+	const uint32_t parity = even ? 0 : 1;
+	for(uint32_t i = 0; i < sn; ++i)
+		b[i] = a[parity + 2 * i];
+	for(uint32_t i = 0; i < len - sn; ++i)
+		b[sn + i] = a[1 - parity + 2 * i];
+}
+
+static void ref_1d_53(int32_t* x, int32_t* tmp, uint32_t len, bool even)
+{
+	if(len == 1)
+	{
+		if(!even)
+			x[0] *= 2;
+		return;
+	}
+	const int64_t n = len;
+	// low band samples sit at even positions for even lines
+	const int64_t lo = even ? 0 : 1;
+	auto at = [&](int64_t i) {
+		// whole sample symmetric extension
+		if(i < 0)
+			i = -i;
+		if(i >= n)
+			i = 2 * (n - 1) - i;
+		return x[i];
+	};
+	for(int64_t i = 1 - lo; i < n; i += 2)
+		x[i] -= (at(i - 1) + at(i + 1)) >> 1;
+	for(int64_t i = lo; i < n; i += 2)
+		x[i] += (at(i - 1) + at(i + 1) + 2) >> 2;
+	ref_deinterleave(x, tmp, len, even);
+	memcpy(x, tmp, len * sizeof(int32_t));
+}
+
+static void ref_1d_97(float* x, float* tmp, uint32_t len, bool even)
+{
+	if(len == 1)
+		return;
+	const int64_t n = len;
+	const int64_t lo = even ? 0 : 1;
+	auto at = [&](int64_t i) {
+		if(i < 0)
+			i = -i;
+		if(i >= n)
+			i = 2 * (n - 1) - i;
+		return x[i];
+	};
+	for(float c : {ref_alpha, ref_beta, ref_gamma, ref_delta})
+	{
+		const int64_t start = (c == ref_alpha || c == ref_gamma) ? 1 - lo : lo;
+		for(int64_t i = start; i < n; i += 2)
+			x[i] += (at(i - 1) + at(i + 1)) * c;
+	}
+	for(int64_t i = 0; i < n; ++i)
+		x[i] *= ((i & 1) == lo) ? ref_invK : ref_K;
+	ref_deinterleave(x, tmp, len, even);
+	memcpy(x, tmp, len * sizeof(float));
+}
+
+template<typename T>
+static void ref_2d(T* img, uint32_t w, uint32_t h, uint32_t stride, bool evenRow, bool evenCol,
+				   void (*fn)(T*, T*, uint32_t, bool))
+{
+	std::vector<T> line((std::max)(w, h)), tmp((std::max)(w, h));
+	for(uint32_t j = 0; j < w; ++j)
+	{
+		for(uint32_t k = 0; k < h; ++k)
+			line[k] = img[(size_t)k * stride + j];
+		fn(line.data(), tmp.data(), h, evenCol);
+		for(uint32_t k = 0; k < h; ++k)
+			img[(size_t)k * stride + j] = line[k];
+	}
+	for(uint32_t k = 0; k < h; ++k)
+		fn(img + (size_t)k * stride, tmp.data(), w, evenRow);
+}
+
+template<typename T>
+static void fill(T* img, size_t len, uint32_t seed)
+{
+	for(size_t i = 0; i < len; ++i)
+	{
+		seed = seed * 1103515245 + 12345;
+		img[i] = (T)(int32_t)((seed >> 16) & 0xFFFF) - (T)32768;
+	}
+}
+
+/**
+ * Compare all sizes up to maxDim x maxDim and all parities with scalar reference
+ * @return number of mismatches
+ */
+template<typename T>
+static uint32_t verify(void (*fn)(T*, T*, uint32_t, uint32_t, uint32_t, bool, bool),
+					   void (*ref)(T*, T*, uint32_t, bool))
+{
+	const uint32_t maxDim = 70;
+	const uint32_t stride = maxDim + 3;
+	auto img = hwy::AllocateAligned<T>((size_t)stride * maxDim);
+	auto expected = hwy::AllocateAligned<T>((size_t)stride * maxDim);
+	auto tmp = hwy::AllocateAligned<T>((size_t)maxDim * HWY_DYNAMIC_DISPATCH(num_cols)());
+	uint32_t mismatches = 0;
+	for(uint32_t h = 1; h <= maxDim; h += (h < 20 ? 1 : 7))
+	{
+		for(uint32_t w = 1; w <= maxDim; w += (w < 20 ? 1 : 5))
+		{
+			for(uint32_t parity = 0; parity < 4; ++parity)
+			{
+				bool evenRow = (parity & 1) == 0;
+				bool evenCol = (parity & 2) == 0;
+				fill(img.get(), (size_t)stride * h, w * 131 + h);
+				memcpy(expected.get(), img.get(), (size_t)stride * h * sizeof(T));
+				ref_2d<T>(expected.get(), w, h, stride, evenRow, evenCol, ref);
+				fn(img.get(), tmp.get(), w, h, stride, evenRow, evenCol);
+				for(uint32_t k = 0; k < h; ++k)
+				{
+					if(memcmp(img.get() + (size_t)k * stride, expected.get() + (size_t)k * stride,
+							  w * sizeof(T)) != 0)
+					{
+						if(!mismatches)
+							fprintf(stderr, "mismatch: %ux%u, parity (%d,%d), row %u\n", w, h,
+									!evenRow, !evenCol, k);
+						mismatches++;
+						break;
+					}
+				}
+			}
+		}
+	}
+
+	return mismatches;
+}
+
+template<typename T>
+static double bench(void (*fn)(T*, T*, uint32_t, uint32_t, uint32_t, bool, bool),
+					void (*ref)(T*, T*, uint32_t, bool), uint32_t w, uint32_t h,
+					uint32_t iterations)
+{
+	auto img = hwy::AllocateAligned<T>((size_t)w * h);
+	const size_t maxCols = 64;
+	auto tmp = hwy::AllocateAligned<T>((size_t)(std::max)(w, h) * maxCols);
+	double ms = 0;
+	for(uint32_t it = 0; it < iterations; ++it)
+	{
+		fill(img.get(), (size_t)w * h, it);
+		grk_bench::Timer timer;
+		if(fn)
+			fn(img.get(), tmp.get(), w, h, w, true, true);
+		else
+			ref_2d<T>(img.get(), w, h, w, true, true, ref);
+		ms += timer.elapsedMs();
+	}
+
+	return ms;
+}
+
+} // namespace grk
+
+int main(int argc, char** argv)
+{
+	uint32_t w = 4096, h = 4096, iterations = 4;
+	if(argc >= 2)
+		w = (uint32_t)atoi(argv[1]);
+	if(argc >= 3)
+		h = (uint32_t)atoi(argv[2]);
+	if(argc >= 4)
+		iterations = (uint32_t)atoi(argv[3]);
+	if(!w || !h || !iterations)
+		return EXIT_FAILURE;
+
+	const double numSamples = (double)w * h * iterations;
+	uint32_t failures = 0;
+	printf("%-12s %6s %6s %11s %14s\n", "target", "filter", "exact", "time (ms)", "Msamples/s");
+	for(int filter = 0; filter < 2; ++filter)
+	{
+		double ms = filter == 0 ? grk::bench<int32_t>(nullptr, grk::ref_1d_53, w, h, iterations)
+								: grk::bench<float>(nullptr, grk::ref_1d_97, w, h, iterations);
+		printf("%-12s %6s %6s %11.1f %14.1f\n", "reference", filter == 0 ? "5/3" : "9/7", "-", ms,
+			   numSamples / (ms * 1000.0));
+	}
+	for(int64_t target : hwy::SupportedAndGeneratedTargets())
+	{
+		hwy::SetSupportedTargetsForTest(target);
+		for(int filter = 0; filter < 2; ++filter)
+		{
+			uint32_t mismatches;
+			double ms;
+			if(filter == 0)
+			{
+				auto fn = HWY_DYNAMIC_DISPATCH(grk::fwd_2d_53);
+				mismatches = grk::verify<int32_t>(fn, grk::ref_1d_53);
+				ms = grk::bench<int32_t>(fn, nullptr, w, h, iterations);
+			}
+			else
+			{
+				auto fn = HWY_DYNAMIC_DISPATCH(grk::fwd_2d_97);
+				mismatches = grk::verify<float>(fn, grk::ref_1d_97);
+				ms = grk::bench<float>(fn, nullptr, w, h, iterations);
+			}
+			failures += mismatches;
+			printf("%-12s %6s %6s %11.1f %14.1f\n", hwy::TargetName(target),
+				   filter == 0 ? "5/3" : "9/7", mismatches ? "NO" : "yes", ms,
+				   numSamples / (ms * 1000.0));
+		}
+	}
+	hwy::SetSupportedTargetsForTest(0);
+
+	return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+#endif
@@ -1,34 +1,95 @@
 #include <BufferPool.h>
 
-BufferPool::BufferPool() {}
+BufferPool::BufferPool() : returned_(nullptr), numHits_(0), numMisses_(0) {}
 
 BufferPool::~BufferPool()
 {
-	for(auto& p : pool)
-		p.second.dealloc();
+	drainReturned();
+	for(auto& list : free_)
+	{
+		for(auto data : list)
+			grk_bin::grk_aligned_free(data);
+	}
 }
+uint32_t BufferPool::sizeClass(size_t len, size_t* classLen)
+{
+	uint32_t bits = minClassBits;
+	while(bits < 63 && ((size_t)1 << (bits + 1)) <= len)
+		bits++;
+	size_t base = (size_t)1 << bits;
+	if(len <= base)
+	{
+		*classLen = base;
+		return 0;
+	}
+	size_t step = base >> 2;
+	size_t steps = (len - base + step - 1) / step;
+	if(steps == 4)
+	{
+		*classLen = base << 1;
+		return (bits + 1 - minClassBits) * 4;
+	}
+	*classLen = base + steps * step;
 
+	return (bits - minClassBits) * 4 + (uint32_t)steps;
+}
 GrkIOBuf BufferPool::get(size_t len)
 {
-	for(auto iter = pool.begin(); iter != pool.end(); ++iter)
+	size_t classLen;
+	uint32_t c = sizeClass(len, &classLen);
+	if(free_[c].empty())
+		drainReturned();
+	if(!free_[c].empty())
 	{
-		if(iter->second.allocLen_ >= len)
-		{
-			auto b = iter->second;
-			b.len_ = len;
-			pool.erase(iter);
-			// printf("Buffer pool get  %p\n", b.data);
-			return b;
-		}
+		auto data = free_[c].back();
+		free_[c].pop_back();
+		numHits_++;
+		return GrkIOBuf(data, 0, len, classLen, false);
 	}
+	numMisses_++;
 	GrkIOBuf rc;
-	rc.alloc(len);
+	if(rc.alloc(classLen))
+		rc.len_ = len;
 
 	return rc;
 }
 void BufferPool::put(GrkIOBuf b)
 {
-	assert(b.data_);
-	assert(pool.find(b.data_) == pool.end());
-	pool[b.data_] = b;
+	if(!b.data_)
+		return;
+	if(b.allocLen_ < ((size_t)1 << minClassBits))
+	{
+		b.dealloc();
+		return;
+	}
+	auto node = (Node*)b.data_;
+	node->allocLen = b.allocLen_;
+	node->next = returned_.load(std::memory_order_relaxed);
+	while(!returned_.compare_exchange_weak(node->next, node, std::memory_order_release,
+										   std::memory_order_relaxed))
+	{}
+}
+void BufferPool::drainReturned(void)
+{
+	// whole stack is taken at once, so there is no ABA problem
+	auto node = returned_.exchange(nullptr, std::memory_order_acquire);
+	while(node)
+	{
+		auto next = node->next;
+		size_t classLen;
+		uint32_t c = sizeClass(node->allocLen, &classLen);
+		// buffers that were not allocated by the pool go to the largest class they can hold
+		if(classLen > node->allocLen)
+			c--;
+		free_[c].push_back((uint8_t*)node);
+		node = next;
+	}
+}
+uint64_t BufferPool::getNumHits(void) const
+{
+	return numHits_;
+}
+uint64_t BufferPool::getNumMisses(void) const
+{
+	return numMisses_;
 }
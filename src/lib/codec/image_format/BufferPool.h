@@ -1,9 +1,17 @@
 #pragma once
 
+#include <atomic>
 #include <cstdint>
-#include <map>
+#include <vector>
 #include <IFileIO.h>
 
+/**
+ * Pool of I/O buffers in size classes, four per power of two.
+ *
+ * Buffers are got by one thread at a time, the encoding thread, from private free lists,
+ * and can be put back by any thread, such as an asynchronous I/O completion, onto
+ * a lock-free stack that is drained when the free lists run dry.
+ */
 class BufferPool
 {
   public:
@@ -11,7 +19,24 @@ class BufferPool
 	virtual ~BufferPool();
 	GrkIOBuf get(size_t len);
 	void put(GrkIOBuf b);
+	uint64_t getNumHits(void) const;
+	uint64_t getNumMisses(void) const;
+
+	// pooled buffers are at least this long, so that a free list node fits in a returned buffer
+	static const uint32_t minClassBits = 12;
+	static const uint32_t numClasses = 4 * (64 - minClassBits);
 
   private:
-	std::map<uint8_t*, GrkIOBuf> pool;
+	// free list node, stored in the returned buffer itself
+	struct Node
+	{
+		Node* next;
+		size_t allocLen;
+	};
+	static uint32_t sizeClass(size_t len, size_t* classLen);
+	void drainReturned(void);
+	std::vector<uint8_t*> free_[numClasses];
+	std::atomic<Node*> returned_;
+	std::atomic<uint64_t> numHits_;
+	std::atomic<uint64_t> numMisses_;
 };
@@ -20,6 +20,7 @@
 #ifdef GROK_HAVE_URING
 
 #include "FileUringIO.h"
+#include "spdlog/spdlog.h"
 #include "common.h"
 #include <strings.h>
 #include <sys/time.h>
@@ -38,7 +39,8 @@ const static bool debugUring = false;
 
 FileUringIO::FileUringIO()
 	: fd_(0), ownsDescriptor(false), requestsSubmitted(0), requestsCompleted(0),
-	  reclaim_callback_(nullptr), reclaim_user_data_(nullptr)
+	  reclaim_callback_(nullptr), reclaim_user_data_(nullptr), requestsQueued(0),
+	  fileRegistered_(false), buffersRegistered_(false)
 {
 	memset(&ring, 0, sizeof(ring));
 }
@@ -101,6 +103,14 @@ bool FileUringIO::initQueue(void)
 		close();
 		return false;
 	}
+	// a fixed file saves the kernel a file table lookup per request
+	fileRegistered_ = io_uring_register_files(&ring, &fd_, 1) == 0;
+	// pooled buffers are added to the sparse table the first time they are written,
+	// so that subsequent writes from the same buffer skip page pinning
+	buffersRegistered_ = io_uring_register_buffers_sparse(&ring, maxRegisteredBuffers) == 0;
+	if(debugUring)
+		spdlog::info("uring: fixed file {}, registered buffers {}", fileRegistered_,
+					 buffersRegistered_);
 
 	return true;
 }
@@ -129,25 +139,62 @@ int FileUringIO::getMode(const char* mode)
 	return m;
 }
 
+/**
+ * Pooled buffers are only freed when their pool is destroyed, after all writes
+ * have completed, so a buffer address identifies a registered buffer
+ * for the lifetime of the queue
+ */
+int FileUringIO::getRegisteredBufferIndex(const GrkIOBuf& buf)
+{
+	if(!buffersRegistered_ || !buf.pooled_ || buf.allocLen_ < buf.len_)
+		return -1;
+	auto iter = registeredBufferIndex_.find(buf.data_);
+	if(iter != registeredBufferIndex_.end())
+		return (int)iter->second;
+	if(registeredBuffers_.size() == maxRegisteredBuffers)
+		return -1;
+	iovec iov;
+	iov.iov_base = buf.data_;
+	iov.iov_len = buf.allocLen_;
+	auto index = (uint32_t)registeredBuffers_.size();
+	if(io_uring_register_buffers_update_tag(&ring, index, &iov, nullptr, 1) != 1)
+	{
+		// e.g. RLIMIT_MEMLOCK exceeded: fall back to unregistered writes
+		buffersRegistered_ = false;
+		return -1;
+	}
+	registeredBuffers_.push_back(iov);
+	registeredBufferIndex_[buf.data_] = index;
+
+	return (int)index;
+}
 void FileUringIO::enqueue(io_uring* ring, io_data* data, bool readop, int fd)
 {
 	auto sqe = io_uring_get_sqe(ring);
+	if(!sqe)
+	{
+		// submission queue is full
+		submit();
+		sqe = io_uring_get_sqe(ring);
+	}
 	assert(sqe);
-
-	// grk::ChronoTimer timer("uring: time to enque");
-	// timer.start();
 	assert(data->buf.data_ == data->iov.iov_base);
+	if(fileRegistered_)
+		fd = 0;
+	int bufIndex = readop ? -1 : getRegisteredBufferIndex(data->buf);
 	if(readop)
 		io_uring_prep_readv(sqe, fd, &data->iov, 1, data->buf.offset_);
+	else if(bufIndex >= 0)
+		io_uring_prep_write_fixed(sqe, fd, data->buf.data_, (unsigned)data->buf.len_,
+								  data->buf.offset_, bufIndex);
 	else
 		io_uring_prep_writev(sqe, fd, &data->iov, 1, data->buf.offset_);
+	if(fileRegistered_)
+		io_uring_sqe_set_flags(sqe, IOSQE_FIXED_FILE);
 	io_uring_sqe_set_data(sqe, data);
-	[[maybe_unused]] int ret = io_uring_submit(ring);
-	// if (debugUring)
-	//	spdlog::info("Enqueued {}, length {}, offset {}", fmt::ptr(data->buf.data),
-	// data->buf.dataLen, data->buf.offset); timer.finish();
-	assert(ret == 1);
-	requestsSubmitted++;
+	// submit in batches rather than once per request
+	if(++requestsQueued == submitBatch)
+		submit();
 
 	while(true)
 	{
@@ -155,25 +202,31 @@ void FileUringIO::enqueue(io_uring* ring, io_data* data, bool readop, int fd)
 		auto data = retrieveCompletion(true, success);
 		if(!success || !data)
 			break;
-		if(data->buf.pooled_)
-		{
-			if(reclaim_callback_)
-			{
-				reclaim_callback_(0, data->buf, reclaim_user_data_);
-			}
-			else
-			{
-				grk_bin::grk_aligned_free((uint8_t*)data->iov.iov_base);
-			}
-		}
-		else
-		{
-			grk_bin::grk_aligned_free((uint8_t*)data->iov.iov_base);
-		}
-		delete data;
+		reclaim(data);
+	}
+}
+bool FileUringIO::submit(void)
+{
+	if(!requestsQueued)
+		return true;
+	int ret = io_uring_submit(&ring);
+	if(ret < 0)
+	{
+		spdlog::error("io_uring_submit: {}", strerror(-ret));
+		return false;
 	}
-	// if (debugUring && canReclaim && *num_reclaimed)
-	//	spdlog::info("Reclaimed : {}", *num_reclaimed);
+	requestsSubmitted += (size_t)ret;
+	requestsQueued -= (size_t)ret;
+
+	return requestsQueued == 0;
+}
+void FileUringIO::reclaim(io_data* data)
+{
+	if(data->buf.pooled_ && reclaim_callback_)
+		reclaim_callback_(0, data->buf, reclaim_user_data_);
+	else
+		grk_bin::grk_aligned_free((uint8_t*)data->iov.iov_base);
+	delete data;
 }
 
 io_data* FileUringIO::retrieveCompletion(bool peek, bool& success)
@@ -224,7 +277,8 @@ bool FileUringIO::close(void)
 		// grk::ChronoTimer timer("uring: time to close");
 		// timer.start();
 
-		// process pending requests
+		// submit queued requests and process pending requests
+		submit();
 		size_t count = requestsSubmitted - requestsCompleted;
 		for(uint32_t i = 0; i < count; ++i)
 		{
@@ -233,20 +287,21 @@ bool FileUringIO::close(void)
 			if(!success)
 				break;
 			if(data)
-			{
-				// if (debugUring)
-				//	printf("Close: deallocating  %p\n", data->iov.iov_base);
-				grk_bin::grk_aligned_free(data->iov.iov_base);
-				delete data;
-			}
+				reclaim(data);
 		}
+		// exiting the queue also releases registered files and buffers
 		io_uring_queue_exit(&ring);
 		memset(&ring, 0, sizeof(ring));
+		registeredBuffers_.clear();
+		registeredBufferIndex_.clear();
+		fileRegistered_ = false;
+		buffersRegistered_ = false;
 
 		// timer.finish();
 	}
 	requestsSubmitted = 0;
 	requestsCompleted = 0;
+	requestsQueued = 0;
 	bool rc = !ownsDescriptor || (fd_ && ::close(fd_) == 0);
 	fd_ = 0;
 	ownsDescriptor = false;
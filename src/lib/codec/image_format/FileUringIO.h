@@ -25,6 +25,8 @@
 #include <liburing.h>
 #include <liburing/io_uring.h>
 #include <mutex>
+#include <unordered_map>
+#include <vector>
 
 struct io_data
 {
@@ -57,11 +59,24 @@ class FileUringIO : public IFileIO
 	size_t requestsCompleted;
 	int getMode(const char* mode);
 	void enqueue(io_uring* ring, io_data* data, bool readop, int fd);
+	bool submit(void);
+	void reclaim(io_data* data);
+	int getRegisteredBufferIndex(const GrkIOBuf& buf);
 	bool initQueue(void);
 
 	const uint32_t QD = 1024;
+	// number of prepared requests that triggers a submit
+	const uint32_t submitBatch = 16;
+	const uint32_t maxRegisteredBuffers = 256;
 	grk_io_callback reclaim_callback_;
 	void* reclaim_user_data_;
+	size_t requestsQueued;
+	// file descriptor is registered as fixed file 0
+	bool fileRegistered_;
+	// sparse registered buffer table is available
+	bool buffersRegistered_;
+	std::vector<iovec> registeredBuffers_;
+	std::unordered_map<uint8_t*, uint32_t> registeredBufferIndex_;
 };
 
 #endif
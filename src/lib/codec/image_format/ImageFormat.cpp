@@ -33,8 +33,8 @@ static bool grkReclaimCallback([[maybe_unused]] uint32_t threadId, grk_io_buf bu
 
 ImageFormat::ImageFormat()
 	: image_(nullptr), fileIO_(new FileStreamIO()), fileStream_(nullptr), fileName_(""),
-	  compressionLevel_(GRK_DECOMPRESS_COMPRESSION_LEVEL_DEFAULT), useStdIO_(false),
-	  encodeState(IMAGE_FORMAT_UNENCODED)
+	  compressionLevel_(GRK_DECOMPRESS_COMPRESSION_LEVEL_DEFAULT), concurrency_(1),
+	  useStdIO_(false), encodeState(IMAGE_FORMAT_UNENCODED), stripEncoder_(nullptr)
 {
 	grk_io_init init;
 	init.maxPooledRequests_ = 0;
@@ -42,6 +42,9 @@ ImageFormat::ImageFormat()
 }
 ImageFormat::~ImageFormat()
 {
+	delete stripEncoder_;
+	if(pool.getNumHits() || pool.getNumMisses())
+		spdlog::info("Buffer pool: {} hits, {} misses", pool.getNumHits(), pool.getNumMisses());
 	delete fileIO_;
 }
 void ImageFormat::registerGrkReclaimCallback(grk_io_init io_init, grk_io_callback reclaim_callback,
@@ -65,9 +68,10 @@ void ImageFormat::reclaim(uint32_t threadId, grk_io_buf pixels)
 }
 #endif
 bool ImageFormat::encodeInit(grk_image* image, const std::string& filename,
-							 uint32_t compressionLevel, [[maybe_unused]] uint32_t concurrency)
+							 uint32_t compressionLevel, uint32_t concurrency)
 {
 	compressionLevel_ = compressionLevel;
+	concurrency_ = concurrency;
 	fileName_ = filename;
 	image_ = image;
 	useStdIO_ = grk::useStdio(fileName_);
@@ -92,8 +96,36 @@ bool ImageFormat::encodePixels(uint32_t threadId, grk_io_buf pixels)
  */
 bool ImageFormat::encodePixelsCore([[maybe_unused]] uint32_t threadId, grk_io_buf pixels)
 {
-#ifdef GROK_HAVE_URING
-	serializer.initPooledRequest();
+#ifndef GROK_HAVE_URING
+	// compress strips on worker threads, while decompression carries on
+	if(!stripEncoder_ && concurrency_ > 1 && supportsStripEncoder())
+	{
+		stripEncoder_ = new StripEncoder(
+			concurrency_, [this](EncodedStrip& strip) { return compressStrip(strip); },
+			[this](EncodedStrip& strip) { return writeStrip(strip); },
+			[this](uint32_t id, grk_io_buf buf) { ioReclaimBuffer(id, buf); });
+	}
+	if(stripEncoder_)
+	{
+		auto strip = new EncodedStrip(threadId, pixels);
+		prepareStrip(*strip);
+		bool success = stripEncoder_->submit(strip);
+		if(success)
+		{
+			serializer.incrementPooled();
+			if(serializer.allPooledRequestsComplete())
+				success = encodeFinish();
+		}
+		if(!success)
+		{
+			spdlog::error("ImageFormat::encodePixelsCore: error in parallel pixels encode");
+			encodeState |= IMAGE_FORMAT_ERROR;
+		}
+
+		return success;
+	}
+#else
+	serializer.initPooledRequest(pixels);
 #endif
 	bool success = encodePixelsCoreWrite(pixels);
 	if(success)
@@ -131,6 +163,23 @@ bool ImageFormat::encodePixelsCoreWrite(grk_io_buf pixels)
 {
 	return (serializer.write(pixels.data_, pixels.len_) == pixels.len_);
 }
+bool ImageFormat::supportsStripEncoder(void)
+{
+	return false;
+}
+void ImageFormat::prepareStrip([[maybe_unused]] EncodedStrip& strip) {}
+bool ImageFormat::compressStrip([[maybe_unused]] EncodedStrip& strip)
+{
+	return false;
+}
+bool ImageFormat::writeStrip([[maybe_unused]] EncodedStrip& strip)
+{
+	return false;
+}
+bool ImageFormat::finishStripEncoder(void)
+{
+	return !stripEncoder_ || stripEncoder_->finish();
+}
 bool ImageFormat::encodeFinish(void)
 {
 	bool rc = fileIO_->close();
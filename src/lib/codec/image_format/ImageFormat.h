@@ -21,6 +21,7 @@
 #include "IFileIO.h"
 #include "BufferPool.h"
 #include "Serializer.h"
+#include "StripEncoder.h"
 
 #include <mutex>
 
@@ -57,6 +58,28 @@ class ImageFormat : public IImageFormat
 	 * Common core pixel encoding write to disk
 	 */
 	virtual bool encodePixelsCoreWrite(grk_io_buf pixels);
+	/***
+	 * Parallel output stage: return true if format compresses strips on worker threads
+	 */
+	virtual bool supportsStripEncoder(void);
+	/***
+	 * Prepare strip for compression, called in strip order
+	 */
+	virtual void prepareStrip(EncodedStrip& strip);
+	/***
+	 * Compress strip, called on a worker thread
+	 */
+	virtual bool compressStrip(EncodedStrip& strip);
+	/***
+	 * Write compressed strip, called in strip order
+	 */
+	virtual bool writeStrip(EncodedStrip& strip);
+	/***
+	 * Wait for parallel output stage to write all strips
+	 *
+	 * @return true if parallel output stage was not used, or succeeded
+	 */
+	bool finishStripEncoder(void);
 	bool open(const std::string& fname, const std::string& mode);
 	uint64_t write(GrkIOBuf buffer);
 	bool read(uint8_t* buf, size_t len);
@@ -79,10 +102,12 @@ class ImageFormat : public IImageFormat
 	FILE* fileStream_;
 	std::string fileName_;
 	uint32_t compressionLevel_;
+	uint32_t concurrency_;
 
 	bool useStdIO_;
 	uint32_t encodeState;
 	mutable std::mutex encodePixelmutex;
 	BufferPool pool;
 	Serializer serializer;
+	StripEncoder* stripEncoder_;
 };
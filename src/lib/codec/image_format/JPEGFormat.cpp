@@ -29,6 +29,7 @@
 
 #include <setjmp.h>
 #include <cassert>
+#include <algorithm>
 
 #include "common.h"
 #include "FileStreamIO.h"
@@ -333,6 +334,9 @@ cleanup:
 	return image_;
 } /* jpegtoimage() */
 
+// number of scanlines interleaved and written at a time by application-orchestrated encode
+const uint32_t jpegBatchRows = 16;
+
 JPEGFormat::JPEGFormat(void)
 	: success(true), buffer(nullptr), buffer32s(nullptr), color_space(JCS_UNKNOWN), adjust(0),
 	  readFromStdin(false), planes{0, 0, 0}
@@ -449,7 +453,7 @@ bool JPEGFormat::encodeHeader(void)
 					 " as last channels in image_.");
 		numAlphaChannels = 0;
 	}
-	buffer = new uint8_t[width * decompressNumComps];
+	buffer = new uint8_t[(size_t)width * decompressNumComps * jpegBatchRows];
 	buffer32s = new int32_t[width * decompressNumComps];
 
 	/* We set up the normal JPEG error routines, then override error_exit. */
@@ -530,36 +534,59 @@ bool JPEGFormat::encodeHeader(void)
 }
 bool JPEGFormat::encodePixels(void)
 {
+	if(encodeState & IMAGE_FORMAT_ENCODED_PIXELS)
+		return true;
 	/* Step 5: while (scan lines remain to be written) */
 	/*           jpeg_write_scanlines(...); */
 
 	/* Here we use the library's state variable cinfo.next_scanline as the
 	 * loop counter, so that we don't have to keep track ourselves.
-	 * To keep things simple, we pass one scanline per call; you can pass
-	 * more if you wish, though.
+	 * Scanlines are interleaved and passed to the library in batches.
 	 */
 	auto iter = grk::InterleaverFactory<int32_t>::makeInterleaver(8);
 	if(!iter)
 		return false;
+	size_t rowBytes = (size_t)image_->decompressWidth * image_->decompressNumComps;
+	JSAMPROW rowPointers[jpegBatchRows];
+	for(uint32_t i = 0; i < jpegBatchRows; ++i)
+		rowPointers[i] = buffer + i * rowBytes;
 	while(cinfo.next_scanline < cinfo.image_height)
 	{
-		/* jpeg_write_scanlines expects an array of pointers to scanlines.
-		 * Here the array is only one element long, but you could pass
-		 * more than one scanline at a time if that's more convenient.
-		 */
+		uint32_t numRows =
+			std::min<uint32_t>(jpegBatchRows, cinfo.image_height - cinfo.next_scanline);
 		iter->interleave((int32_t**)planes, image_->decompressNumComps, (uint8_t*)buffer,
-						 image_->decompressWidth, image_->comps[0].stride, image_->decompressWidth,
-						 1, adjust);
-		JSAMPROW row_pointer[1]; /* pointer to JSAMPLE row[s] */
-		row_pointer[0] = buffer;
-		jpeg_write_scanlines(&cinfo, row_pointer, 1);
+						 image_->decompressWidth, image_->comps[0].stride, rowBytes, numRows,
+						 adjust);
+		if(jpeg_write_scanlines(&cinfo, rowPointers, numRows) != numRows)
+		{
+			delete iter;
+			return false;
+		}
 	}
 	delete iter;
 
 	return true;
 }
+/***
+ * Write strip of interleaved rows, packed by library, with a single call
+ */
+bool JPEGFormat::encodePixelsCoreWrite(grk_io_buf pixels)
+{
+	size_t rowBytes = (size_t)cinfo.image_width * (size_t)cinfo.input_components;
+	if(!rowBytes || pixels.len_ % rowBytes)
+		return false;
+	auto numRows = (JDIMENSION)(pixels.len_ / rowBytes);
+	rows_.resize(numRows);
+	for(JDIMENSION i = 0; i < numRows; ++i)
+		rows_[i] = pixels.data_ + i * rowBytes;
+
+	return jpeg_write_scanlines(&cinfo, rows_.data(), numRows) == numRows;
+}
 bool JPEGFormat::encodeFinish(void)
 {
+	if(encodeState & IMAGE_FORMAT_ENCODED_PIXELS)
+		return true;
+	encodeState |= IMAGE_FORMAT_ENCODED_PIXELS;
 	/* Step 6: Finish compression */
 	jpeg_finish_compress(&cinfo);
 
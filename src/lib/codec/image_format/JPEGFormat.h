@@ -17,6 +17,7 @@
 #pragma once
 
 #include "ImageFormat.h"
+#include <vector>
 #ifdef _WIN32
 #define HAVE_BOOLEAN
 typedef unsigned char boolean;
@@ -37,6 +38,7 @@ class JPEGFormat : public ImageFormat
 	grk_image* decode(const std::string& filename, grk_cparameters* parameters) override;
 
   private:
+	bool encodePixelsCoreWrite(grk_io_buf pixels) override;
 	grk_image* jpegtoimage(const char* filename, grk_cparameters* parameters);
 	bool imagetojpeg(grk_image* image, const char* filename, uint32_t compressionLevel);
 
@@ -55,4 +57,6 @@ class JPEGFormat : public ImageFormat
 	 */
 	struct jpeg_compress_struct cinfo;
 	int32_t const* planes[3];
+	// scanlines passed to a single jpeg_write_scanlines call
+	std::vector<JSAMPROW> rows_;
 };
@@ -32,6 +32,8 @@
 #include <string>
 #include <cassert>
 #include <locale>
+#include <algorithm>
+#include <zlib.h>
 #include "common.h"
 #include "FileStreamIO.h"
 
@@ -67,9 +69,13 @@ static void user_error_fn([[maybe_unused]] png_structp png_ptr, png_const_charp
 	spdlog::error("libpng error: {}", message);
 }
 
+// IDAT chunks written by parallel output stage are at most this long
+const size_t maxIDATLength = (size_t)1 << 30;
+
 PNGFormat::PNGFormat()
 	: info_(nullptr), png(nullptr), row_buf(nullptr), row_buf_array(nullptr), row32s(nullptr),
-	  colorSpace_(GRK_CLRSPC_UNKNOWN), prec(0), nr_comp(0)
+	  colorSpace_(GRK_CLRSPC_UNKNOWN), prec(0), nr_comp(0), rowBytes_(0), rowsQueued_(0),
+	  adler_(1)
 {}
 
 bool PNGFormat::encodeHeader(void)
@@ -110,11 +116,6 @@ bool PNGFormat::encodeHeader(void)
 			break;
 		if(image_->comps[0].sgnd != image_->comps[i].sgnd)
 			break;
-		if(!image_->comps[i].data)
-		{
-			spdlog::error("imagetopng: component {} is null.", i);
-			return false;
-		}
 	}
 	if(i != nr_comp)
 	{
@@ -274,6 +275,7 @@ bool PNGFormat::encodeHeader(void)
 			spdlog::error("Invalid PNG row size");
 			goto beach;
 		}
+		rowBytes_ = png_row_size;
 		row_buf = (png_bytep)malloc(png_row_size);
 		if(row_buf == nullptr)
 		{
@@ -294,8 +296,24 @@ bool PNGFormat::encodeHeader(void)
 beach:
 	return !fails;
 }
+/***
+ * application-orchestrated pixel encoding
+ */
 bool PNGFormat::encodePixels(void)
 {
+	if(encodeState & IMAGE_FORMAT_ENCODED_PIXELS)
+		return true;
+	if(!isHeaderEncoded() && !encodeHeader())
+		return false;
+	for(uint16_t compno = 0; compno < nr_comp; ++compno)
+	{
+		if(!image_->comps[compno].data)
+		{
+			spdlog::error("imagetopng: component {} is null.", compno);
+			return false;
+		}
+	}
+
 	int32_t const* planes[4];
 	for(uint16_t compno = 0; compno < nr_comp; ++compno)
 		planes[compno] = image_->comps[compno].data;
@@ -317,21 +335,229 @@ bool PNGFormat::encodePixels(void)
 
 	return true;
 }
-bool PNGFormat::encodeFinish(void)
+/***
+ * Write strip of interleaved rows, packed by library
+ */
+bool PNGFormat::encodePixelsCoreWrite(grk_io_buf pixels)
 {
+	auto rowBytes = png_get_rowbytes(png, info_);
+	if(!rowBytes || pixels.len_ % rowBytes)
+		return false;
 	if(setjmp(png_jmpbuf(png)))
 		return false;
+	for(uint64_t offset = 0; offset < pixels.len_; offset += rowBytes)
+		png_write_row(png, pixels.data_ + offset);
 
+	return true;
+}
+/***
+ * Filter one row with each PNG filter type, and keep the one with the smallest sum of
+ * absolute values, taken as signed bytes: the heuristic used by libpng.
+ * Loops are kept simple so that the compiler can vectorize them.
+ *
+ * @param row row to filter
+ * @param prior previous row, all zeros for first row of image
+ * @param rowBytes number of bytes in row
+ * @param bpp number of bytes per complete pixel
+ * @param scratch scratch buffer of 4 * (rowBytes + 1) bytes
+ * @param out filtered row, filter type followed by rowBytes bytes
+ */
+static void pngFilterRow(const uint8_t* row, const uint8_t* prior, size_t rowBytes, size_t bpp,
+						 uint8_t* scratch, uint8_t* out)
+{
+	uint8_t* sub = scratch;
+	uint8_t* up = sub + rowBytes + 1;
+	uint8_t* avg = up + rowBytes + 1;
+	uint8_t* paeth = avg + rowBytes + 1;
+	sub[0] = PNG_FILTER_VALUE_SUB;
+	up[0] = PNG_FILTER_VALUE_UP;
+	avg[0] = PNG_FILTER_VALUE_AVG;
+	paeth[0] = PNG_FILTER_VALUE_PAETH;
+	for(size_t i = 0; i < bpp; ++i)
+	{
+		sub[i + 1] = row[i];
+		avg[i + 1] = (uint8_t)(row[i] - (prior[i] >> 1));
+		paeth[i + 1] = (uint8_t)(row[i] - prior[i]);
+	}
+	for(size_t i = bpp; i < rowBytes; ++i)
+	{
+		sub[i + 1] = (uint8_t)(row[i] - row[i - bpp]);
+		avg[i + 1] = (uint8_t)(row[i] - ((row[i - bpp] + prior[i]) >> 1));
+		int a = row[i - bpp];
+		int b = prior[i];
+		int c = prior[i - bpp];
+		int pa = abs(b - c);
+		int pb = abs(a - c);
+		int pc = abs(a + b - 2 * c);
+		int pred = (pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c);
+		paeth[i + 1] = (uint8_t)(row[i] - pred);
+	}
+	for(size_t i = 0; i < rowBytes; ++i)
+		up[i + 1] = (uint8_t)(row[i] - prior[i]);
+
+	auto cost = [rowBytes](const uint8_t* filtered) {
+		uint64_t sum = 0;
+		for(size_t i = 0; i < rowBytes; ++i)
+			sum += (uint64_t)abs((int8_t)filtered[i]);
+		return sum;
+	};
+	const uint8_t* best = nullptr;
+	uint64_t bestCost = cost(row);
+	for(auto candidate : {sub, up, avg, paeth})
+	{
+		uint64_t c = cost(candidate + 1);
+		if(c < bestCost)
+		{
+			bestCost = c;
+			best = candidate;
+		}
+	}
+	if(best)
+	{
+		memcpy(out, best, rowBytes + 1);
+	}
+	else
+	{
+		out[0] = PNG_FILTER_VALUE_NONE;
+		memcpy(out + 1, row, rowBytes);
+	}
+}
+/***
+ * Parallel output stage is used for library-orchestrated encoding
+ */
+bool PNGFormat::supportsStripEncoder(void)
+{
+	return true;
+}
+void PNGFormat::prepareStrip(EncodedStrip& strip)
+{
+	// first row of strip is filtered against last row of previous strip
+	strip.prior_.swap(lastRow_);
+	if(strip.prior_.empty())
+		strip.prior_.resize(rowBytes_);
+	if(rowBytes_ && strip.pixels_.len_ >= rowBytes_)
+		lastRow_.assign(strip.pixels_.data_ + strip.pixels_.len_ - rowBytes_,
+						strip.pixels_.data_ + strip.pixels_.len_);
+	rowsQueued_ += rowBytes_ ? (uint32_t)(strip.pixels_.len_ / rowBytes_) : 0;
+	strip.last_ = rowsQueued_ >= image_->comps[0].h;
+}
+/***
+ * Filter strip and compress it to a raw deflate stream. Strips other than the last
+ * end with a sync flush, so that they can be concatenated
+ */
+bool PNGFormat::compressStrip(EncodedStrip& strip)
+{
+	if(!rowBytes_ || strip.pixels_.len_ % rowBytes_)
+		return false;
+	size_t numRows = strip.pixels_.len_ / rowBytes_;
+	std::vector<uint8_t> filtered(numRows * (rowBytes_ + 1));
+	if(filtered.size() > UINT32_MAX)
+	{
+		spdlog::error("PNGFormat: strip is too large for parallel encode");
+		return false;
+	}
+	int level = (compressionLevel_ == GRK_DECOMPRESS_COMPRESSION_LEVEL_DEFAULT)
+					? 0
+					: (int)compressionLevel_;
+	// filtering gains nothing for stored blocks
+	bool filter = level != 0;
+	size_t bpp = std::max<size_t>(1, ((size_t)nr_comp * prec) >> 3);
+	std::vector<uint8_t> scratch(filter ? 4 * (rowBytes_ + 1) : 0);
+	const uint8_t* prior = strip.prior_.data();
+	for(size_t r = 0; r < numRows; ++r)
+	{
+		auto row = strip.pixels_.data_ + r * rowBytes_;
+		auto out = filtered.data() + r * (rowBytes_ + 1);
+		if(filter)
+		{
+			pngFilterRow(row, prior, rowBytes_, bpp, scratch.data(), out);
+		}
+		else
+		{
+			out[0] = PNG_FILTER_VALUE_NONE;
+			memcpy(out + 1, row, rowBytes_);
+		}
+		prior = row;
+	}
+	strip.checksum_ = (uint32_t)adler32(1, filtered.data(), (uInt)filtered.size());
+
+	z_stream strm;
+	memset(&strm, 0, sizeof(strm));
+	if(deflateInit2(&strm, level, Z_DEFLATED, -MAX_WBITS, 8,
+					filter ? Z_FILTERED : Z_DEFAULT_STRATEGY) != Z_OK)
+		return false;
+	// room for zlib header, sync flush marker and adler32 trailer
+	strip.data_.resize(deflateBound(&strm, (uLong)filtered.size()) + 16);
+	size_t headerLen = 0;
+	if(strip.index_ == 0)
+	{
+		uint32_t cmf = 0x78;
+		uint32_t flg = (uint32_t)(level < 2 ? 0 : (level < 6 ? 1 : (level == 6 ? 2 : 3))) << 6;
+		flg += 31 - ((cmf << 8) + flg) % 31;
+		strip.data_[0] = (uint8_t)cmf;
+		strip.data_[1] = (uint8_t)flg;
+		headerLen = 2;
+	}
+	strm.next_in = filtered.data();
+	strm.avail_in = (uInt)filtered.size();
+	strm.next_out = strip.data_.data() + headerLen;
+	strm.avail_out = (uInt)(strip.data_.size() - headerLen);
+	int rc = deflate(&strm, strip.last_ ? Z_FINISH : Z_SYNC_FLUSH);
+	bool success = strip.last_ ? rc == Z_STREAM_END : (rc == Z_OK && strm.avail_in == 0);
+	strip.data_.resize(headerLen + strm.total_out);
+	deflateEnd(&strm);
+
+	return success;
+}
+/***
+ * Write compressed strip as IDAT chunks, with adler32 of the whole image appended to the
+ * last strip
+ */
+bool PNGFormat::writeStrip(EncodedStrip& strip)
+{
+	size_t filteredLen = strip.pixels_.len_ + strip.pixels_.len_ / rowBytes_;
+	adler_ = (uint32_t)adler32_combine(adler_, strip.checksum_, (z_off_t)filteredLen);
+	if(strip.last_)
+	{
+		for(int shift = 24; shift >= 0; shift -= 8)
+			strip.data_.push_back((uint8_t)(adler_ >> shift));
+	}
+	if(setjmp(png_jmpbuf(png)))
+		return false;
+	for(size_t offset = 0; offset < strip.data_.size(); offset += maxIDATLength)
+	{
+		size_t len = std::min(maxIDATLength, strip.data_.size() - offset);
+		png_write_chunk(png, (png_const_bytep) "IDAT", strip.data_.data() + offset, len);
+	}
+
+	return true;
+}
+bool PNGFormat::encodeFinish(void)
+{
+	if(encodeState & IMAGE_FORMAT_ENCODED_PIXELS)
+		return true;
+	encodeState |= IMAGE_FORMAT_ENCODED_PIXELS;
+
+	bool parallel = stripEncoder_ != nullptr;
+	bool success = finishStripEncoder();
 	if(png)
 	{
-		png_write_end(png, info_);
+		if(setjmp(png_jmpbuf(png)))
+			return false;
+		// libpng did not see the IDAT chunks written by the parallel output stage
+		if(parallel)
+			png_write_chunk(png, (png_const_bytep) "IEND", nullptr, 0);
+		else
+			png_write_end(png, info_);
 		png_destroy_write_struct(&png, &info_);
 	}
 	free(row_buf);
+	row_buf = nullptr;
 	free(row32s);
+	row32s = nullptr;
 	bool rc = ImageFormat::encodeFinish();
 
-	return rc;
+	return rc && success;
 }
 grk_image* PNGFormat::decode(const std::string& filename, grk_cparameters* parameters)
 {
@@ -19,6 +19,7 @@
 #include "ImageFormat.h"
 #include <png.h>
 #include <string>
+#include <vector>
 
 void pngSetVerboseFlag(bool verbose);
 
@@ -33,6 +34,11 @@ class PNGFormat : public ImageFormat
 	grk_image* decode(const std::string& filename, grk_cparameters* parameters) override;
 
   private:
+	bool encodePixelsCoreWrite(grk_io_buf pixels) override;
+	bool supportsStripEncoder(void) override;
+	void prepareStrip(EncodedStrip& strip) override;
+	bool compressStrip(EncodedStrip& strip) override;
+	bool writeStrip(EncodedStrip& strip) override;
 	grk_image* do_decode(grk_cparameters* params);
 
 	png_infop info_;
@@ -43,4 +49,10 @@ class PNGFormat : public ImageFormat
 	GRK_COLOR_SPACE colorSpace_;
 	uint8_t prec;
 	uint16_t nr_comp;
+	// parallel output stage: strips are filtered and deflated independently, and their
+	// deflate streams are stitched together into a single zlib stream
+	size_t rowBytes_;
+	uint32_t rowsQueued_;
+	std::vector<uint8_t> lastRow_;
+	uint32_t adler_;
 };
@@ -158,6 +158,9 @@ size_t Serializer::write(uint8_t* buf, size_t bytes_total)
 	if(asynchActive_)
 	{
 		// 1. schedule buffer
+		// allocation length is only known when writing the pooled buffer itself
+		if(buf != scheduled_.data_)
+			scheduled_.allocLen_ = 0;
 		scheduled_.data_ = buf;
 		scheduled_.len_ = bytes_total;
 		scheduled_.offset_ = off_;
@@ -200,8 +203,9 @@ size_t Serializer::write(uint8_t* buf, size_t bytes_total)
 #endif // #ifndef _WIN32
 
 #ifdef GROK_HAVE_URING
-void Serializer::initPooledRequest(void)
+void Serializer::initPooledRequest(grk_io_buf pixels)
 {
+	scheduled_ = GrkIOBuf(pixels);
 	scheduled_.pooled_ = true;
 }
 #else
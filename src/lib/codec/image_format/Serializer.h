@@ -29,7 +29,7 @@ struct Serializer
 	uint32_t getNumPooledRequests(void);
 	uint64_t getOffset(void);
 #ifdef GROK_HAVE_URING
-	void initPooledRequest(void);
+	void initPooledRequest(grk_io_buf pixels);
 #else
 	void incrementPooled(void);
 #endif
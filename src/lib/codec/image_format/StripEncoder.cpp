@@ -0,0 +1,95 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "StripEncoder.h"
+
+StripEncoder::StripEncoder(uint32_t numThreads, StripFn compress, StripFn write,
+						   ReclaimFn reclaim)
+	: compress_(compress), write_(write), reclaim_(reclaim), maxInFlight_(2 * numThreads),
+	  numSubmitted_(0), numWritten_(0), writing_(false), stop_(false), success_(true)
+{
+	for(uint32_t i = 0; i < numThreads; ++i)
+		workers_.emplace_back([this] { run(); });
+}
+StripEncoder::~StripEncoder()
+{
+	finish();
+}
+bool StripEncoder::submit(EncodedStrip* strip)
+{
+	std::unique_lock<std::mutex> lk(mutex_);
+	// bound the memory held by the output stage
+	writtenCondition_.wait(lk, [this] { return numSubmitted_ - numWritten_ < maxInFlight_; });
+	strip->index_ = numSubmitted_++;
+	queue_.push_back(strip);
+	queueCondition_.notify_one();
+
+	return success_;
+}
+bool StripEncoder::finish(void)
+{
+	{
+		std::unique_lock<std::mutex> lk(mutex_);
+		writtenCondition_.wait(lk, [this] { return numWritten_ == numSubmitted_; });
+		stop_ = true;
+	}
+	queueCondition_.notify_all();
+	for(auto& t : workers_)
+		t.join();
+	workers_.clear();
+
+	return success_;
+}
+void StripEncoder::run(void)
+{
+	std::unique_lock<std::mutex> lk(mutex_);
+	while(true)
+	{
+		queueCondition_.wait(lk, [this] { return stop_ || !queue_.empty(); });
+		if(queue_.empty())
+			return;
+		auto strip = queue_.front();
+		queue_.pop_front();
+		lk.unlock();
+		// after a failure, strips are only drained
+		if(success_ && !compress_(*strip))
+			success_ = false;
+		reclaim_(strip->threadId_, strip->pixels_);
+		lk.lock();
+		compressed_[strip->index_] = strip;
+		// whichever worker holds the writing flag writes all strips that are next in line.
+		// Strips compressed meanwhile by other workers are picked up by the same loop
+		if(writing_)
+			continue;
+		writing_ = true;
+		auto next = compressed_.begin();
+		while(next != compressed_.end() && next->first == numWritten_)
+		{
+			strip = next->second;
+			compressed_.erase(next);
+			lk.unlock();
+			if(success_ && !write_(*strip))
+				success_ = false;
+			delete strip;
+			lk.lock();
+			numWritten_++;
+			writtenCondition_.notify_all();
+			next = compressed_.begin();
+		}
+		writing_ = false;
+	}
+}
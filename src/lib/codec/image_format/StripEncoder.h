@@ -0,0 +1,103 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+#include "grok.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * Strip of packed pixels on its way through the parallel output stage
+ */
+struct EncodedStrip
+{
+	EncodedStrip(uint32_t threadId, grk_io_buf pixels)
+		: threadId_(threadId), pixels_(pixels), index_(0), checksum_(0), last_(false)
+	{}
+	// thread that owns the pixel buffer
+	uint32_t threadId_;
+	grk_io_buf pixels_;
+	// position of strip in output order
+	uint32_t index_;
+	// format-specific data carried over from the previous strip
+	std::vector<uint8_t> prior_;
+	// compressed strip
+	std::vector<uint8_t> data_;
+	// lengths of consecutive pieces of compressed strip that are written separately, e.g. tiles
+	std::vector<size_t> segments_;
+	uint32_t checksum_;
+	bool last_;
+};
+
+/**
+ * Parallel output stage.
+ *
+ * Strips are submitted in output order by the serializing thread and compressed on
+ * worker threads. Compressed strips are written in output order by whichever worker
+ * completes the next strip in line, while the other workers carry on compressing.
+ * Pixel buffers are reclaimed as soon as their strip has been compressed.
+ */
+class StripEncoder
+{
+  public:
+	typedef std::function<bool(EncodedStrip& strip)> StripFn;
+	typedef std::function<void(uint32_t threadId, grk_io_buf pixels)> ReclaimFn;
+
+	StripEncoder(uint32_t numThreads, StripFn compress, StripFn write, ReclaimFn reclaim);
+	~StripEncoder();
+	/**
+	 * Queue strip for compression, taking ownership of it. Blocks while too many strips
+	 * are in flight
+	 *
+	 * @return false if an earlier strip failed
+	 */
+	bool submit(EncodedStrip* strip);
+	/**
+	 * Wait until all submitted strips have been written, and stop worker threads
+	 *
+	 * @return true if all strips were successfully compressed and written
+	 */
+	bool finish(void);
+
+  private:
+	void run(void);
+	StripFn compress_;
+	StripFn write_;
+	ReclaimFn reclaim_;
+	std::vector<std::thread> workers_;
+	std::mutex mutex_;
+	std::condition_variable queueCondition_;
+	std::condition_variable writtenCondition_;
+	std::deque<EncodedStrip*> queue_;
+	// compressed strips waiting for their turn to be written
+	std::map<uint32_t, EncodedStrip*> compressed_;
+	uint32_t maxInFlight_;
+	uint32_t numSubmitted_;
+	uint32_t numWritten_;
+	bool writing_;
+	bool stop_;
+	std::atomic<bool> success_;
+};
@@ -31,6 +31,10 @@
 #include "convert.h"
 #include "common.h"
 
+#ifdef ZIP_SUPPORT
+#include <zlib.h>
+#endif
+
 #ifdef GRK_CUSTOM_TIFF_IO
 #define IO_MAX 2147483647U
 
@@ -106,8 +110,10 @@ static bool ioReclaimCallback(uint32_t threadId, io::io_buf* buffer, void* io_us
 #endif
 
 TIFFFormat::TIFFFormat()
-	: tif_(nullptr), chroma_subsample_x(1), chroma_subsample_y(1), units(0),
-	  grkReclaimCallback_(nullptr), grkReclaimUserData_(nullptr)
+	: tif_(nullptr), chroma_subsample_x(1), chroma_subsample_y(1), units(0), tileWidth_(0),
+	  tileLength_(0), tileRowBytes_(0), cachedTile_(UINT_MAX), pullSamplesPerPixel_(0),
+	  pullBytesPerSample_(0), pullPlanar_(false), grkReclaimCallback_(nullptr),
+	  grkReclaimUserData_(nullptr)
 
 {}
 TIFFFormat::~TIFFFormat()
@@ -121,8 +127,12 @@ void TIFFFormat::registerGrkReclaimCallback(grk_io_init io_init, grk_io_callback
 {
 	grkReclaimCallback_ = reclaim_callback;
 	grkReclaimUserData_ = user_data;
-	if(io_init.maxPooledRequests_)
-		serializer.setMaxPooledRequests(io_init.maxPooledRequests_);
+	// written strips are returned to the library's pools rather than the local pool
+	ImageFormat::registerGrkReclaimCallback(io_init, reclaim_callback, user_data);
+}
+void TIFFFormat::setTileWidth(uint32_t tileWidth)
+{
+	tileWidth_ = tileWidth;
 }
 #ifdef GRK_NEW_IO
 bool TIFFFormat::ioReclaim(uint32_t threadId, io::io_buf* buffer)
@@ -327,7 +337,32 @@ bool TIFFFormat::encodeHeader(TIFF* tif)
 	TIFFSetField(tif, TIFFTAG_ORIENTATION, ORIENTATION_TOPLEFT);
 	TIFFSetField(tif, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
 	TIFFSetField(tif, TIFFTAG_PHOTOMETRIC, tiPhoto);
-	TIFFSetField(tif, TIFFTAG_ROWSPERSTRIP, image_->rowsPerStrip);
+	if(tileWidth_)
+	{
+		// each strip holds one row of tiles, so tile length is set by rows per strip,
+		// and TIFF requires both tile dimensions to be multiples of 16
+		if(subsampled || (image_->rowsPerStrip < height && (image_->rowsPerStrip & 15)))
+		{
+			spdlog::warn("TIFFFormat::encodeHeader: tiles not supported for this image. "
+						 "Writing strips instead");
+			tileWidth_ = 0;
+		}
+		else
+		{
+			tileWidth_ = ((std::min)(tileWidth_, width) + 15) & ~15U;
+			tileLength_ = (image_->rowsPerStrip + 15) & ~15U;
+		}
+	}
+	if(tileWidth_)
+	{
+		TIFFSetField(tif, TIFFTAG_TILEWIDTH, tileWidth_);
+		TIFFSetField(tif, TIFFTAG_TILELENGTH, tileLength_);
+		tileRowBytes_ = ((uint64_t)tileWidth_ * numcomps * bps + 7) / 8;
+	}
+	else
+	{
+		TIFFSetField(tif, TIFFTAG_ROWSPERSTRIP, image_->rowsPerStrip);
+	}
 	if(tiPhoto == PHOTOMETRIC_YCBCR)
 	{
 		float refBlackWhite[6] = {0.0, 255.0, 128.0, 255.0, 128.0, 255.0};
@@ -576,10 +611,101 @@ cleanup:
  */
 bool TIFFFormat::encodePixelsCoreWrite(grk_io_buf pixels)
 {
+	if(tileWidth_)
+	{
+		return cutTiles(pixels, tileBuf_, [this](uint32_t tileIndex, uint8_t* tile, size_t len) {
+			return TIFFWriteEncodedTile(tif_, tileIndex, tile, (tmsize_t)len) != -1;
+		});
+	}
 	tmsize_t written =
 		TIFFWriteEncodedStrip(tif_, pixels.index_, pixels.data_, (tmsize_t)pixels.len_);
 	return written != -1;
 }
+/***
+ * Cut strip into its row of tiles. Tiles on the right and bottom edges of the image
+ * are padded with zeros
+ */
+bool TIFFFormat::cutTiles(
+	grk_io_buf pixels, std::vector<uint8_t>& tileBuf,
+	const std::function<bool(uint32_t tileIndex, uint8_t* tile, size_t len)>& fn)
+{
+	uint64_t rowBytes = image_->packedRowBytes;
+	uint32_t rows = (uint32_t)(pixels.len_ / rowBytes);
+	uint32_t tilesAcross = (image_->decompressWidth + tileWidth_ - 1) / tileWidth_;
+	tileBuf.resize(tileRowBytes_ * tileLength_);
+	for(uint32_t i = 0; i < tilesAcross; ++i)
+	{
+		uint64_t offset = (uint64_t)i * tileRowBytes_;
+		size_t len = (size_t)(std::min)((uint64_t)tileRowBytes_, rowBytes - offset);
+		if(len < tileRowBytes_ || rows < tileLength_)
+			memset(tileBuf.data(), 0, tileBuf.size());
+		for(uint32_t y = 0; y < rows; ++y)
+			memcpy(tileBuf.data() + y * tileRowBytes_, pixels.data_ + y * rowBytes + offset, len);
+		if(!fn(pixels.index_ * tilesAcross + i, tileBuf.data(), tileBuf.size()))
+			return false;
+	}
+
+	return true;
+}
+/***
+ * Deflate strips are compressed independently on worker threads, and written raw
+ */
+bool TIFFFormat::supportsStripEncoder(void)
+{
+#ifdef ZIP_SUPPORT
+	return compressionLevel_ == COMPRESSION_ADOBE_DEFLATE ||
+		   compressionLevel_ == COMPRESSION_DEFLATE;
+#else
+	return false;
+#endif
+}
+bool TIFFFormat::compressStrip([[maybe_unused]] EncodedStrip& strip)
+{
+#ifdef ZIP_SUPPORT
+	// libtiff's Deflate codec writes each strip or tile as a complete zlib stream
+	auto deflate = [&strip](const uint8_t* src, size_t srcLen) {
+		size_t pos = strip.data_.size();
+		uLongf len = compressBound((uLong)srcLen);
+		strip.data_.resize(pos + len);
+		if(compress2(strip.data_.data() + pos, &len, src, (uLong)srcLen,
+					 Z_DEFAULT_COMPRESSION) != Z_OK)
+			return false;
+		strip.data_.resize(pos + len);
+		strip.segments_.push_back(len);
+
+		return true;
+	};
+	if(tileWidth_)
+	{
+		std::vector<uint8_t> tileBuf;
+		return cutTiles(strip.pixels_, tileBuf,
+						[&deflate]([[maybe_unused]] uint32_t tileIndex, uint8_t* tile,
+								   size_t len) { return deflate(tile, len); });
+	}
+
+	return deflate(strip.pixels_.data_, strip.pixels_.len_);
+#else
+	return false;
+#endif
+}
+bool TIFFFormat::writeStrip(EncodedStrip& strip)
+{
+	if(tileWidth_)
+	{
+		uint32_t tileIndex = strip.pixels_.index_ * (uint32_t)strip.segments_.size();
+		auto data = strip.data_.data();
+		for(auto len : strip.segments_)
+		{
+			if(TIFFWriteRawTile(tif_, tileIndex++, data, (tmsize_t)len) == -1)
+				return false;
+			data += len;
+		}
+		return true;
+	}
+
+	return TIFFWriteRawStrip(tif_, strip.pixels_.index_, strip.data_.data(),
+							 (tmsize_t)strip.data_.size()) != -1;
+}
 bool TIFFFormat::encodeFinish(void)
 {
 	if(encodeState & IMAGE_FORMAT_ENCODED_PIXELS)
@@ -587,12 +713,13 @@ bool TIFFFormat::encodeFinish(void)
 		assert(!tif_);
 		return true;
 	}
+	bool success = finishStripEncoder();
 	if(tif_)
 		TIFFClose(tif_);
 	tif_ = nullptr;
 	encodeState |= IMAGE_FORMAT_ENCODED_PIXELS;
 
-	return true;
+	return success;
 }
 
 ////////////////////////////////////////////////////////////////////////////////////////////////
@@ -700,6 +827,95 @@ static void set_resolution(double* res, float resx, float resy, short resUnit)
 	}
 }
 
+/**
+ * Reads stripped images one strip at a time, and tiled images one row of tiles at a time,
+ * so that both can be unpacked row by row. For planar images, strips of the first plane
+ * are followed by strips of the second plane, and so on
+ */
+class TiffStripReader
+{
+  public:
+	explicit TiffStripReader(TIFF* tif)
+		: tif_(tif), tiled_(TIFFIsTiled(tif)), height_(0), rowStride_(0), tileWidth_(0),
+		  tileLength_(0), tilesAcross_(0), tilesDown_(0), tileRowBytes_(0)
+	{}
+	/**
+	 * @param width image width
+	 * @param height image height
+	 * @param bitsPerPixel number of bits per pixel in one plane
+	 */
+	bool init(uint32_t width, uint32_t height, uint32_t bitsPerPixel)
+	{
+		height_ = height;
+		if(!tiled_)
+			return true;
+		TIFFGetField(tif_, TIFFTAG_TILEWIDTH, &tileWidth_);
+		TIFFGetField(tif_, TIFFTAG_TILELENGTH, &tileLength_);
+		// rows of neighbouring tiles can only be concatenated on byte boundaries
+		if(!tileWidth_ || !tileLength_ || ((uint64_t)tileWidth_ * bitsPerPixel) % 8)
+		{
+			spdlog::error("TIFFFormat::decode: unsupported tile dimensions ({},{})", tileWidth_,
+						  tileLength_);
+			return false;
+		}
+		rowStride_ = (tsize_t)(((uint64_t)width * bitsPerPixel + 7) / 8);
+		tileRowBytes_ = (tsize_t)((uint64_t)tileWidth_ * bitsPerPixel / 8);
+		tilesAcross_ = (width + tileWidth_ - 1) / tileWidth_;
+		tilesDown_ = (height + tileLength_ - 1) / tileLength_;
+		tileBuf_.resize((size_t)TIFFTileSize(tif_));
+
+		return true;
+	}
+	tsize_t stripSize(void) const
+	{
+		return tiled_ ? rowStride_ * (tsize_t)tileLength_ : TIFFStripSize(tif_);
+	}
+	uint32_t numStrips(void) const
+	{
+		return tiled_ ? TIFFNumberOfTiles(tif_) / tilesAcross_ : TIFFNumberOfStrips(tif_);
+	}
+	/**
+	 * Read strip
+	 *
+	 * @return number of bytes read, or -1 on failure
+	 */
+	tsize_t read(uint32_t strip, void* buf, tsize_t len)
+	{
+		if(!tiled_)
+			return TIFFReadEncodedStrip(tif_, strip, buf, len);
+		uint32_t y = (strip % tilesDown_) * tileLength_;
+		uint16_t plane = (uint16_t)(strip / tilesDown_);
+		uint32_t rows = (std::min)(tileLength_, height_ - y);
+		if((tsize_t)rows * rowStride_ > len)
+			return -1;
+		for(uint32_t i = 0; i < tilesAcross_; ++i)
+		{
+			auto tile = TIFFComputeTile(tif_, i * tileWidth_, y, 0, plane);
+			if(TIFFReadEncodedTile(tif_, tile, tileBuf_.data(), (tmsize_t)tileBuf_.size()) < 0)
+				return -1;
+			tsize_t offset = (tsize_t)i * tileRowBytes_;
+			size_t rowLen = (size_t)(std::min)(tileRowBytes_, rowStride_ - offset);
+			for(uint32_t j = 0; j < rows; ++j)
+				memcpy((uint8_t*)buf + j * rowStride_ + offset,
+					   tileBuf_.data() + (size_t)j * tileRowBytes_, rowLen);
+		}
+
+		return (tsize_t)rows * rowStride_;
+	}
+
+  private:
+	TIFF* tif_;
+	bool tiled_;
+	uint32_t height_;
+	tsize_t rowStride_;
+	uint32_t tileWidth_;
+	uint32_t tileLength_;
+	uint32_t tilesAcross_;
+	uint32_t tilesDown_;
+	tsize_t tileRowBytes_;
+	std::vector<uint8_t> tileBuf_;
+};
+
 static bool readTiffPixels(TIFF* tif, grk_image_comp* comps, uint32_t numcomps, uint16_t tiSpp,
 						   uint16_t tiPC, uint16_t tiPhoto, uint32_t chroma_subsample_x,
 						   uint32_t chroma_subsample_y)
@@ -718,6 +934,7 @@ static bool readTiffPixels(TIFF* tif, grk_image_comp* comps, uint32_t numcomps,
 	tsize_t strip_size;
 	uint32_t currentPlane = 0;
 	int32_t* buffer32s = nullptr;
+	TiffStripReader reader(tif);
 	bool subsampled = chroma_subsample_x != 1 || chroma_subsample_y != 1;
 	size_t luma_block = chroma_subsample_x * chroma_subsample_y;
 	size_t unitSize = luma_block + 2;
@@ -776,7 +993,12 @@ static bool readTiffPixels(TIFF* tif, grk_image_comp* comps, uint32_t numcomps,
 		tiSpp = 1U; /* consider only one sample per plane */
 	}
 
-	strip_size = TIFFStripSize(tif);
+	if(!reader.init(comps[0].w, comps[0].h, (uint32_t)tiSpp * comps[0].prec))
+	{
+		success = false;
+		goto local_cleanup;
+	}
+	strip_size = reader.stripSize();
 	buf = _TIFFmalloc(strip_size);
 	if(buf == nullptr)
 	{
@@ -801,9 +1023,9 @@ static bool readTiffPixels(TIFF* tif, grk_image_comp* comps, uint32_t numcomps,
 		if(subsampled)
 			rowStride = (tsize_t)(units * unitSize);
 		size_t xpos = 0;
-		for(; (height < comp->h) && (strip < TIFFNumberOfStrips(tif)); strip++)
+		for(; (height < comp->h) && (strip < reader.numStrips()); strip++)
 		{
-			tsize_t ssize = TIFFReadEncodedStrip(tif, strip, buf, strip_size);
+			tsize_t ssize = reader.read(strip, buf, strip_size);
 			if(ssize < 1 || ssize > strip_size)
 			{
 				spdlog::error("tiftoimage: Bad value for ssize({}) "
@@ -888,6 +1110,7 @@ bool readTiffPixelsSigned(TIFF* tif, grk_image_comp* comps, uint32_t numcomps, u
 	tsize_t strip_size;
 	uint32_t currentPlane = 0;
 	int32_t* buffer32s = nullptr;
+	TiffStripReader reader(tif);
 
 	cvtToPlanar = cvtInterleavedToPlanar_LUT[numcomps];
 	if(tiPC == PLANARCONFIG_SEPARATE)
@@ -896,7 +1119,12 @@ bool readTiffPixelsSigned(TIFF* tif, grk_image_comp* comps, uint32_t numcomps, u
 		tiSpp = 1U; /* consider only one sample per plane */
 	}
 
-	strip_size = TIFFStripSize(tif);
+	if(!reader.init(comps[0].w, comps[0].h, (uint32_t)tiSpp * comps[0].prec))
+	{
+		success = false;
+		goto local_cleanup;
+	}
+	strip_size = reader.stripSize();
 	buf = _TIFFmalloc(strip_size);
 	if(buf == nullptr)
 	{
@@ -914,9 +1142,9 @@ bool readTiffPixelsSigned(TIFF* tif, grk_image_comp* comps, uint32_t numcomps, u
 		planes[0] = comp->data; /* to manage planar data */
 		uint32_t height = comp->h;
 		/* Read the Image components */
-		for(; (height > 0) && (strip < TIFFNumberOfStrips(tif)); strip++)
+		for(; (height > 0) && (strip < reader.numStrips()); strip++)
 		{
-			tsize_t ssize = TIFFReadEncodedStrip(tif, strip, buf, strip_size);
+			tsize_t ssize = reader.read(strip, buf, strip_size);
 			if(ssize < 1 || ssize > strip_size)
 			{
 				spdlog::error("tiftoimage: Bad value for ssize({}) "
@@ -947,8 +1175,52 @@ local_cleanup:
 	return success;
 }
 
+bool TIFFFormat::pullTiles(grk_io_pull_request* request, void* user_data)
+{
+	return ((TIFFFormat*)user_data)->readTiles(request);
+}
+bool TIFFFormat::readTiles(grk_io_pull_request* request)
+{
+	// planar images store each component in its own set of tiles
+	uint16_t plane = pullPlanar_ ? request->compno : 0;
+	size_t pixelBytes = (size_t)pullSamplesPerPixel_ * pullBytesPerSample_;
+	size_t tileStride = tileWidth_ * pixelBytes;
+	for(uint32_t ty = request->y0 - request->y0 % tileLength_; ty < request->y1; ty += tileLength_)
+	{
+		for(uint32_t tx = request->x0 - request->x0 % tileWidth_; tx < request->x1;
+			tx += tileWidth_)
+		{
+			// consecutive requests usually fall in the same tile
+			auto tile = TIFFComputeTile(tif_, tx, ty, 0, plane);
+			if(tile != cachedTile_)
+			{
+				cachedTile_ = UINT_MAX;
+				if(TIFFReadEncodedTile(tif_, tile, tileBuf_.data(), (tmsize_t)tileBuf_.size()) < 0)
+				{
+					spdlog::error("TIFFFormat: failed to read tile {}", tile);
+					return false;
+				}
+				cachedTile_ = tile;
+			}
+			uint32_t x0 = (std::max)(tx, request->x0);
+			uint32_t x1 = (std::min)(tx + tileWidth_, request->x1);
+			uint32_t y0 = (std::max)(ty, request->y0);
+			uint32_t y1 = (std::min)(ty + tileLength_, request->y1);
+			for(uint32_t y = y0; y < y1; ++y)
+				memcpy(request->data + (y - request->y0) * request->stride +
+						   (x0 - request->x0) * pixelBytes,
+					   tileBuf_.data() + (y - ty) * tileStride + (x0 - tx) * pixelBytes,
+					   (x1 - x0) * pixelBytes);
+		}
+	}
+
+	return true;
+}
+
 // rec 601 conversion factors, multiplied by 1000
 const uint32_t rec_601_luma[3]{299, 587, 114};
+// maximum number of tiles allowed by JPEG 2000
+const uint64_t maxNumTilesJ2K = 65535;
 
 grk_image* TIFFFormat::decode(const std::string& filename, grk_cparameters* parameters)
 {
@@ -1003,6 +1275,8 @@ grk_image* TIFFFormat::decode(const std::string& filename, grk_cparameters* para
 	bool hasXRes = false, hasYRes = false, hasResUnit = false;
 	bool isSigned = (tiSf == SAMPLEFORMAT_INT);
 	bool needSignedPixelReader = isSigned && (tiBps == 8 || tiBps == 16);
+	uint32_t tileWidth = 0, tileLength = 0;
+	bool pull = false;
 
 	// 1. sanity checks
 
@@ -1191,6 +1465,23 @@ grk_image* TIFFFormat::decode(const std::string& filename, grk_cparameters* para
 		goto cleanup;
 	}
 
+	// 3. tiled images are pulled by the compressor one tile at a time, unless samples
+	// need conversion on the way in
+	if(TIFFIsTiled(tif_))
+	{
+		if(chroma_subsample_x != 1 || chroma_subsample_y != 1)
+		{
+			spdlog::error("TIFFFormat::decode: tiled image with chroma subsampling "
+						  "is not supported");
+			goto cleanup;
+		}
+		TIFFGetField(tif_, TIFFTAG_TILEWIDTH, &tileWidth);
+		TIFFGetField(tif_, TIFFTAG_TILELENGTH, &tileLength);
+		pull = tileWidth && tileLength && (tiBps == 8 || tiBps == 16) && numcomps == tiSpp &&
+			   !is_cinema && !isCIE && tiPhoto != PHOTOMETRIC_MINISWHITE &&
+			   !parameters->apply_icc_ && !parameters->io_pull_callback;
+	}
+
 	// 4. create image
 	for(uint32_t j = 0; j < numcomps; j++)
 	{
@@ -1202,7 +1493,7 @@ grk_image* TIFFFormat::decode(const std::string& filename, grk_cparameters* para
 		img_comp->w = grk::ceildiv<uint32_t>(w, img_comp->dx);
 		img_comp->h = grk::ceildiv<uint32_t>(h, img_comp->dy);
 	}
-	image = grk_image_new(numcomps, &cmptparm[0], color_space, true);
+	image = grk_image_new(numcomps, &cmptparm[0], color_space, !pull);
 	if(!image)
 		goto cleanup;
 
@@ -1356,7 +1647,36 @@ grk_image* TIFFFormat::decode(const std::string& filename, grk_cparameters* para
 		memcpy(image->meta->xmp_buf, xmp_buf, xmp_len);
 	}
 	// 9. read pixel data
-	if(needSignedPixelReader)
+	if(pull)
+	{
+		pullPlanar_ = tiPC == PLANARCONFIG_SEPARATE;
+		pullSamplesPerPixel_ = pullPlanar_ ? 1 : tiSpp;
+		pullBytesPerSample_ = (uint8_t)(tiBps / 8);
+		tileWidth_ = tileWidth;
+		tileLength_ = tileLength;
+		tileBuf_.resize((size_t)TIFFTileSize(tif_));
+		cachedTile_ = UINT_MAX;
+		parameters->io_pull_callback = pullTiles;
+		parameters->io_pull_user_data = this;
+		parameters->io_pull_bytes_per_sample = pullBytesPerSample_;
+		parameters->io_pull_interleaved = !pullPlanar_;
+		// map JPEG 2000 tiles onto TIFF tiles, so that each TIFF tile is read once,
+		// and TIFF tiles are read as the compressor works through the tiles
+		uint64_t numTiles =
+			(uint64_t)((w + tileWidth - 1) / tileWidth) * ((h + tileLength - 1) / tileLength);
+		if(!parameters->tile_size_on && numTiles <= maxNumTilesJ2K &&
+		   !GRK_IS_CINEMA(parameters->rsiz) && !GRK_IS_IMF(parameters->rsiz) &&
+		   !GRK_IS_BROADCAST(parameters->rsiz))
+		{
+			parameters->tile_size_on = true;
+			parameters->t_width = tileWidth;
+			parameters->t_height = tileLength;
+			parameters->tx0 = parameters->image_offset_x0;
+			parameters->ty0 = parameters->image_offset_y0;
+		}
+		success = true;
+	}
+	else if(needSignedPixelReader)
 	{
 		if(tiBps == 8)
 			success = readTiffPixelsSigned<int8_t>(tif_, image->comps, numcomps, tiSpp, tiPC);
@@ -1369,9 +1689,12 @@ grk_image* TIFFFormat::decode(const std::string& filename, grk_cparameters* para
 								 chroma_subsample_x, chroma_subsample_y);
 	}
 cleanup:
-	if(tif_)
+	// pulled image is read while it is compressed
+	if(tif_ && !(pull && success))
+	{
 		TIFFClose(tif_);
-	tif_ = nullptr;
+		tif_ = nullptr;
+	}
 	if(success)
 	{
 		if(is_cinema)
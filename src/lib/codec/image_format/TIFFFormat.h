@@ -31,6 +31,9 @@
 #include <tiffio.h>
 #include "convert.h"
 
+#include <functional>
+#include <vector>
+
 // #define GRK_NEW_IO
 
 #ifdef GRK_NEW_IO
@@ -61,6 +64,17 @@ class TIFFFormat : public ImageFormat
 	virtual bool encodePixels(uint32_t threadId, grk_io_buf pixels) override;
 	bool encodeFinish(void) override;
 	grk_image* decode(const std::string& filename, grk_cparameters* parameters) override;
+	/***
+	 * Write tiles rather than strips. Tile length is set by the rows per strip
+	 * of the image, and both tile dimensions are rounded up to multiples of 16
+	 *
+	 * @param tileWidth nominal tile width
+	 */
+	void setTileWidth(uint32_t tileWidth);
+	/***
+	 * Pull callback for tiled input: samples are read from TIFF tiles on demand
+	 */
+	static bool pullTiles(grk_io_pull_request* request, void* user_data);
 
 #ifdef GRK_NEW_IO
 	bool ioReclaim(uint32_t threadId, io::io_buf* buffer);
@@ -75,10 +89,26 @@ class TIFFFormat : public ImageFormat
 	 * Common core pixel encoding write to disk
 	 */
 	bool encodePixelsCoreWrite(grk_io_buf pixels) override;
+	bool supportsStripEncoder(void) override;
+	bool compressStrip(EncodedStrip& strip) override;
+	bool writeStrip(EncodedStrip& strip) override;
+	bool readTiles(grk_io_pull_request* request);
+	bool cutTiles(grk_io_buf pixels, std::vector<uint8_t>& tileBuf,
+				  const std::function<bool(uint32_t tileIndex, uint8_t* tile, size_t len)>& fn);
 	TIFF* tif_;
 	uint32_t chroma_subsample_x;
 	uint32_t chroma_subsample_y;
 	size_t units;
+	// tile dimensions, or zero for strips
+	uint32_t tileWidth_;
+	uint32_t tileLength_;
+	size_t tileRowBytes_;
+	std::vector<uint8_t> tileBuf_;
+	// pulled input
+	uint32_t cachedTile_;
+	uint16_t pullSamplesPerPixel_;
+	uint8_t pullBytesPerSample_;
+	bool pullPlanar_;
 #ifdef GRK_NEW_IO
 	io::TIFFFormat ioTiffFormat;
 #endif
@@ -40,6 +40,7 @@
 #include <chrono>
 
 #include <filesystem>
+#include <memory>
 #include "common.h"
 using namespace grk;
 #include "grk_apps_config.h"
@@ -289,13 +290,19 @@ static void compress_help_display(void)
 	fprintf(stdout, "\n");
 	fprintf(stdout, "-F 512,512,3,8,u@1x1:2x2:2x2\n");
 	fprintf(stdout, "\n");
-	fprintf(stdout, " `-A, -rate_control_algorithm [0|1]`\n");
+	fprintf(stdout, " `-A, -rate_control_algorithm [0|1|2|3]`\n");
 	fprintf(stdout, "\n");
 	fprintf(stdout, "Select algorithm used for rate control.\n");
 	fprintf(stdout, "* 0: Bisection search for optimal threshold using all code passes in code\n");
 	fprintf(stdout, "blocks. Slightly higher PSNR than algorithm 1.\n");
 	fprintf(stdout, "* 1: Bisection search for optimal threshold using only feasible truncation\n");
 	fprintf(stdout, "points, on convex hull (default). Faster than algorithm 0.\n");
+	fprintf(stdout, "* 2: Feasible truncation points, with layer thresholds read from cumulative\n");
+	fprintf(stdout, "rate tables and confirmed by one or two T2 simulations. Faster than\n");
+	fprintf(stdout, "algorithm 1 for many layers.\n");
+	fprintf(stdout, "* 3: As algorithm 2, but with a single threshold per layer for the whole\n");
+	fprintf(stdout, "image rather than for each tile. All tiles are kept in memory until rate\n");
+	fprintf(stdout, "control is complete.\n");
 	fprintf(stdout, "\n");
 	fprintf(stdout, " `-r, -compression_ratios [<compression ratio>,<compression ratio>,...]`\n");
 	fprintf(stdout, "\n");
@@ -364,6 +371,8 @@ static void compress_help_display(void)
 	fprintf(stdout, " `-t, -tile_dims [tile width,tile height]`\n");
 	fprintf(stdout, "\n");
 	fprintf(stdout, "Tile size. Default: the dimension of the whole image, thus only one tile.\n");
+	fprintf(stdout, "For tiled `TIF` input, the default is the `TIF` tile size, and 8 or 16 bit\n");
+	fprintf(stdout, "samples are read one tile at a time as the image is compressed.\n");
 	fprintf(stdout, "\n");
 	fprintf(stdout, " `-L, -PLT`\n");
 	fprintf(stdout, "\n");
@@ -1156,7 +1165,7 @@ GrkRC GrkCompress::parseCommandLine(int argc, char** argv, CompressInitParams* i
 		if(rateControlAlgoArg.isSet())
 		{
 			uint32_t algo = rateControlAlgoArg.getValue();
-			if(algo > GRK_RATE_CONTROL_PCRD_OPT)
+			if(algo > GRK_RATE_CONTROL_PCRD_GLOBAL)
 				spdlog::warn("Rate control algorithm %u is not valid. Using default");
 			else
 				parameters->rateControlAlgorithm =
@@ -2235,6 +2244,12 @@ static uint64_t pluginCompressCallback(grk_plugin_compress_user_callback_info* i
 	bool createdImage = false;
 	std::string outfile;
 	std::string temp_ofname;
+#ifdef GROK_HAVE_LIBTIFF
+	// tiled TIFF input is read while it is compressed
+	std::unique_ptr<TIFFFormat> tif;
+#endif
+	// input may set tiling and pull parameters for its own image
+	auto savedParameters = *parameters;
 
 	bool hasStreamParams = info->stream_params.file || info->stream_params.buf;
 	// get output file
@@ -2317,8 +2332,8 @@ static uint64_t pluginCompressCallback(grk_plugin_compress_user_callback_info* i
 
 #ifdef GROK_HAVE_LIBTIFF
 			case GRK_FMT_TIF: {
-				TIFFFormat tif;
-				image = tif.decode(info->input_file_name, info->compressor_parameters);
+				tif = std::make_unique<TIFFFormat>();
+				image = tif->decode(info->input_file_name, info->compressor_parameters);
 				if(!image)
 					goto cleanup;
 			}
@@ -2544,6 +2559,15 @@ cleanup:
 	grk_object_unref(codec);
 	if(createdImage)
 		grk_object_unref(&image->obj);
+	parameters->tile_size_on = savedParameters.tile_size_on;
+	parameters->t_width = savedParameters.t_width;
+	parameters->t_height = savedParameters.t_height;
+	parameters->tx0 = savedParameters.tx0;
+	parameters->ty0 = savedParameters.ty0;
+	parameters->io_pull_callback = savedParameters.io_pull_callback;
+	parameters->io_pull_user_data = savedParameters.io_pull_user_data;
+	parameters->io_pull_bytes_per_sample = savedParameters.io_pull_bytes_per_sample;
+	parameters->io_pull_interleaved = savedParameters.io_pull_interleaved;
 	if(!compressedBytes)
 	{
 		spdlog::error("failed to compress image");
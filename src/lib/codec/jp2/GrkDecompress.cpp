@@ -303,6 +303,14 @@ static void decompress_help_display(void)
 	fprintf(stdout, "```\n");
 	fprintf(stdout, "example: `-m 0` would disable all three markers.\n");
 	fprintf(stdout, "\n");
+	fprintf(stdout, " `-S, -streaming`\n");
+	fprintf(stdout, "\n");
+	fprintf(stdout,
+			"Decompress each resolution of a tile as soon as its packets have been read,\n");
+	fprintf(stdout, "rather than after all packets of the tile have been read. Applies to\n");
+	fprintf(stdout, "multi-threaded, full tile decompression of tiles without PLT or PLM\n");
+	fprintf(stdout, "markers.\n");
+	fprintf(stdout, "\n");
 	fprintf(stdout, "\n");
 	fprintf(stdout, " `-c, -compression [compression value]`\n");
 	fprintf(stdout, "\n");
@@ -313,6 +321,14 @@ static void decompress_help_display(void)
 	fprintf(stdout, "`ZIP`,`LZMA`,`ZSTD`,`WEBP`}.\n");
 	fprintf(stdout, "Default value is `NONE`.\n");
 	fprintf(stdout, "\n");
+	fprintf(stdout, " `-T, -tiff_tiles`\n");
+	fprintf(stdout, "\n");
+	fprintf(stdout,
+			"Write `TIF` output as tiles rather than strips. Tile width follows the JPEG 2000\n");
+	fprintf(stdout, "tile width, and tile height follows the JPEG 2000 tile height, both\n");
+	fprintf(stdout, "rounded up to multiples of 16. Tiles are written as each row of JPEG 2000\n");
+	fprintf(stdout, "tiles is decompressed, without building the full output image.\n");
+	fprintf(stdout, "\n");
 	fprintf(stdout, " `-L, -compression_level [compression level]`\n");
 	fprintf(stdout, "\n");
 	fprintf(stdout, "\"Quality\" of compression. Currently only implemented for `PNG` format.\n");
@@ -658,6 +674,8 @@ GrkRC GrkDecompress::parseCommandLine(int argc, char** argv, DecompressInitParam
 		TCLAP::ValueArg<uint32_t> reduceArg("r", "reduce", "reduce resolutions", false, 0,
 											"unsigned integer", cmd);
 		TCLAP::SwitchArg splitPnmArg("s", "split_pnm", "Split PNM", cmd);
+		TCLAP::SwitchArg streamingArg("S", "streaming", "Stream packets", cmd);
+		TCLAP::SwitchArg tiffTilesArg("T", "tiff_tiles", "Tiled TIFF output", cmd);
 		TCLAP::ValueArg<uint32_t> tileArg("t", "tile_info", "Input tile index", false, 0,
 										  "unsigned integer", cmd);
 		TCLAP::SwitchArg upsampleArg("u", "upsample", "Upsample", cmd);
@@ -713,6 +731,7 @@ GrkRC GrkDecompress::parseCommandLine(int argc, char** argv, DecompressInitParam
 				parameters->upsample = true;
 		}
 		parameters->split_pnm = splitPnmArg.isSet();
+		parameters->tiff_tiles = tiffTilesArg.isSet();
 		if(compressionArg.isSet())
 		{
 			uint32_t comp = getCompressionCode(compressionArg.getValue());
@@ -874,6 +893,7 @@ GrkRC GrkDecompress::parseCommandLine(int argc, char** argv, DecompressInitParam
 			parameters->core.layers_to_decompress_ = layerArg.getValue();
 		if(randomAccessArg.isSet())
 			parameters->core.randomAccessFlags_ = randomAccessArg.getValue();
+		parameters->core.streamingDecompress = streamingArg.isSet();
 		parameters->singleTileDecompress = tileArg.isSet();
 		if(tileArg.isSet())
 			parameters->tileIndex = (uint16_t)tileArg.getValue();
@@ -1210,6 +1230,15 @@ bool GrkDecompress::encodeInit(grk_plugin_decompress_callback_info* info)
 		compressionLevel = parameters->compression;
 	else if(cod_format == GRK_FMT_JPG || cod_format == GRK_FMT_PNG)
 		compressionLevel = parameters->compressionLevel;
+#ifdef GROK_HAVE_LIBTIFF
+	if(cod_format == GRK_FMT_TIF && parameters->tiff_tiles)
+	{
+		uint8_t reduce = parameters->core.reduce;
+		((TIFFFormat*)imageFormat)
+			->setTileWidth(
+				(uint32_t)(((uint64_t)info->header_info.t_width + (1U << reduce) - 1) >> reduce));
+	}
+#endif
 	if(!imageFormat->encodeInit(info->image, outfileStr, compressionLevel,
 								info->decompressor_parameters->numThreads
 									? info->decompressor_parameters->numThreads
@@ -0,0 +1,102 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "grk_includes.h"
+
+namespace grk
+{
+// chunk header is padded so that chunk data stays cache line aligned
+const size_t kBlockArenaHeaderSize = 64;
+
+BlockArena::BlockArena(size_t chunkSize)
+	: chunkSize_(chunkSize), curr_(nullptr), head_(nullptr), numAllocations_(0), numChunks_(0),
+	  bytesAllocated_(0)
+{
+	static_assert(sizeof(Chunk) <= kBlockArenaHeaderSize);
+}
+BlockArena::~BlockArena(void)
+{
+	release();
+}
+BlockArena::Chunk* BlockArena::newChunk(size_t size)
+{
+	auto mem = (uint8_t*)grk_aligned_malloc(kBlockArenaHeaderSize + size);
+	if(!mem)
+		throw std::bad_alloc();
+	auto chunk = new(mem) Chunk();
+	chunk->next = head_;
+	chunk->size = size;
+	chunk->used = 0;
+	chunk->data = mem + kBlockArenaHeaderSize;
+	head_ = chunk;
+	numChunks_++;
+	bytesAllocated_ += size;
+
+	return chunk;
+}
+void* BlockArena::alloc(size_t bytes)
+{
+	bytes = (std::max<size_t>(bytes, 1) + kAlignment - 1) & ~(kAlignment - 1);
+	numAllocations_.fetch_add(1, std::memory_order_relaxed);
+	// large allocations get a dedicated chunk, leaving the current chunk untouched
+	if(bytes > chunkSize_ / 4)
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		auto chunk = newChunk(bytes);
+		chunk->used = bytes;
+		return chunk->data;
+	}
+	while(true)
+	{
+		auto chunk = curr_.load(std::memory_order_acquire);
+		if(chunk)
+		{
+			size_t offset = chunk->used.fetch_add(bytes, std::memory_order_relaxed);
+			if(offset + bytes <= chunk->size)
+				return chunk->data + offset;
+		}
+		std::lock_guard<std::mutex> lock(mutex_);
+		// another thread may already have replaced the exhausted chunk
+		if(curr_.load(std::memory_order_relaxed) == chunk)
+			curr_.store(newChunk(chunkSize_), std::memory_order_release);
+	}
+}
+void BlockArena::release(void)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	curr_ = nullptr;
+	while(head_)
+	{
+		auto next = head_->next;
+		head_->~Chunk();
+		grk_aligned_free(head_);
+		head_ = next;
+	}
+}
+uint64_t BlockArena::getNumAllocations(void) const
+{
+	return numAllocations_;
+}
+uint64_t BlockArena::getNumChunks(void) const
+{
+	return numChunks_;
+}
+uint64_t BlockArena::getBytesAllocated(void) const
+{
+	return bytesAllocated_;
+}
+
+} // namespace grk
@@ -0,0 +1,128 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <type_traits>
+
+namespace grk
+{
+const size_t kBlockArenaChunkSize = 1024 * 1024;
+
+/**
+ * Tile-scoped monotonic arena for code blocks and their segment, pass and layer arrays.
+ *
+ * Memory is carved out of large chunks by bumping an atomic offset, so threads
+ * only take a lock when a new chunk is needed. Memory is never returned to the arena:
+ * objects are destroyed in place by their owners, and all chunks are freed
+ * together when the arena is released.
+ */
+class BlockArena
+{
+  public:
+	explicit BlockArena(size_t chunkSize = kBlockArenaChunkSize);
+	~BlockArena(void);
+	/**
+	 * Allocate uninitialized memory aligned to kAlignment bytes
+	 *
+	 * @param bytes number of bytes
+	 * @return pointer to memory; std::bad_alloc is thrown on failure
+	 */
+	void* alloc(size_t bytes);
+	template<typename T, typename... Args>
+	T* create(Args&&... args)
+	{
+		static_assert(alignof(T) <= kAlignment);
+		return new(alloc(sizeof(T))) T(std::forward<Args>(args)...);
+	}
+	/**
+	 * Allocate array of default-constructed elements. Elements are never destroyed,
+	 * so they must be trivially destructible
+	 */
+	template<typename T>
+	T* createArray(size_t num)
+	{
+		static_assert(std::is_trivially_destructible<T>::value);
+		static_assert(alignof(T) <= kAlignment);
+		auto arr = (T*)alloc(num * sizeof(T));
+		for(size_t i = 0; i < num; ++i)
+			new(arr + i) T();
+		return arr;
+	}
+	/**
+	 * Free all chunks. Objects created in the arena must already be destroyed
+	 */
+	void release(void);
+	uint64_t getNumAllocations(void) const;
+	uint64_t getNumChunks(void) const;
+	uint64_t getBytesAllocated(void) const;
+
+	static constexpr size_t kAlignment = 16;
+
+  private:
+	struct Chunk
+	{
+		Chunk* next;
+		size_t size;
+		std::atomic<size_t> used;
+		uint8_t* data;
+	};
+	Chunk* newChunk(size_t size);
+
+	size_t chunkSize_;
+	// chunk that allocations are currently carved from
+	std::atomic<Chunk*> curr_;
+	// all chunks, including dedicated chunks for large allocations
+	Chunk* head_;
+	std::mutex mutex_;
+	std::atomic<uint64_t> numAllocations_;
+	std::atomic<uint64_t> numChunks_;
+	std::atomic<uint64_t> bytesAllocated_;
+};
+
+/**
+ * STL allocator drawing from a BlockArena; deallocation is a no-op
+ */
+template<typename T>
+struct BlockArenaAllocator
+{
+	typedef T value_type;
+	explicit BlockArenaAllocator(BlockArena* arena) : arena_(arena) {}
+	template<typename U>
+	BlockArenaAllocator(const BlockArenaAllocator<U>& rhs) : arena_(rhs.arena_)
+	{}
+	T* allocate(size_t num)
+	{
+		return (T*)arena_->alloc(num * sizeof(T));
+	}
+	void deallocate([[maybe_unused]] T* p, [[maybe_unused]] size_t num) {}
+	template<typename U>
+	bool operator==(const BlockArenaAllocator<U>& rhs) const
+	{
+		return arena_ == rhs.arena_;
+	}
+	template<typename U>
+	bool operator!=(const BlockArenaAllocator<U>& rhs) const
+	{
+		return arena_ != rhs.arena_;
+	}
+
+	BlockArena* arena_;
+};
+
+} // namespace grk
@@ -0,0 +1,106 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "grk_includes.h"
+
+namespace grk
+{
+DecodedBlockCache::DecodedBlockCache(void) : numHits_(0), numMisses_(0) {}
+DecodedBlockCache::Key DecodedBlockCache::key(DecompressBlockExec* block)
+{
+	Key key;
+	key.tileIndex = block->tileIndex;
+	key.compno = block->compno;
+	key.resno = block->resno;
+	key.bandOrientation = (uint8_t)block->bandOrientation;
+	key.x0 = block->cblk->x0;
+	key.y0 = block->cblk->y0;
+
+	return key;
+}
+DecodedBlockCache::Signature DecodedBlockCache::signature(DecompressBlockExec* block)
+{
+	auto cblk = block->cblk;
+	Signature signature;
+	signature.numPasses = 0;
+	for(uint32_t i = 0; i < cblk->getNumSegments(); ++i)
+		signature.numPasses += cblk->getSegment(i)->numpasses;
+	signature.numBytes = cblk->getSegBuffersLen();
+	signature.numbps = cblk->numbps;
+
+	return signature;
+}
+bool DecodedBlockCache::restore(DecompressBlockExec* block)
+{
+	if(block->cblk->seg_buffers.empty())
+		return false;
+	Entry* entry = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		auto it = blocks_.find(key(block));
+		if(it != blocks_.end())
+			entry = &it->second;
+	}
+	// a block is only ever decoded by one thread at a time, so entry can be read unlocked
+	if(!entry || !(entry->signature == signature(block)))
+	{
+		numMisses_++;
+		return false;
+	}
+	numHits_++;
+	// post processing may transform its input in place
+	auto data = entry->data;
+	if(entry->ht)
+		block->tilec->postProcessHT(data.data(), block, (uint16_t)entry->stride);
+	else
+		block->tilec->postProcess(data.data(), block);
+
+	return true;
+}
+void DecodedBlockCache::store(DecompressBlockExec* block, const int32_t* data, uint32_t stride,
+							  bool ht)
+{
+	auto cblk = block->cblk;
+	if(cblk->seg_buffers.empty())
+		return;
+	auto sig = signature(block);
+	Entry* entry;
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		entry = &blocks_[key(block)];
+	}
+	if(entry->signature == sig && !entry->data.empty())
+		return;
+	entry->signature = sig;
+	entry->stride = stride;
+	entry->ht = ht;
+	entry->data.assign(data, data + (size_t)stride * cblk->height());
+}
+void DecodedBlockCache::clear(void)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+	blocks_.clear();
+}
+uint64_t DecodedBlockCache::getNumHits(void) const
+{
+	return numHits_;
+}
+uint64_t DecodedBlockCache::getNumMisses(void) const
+{
+	return numMisses_;
+}
+
+} // namespace grk
@@ -0,0 +1,112 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace grk
+{
+struct DecompressBlockExec;
+
+/**
+ * Decoded code blocks, kept across decompressions of a code stream that grows
+ * as it is received.
+ *
+ * The T1 output of each code block is stored along with the number of coding passes and
+ * compressed bytes that it was decoded from. A code block that has received no new data
+ * since it was stored is restored from the cache rather than decoded again.
+ */
+class DecodedBlockCache
+{
+  public:
+	DecodedBlockCache(void);
+	/**
+	 * Restore T1 output of block from cache, and post-process it into the tile window
+	 *
+	 * @param block block to restore
+	 * @return true if block was restored, false if it must be decoded
+	 */
+	bool restore(DecompressBlockExec* block);
+	/**
+	 * Store T1 output of block, unless it was itself restored from the cache
+	 *
+	 * @param block decoded block
+	 * @param data T1 output
+	 * @param stride T1 output stride
+	 * @param ht true if T1 output is in HT block coder format
+	 */
+	void store(DecompressBlockExec* block, const int32_t* data, uint32_t stride, bool ht);
+	void clear(void);
+	uint64_t getNumHits(void) const;
+	uint64_t getNumMisses(void) const;
+
+  private:
+	struct Key
+	{
+		bool operator==(const Key& rhs) const
+		{
+			return tileIndex == rhs.tileIndex && compno == rhs.compno && resno == rhs.resno &&
+				   bandOrientation == rhs.bandOrientation && x0 == rhs.x0 && y0 == rhs.y0;
+		}
+		uint16_t tileIndex;
+		uint16_t compno;
+		uint8_t resno;
+		uint8_t bandOrientation;
+		uint32_t x0;
+		uint32_t y0;
+	};
+	struct KeyHash
+	{
+		size_t operator()(const Key& key) const
+		{
+			uint64_t h = ((uint64_t)key.tileIndex << 48) ^ ((uint64_t)key.compno << 32) ^
+						 ((uint64_t)key.resno << 24) ^ ((uint64_t)key.bandOrientation << 16);
+			h ^= ((uint64_t)key.x0 << 20) ^ key.y0;
+			return std::hash<uint64_t>()(h);
+		}
+	};
+	// compressed data that a block was decoded from
+	struct Signature
+	{
+		bool operator==(const Signature& rhs) const
+		{
+			return numPasses == rhs.numPasses && numBytes == rhs.numBytes &&
+				   numbps == rhs.numbps;
+		}
+		uint32_t numPasses = 0;
+		size_t numBytes = 0;
+		uint8_t numbps = 0;
+	};
+	struct Entry
+	{
+		Signature signature;
+		uint32_t stride = 0;
+		bool ht = false;
+		std::vector<int32_t> data;
+	};
+	static Key key(DecompressBlockExec* block);
+	static Signature signature(DecompressBlockExec* block);
+
+	std::unordered_map<Key, Entry, KeyHash> blocks_;
+	std::mutex mutex_;
+	std::atomic<uint64_t> numHits_;
+	std::atomic<uint64_t> numMisses_;
+};
+
+} // namespace grk
@@ -230,7 +230,7 @@ TilePartLengthInfo::TilePartLengthInfo(uint16_t tileno, uint32_t len)
 TileLengthMarkers::TileLengthMarkers(uint16_t numSignalledTiles)
 	: markers_(new TL_MAP()), markerIt_(markers_->end()), markerTilePartIndex_(0),
 	  curr_vec_(nullptr), stream_(nullptr), streamStart(0), valid_(true), hasTileIndices_(false),
-	  tileCount_(0), numSignalledTiles_(numSignalledTiles)
+	  tileCount_(0), numSignalledTiles_(numSignalledTiles), readAheadEnd_(0)
 {}
 TileLengthMarkers::TileLengthMarkers(BufferedStream* stream) : TileLengthMarkers(USHRT_MAX)
 {
@@ -378,6 +378,7 @@ void TileLengthMarkers::rewind(void)
 {
 	markerTilePartIndex_ = 0;
 	curr_vec_ = nullptr;
+	readAheadEnd_ = 0;
 	if(markers_)
 	{
 		markerIt_ = markers_->begin();
@@ -469,6 +470,52 @@ void TileLengthMarkers::seek(TileSet* tilesToDecompress, CodingParams* cp, Buffe
 	if(skip && !stream->seek(stream->tell() + skip))
 		throw CorruptTLMException();
 }
+void TileLengthMarkers::readAhead(TileSet* tilesToDecompress, BufferedStream* stream)
+{
+	if(!valid_ || !curr_vec_ || !stream->supportsPrefetch())
+		return;
+	uint64_t position = stream->tell();
+	// wait until at least half of the prefetched region has been consumed
+	if(readAheadEnd_ > position + kTLMReadAheadBytes / 2)
+		return;
+	uint64_t limit = position + kTLMReadAheadBytes;
+	uint64_t start = std::max(position, readAheadEnd_);
+	uint64_t runStart = 0, runEnd = 0;
+	auto it = markerIt_;
+	auto vec = curr_vec_;
+	uint16_t index = markerTilePartIndex_;
+	while(position < limit)
+	{
+		if(index == vec->size())
+		{
+			if(++it == markers_->end())
+				break;
+			vec = it->second;
+			index = 0;
+			continue;
+		}
+		auto tilePart = vec->data() + index++;
+		if(tilePart->length_ == 0)
+			break;
+		uint64_t tilePartEnd = position + tilePart->length_;
+		// coalesce contiguous scheduled tile parts into a single request
+		if(tilesToDecompress->isScheduled(tilePart->tileIndex_) && tilePartEnd > start)
+		{
+			uint64_t begin = std::max(position, start);
+			if(runEnd != begin)
+			{
+				if(runEnd > runStart)
+					stream->prefetch(runStart, runEnd - runStart);
+				runStart = begin;
+			}
+			runEnd = tilePartEnd;
+		}
+		position = tilePartEnd;
+	}
+	if(runEnd > runStart)
+		stream->prefetch(runStart, runEnd - runStart);
+	readAheadEnd_ = std::max(readAheadEnd_, position);
+}
 
 bool TileLengthMarkers::writeBegin(uint16_t numTilePartsTotal)
 {
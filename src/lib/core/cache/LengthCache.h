@@ -103,6 +103,9 @@ struct TilePartLengthInfo
 typedef std::vector<TilePartLengthInfo> TL_INFO_VEC;
 typedef std::map<uint16_t, TL_INFO_VEC*> TL_MAP;
 
+// maximum number of bytes of upcoming tile parts to prefetch
+const uint64_t kTLMReadAheadBytes = 8 * 1024 * 1024;
+
 struct TileLengthMarkers
 {
 	explicit TileLengthMarkers(uint16_t numSignalledTiles);
@@ -116,6 +119,13 @@ struct TileLengthMarkers
 	void invalidate(void);
 	bool valid(void);
 	void seek(TileSet* tilesToDecompress, CodingParams* cp, BufferedStream* stream);
+	/**
+	 * Prefetch upcoming scheduled tile parts, if stream supports prefetch
+	 *
+	 * @param tilesToDecompress scheduled tiles
+	 * @param stream stream positioned at beginning of next tile part
+	 */
+	void readAhead(TileSet* tilesToDecompress, BufferedStream* stream);
 	bool writeBegin(uint16_t numTilePartsTotal);
 	void push(uint16_t tileIndex, uint32_t tile_part_size);
 	bool writeEnd(void);
@@ -144,6 +154,8 @@ struct TileLengthMarkers
 	// stored in markers
 	uint16_t tileCount_;
 	uint16_t numSignalledTiles_;
+	// end of prefetched region of stream
+	uint64_t readAheadEnd_;
 };
 
 struct PacketInfo
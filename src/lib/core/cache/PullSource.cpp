@@ -0,0 +1,140 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "grk_includes.h"
+
+namespace grk
+{
+// upper bound on native bytes pulled in one request
+const size_t kPullStripBytes = 4 * 1024 * 1024;
+
+template<typename T>
+static void convert(const uint8_t* src, size_t srcStride, uint32_t srcStep, uint32_t w,
+					uint32_t h, int32_t* dest, uint32_t destStride)
+{
+	for(uint32_t j = 0; j < h; ++j)
+	{
+		auto s = (const T*)(src + j * srcStride);
+		auto d = dest + (size_t)j * destStride;
+		for(uint32_t i = 0; i < w; ++i)
+			d[i] = s[(size_t)i * srcStep];
+	}
+}
+static void convert(const uint8_t* src, size_t srcStride, uint32_t srcStep,
+					uint8_t bytesPerSample, bool sgnd, uint32_t w, uint32_t h, int32_t* dest,
+					uint32_t destStride)
+{
+	if(bytesPerSample == 1)
+	{
+		if(sgnd)
+			convert<int8_t>(src, srcStride, srcStep, w, h, dest, destStride);
+		else
+			convert<uint8_t>(src, srcStride, srcStep, w, h, dest, destStride);
+	}
+	else
+	{
+		if(sgnd)
+			convert<int16_t>(src, srcStride, srcStep, w, h, dest, destStride);
+		else
+			convert<uint16_t>(src, srcStride, srcStep, w, h, dest, destStride);
+	}
+}
+
+PullSource::PullSource(grk_io_pull_callback callback, void* userData, uint8_t bytesPerSample,
+					   bool interleaved)
+	: callback_(callback), userData_(userData), bytesPerSample_(bytesPerSample),
+	  interleaved_(interleaved)
+{}
+bool PullSource::validate(GrkImage* image)
+{
+	if(bytesPerSample_ != 1 && bytesPerSample_ != 2)
+	{
+		Logger::logger_.error("Pulled samples must be 1 or 2 bytes, not %u", bytesPerSample_);
+		return false;
+	}
+	for(uint16_t compno = 0; compno < image->numcomps; ++compno)
+	{
+		auto comp = image->comps + compno;
+		if(comp->prec > 8 * bytesPerSample_)
+		{
+			Logger::logger_.error("Component %u precision %u does not fit in %u bit pulled samples",
+								  compno, comp->prec, 8 * bytesPerSample_);
+			return false;
+		}
+		if(interleaved_ && (comp->dx != image->comps->dx || comp->dy != image->comps->dy ||
+							comp->w != image->comps->w || comp->h != image->comps->h))
+		{
+			Logger::logger_.error(
+				"Interleaved samples can only be pulled if all components have the same size");
+			return false;
+		}
+	}
+
+	return true;
+}
+bool PullSource::pull(grk_io_pull_request* request)
+{
+	std::lock_guard<std::mutex> lock(mutex_);
+
+	return callback_(request, userData_);
+}
+bool PullSource::ingest(GrkImage* image, Tile* tile)
+{
+	uint16_t numRequests = interleaved_ ? 1 : image->numcomps;
+	uint16_t numInterleaved = interleaved_ ? image->numcomps : 1;
+	std::vector<uint8_t> buf;
+	for(uint16_t compno = 0; compno < numRequests; ++compno)
+	{
+		auto tilec = tile->comps + compno;
+		auto imgComp = image->comps + compno;
+		uint32_t offsetX = ceildiv<uint32_t>(image->x0, imgComp->dx);
+		uint32_t offsetY = ceildiv<uint32_t>(image->y0, imgComp->dy);
+		uint32_t w = tilec->width();
+		uint32_t h = tilec->height();
+		size_t rowBytes = (size_t)w * numInterleaved * bytesPerSample_;
+		uint32_t stripHeight = (uint32_t)std::clamp<size_t>(kPullStripBytes / rowBytes, 1, h);
+		buf.resize(rowBytes * stripHeight);
+		for(uint32_t y = 0; y < h; y += stripHeight)
+		{
+			uint32_t rows = std::min<uint32_t>(stripHeight, h - y);
+			grk_io_pull_request request;
+			request.compno = compno;
+			request.x0 = tilec->x0 - offsetX;
+			request.y0 = tilec->y0 - offsetY + y;
+			request.x1 = request.x0 + w;
+			request.y1 = request.y0 + rows;
+			request.data = buf.data();
+			request.stride = rowBytes;
+			if(!pull(&request))
+			{
+				Logger::logger_.error("Failed to pull rows %u to %u of component %u",
+									  request.y0, request.y1 - 1, compno);
+				return false;
+			}
+			for(uint16_t i = 0; i < numInterleaved; ++i)
+			{
+				auto dest = tile->comps[compno + i].getWindow()->getResWindowBufferHighestSimple();
+				convert(buf.data() + (size_t)i * bytesPerSample_, rowBytes, numInterleaved,
+						bytesPerSample_, image->comps[compno + i].sgnd, w, rows,
+						dest.buf_ + (size_t)y * dest.stride_, dest.stride_);
+			}
+		}
+	}
+
+	return true;
+}
+
+} // namespace grk
@@ -0,0 +1,57 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <mutex>
+
+namespace grk
+{
+/**
+ * Compression input pulled from the client, one strip of tile rows at a time.
+ *
+ * Samples arrive in native 8 or 16 bit format, either planar or interleaved, and are
+ * converted to 32 bit integers directly in the tile component windows, so that no
+ * full image buffer is needed.
+ */
+class PullSource
+{
+  public:
+	PullSource(grk_io_pull_callback callback, void* userData, uint8_t bytesPerSample,
+			   bool interleaved);
+	/**
+	 * Check that image can be pulled in this format
+	 */
+	bool validate(GrkImage* image);
+	/**
+	 * Pull tile samples into tile component windows
+	 *
+	 * @param image header image
+	 * @param tile tile with allocated windows
+	 * @return true if successful
+	 */
+	bool ingest(GrkImage* image, Tile* tile);
+
+  private:
+	bool pull(grk_io_pull_request* request);
+	grk_io_pull_callback callback_;
+	void* userData_;
+	uint8_t bytesPerSample_;
+	bool interleaved_;
+	// serializes callbacks
+	std::mutex mutex_;
+};
+
+} // namespace grk
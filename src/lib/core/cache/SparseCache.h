@@ -83,6 +83,25 @@ class SparseCache
 
   protected:
 	virtual T* create(uint64_t index) = 0;
+	/**
+	 * Pass every item to f and remove it from cache, for items that are not
+	 * owned by the cache
+	 */
+	template<typename F>
+	void releaseItems(F f)
+	{
+		for(auto& ch : chunks)
+		{
+			for(size_t i = 0; i < chunkSize_; ++i)
+			{
+				if(ch.second[i])
+				{
+					f(ch.second[i]);
+					ch.second[i] = nullptr;
+				}
+			}
+		}
+	}
 
   private:
 	std::map<uint64_t, T**> chunks;
@@ -13,8 +13,102 @@ static bool grkReclaimCallback(uint32_t threadId, grk_io_buf buffer, void* io_us
 	return true;
 }
 
+BufPool::BufPool(void) : returned_(nullptr), numHits_(0), numMisses_(0) {}
+BufPool::~BufPool(void)
+{
+	drainReturned();
+	for(auto& list : free_)
+	{
+		for(auto data : list)
+			grk_aligned_free(data);
+	}
+}
+uint32_t BufPool::sizeClass(size_t len, size_t* classLen)
+{
+	uint32_t bits = kBufPoolMinClassBits;
+	while(bits < 63 && ((size_t)1 << (bits + 1)) <= len)
+		bits++;
+	size_t base = (size_t)1 << bits;
+	if(len <= base)
+	{
+		*classLen = base;
+		return 0;
+	}
+	size_t step = base >> 2;
+	size_t steps = (len - base + step - 1) / step;
+	if(steps == 4)
+	{
+		*classLen = base << 1;
+		return (bits + 1 - kBufPoolMinClassBits) * 4;
+	}
+	*classLen = base + steps * step;
+
+	return (bits - kBufPoolMinClassBits) * 4 + (uint32_t)steps;
+}
+GrkIOBuf BufPool::get(size_t len)
+{
+	size_t classLen;
+	uint32_t c = sizeClass(len, &classLen);
+	if(free_[c].empty())
+		drainReturned();
+	if(!free_[c].empty())
+	{
+		auto data = free_[c].back();
+		free_[c].pop_back();
+		numHits_++;
+		return GrkIOBuf(data, 0, len, classLen, false, 0);
+	}
+	numMisses_++;
+	GrkIOBuf rc;
+	if(rc.alloc(classLen))
+		rc.len_ = len;
+
+	return rc;
+}
+void BufPool::put(GrkIOBuf b)
+{
+	if(!b.data_)
+		return;
+	if(b.allocLen_ < ((size_t)1 << kBufPoolMinClassBits))
+	{
+		b.dealloc();
+		return;
+	}
+	auto node = (Node*)b.data_;
+	node->allocLen = b.allocLen_;
+	node->next = returned_.load(std::memory_order_relaxed);
+	while(!returned_.compare_exchange_weak(node->next, node, std::memory_order_release,
+										   std::memory_order_relaxed))
+	{}
+}
+void BufPool::drainReturned(void)
+{
+	// owner takes the whole stack at once, so there is no ABA problem
+	auto node = returned_.exchange(nullptr, std::memory_order_acquire);
+	while(node)
+	{
+		auto next = node->next;
+		size_t classLen;
+		uint32_t c = sizeClass(node->allocLen, &classLen);
+		// buffers that were not allocated by a pool go to the largest class they can hold
+		if(classLen > node->allocLen)
+			c--;
+		free_[c].push_back((uint8_t*)node);
+		node = next;
+	}
+}
+uint64_t BufPool::getNumHits(void) const
+{
+	return numHits_;
+}
+uint64_t BufPool::getNumMisses(void) const
+{
+	return numMisses_;
+}
+
 Strip::Strip(GrkImage* outputImage, uint16_t index, uint32_t nominalHeight, uint8_t reduce)
-	: stripImg(new GrkImage()), tileCounter(0), reduce_(reduce), allocatedInterleaved_(false)
+	: stripImg(new GrkImage()), tileCounter(0), componentCounter(0), reduce_(reduce),
+	  allocatedInterleaved_(false)
 {
 	outputImage->copyHeader(stripImg);
 
@@ -51,11 +145,16 @@ bool Strip::allocInterleaved(uint64_t len, BufPool* pool)
 }
 StripCache::StripCache()
 	: strips(nullptr), numTiles_(0), numStrips_(0), nominalStripHeight_(0), imageY0_(0),
-	  packedRowBytes_(0), ioUserData_(nullptr), ioBufferCallback_(nullptr), initialized_(false),
-	  multiTile_(true)
+	  packedRowBytes_(0), packedRowHeight_(1), ioUserData_(nullptr), ioBufferCallback_(nullptr),
+	  serializing_(false), nextStrip_(0), serializeFailed_(false), initialized_(false),
+	  multiTile_(true), packedRGB8_(false)
 {}
 StripCache::~StripCache()
 {
+	if(initialized_)
+		Logger::logger_.info("Strip buffer pools: %llu hits, %llu misses",
+							 (unsigned long long)getNumPoolHits(),
+							 (unsigned long long)getNumPoolMisses());
 	for(const auto& p : pools_)
 		delete p;
 	for(uint16_t i = 0; i < numStrips_; ++i)
@@ -70,6 +169,14 @@ bool StripCache::isMultiTile(void)
 {
 	return multiTile_;
 }
+bool StripCache::isPackedRGB8(void)
+{
+	return packedRGB8_;
+}
+uint64_t StripCache::getPackedRowBytes(void)
+{
+	return packedRowBytes_;
+}
 void StripCache::init(uint32_t concurrency, uint16_t numTiles, uint32_t numStrips,
 					  uint32_t nominalStripHeight, uint8_t reduce, GrkImage* outputImage,
 					  grk_io_pixels_callback ioBufferCallback, void* ioUserData,
@@ -82,7 +189,7 @@ void StripCache::init(uint32_t concurrency, uint16_t numTiles, uint32_t numStrip
 	ioBufferCallback_ = ioBufferCallback;
 	ioUserData_ = ioUserData;
 	grk_io_init io_init;
-	// we can ignore subsampling since it is disabled for library-orchestrated encoding,
+	// first component is never subsampled for library-orchestrated encoding,
 	// which is the only case where maxPooledRequests_ is utilized
 	io_init.maxPooledRequests_ =
 		(outputImage->comps->h + outputImage->rowsPerStrip - 1) / outputImage->rowsPerStrip;
@@ -93,34 +200,75 @@ void StripCache::init(uint32_t concurrency, uint16_t numTiles, uint32_t numStrip
 	imageY0_ = outputImage->y0;
 	nominalStripHeight_ = nominalStripHeight;
 	packedRowBytes_ = outputImage->packedRowBytes;
+	packedRowHeight_ = outputImage->isTiffSubsampled() ? outputImage->comps[1].dy : 1;
+	packedRGB8_ = outputImage->numcomps == 3 && !outputImage->comps->sgnd &&
+				  !outputImage->isSubsampled() &&
+				  packedRowBytes_ == (uint64_t)outputImage->comps->w * 3;
 	strips = new Strip*[numStrips];
 	for(uint16_t i = 0; i < numStrips_; ++i)
 		strips[i] = new Strip(outputImage, i, nominalStripHeight_, reduce);
+	pendingStrips_.resize(numStrips);
+	pendingFlags_.reset(new std::atomic<bool>[numStrips]);
+	for(uint32_t i = 0; i < numStrips; ++i)
+		pendingFlags_[i] = false;
+	nextStrip_ = 0;
+	serializeFailed_ = false;
 	initialized_ = true;
 	for(uint32_t i = 0; i < concurrency; ++i)
 		pools_.push_back(new BufPool());
 }
+uint16_t StripCache::stripIndex(uint32_t yBegin)
+{
+	uint16_t stripId = (uint16_t)((yBegin + nominalStripHeight_ - 1) / nominalStripHeight_);
+	assert(stripId < numStrips_);
+
+	return stripId;
+}
+uint64_t StripCache::packedBytes(uint32_t rows)
+{
+	return packedRowBytes_ * ((rows + packedRowHeight_ - 1) / packedRowHeight_);
+}
 bool StripCache::ingestStrip(uint32_t threadId, Tile* src, uint32_t yBegin, uint32_t yEnd)
+{
+	if(!getStripBuffer(threadId, yBegin, yEnd))
+		return false;
+	if(!strips[stripIndex(yBegin)]->stripImg->compositeInterleaved(src, yBegin, yEnd))
+		return false;
+
+	return serializeStrip(threadId, yBegin, yEnd);
+}
+bool StripCache::ingestStripComponents(uint32_t threadId, Tile* src, uint32_t yBegin,
+									   uint32_t yEnd, uint16_t numComps)
 {
 	if(!initialized_)
 		return false;
+	auto strip = strips[stripIndex(yBegin)];
+	if((strip->componentCounter += numComps) < src->numcomps_)
+		return true;
 
-	uint16_t stripId = (uint16_t)((yBegin + nominalStripHeight_ - 1) / nominalStripHeight_);
-	assert(stripId < numStrips_);
-	auto strip = strips[stripId];
-	auto dest = strip->stripImg;
-	// use height of first component, because no subsampling
-	uint64_t dataLen = packedRowBytes_ * (yEnd - yBegin);
-	uint64_t dataOffset = packedRowBytes_ * yBegin;
+	return ingestStrip(threadId, src, yBegin, yEnd);
+}
+uint8_t* StripCache::getStripBuffer(uint32_t threadId, uint32_t yBegin, uint32_t yEnd)
+{
+	if(!initialized_)
+		return nullptr;
+
+	auto strip = strips[stripIndex(yBegin)];
+	// use height of first component
+	uint64_t dataLen = packedBytes(yEnd - yBegin);
 	if(!strip->allocInterleaved(dataLen, pools_[threadId]))
-		return false;
-	if(!dest->compositeInterleaved(src, yBegin, yEnd))
-		return false;
+		return nullptr;
 
+	return strip->stripImg->interleavedData.data_;
+}
+bool StripCache::serializeStrip(uint32_t threadId, uint32_t yBegin, uint32_t yEnd)
+{
+	uint16_t stripId = stripIndex(yBegin);
+	auto dest = strips[stripId]->stripImg;
 	auto buf = GrkIOBuf(dest->interleavedData);
 	buf.index_ = stripId;
-	buf.offset_ = dataOffset;
-	buf.len_ = dataLen;
+	buf.offset_ = packedBytes(yBegin);
+	buf.len_ = packedBytes(yEnd - yBegin);
 	dest->interleavedData.data_ = nullptr;
 
 	return serialize(threadId, buf);
@@ -140,9 +288,9 @@ bool StripCache::ingestTile(uint32_t threadId, GrkImage* src)
 	assert(stripId < numStrips_);
 	auto strip = strips[stripId];
 	auto dest = strip->stripImg;
-	// use height of first component, because no subsampling
-	uint64_t dataLen = packedRowBytes_ * dest->comps->h;
-	uint64_t offset = packedRowBytes_ * dest->comps->y0;
+	// use height of first component
+	uint64_t dataLen = packedBytes(dest->comps->h);
+	uint64_t offset = packedBytes(dest->comps->y0);
 	if(!strip->allocInterleavedLocked(dataLen, pools_[threadId]))
 		return false;
 	if(!dest->compositeInterleaved(src))
@@ -169,48 +317,56 @@ bool StripCache::serialize(uint32_t threadId, GrkIOBuf buf)
 	if(grokNewIO)
 		return ioBufferCallback_(threadId, buf, ioUserData_);
 
-	std::queue<GrkIOBuf> buffersToSerialize;
-	{
-		std::unique_lock<std::mutex> lk(heapMutex_);
-		// 1. push to heap
-		serializeHeap.push(buf);
-		// 2. get all sequential buffers in heap
-		while(serializeHeap.pop(buf))
-			buffersToSerialize.push(buf);
-	}
-	// 3. serialize buffers
-	if(!buffersToSerialize.empty())
+	uint32_t stripId = buf.getIndex();
+	assert(stripId < numStrips_);
+	pendingStrips_[stripId] = buf;
+	pendingFlags_[stripId] = true;
+	// whichever thread acquires the serializing flag writes all strips that are next in line.
+	// After releasing the flag, check again: a strip may have become pending just before the
+	// release, while the thread that added it failed to acquire the flag
+	bool success = true;
+	while(!serializing_.exchange(true))
 	{
+		uint32_t next = nextStrip_;
+		while(next < numStrips_ && pendingFlags_[next])
 		{
-			std::unique_lock<std::mutex> lk(serializeMutex_);
-			while(!buffersToSerialize.empty())
-			{
-				auto b = buffersToSerialize.front();
-				if(!ioBufferCallback_(threadId, b, ioUserData_))
-					break;
-				buffersToSerialize.pop();
-			}
-		}
-		// if non empty, then there has been a serialize failure
-		if(!buffersToSerialize.empty())
-		{
-			// cleanup
-			while(!buffersToSerialize.empty())
+			auto b = pendingStrips_[next++];
+			if(serializeFailed_ || !ioBufferCallback_(threadId, b, ioUserData_))
 			{
-				auto b = buffersToSerialize.front();
+				// clean up after failure
+				serializeFailed_ = true;
+				success = false;
 				b.dealloc();
-				buffersToSerialize.pop();
 			}
-			return false;
 		}
+		nextStrip_ = next;
+		serializing_ = false;
+		if(next == numStrips_ || !pendingFlags_[next])
+			break;
 	}
 
-	return true;
+	return success;
 }
 
 void StripCache::returnBufferToPool(uint32_t threadId, GrkIOBuf b)
 {
 	pools_[threadId]->put(b);
 }
+uint64_t StripCache::getNumPoolHits(void)
+{
+	uint64_t hits = 0;
+	for(auto p : pools_)
+		hits += p->getNumHits();
+
+	return hits;
+}
+uint64_t StripCache::getNumPoolMisses(void)
+{
+	uint64_t misses = 0;
+	for(auto p : pools_)
+		misses += p->getNumMisses();
+
+	return misses;
+}
 
 } // namespace grk
@@ -3,8 +3,8 @@
 #include <vector>
 #include <mutex>
 #include <atomic>
+#include <memory>
 #include "grok.h"
-#include "MinHeap.h"
 
 namespace grk
 {
@@ -55,40 +55,48 @@ struct GrkIOBuf : public grk_io_buf
 	}
 };
 
+// pooled buffers are at least this long, so that a free list node fits in a returned buffer
+const uint32_t kBufPoolMinClassBits = 12;
+// four size classes per power of two
+const uint32_t kBufPoolNumClasses = 4 * (64 - kBufPoolMinClassBits);
+
+/**
+ * Per thread pool of I/O buffers.
+ *
+ * Buffers are kept in size classes, four per power of two, so that a buffer is found in
+ * constant time and wastes at most a quarter of its length. Only the owning thread gets
+ * buffers, from private free lists. Any thread, such as the I/O reclaim callback, can put
+ * buffers back, onto a lock-free stack that the owner drains when its free lists run dry.
+ */
 class BufPool
 {
   public:
-	~BufPool(void)
-	{
-		for(auto& b : pool)
-			b.second.dealloc();
-	}
-	GrkIOBuf get(size_t len)
-	{
-		for(auto iter = pool.begin(); iter != pool.end(); ++iter)
-		{
-			if(iter->second.allocLen_ >= len)
-			{
-				auto b = iter->second;
-				b.len_ = len;
-				pool.erase(iter);
-				return b;
-			}
-		}
-		GrkIOBuf rc;
-		rc.alloc(len);
-
-		return rc;
-	}
-	void put(GrkIOBuf b)
-	{
-		assert(b.data_);
-		assert(pool.find(b.data_) == pool.end());
-		pool[b.data_] = b;
-	}
+	BufPool(void);
+	~BufPool(void);
+	GrkIOBuf get(size_t len);
+	void put(GrkIOBuf b);
+	uint64_t getNumHits(void) const;
+	uint64_t getNumMisses(void) const;
 
   private:
-	std::map<uint8_t*, GrkIOBuf> pool;
+	// free list node, stored in the returned buffer itself
+	struct Node
+	{
+		Node* next;
+		size_t allocLen;
+	};
+	/**
+	 * Get smallest size class holding len bytes
+	 *
+	 * @param len number of bytes
+	 * @param classLen receives length of buffers in class
+	 */
+	static uint32_t sizeClass(size_t len, size_t* classLen);
+	void drainReturned(void);
+	std::vector<uint8_t*> free_[kBufPoolNumClasses];
+	std::atomic<Node*> returned_;
+	std::atomic<uint64_t> numHits_;
+	std::atomic<uint64_t> numMisses_;
 };
 
 struct Strip
@@ -101,6 +109,7 @@ struct Strip
 	bool allocInterleaved(uint64_t len, BufPool* pool);
 	GrkImage* stripImg;
 	std::atomic<uint32_t> tileCounter; // count number of tiles added to strip
+	std::atomic<uint16_t> componentCounter; // count number of single tile components completed
 	uint8_t reduce_; // resolution reduction
 	mutable std::mutex interleaveMutex_;
 	mutable std::atomic<bool> allocatedInterleaved_;
@@ -119,11 +128,34 @@ class StripCache
 	bool ingestTile(uint32_t threadId, GrkImage* src);
 	bool ingestTile(GrkImage* src);
 	bool ingestStrip(uint32_t threadId, Tile* src, uint32_t yBegin, uint32_t yEnd);
+	/**
+	 * Signal that numComps components of single tile strip are complete.
+	 * Strip is ingested once all of the tile's components are complete
+	 */
+	bool ingestStripComponents(uint32_t threadId, Tile* src, uint32_t yBegin, uint32_t yEnd,
+							   uint16_t numComps);
+	/**
+	 * Get interleaved buffer for single tile strip, to be filled by caller
+	 * and then passed on with serializeStrip
+	 *
+	 * @return buffer, or nullptr on failure
+	 */
+	uint8_t* getStripBuffer(uint32_t threadId, uint32_t yBegin, uint32_t yEnd);
+	bool serializeStrip(uint32_t threadId, uint32_t yBegin, uint32_t yEnd);
+	/**
+	 * True if strips are unsigned 8 bit RGB, with no row padding
+	 */
+	bool isPackedRGB8(void);
+	uint64_t getPackedRowBytes(void);
 	void returnBufferToPool(uint32_t threadId, GrkIOBuf b);
+	uint64_t getNumPoolHits(void);
+	uint64_t getNumPoolMisses(void);
 	bool isInitialized(void);
 	bool isMultiTile(void);
 
   private:
+	uint16_t stripIndex(uint32_t yBegin);
+	uint64_t packedBytes(uint32_t rows);
 	bool serialize(uint32_t threadId, GrkIOBuf buf);
 	std::vector<BufPool*> pools_;
 	Strip** strips;
@@ -132,13 +164,20 @@ class StripCache
 	uint32_t nominalStripHeight_;
 	uint32_t imageY0_;
 	uint64_t packedRowBytes_;
+	// number of image rows covered by each packed row
+	uint32_t packedRowHeight_;
 	void* ioUserData_;
 	grk_io_pixels_callback ioBufferCallback_;
-	mutable std::mutex serializeMutex_;
-	MinHeap<GrkIOBuf, uint32_t, MinHeapFakeLocker> serializeHeap;
-	mutable std::mutex heapMutex_;
+	// strip buffers waiting to be serialized; a buffer is pending once its flag is set
+	std::vector<GrkIOBuf> pendingStrips_;
+	std::unique_ptr<std::atomic<bool>[]> pendingFlags_;
+	// held by the one thread serializing strips, which owns nextStrip_
+	std::atomic<bool> serializing_;
+	uint32_t nextStrip_;
+	std::atomic<bool> serializeFailed_;
 	bool initialized_;
 	bool multiTile_;
+	bool packedRGB8_;
 };
 
 } // namespace grk
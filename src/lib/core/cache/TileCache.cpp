@@ -18,13 +18,15 @@
 
 namespace grk
 {
-TileCacheEntry::TileCacheEntry(TileProcessor* p) : processor(p) {}
+TileCacheEntry::TileCacheEntry(TileProcessor* p) : processor(p), parsed(false), bytes(0) {}
 TileCacheEntry::TileCacheEntry() : TileCacheEntry(nullptr) {}
 TileCacheEntry::~TileCacheEntry()
 {
 	delete processor;
 }
-TileCache::TileCache(GRK_TILE_CACHE_STRATEGY strategy) : tileComposite(nullptr), strategy_(strategy)
+TileCache::TileCache(GRK_TILE_CACHE_STRATEGY strategy)
+	: tileComposite(nullptr), strategy_(strategy), budget_(kDefaultTileCacheBudget), bytes_(0),
+	  numHits_(0), numMisses_(0), numEvictions_(0)
 {
 	tileComposite = new GrkImage();
 }
@@ -93,5 +95,60 @@ std::vector<GrkImage*> TileCache::getTileImages(void)
 	}
 	return rc;
 }
+void TileCache::setBudget(uint64_t budget)
+{
+	budget_ = budget ? budget : kDefaultTileCacheBudget;
+}
+GrkImage* TileCache::lookup(uint16_t tileIndex)
+{
+	auto entry = get(tileIndex);
+	auto image = (entry && entry->processor) ? entry->processor->getImage() : nullptr;
+	if(!image)
+	{
+		numMisses_++;
+		return nullptr;
+	}
+	numHits_++;
+	if(entry->bytes)
+		lru_.splice(lru_.begin(), lru_, entry->lruIter);
+
+	return image;
+}
+void TileCache::insert(uint16_t tileIndex)
+{
+	auto entry = get(tileIndex);
+	if(!entry || entry->bytes || !entry->processor || !entry->processor->getImage())
+		return;
+	auto image = entry->processor->getImage();
+	for(uint16_t compno = 0; compno < image->numcomps; ++compno)
+	{
+		auto comp = image->comps + compno;
+		entry->bytes += (uint64_t)comp->stride * comp->h * sizeof(int32_t);
+	}
+	// an image with no data still occupies a place in the LRU list
+	if(!entry->bytes)
+		entry->bytes = 1;
+	bytes_ += entry->bytes;
+	lru_.push_front(tileIndex);
+	entry->lruIter = lru_.begin();
+
+	// always keep the most recently used tile
+	while(bytes_ > budget_ && lru_.size() > 1)
+	{
+		auto victim = get(lru_.back());
+		lru_.pop_back();
+		bytes_ -= victim->bytes;
+		victim->bytes = 0;
+		victim->processor->releaseImage();
+		numEvictions_++;
+	}
+}
+void TileCache::getStats(grk_tile_cache_stats* stats)
+{
+	stats->hits = numHits_;
+	stats->misses = numMisses_;
+	stats->evictions = numEvictions_;
+	stats->bytes = bytes_;
+}
 
 } // namespace grk
@@ -17,6 +17,7 @@
 #pragma once
 
 #include <map>
+#include <list>
 
 namespace grk
 {
@@ -32,8 +33,17 @@ struct TileCacheEntry
 	~TileCacheEntry();
 
 	TileProcessor* processor;
+	// all tile parts of tile have been parsed (GRK_TILE_CACHE_LRU)
+	bool parsed;
+	// bytes of tile image held in LRU list
+	uint64_t bytes;
+	// position in LRU list, valid if bytes is non-zero
+	std::list<uint16_t>::iterator lruIter;
 };
 
+// default memory budget for GRK_TILE_CACHE_LRU strategy
+const uint64_t kDefaultTileCacheBudget = 256 * 1024 * 1024;
+
 class TileCache
 {
   public:
@@ -49,12 +59,41 @@ class TileCache
 	GrkImage* getComposite(void);
 	std::vector<GrkImage*> getAllImages(void);
 	std::vector<GrkImage*> getTileImages(void);
+	/**
+	 * Set memory budget for GRK_TILE_CACHE_LRU strategy
+	 *
+	 * @param budget budget in bytes; if zero, default budget is used
+	 */
+	void setBudget(uint64_t budget);
+	/**
+	 * Look up decompressed tile image, and record hit or miss.
+	 * A hit makes the tile the most recently used
+	 *
+	 * @param tileIndex tile index
+	 * @return tile image, or nullptr if tile needs to be decompressed
+	 */
+	GrkImage* lookup(uint16_t tileIndex);
+	/**
+	 * Add newly decompressed tile image to LRU list, then evict least recently used
+	 * tile images until cache is within budget
+	 *
+	 * @param tileIndex tile index
+	 */
+	void insert(uint16_t tileIndex);
+	void getStats(grk_tile_cache_stats* stats);
 
   private:
 	// each component is sub-sampled and resolution-reduced
 	GrkImage* tileComposite;
 	std::map<uint32_t, TileCacheEntry*> cache_;
 	GRK_TILE_CACHE_STRATEGY strategy_;
+	// most recently used tile at front
+	std::list<uint16_t> lru_;
+	uint64_t budget_;
+	uint64_t bytes_;
+	uint64_t numHits_;
+	uint64_t numMisses_;
+	uint64_t numEvictions_;
 };
 
 } // namespace grk
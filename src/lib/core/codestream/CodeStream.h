@@ -118,6 +118,7 @@ struct ICodeStreamDecompress
 	virtual bool readHeader(grk_header_info* header_info) = 0;
 	virtual GrkImage* getImage(uint16_t tileIndex) = 0;
 	virtual GrkImage* getImage(void) = 0;
+	virtual bool getTileCacheStats(grk_tile_cache_stats* stats) = 0;
 	virtual void init(grk_decompress_core_params* p_param) = 0;
 	virtual bool setDecompressRegion(grk_rect_single region) = 0;
 	virtual bool decompress(grk_plugin_tile* tile) = 0;
@@ -54,12 +54,16 @@ static j2k_prog_order j2k_prog_order_list[] = {{GRK_CPRL, "CPRL"}, {GRK_LRCP, "L
 											   {GRK_PCRL, "PCRL"}, {GRK_RLCP, "RLCP"},
 											   {GRK_RPCL, "RPCL"}, {(GRK_PROG_ORDER)-1, ""}};
 
-CodeStreamCompress::CodeStreamCompress(BufferedStream* stream) : CodeStream(stream)
+CodeStreamCompress::CodeStreamCompress(BufferedStream* stream)
+	: CodeStream(stream), pullSource_(nullptr)
 {
 	cp_.wholeTileDecompress_ = false;
 }
 
-CodeStreamCompress::~CodeStreamCompress() {}
+CodeStreamCompress::~CodeStreamCompress()
+{
+	delete pullSource_;
+}
 char* CodeStreamCompress::convertProgressionOrder(GRK_PROG_ORDER prg_order)
 {
 	j2k_prog_order* po;
@@ -151,8 +155,21 @@ bool CodeStreamCompress::init(grk_cparameters* parameters, GrkImage* image)
 			return false;
 		}
 	}
+	if(parameters->io_pull_callback)
+	{
+		pullSource_ =
+			new PullSource(parameters->io_pull_callback, parameters->io_pull_user_data,
+						   parameters->io_pull_bytes_per_sample, parameters->io_pull_interleaved);
+		if(!pullSource_->validate(image))
+			return false;
+	}
 	if(parameters->apply_icc_)
-		image->applyICC();
+	{
+		if(pullSource_)
+			Logger::logger_.warn("ICC profile cannot be applied to pulled samples");
+		else
+			image->applyICC();
+	}
 
 	// create private sanitized copy of image
 	headerImage_ = new GrkImage();
@@ -310,6 +327,8 @@ bool CodeStreamCompress::init(grk_cparameters* parameters, GrkImage* image)
 	cp_.coding_params_.enc_.writePLT = parameters->writePLT;
 	cp_.coding_params_.enc_.writeTLM = parameters->writeTLM;
 	cp_.coding_params_.enc_.rateControlAlgorithm = parameters->rateControlAlgorithm;
+	cp_.coding_params_.enc_.maxTilesInFlight_ = parameters->maxTilesInFlight;
+	cp_.coding_params_.enc_.pullSource_ = pullSource_;
 
 	/* tiles */
 	cp_.t_width = parameters->t_width;
@@ -615,7 +634,6 @@ bool CodeStreamCompress::init(grk_cparameters* parameters, GrkImage* image)
 }
 uint64_t CodeStreamCompress::compress(grk_plugin_tile* tile)
 {
-	MinHeapPtr<TileProcessor, uint16_t, MinHeapLocker> heap;
 	uint32_t numTiles = (uint32_t)cp_.t_grid_height * cp_.t_grid_width;
 	if(numTiles > maxNumTilesJ2K)
 	{
@@ -627,29 +645,75 @@ uint64_t CodeStreamCompress::compress(grk_plugin_tile* tile)
 	auto numRequiredThreads =
 		std::min<uint32_t>((uint32_t)ExecSingleton::get()->num_workers(), numTiles);
 	std::atomic<bool> success(true);
-	if(numRequiredThreads > 1)
-	{
-		tf::Executor exec(numRequiredThreads);
-		tf::Taskflow taskflow;
-		auto node = new tf::Task[numTiles];
-		for(uint64_t i = 0; i < numTiles; i++)
-			node[i] = taskflow.placeholder();
+	if(cp_.coding_params_.enc_.rateControlAlgorithm == GRK_RATE_CONTROL_PCRD_GLOBAL &&
+	   numTiles > 1)
+	{
+		success = compressGlobal(tile, numTiles);
+	}
+	else if(numRequiredThreads > 1)
+	{
+		// Tiles are compressed in parallel, and each tile is written (and freed)
+		// as soon as all preceding tiles have been written. The number of tiles in flight
+		// is bounded, so peak memory scales with the number of threads, not with the image
+		uint32_t maxInFlight = cp_.coding_params_.enc_.maxTilesInFlight_;
+		if(!maxInFlight)
+			maxInFlight = 2 * numRequiredThreads;
+		// shared with the tile tasks, which may still be unwinding after the last tile is
+		// reported as written
+		struct WriteState
+		{
+			MinHeapPtr<TileProcessor, uint16_t, MinHeapLocker> heap;
+			std::atomic<bool> success{true};
+			std::atomic<uint32_t> numTilesWritten{0};
+			std::mutex writeMutex;
+			std::mutex waitMutex;
+			std::condition_variable waitCondition;
+		};
+		auto state = std::make_shared<WriteState>();
+		auto executor = ExecSingleton::get();
 		for(uint16_t j = 0; j < numTiles; ++j)
 		{
+			ExecSingleton::waitUntil(
+				[&state, j, maxInFlight] {
+					return (uint32_t)j - state->numTilesWritten.load() < maxInFlight;
+				},
+				state->waitMutex, state->waitCondition);
 			uint16_t tileIndex = j;
-			node[j].work([this, tile, tileIndex, &heap, &success] {
-				if(success)
+			executor->silent_async([this, tile, tileIndex, state] {
+				auto tileProcessor = new TileProcessor(tileIndex, this, stream_, true, nullptr);
+				if(state->success)
 				{
-					auto tileProcessor = new TileProcessor(tileIndex, this, stream_, true, nullptr);
 					tileProcessor->current_plugin_tile = tile;
 					if(!tileProcessor->preCompressTile() || !tileProcessor->doCompress())
-						success = false;
-					heap.push(tileProcessor);
+						state->success = false;
+				}
+				state->heap.push(tileProcessor);
+				// write all tiles that are now next in line
+				uint32_t numWritten = 0;
+				{
+					std::unique_lock<std::mutex> lk(state->writeMutex);
+					auto completeTileProcessor = state->heap.pop();
+					while(completeTileProcessor)
+					{
+						if(state->success && !writeTileParts(completeTileProcessor))
+							state->success = false;
+						delete completeTileProcessor;
+						numWritten++;
+						completeTileProcessor = state->heap.pop();
+					}
+				}
+				if(numWritten)
+				{
+					std::unique_lock<std::mutex> lk(state->waitMutex);
+					state->numTilesWritten += numWritten;
+					state->waitCondition.notify_all();
 				}
 			});
 		}
-		exec.run(taskflow).wait();
-		delete[] node;
+		ExecSingleton::waitUntil(
+			[&state, numTiles] { return state->numTilesWritten.load() == numTiles; },
+			state->waitMutex, state->waitCondition);
+		success = state->success.load();
 	}
 	else
 	{
@@ -673,21 +737,49 @@ uint64_t CodeStreamCompress::compress(grk_plugin_tile* tile)
 		}
 	}
 cleanup:
-	auto completeTileProcessor = heap.pop();
-	while(completeTileProcessor)
+	if(success)
+		success = end();
+
+	return success ? stream_->tell() : 0;
+}
+bool CodeStreamCompress::compressGlobal(grk_plugin_tile* tile, uint32_t numTiles)
+{
+	// 1. T1 for all tiles
+	std::vector<TileProcessor*> tileProcessors(numTiles, nullptr);
+	std::atomic<bool> success(true);
+	tf::Taskflow taskflow;
+	for(uint16_t i = 0; i < numTiles; ++i)
 	{
-		if(success)
-		{
-			if(!writeTileParts(completeTileProcessor))
+		taskflow.emplace([this, tile, i, &tileProcessors, &success] {
+			auto tileProcessor = new TileProcessor(i, this, stream_, true, nullptr);
+			tileProcessors[i] = tileProcessor;
+			if(!success)
+				return;
+			tileProcessor->current_plugin_tile = tile;
+			if(!tileProcessor->preCompressTile() || !tileProcessor->compressT1())
 				success = false;
-		}
-		delete completeTileProcessor;
-		completeTileProcessor = heap.pop();
+		});
 	}
+	ExecSingleton::run(taskflow);
+	// 2. rate control over all tiles
 	if(success)
-		success = end();
+	{
+		GlobalRateAllocator allocator(tileProcessors);
+		if(!allocator.allocate())
+		{
+			Logger::logger_.error("Unable to perform image-wide rate control");
+			success = false;
+		}
+	}
+	// 3. write tiles in order
+	for(auto tileProcessor : tileProcessors)
+	{
+		if(success && !writeTileParts(tileProcessor))
+			success = false;
+		delete tileProcessor;
+	}
 
-	return success ? stream_->tell() : 0;
+	return success;
 }
 bool CodeStreamCompress::end(void)
 {
@@ -42,6 +42,11 @@ class CodeStreamCompress : public CodeStream, public ICodeStreamCompress
 	bool init_header_writing(void);
 	bool cacheEndOfHeader(void);
 	bool end(void);
+	/**
+	 * Compress all tiles up to and including T1, then perform
+	 * image-wide rate control before writing the tiles
+	 */
+	bool compressGlobal(grk_plugin_tile* tile, uint32_t numTiles);
 	bool writeTilePart(TileProcessor* tileProcessor);
 	bool writeTileParts(TileProcessor* tileProcessor);
 	bool updateRates(void);
@@ -312,6 +317,8 @@ class CodeStreamCompress : public CodeStream, public ICodeStreamCompress
 	bool init_mct_encoding(TileCodingParams* p_tcp, GrkImage* p_image);
 
 	CompressorState compressorState_;
+	// client source of uncompressed samples, if image data is pulled
+	PullSource* pullSource_;
 };
 
 } // namespace grk
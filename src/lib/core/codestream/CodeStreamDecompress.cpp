@@ -253,6 +253,25 @@ bool CodeStreamDecompress::setDecompressRegion(grk_rect_single region)
 		Logger::logger_.error("Need to read the main header before setting decompress region");
 		return false;
 	}
+	// with LRU tile cache, region may be changed after each decompression
+	if(outputImage_ && tileCache_->getStrategy() == GRK_TILE_CACHE_LRU)
+	{
+		auto decompressFormat = compositeImage->decompressFormat;
+		auto forceRGB = compositeImage->forceRGB;
+		auto upsample = compositeImage->upsample;
+		auto precision = compositeImage->precision;
+		auto numPrecision = compositeImage->numPrecision;
+		auto splitByComponent = compositeImage->splitByComponent;
+		image->copyHeader(compositeImage);
+		compositeImage->decompressFormat = decompressFormat;
+		compositeImage->forceRGB = forceRGB;
+		compositeImage->upsample = upsample;
+		compositeImage->precision = precision;
+		compositeImage->numPrecision = numPrecision;
+		compositeImage->splitByComponent = splitByComponent;
+		decompressor->tilesToDecompress_.scheduleAll();
+		cp_.wholeTileDecompress_ = true;
+	}
 
 	if(region != grk_rect_single(0, 0, 0, 0))
 	{
@@ -358,15 +377,27 @@ void CodeStreamDecompress::init(grk_decompress_core_params* parameters)
 	cp_.coding_params_.dec_.layers_to_decompress_ = parameters->layers_to_decompress_;
 	cp_.coding_params_.dec_.reduce_ = parameters->reduce;
 	cp_.coding_params_.dec_.randomAccessFlags_ = parameters->randomAccessFlags_;
+	cp_.coding_params_.dec_.waveletStrategy_ = parameters->waveletStrategy;
+	cp_.coding_params_.dec_.streamingDecompress_ = parameters->streamingDecompress;
 	tileCache_->setStrategy(parameters->tileCacheStrategy);
+	tileCache_->setBudget(parameters->tileCacheBudget);
 
 	ioBufferCallback = parameters->io_buffer_callback;
 	ioUserData = parameters->io_user_data;
 	grkRegisterReclaimCallback_ = parameters->io_register_client_callback;
 }
+bool CodeStreamDecompress::getTileCacheStats(grk_tile_cache_stats* stats)
+{
+	tileCache_->getStats(stats);
+
+	return true;
+}
 bool CodeStreamDecompress::decompress(grk_plugin_tile* tile)
 {
-	procedure_list_.push_back(std::bind(&CodeStreamDecompress::decompressTiles, this));
+	if(tileCache_->getStrategy() == GRK_TILE_CACHE_LRU)
+		procedure_list_.push_back(std::bind(&CodeStreamDecompress::decompressCachedTiles, this));
+	else
+		procedure_list_.push_back(std::bind(&CodeStreamDecompress::decompressTiles, this));
 	current_plugin_tile = tile;
 
 	return decompressExec();
@@ -374,8 +405,10 @@ bool CodeStreamDecompress::decompress(grk_plugin_tile* tile)
 bool CodeStreamDecompress::decompressTile(uint16_t tileIndex)
 {
 	// 1. check if tile has already been decompressed
+	// (LRU tile cache composites cached tile into output image)
+	bool lru = tileCache_->getStrategy() == GRK_TILE_CACHE_LRU;
 	auto entry = tileCache_->get(tileIndex);
-	if(entry && entry->processor && entry->processor->getImage())
+	if(!lru && entry && entry->processor && entry->processor->getImage())
 		return true;
 
 	// 2. otherwise, decompress tile
@@ -444,7 +477,10 @@ bool CodeStreamDecompress::decompressTile(uint16_t tileIndex)
 		cp_.tcps[i].tilePartCounter_ = 0;
 
 	/* customization of the decoding */
-	procedure_list_.push_back([this] { return decompressTile(); });
+	if(lru)
+		procedure_list_.push_back([this] { return decompressCachedTiles(); });
+	else
+		procedure_list_.push_back([this] { return decompressTile(); });
 
 	return decompressExec();
 }
@@ -483,12 +519,10 @@ bool CodeStreamDecompress::decompressTiles(void)
 	std::atomic<bool> success(true);
 	std::atomic<uint32_t> numTilesDecompressed(0);
 
-	tf::Executor* executor = nullptr;
 	tf::Task* node = nullptr;
 	tf::Taskflow taskflow;
 	if(numRequiredThreads > 1)
 	{
-		executor = new tf::Executor(numRequiredThreads);
 		node = new tf::Task[numTilesToDecompress];
 		for(uint64_t i = 0; i < numTilesToDecompress; i++)
 			node[i] = taskflow.placeholder();
@@ -541,7 +575,7 @@ bool CodeStreamDecompress::decompressTiles(void)
 		// 3. T2 + T1 decompress
 		// once we schedule a processor for T1 compression, we will destroy it
 		// regardless of success or not
-		auto exec = [this, executor, processor, numTilesToDecompress, &numTilesDecompressed,
+		auto exec = [this, node, processor, numTilesToDecompress, &numTilesDecompressed,
 					 &success] {
 			if(success)
 			{
@@ -559,12 +593,9 @@ bool CodeStreamDecompress::decompressTiles(void)
 					{
 						if(outputImage_->supportsStripCache(&cp_))
 						{
-							if(executor)
+							if(node)
 							{
-								uint32_t threadId = executor->num_workers() > 1
-														? (uint32_t)executor->this_worker_id()
-														: 0;
-								if(!stripCache_.ingestTile(threadId, img))
+								if(!stripCache_.ingestTile(ExecSingleton::threadId(), img))
 									success = false;
 							}
 							else
@@ -607,11 +638,9 @@ bool CodeStreamDecompress::decompressTiles(void)
 			break;
 		}
 	}
-	if(executor)
+	if(node)
 	{
-		executor->run(taskflow).wait();
-		delete executor;
-		executor = nullptr;
+		ExecSingleton::run(taskflow);
 		delete[] node;
 		node = nullptr;
 	}
@@ -632,14 +661,220 @@ bool CodeStreamDecompress::decompressTiles(void)
 							 numTilesToDecompress);
 	}
 cleanup:
-	if(executor)
+	if(node)
 	{
-		executor->run(taskflow).wait();
-		delete executor;
+		ExecSingleton::run(taskflow);
 		delete[] node;
 	}
 	return success;
 }
+bool CodeStreamDecompress::rewind(void)
+{
+	if(!codeStreamInfo || !stream_->seek(codeStreamInfo->getMainHeaderEnd() + MARKER_BYTES))
+		return false;
+	curr_marker_ = J2K_MS_SOT;
+	currentTileProcessor_ = nullptr;
+	decompressorState_.lastSotReadPosition = 0;
+	decompressorState_.lastTilePartInCodeStream = false;
+	if(cp_.tlm_markers)
+		cp_.tlm_markers->rewind();
+	uint16_t numTiles = (uint16_t)(cp_.t_grid_width * cp_.t_grid_height);
+	for(uint16_t i = 0; i < numTiles; ++i)
+		cp_.tcps[i].tilePartCounter_ = 0;
+	decompressorState_.tilesToDecompress_.clearComplete();
+	decompressorState_.setState(DECOMPRESS_STATE_TPH_SOT);
+
+	return true;
+}
+bool CodeStreamDecompress::parseScheduledTiles(std::vector<TileProcessor*>& processors)
+{
+	if(!rewind())
+	{
+		Logger::logger_.error("Unable to rewind to first tile part");
+		return false;
+	}
+	bool canDecompress = true;
+	while(!endOfCodeStream())
+	{
+		try
+		{
+			if(!parseTileParts(&canDecompress))
+				return false;
+		}
+		catch(const InvalidMarkerException& ime)
+		{
+			Logger::logger_.error("Found invalid marker : 0x%x", ime.marker_);
+			return false;
+		}
+		if(!canDecompress)
+			continue;
+		if(!currentTileProcessor_)
+		{
+			Logger::logger_.error("Missing SOT marker");
+			return false;
+		}
+		auto processor = currentTileProcessor_;
+		currentTileProcessor_ = nullptr;
+		processors.push_back(processor);
+		tileCache_->get(processor->getIndex())->parsed = true;
+		try
+		{
+			if(!endOfCodeStream() && !findNextSOT(processor))
+			{
+				Logger::logger_.error("Failed to find next SOT marker or EOC after tile %u",
+									  processor->getIndex());
+				return false;
+			}
+		}
+		catch([[maybe_unused]] const DecodeUnknownMarkerAtEndOfTileException& e)
+		{
+			break;
+		}
+		if(decompressorState_.tilesToDecompress_.allComplete())
+		{
+			// check for corrupt Adobe files where 5 tile parts per tile are signaled
+			// but there are actually 6
+			if(curr_marker_ == J2K_MS_SOT && checkForIllegalTilePart())
+				return false;
+			break;
+		}
+	}
+
+	return true;
+}
+bool CodeStreamDecompress::decompressCachedTiles(void)
+{
+	uint16_t numTiles = (uint16_t)(cp_.t_grid_height * cp_.t_grid_width);
+	if(codeStreamInfo && !codeStreamInfo->allocTileInfo(numTiles))
+	{
+		headerError_ = true;
+		return false;
+	}
+	// output image is composited from cached tile images, so it always owns its data
+	if(outputImage_)
+		grk_object_unref(&outputImage_->obj);
+	outputImage_ = new GrkImage();
+	auto compositeImage = getCompositeImage();
+	compositeImage->copyHeader(outputImage_);
+	for(uint16_t compno = 0; compno < outputImage_->numcomps; ++compno)
+	{
+		auto comp = outputImage_->comps + compno;
+		if(!GrkImage::allocData(comp, true))
+		{
+			Logger::logger_.error(
+				"Failed to allocate pixel data for component %u, with dimensions %u x %u", compno,
+				comp->w, comp->h);
+			return false;
+		}
+	}
+
+	// cached tile images always cover the whole tile
+	cp_.wholeTileDecompress_ = true;
+
+	// 1. look up scheduled tiles in cache
+	auto tiles = decompressorState_.tilesToDecompress_.getScheduled();
+	std::vector<uint16_t> unparsed;
+	std::vector<TileProcessor*> misses;
+	for(auto tileIndex : tiles)
+	{
+		if(tileCache_->lookup(tileIndex))
+			continue;
+		auto entry = tileCache_->get(tileIndex);
+		if(entry && entry->parsed)
+		{
+			// tile image was evicted: decompress again from cached tile data
+			if(!entry->processor->init())
+			{
+				Logger::logger_.error("Cannot decompress tile %u", tileIndex);
+				return false;
+			}
+			misses.push_back(entry->processor);
+		}
+		else
+		{
+			unparsed.push_back(tileIndex);
+		}
+	}
+
+	// 2. parse tiles that have not yet been parsed
+	if(!unparsed.empty())
+	{
+		decompressorState_.tilesToDecompress_.schedule(unparsed);
+		bool parsed = parseScheduledTiles(misses);
+		decompressorState_.tilesToDecompress_.schedule(tiles);
+		if(!parsed)
+			return false;
+	}
+
+	// 3. decompress misses in full, against image with full bounds
+	auto fullImage = new GrkImage();
+	compositeImage->copyHeader(fullImage);
+	fullImage->x0 = headerImage_->x0;
+	fullImage->y0 = headerImage_->y0;
+	fullImage->x1 = headerImage_->x1;
+	fullImage->y1 = headerImage_->y1;
+	for(uint16_t compno = 0; compno < fullImage->numcomps; ++compno)
+	{
+		auto comp = fullImage->comps + compno;
+		auto headerComp = headerImage_->comps + compno;
+		comp->x0 = headerComp->x0;
+		comp->y0 = headerComp->y0;
+		comp->w = headerComp->w;
+		comp->h = headerComp->h;
+	}
+	std::atomic<bool> success(true);
+	auto exec = [this, fullImage, numTiles, &success](TileProcessor* processor) {
+		if(!success)
+			return;
+		if(!processor->decompressT2T1(fullImage))
+		{
+			Logger::logger_.error("Failed to decompress tile %u/%u", processor->getIndex(),
+								  numTiles);
+			success = false;
+		}
+		processor->release(success ? GRK_TILE_CACHE_LRU : GRK_TILE_CACHE_NONE);
+	};
+	if(misses.size() > 1 && ExecSingleton::get()->num_workers() > 1)
+	{
+		tf::Taskflow taskflow;
+		for(auto processor : misses)
+			taskflow.emplace([&exec, processor] { exec(processor); });
+		ExecSingleton::run(taskflow);
+	}
+	else
+	{
+		for(auto processor : misses)
+			exec(processor);
+	}
+	grk_object_unref(&fullImage->obj);
+
+	// 4. composite tile images, then cache newly decompressed tile images
+	uint16_t numComposited = 0;
+	for(auto tileIndex : tiles)
+	{
+		auto img = getImage(tileIndex);
+		if(!img)
+			continue;
+		if(!outputImage_->composite(img))
+			success = false;
+		numComposited++;
+	}
+	for(auto processor : misses)
+		tileCache_->insert(processor->getIndex());
+	if(numComposited == 0)
+	{
+		Logger::logger_.error("No tiles were decompressed.");
+		success = false;
+	}
+	else if(numComposited < tiles.size())
+	{
+		Logger::logger_.warn("Only %u out of %u tiles were decompressed", numComposited,
+							 (uint16_t)tiles.size());
+	}
+
+	// ready for next decompress region
+	return rewind() && success;
+}
 bool CodeStreamDecompress::copy_default_tcp(void)
 {
 	for(uint16_t i = 0; i < cp_.t_grid_height * cp_.t_grid_width; ++i)
@@ -827,6 +1062,7 @@ bool CodeStreamDecompress::skipNonScheduledTLM(CodingParams* cp)
 		return false;
 
 	cp_.tlm_markers->seek(&decompressorState_.tilesToDecompress_, cp, stream_);
+	cp_.tlm_markers->readAhead(&decompressorState_.tilesToDecompress_, stream_);
 
 	return true;
 }
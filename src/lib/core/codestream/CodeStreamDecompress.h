@@ -46,6 +46,7 @@ class CodeStreamDecompress : public CodeStream, public ICodeStreamDecompress
 	bool readHeader(grk_header_info* header_info);
 	GrkImage* getImage(uint16_t tileIndex);
 	GrkImage* getImage(void);
+	bool getTileCacheStats(grk_tile_cache_stats* stats);
 	std::vector<GrkImage*> getAllImages(void);
 	void init(grk_decompress_core_params* p_param);
 	bool setDecompressRegion(grk_rect_single region);
@@ -100,6 +101,25 @@ class CodeStreamDecompress : public CodeStream, public ICodeStreamDecompress
 	bool hasTLM(void);
 	void nextTLM(void);
 	bool decompressTiles(void);
+	/**
+	 * Decompress scheduled tiles through LRU tile cache: cached tiles are composited
+	 * directly, and the rest are parsed if needed, then decompressed in full and cached
+	 */
+	bool decompressCachedTiles(void);
+	/**
+	 * Parse all tile parts of scheduled tiles, from first tile part in code stream
+	 *
+	 * @param processors parsed tile processors
+	 * @return true if successful
+	 */
+	bool parseScheduledTiles(std::vector<TileProcessor*>& processors);
+	/**
+	 * Position stream and decompressor state at first tile part, so that
+	 * tile parts can be parsed again
+	 *
+	 * @return true if successful
+	 */
+	bool rewind(void);
 	bool decompressValidation(void);
 	bool copy_default_tcp(void);
 	bool read_unk(void);
@@ -407,6 +407,7 @@ void CodeStreamDecompress::nextTLM(void)
 				// assert(false);
 			}
 		}
+		cp_.tlm_markers->readAhead(&decompressorState_.tilesToDecompress_, stream_);
 	}
 }
 
@@ -224,6 +224,10 @@ struct EncodingParams
 	bool writeTLM;
 	/* rate control algorithm */
 	uint32_t rateControlAlgorithm;
+	/* maximum number of tiles compressed but not yet written (0 for default) */
+	uint32_t maxTilesInFlight_;
+	/* client source of uncompressed samples, if image data is pulled */
+	PullSource* pullSource_;
 };
 
 struct DecodingParams
@@ -236,6 +240,12 @@ struct DecodingParams
 	uint16_t layers_to_decompress_;
 
 	uint32_t randomAccessFlags_;
+	/** inverse wavelet strategy for full tile decompression */
+	GRK_WAVELET_STRATEGY waveletStrategy_;
+	/** read packets and decompress resolutions concurrently */
+	bool streamingDecompress_;
+	/** T1 output of blocks from earlier decompressions of a growing code stream, if any */
+	DecodedBlockCache* decodedBlockCache_;
 };
 
 /**
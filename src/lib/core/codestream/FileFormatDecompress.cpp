@@ -103,6 +103,10 @@ GrkImage* FileFormatDecompress::getImage(void)
 {
 	return codeStream->getImage();
 }
+bool FileFormatDecompress::getTileCacheStats(grk_tile_cache_stats* stats)
+{
+	return codeStream->getTileCacheStats(stats);
+}
 grk_color* FileFormatDecompress::getColour(void)
 {
 	auto image = codeStream->getHeaderImage();
@@ -266,6 +270,10 @@ bool FileFormatDecompress::setDecompressRegion(grk_rect_single region)
 {
 	return codeStream->setDecompressRegion(region);
 }
+CodeStreamDecompress* FileFormatDecompress::getCodeStream(void)
+{
+	return codeStream;
+}
 /** Set up decompressor function handler */
 void FileFormatDecompress::init(grk_decompress_core_params* parameters)
 {
@@ -33,6 +33,7 @@ class FileFormatDecompress : public FileFormat, public ICodeStreamDecompress
 	bool readHeader(grk_header_info* header_info);
 	GrkImage* getImage(uint16_t tileIndex);
 	GrkImage* getImage(void);
+	bool getTileCacheStats(grk_tile_cache_stats* stats);
 	void init(grk_decompress_core_params* p_param);
 	bool setDecompressRegion(grk_rect_single region);
 	bool decompress(grk_plugin_tile* tile);
@@ -41,6 +42,7 @@ class FileFormatDecompress : public FileFormat, public ICodeStreamDecompress
 	bool postProcess(void);
 	bool preProcess(void);
 	void dump(uint32_t flag, FILE* outputFileStream);
+	CodeStreamDecompress* getCodeStream(void);
 
   private:
 	grk_color* getColour(void);
@@ -0,0 +1,166 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "grk_includes.h"
+
+namespace grk
+{
+// smallest prefix from which code stream format can be detected
+const size_t kProgressiveMinBytes = 12;
+
+ProgressiveDecompress::ProgressiveDecompress(void)
+	: stream_(nullptr), decompressor_(nullptr), decompressorLen_(0), decompressed_(false),
+	  hasHeaderInfo_(false), hasRegion_(false)
+{
+	memset(&params_, 0, sizeof(params_));
+	memset(&headerInfo_, 0, sizeof(headerInfo_));
+}
+ProgressiveDecompress::~ProgressiveDecompress()
+{
+	releaseDecompressor();
+}
+void ProgressiveDecompress::releaseDecompressor(void)
+{
+	delete decompressor_;
+	decompressor_ = nullptr;
+	grk_object_unref(stream_);
+	stream_ = nullptr;
+	decompressorLen_ = 0;
+	decompressed_ = false;
+}
+void ProgressiveDecompress::feed(const uint8_t* data, size_t len)
+{
+	data_.insert(data_.end(), data, data + len);
+}
+uint64_t ProgressiveDecompress::getNumBytes(void) const
+{
+	return data_.size();
+}
+DecodedBlockCache* ProgressiveDecompress::getDecodedBlockCache(void)
+{
+	return &blockCache_;
+}
+bool ProgressiveDecompress::refresh(bool forDecompress)
+{
+	if(decompressor_ && decompressorLen_ == data_.size() && !(forDecompress && decompressed_))
+		return true;
+	// previous decompressor, and its image, are kept until a new one is needed
+	releaseDecompressor();
+	if(data_.size() < kProgressiveMinBytes)
+		return false;
+	stream_ = create_mem_stream(data_.data(), data_.size(), false, true);
+	if(!stream_)
+		return false;
+	auto bstream = BufferedStream::getImpl(stream_);
+	auto format = bstream->getFormat();
+	if(format == GRK_CODEC_UNK)
+	{
+		Logger::logger_.error("Invalid codec format.");
+		releaseDecompressor();
+		return false;
+	}
+	CodeStreamDecompress* codeStream = nullptr;
+	if(format == GRK_CODEC_J2K)
+	{
+		codeStream = new CodeStreamDecompress(bstream);
+		decompressor_ = codeStream;
+	}
+	else
+	{
+		auto fileFormat = new FileFormatDecompress(bstream);
+		codeStream = fileFormat->getCodeStream();
+		decompressor_ = fileFormat;
+	}
+	decompressor_->init(&params_);
+	codeStream->getCodingParams()->coding_params_.dec_.decodedBlockCache_ = &blockCache_;
+	decompressorLen_ = data_.size();
+	// header may not have been fully received yet
+	if(!decompressor_->readHeader(hasHeaderInfo_ ? &headerInfo_ : nullptr) ||
+	   !decompressor_->preProcess() ||
+	   (hasRegion_ && !decompressor_->setDecompressRegion(region_)))
+	{
+		releaseDecompressor();
+		return false;
+	}
+
+	return true;
+}
+bool ProgressiveDecompress::readHeader(grk_header_info* header_info)
+{
+	if(header_info)
+	{
+		headerInfo_ = *header_info;
+		hasHeaderInfo_ = true;
+	}
+	if(!refresh(false))
+		return false;
+
+	return decompressor_->readHeader(header_info);
+}
+GrkImage* ProgressiveDecompress::getImage(uint16_t tileIndex)
+{
+	return decompressor_ ? decompressor_->getImage(tileIndex) : nullptr;
+}
+GrkImage* ProgressiveDecompress::getImage(void)
+{
+	return decompressor_ ? decompressor_->getImage() : nullptr;
+}
+bool ProgressiveDecompress::getTileCacheStats(grk_tile_cache_stats* stats)
+{
+	return decompressor_ && decompressor_->getTileCacheStats(stats);
+}
+void ProgressiveDecompress::init(grk_decompress_core_params* p_param)
+{
+	params_ = *p_param;
+}
+bool ProgressiveDecompress::setDecompressRegion(grk_rect_single region)
+{
+	region_ = region;
+	hasRegion_ = true;
+
+	return decompressor_ ? decompressor_->setDecompressRegion(region) : true;
+}
+bool ProgressiveDecompress::decompress(grk_plugin_tile* tile)
+{
+	if(!refresh(true))
+		return false;
+	decompressed_ = true;
+
+	return decompressor_->decompress(tile);
+}
+bool ProgressiveDecompress::decompressTile(uint16_t tileIndex)
+{
+	// decompressor can decompress several tiles, as long as no new bytes have arrived
+	if(!refresh(false))
+		return false;
+
+	return decompressor_->decompressTile(tileIndex);
+}
+bool ProgressiveDecompress::preProcess(void)
+{
+	return decompressor_ ? decompressor_->preProcess() : false;
+}
+bool ProgressiveDecompress::postProcess(void)
+{
+	return decompressor_ ? decompressor_->postProcess() : false;
+}
+void ProgressiveDecompress::dump(uint32_t flag, FILE* outputFileStream)
+{
+	if(decompressor_)
+		decompressor_->dump(flag, outputFileStream);
+}
+
+} // namespace grk
@@ -0,0 +1,82 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#pragma once
+
+#include <vector>
+
+namespace grk
+{
+/**
+ * Progressive decompression of a code stream that is received incrementally.
+ *
+ * Bytes are appended as they arrive. Each decompression reconstructs the image from all
+ * bytes received so far, tolerating a truncated final tile, and packets that are not yet
+ * complete are simply not decoded. T1 output of code blocks is kept across decompressions,
+ * so only code blocks that have received new data since the last decompression are decoded.
+ */
+class ProgressiveDecompress : public ICodeStreamDecompress
+{
+  public:
+	ProgressiveDecompress(void);
+	virtual ~ProgressiveDecompress();
+	/**
+	 * Append received bytes to code stream
+	 *
+	 * @param data bytes
+	 * @param len number of bytes
+	 */
+	void feed(const uint8_t* data, size_t len);
+	uint64_t getNumBytes(void) const;
+	DecodedBlockCache* getDecodedBlockCache(void);
+	bool readHeader(grk_header_info* header_info);
+	GrkImage* getImage(uint16_t tileIndex);
+	GrkImage* getImage(void);
+	bool getTileCacheStats(grk_tile_cache_stats* stats);
+	void init(grk_decompress_core_params* p_param);
+	bool setDecompressRegion(grk_rect_single region);
+	bool decompress(grk_plugin_tile* tile);
+	bool decompressTile(uint16_t tileIndex);
+	bool preProcess(void);
+	bool postProcess(void);
+	void dump(uint32_t flag, FILE* outputFileStream);
+
+  private:
+	/**
+	 * Create decompressor over all bytes received so far, unless current decompressor
+	 * is already up to date
+	 *
+	 * @param forDecompress true if decompressor will be used to decompress,
+	 * which can only happen once per decompressor
+	 * @return true if decompressor has read code stream header
+	 */
+	bool refresh(bool forDecompress);
+	void releaseDecompressor(void);
+
+	grk_decompress_core_params params_;
+	std::vector<uint8_t> data_;
+	grk_stream* stream_;
+	ICodeStreamDecompress* decompressor_;
+	// number of bytes that current decompressor was created over
+	size_t decompressorLen_;
+	bool decompressed_;
+	grk_header_info headerInfo_;
+	bool hasHeaderInfo_;
+	grk_rect_single region_;
+	bool hasRegion_;
+	DecodedBlockCache blockCache_;
+};
+
+} // namespace grk
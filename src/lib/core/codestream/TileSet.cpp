@@ -3,7 +3,7 @@
 namespace grk
 {
 
-TileSet::TileSet() : lastTileToDecompress_(0) {}
+TileSet::TileSet() : lastTileToDecompress_(0), numScheduledComplete_(0) {}
 uint16_t TileSet::numScheduled(void)
 {
 	return (uint16_t)tilesToDecompress_.size();
@@ -25,6 +25,7 @@ void TileSet::schedule(grk_rect16 tiles)
 			tilesToDecompress_.insert((uint16_t)(i + j * allTiles_.width()));
 	}
 	lastTileToDecompress_ = (uint16_t)((tiles.x1 - 1) + (tiles.y1 - 1) * allTiles_.width());
+	countComplete();
 }
 void TileSet::schedule(grk_pt16 tile)
 {
@@ -35,6 +36,31 @@ void TileSet::schedule(uint16_t tileIndex)
 	tilesToDecompress_.clear();
 	tilesToDecompress_.insert(tileIndex);
 	lastTileToDecompress_ = tileIndex;
+	countComplete();
+}
+void TileSet::schedule(const std::vector<uint16_t>& tiles)
+{
+	tilesToDecompress_.clear();
+	tilesToDecompress_.insert(tiles.begin(), tiles.end());
+	lastTileToDecompress_ = tilesToDecompress_.empty() ? 0 : *tilesToDecompress_.rbegin();
+	countComplete();
+}
+void TileSet::scheduleAll(void)
+{
+	schedule(allTiles_);
+}
+std::vector<uint16_t> TileSet::getScheduled(void)
+{
+	return std::vector<uint16_t>(tilesToDecompress_.begin(), tilesToDecompress_.end());
+}
+void TileSet::countComplete(void)
+{
+	numScheduledComplete_ = 0;
+	for(auto tileIndex : tilesToDecompress_)
+	{
+		if(tilesDecompressed_.contains(tileIndex))
+			numScheduledComplete_++;
+	}
 }
 bool TileSet::isScheduled(uint16_t tileIndex)
 {
@@ -60,7 +86,8 @@ void TileSet::setComplete(uint16_t tileIndex)
 {
 	if(isScheduled(tileIndex))
 	{
-		tilesDecompressed_.insert(tileIndex);
+		if(tilesDecompressed_.insert(tileIndex).second)
+			numScheduledComplete_++;
 		// Logger::logger_.info("Complete %d", tileIndex);
 		// if (allComplete())
 		//	Logger::logger_.info("Complete");
@@ -70,8 +97,13 @@ bool TileSet::isComplete(uint16_t tileIndex)
 {
 	return tilesDecompressed_.contains(tileIndex);
 }
+void TileSet::clearComplete(void)
+{
+	tilesDecompressed_.clear();
+	numScheduledComplete_ = 0;
+}
 bool TileSet::allComplete(void)
 {
-	return tilesDecompressed_.size() == tilesToDecompress_.size();
+	return numScheduledComplete_ == tilesToDecompress_.size();
 }
 } // namespace grk
@@ -15,20 +15,35 @@ class TileSet
 	void schedule(grk_rect16 tiles);
 	void schedule(grk_pt16 tile);
 	void schedule(uint16_t tileIndex);
+	void schedule(const std::vector<uint16_t>& tiles);
+	void scheduleAll(void);
+	std::vector<uint16_t> getScheduled(void);
 	bool isScheduled(uint16_t tileIndex);
 	bool isScheduled(grk_pt16 tile);
+	/**
+	 * Mark tile as complete i.e. all of its tile parts have been parsed
+	 *
+	 * @param tileIndex tile index
+	 */
 	void setComplete(uint16_t tileIndex);
 	bool isComplete(uint16_t tileIndex);
+	/**
+	 * Forget complete tiles, before tile parts are parsed again
+	 */
+	void clearComplete(void);
 	bool allComplete(void);
 	uint16_t getSingle(void);
 
   private:
 	uint16_t index(uint16_t x, uint16_t y);
 	uint16_t index(grk_pt16 tile);
+	void countComplete(void);
 	std::set<uint16_t> tilesToDecompress_;
 	std::set<uint16_t> tilesDecompressed_;
 	grk_rect16 allTiles_;
 	uint16_t lastTileToDecompress_;
+	// number of scheduled tiles that are complete
+	uint16_t numScheduledComplete_;
 };
 
 } // namespace grk
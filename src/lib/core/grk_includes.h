@@ -91,6 +91,8 @@
 #include "CodeStreamLimits.h"
 #include "geometry.h"
 #include "MemManager.h"
+#include "BlockArena.h"
+#include "DecodedBlockCache.h"
 #include "buffer.h"
 #include "minpf_plugin_manager.h"
 #include "plugin_interface.h"
@@ -104,6 +106,7 @@
 #include "GrkMatrix.h"
 #include "GrkImage.h"
 #include "StripCache.h"
+#include "PullSource.h"
 #include "grk_exceptions.h"
 #include "SparseBuffer.h"
 #include "BitIO.h"
@@ -122,6 +125,7 @@
 #include "FileFormat.h"
 #include "FileFormatCompress.h"
 #include "FileFormatDecompress.h"
+#include "ProgressiveDecompress.h"
 #include "BitIO.h"
 #include "TagTree.h"
 #include "t1_common.h"
@@ -133,6 +137,7 @@
 #include "Subband.h"
 #include "Resolution.h"
 #include "BlockExec.h"
+#include "PostT1DecompressFilters.h"
 #include "ImageComponentFlow.h"
 #include "Scheduler.h"
 #include "SparseCanvas.h"
@@ -153,6 +158,8 @@
 #include "plugin_bridge.h"
 #include "RateControl.h"
 #include "RateInfo.h"
+#include "RateEstimator.h"
+#include "GlobalRateAllocator.h"
 #include "T1Factory.h"
 #include "DecompressScheduler.h"
 #include "CompressScheduler.h"
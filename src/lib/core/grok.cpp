@@ -124,6 +124,11 @@ void GRK_CALLCONV grk_initialize(const char* pluginPath, uint32_t numthreads, bo
 	}
 }
 
+GRK_API void GRK_CALLCONV grk_set_executor(void* executor)
+{
+	ExecSingleton::setExternal((tf::Executor*)executor);
+}
+
 GRK_API void GRK_CALLCONV grk_deinitialize()
 {
 	grk_plugin_cleanup();
@@ -340,6 +345,8 @@ void GRK_CALLCONV grk_decompress_set_default_params(grk_decompress_parameters* p
 	auto core_params = &parameters->core;
 	memset(core_params, 0, sizeof(grk_decompress_core_params));
 	core_params->tileCacheStrategy = GRK_TILE_CACHE_NONE;
+	core_params->tileCacheBudget = 0;
+	core_params->waveletStrategy = GRK_WAVELET_AUTO;
 	core_params->randomAccessFlags_ =
 		GRK_RANDOM_ACCESS_TLM | GRK_RANDOM_ACCESS_PLM | GRK_RANDOM_ACCESS_PLT;
 }
@@ -373,6 +380,29 @@ grk_codec* GRK_CALLCONV grk_decompress_init(grk_stream_params* stream_params,
 
 	return codecWrapper;
 }
+grk_codec* GRK_CALLCONV grk_decompress_progressive_init(grk_decompress_core_params* core_params)
+{
+	if(!core_params)
+		return nullptr;
+	auto codec = new GrkCodec(nullptr);
+	codec->decompressor_ = new ProgressiveDecompress();
+	codec->decompressor_->init(core_params);
+
+	return &codec->obj;
+}
+bool GRK_CALLCONV grk_decompress_progressive_feed(grk_codec* codecWrapper, const uint8_t* data,
+												  size_t len)
+{
+	if(!codecWrapper || (!data && len))
+		return false;
+	auto codec = GrkCodec::getImpl(codecWrapper);
+	auto progressive = dynamic_cast<ProgressiveDecompress*>(codec->decompressor_);
+	if(!progressive)
+		return false;
+	progressive->feed(data, len);
+
+	return true;
+}
 bool GRK_CALLCONV grk_decompress_read_header(grk_codec* codecWrapper, grk_header_info* header_info)
 {
 	if(codecWrapper)
@@ -482,6 +512,16 @@ grk_image* GRK_CALLCONV grk_decompress_get_composited_image(grk_codec* codecWrap
 	return nullptr;
 }
 
+bool GRK_CALLCONV grk_decompress_get_tile_cache_stats(grk_codec* codecWrapper,
+													   grk_tile_cache_stats* stats)
+{
+	if(!codecWrapper || !stats)
+		return false;
+	auto codec = GrkCodec::getImpl(codecWrapper);
+
+	return codec->decompressor_ && codec->decompressor_->getTileCacheStats(stats);
+}
+
 /* COMPRESSION FUNCTIONS*/
 
 grk_codec* GRK_CALLCONV grk_compress_create(GRK_CODEC_FORMAT p_format, grk_stream* stream)
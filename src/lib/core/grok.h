@@ -212,11 +212,19 @@ typedef struct _grk_raw_cparameters
  * Rate control algorithms
 	GRK_RATE_CONTROL_BISECT: bisect with all truncation points
 	GRK_RATE_CONTROL_PCRD_OPT: bisect with only feasible truncation points
+	GRK_RATE_CONTROL_PCRD_INCREMENTAL: feasible truncation points, with thresholds
+	 taken from cumulative rate tables and confirmed by one or two T2 simulations
+	GRK_RATE_CONTROL_PCRD_GLOBAL: as GRK_RATE_CONTROL_PCRD_INCREMENTAL, but with a single
+	 threshold per layer shared by all tiles, so that the image-wide byte budget (or quality
+	 target) is met with minimum image-wide distortion. All tiles are held in memory until
+	 rate control is complete.
  */
 typedef enum _GRK_RATE_CONTROL_ALGORITHM
 {
 	GRK_RATE_CONTROL_BISECT,
-	GRK_RATE_CONTROL_PCRD_OPT
+	GRK_RATE_CONTROL_PCRD_OPT,
+	GRK_RATE_CONTROL_PCRD_INCREMENTAL,
+	GRK_RATE_CONTROL_PCRD_GLOBAL
 } GRK_RATE_CONTROL_ALGORITHM;
 
 /**
@@ -482,6 +490,35 @@ typedef void (*grk_io_register_reclaim_callback)(grk_io_init io_init,
 												 void* io_user_data, void* reclaim_user_data);
 typedef bool (*grk_io_pixels_callback)(uint32_t threadId, grk_io_buf buffer, void* user_data);
 
+/**
+ * Request for uncompressed samples, made by the compressor as tiles are compressed.
+ *
+ * Region is in component coordinates, relative to the component's top left hand corner.
+ * For interleaved input, one request covers all components.
+ */
+typedef struct _grk_io_pull_request
+{
+	/** component, or 0 for interleaved input */
+	uint16_t compno;
+	/** region: columns x0 to x1 - 1 and rows y0 to y1 - 1 */
+	uint32_t x0;
+	uint32_t y0;
+	uint32_t x1;
+	uint32_t y1;
+	/** buffer to fill, owned by compressor */
+	uint8_t* data;
+	/** distance in bytes between rows of buffer */
+	size_t stride;
+} grk_io_pull_request;
+
+/**
+ * Pull callback: fill request buffer with samples in native format.
+ * Calls are serialized, so callback need not be thread safe.
+ *
+ * @return true if successful
+ */
+typedef bool (*grk_io_pull_callback)(grk_io_pull_request* request, void* user_data);
+
 /**
  * read stream callback
  *
@@ -549,9 +586,28 @@ typedef struct _grk_stream_params
 typedef enum _GRK_TILE_CACHE_STRATEGY
 {
 	GRK_TILE_CACHE_NONE, /* no tile caching */
-	GRK_TILE_CACHE_IMAGE /* cache final tile image */
+	GRK_TILE_CACHE_IMAGE, /* cache final tile image */
+	GRK_TILE_CACHE_LRU /* cache final tile images, up to a memory budget */
 } GRK_TILE_CACHE_STRATEGY;
 
+/**
+ * Tile cache statistics
+ */
+typedef struct _grk_tile_cache_stats
+{
+	uint64_t hits; /* tiles served from cache */
+	uint64_t misses; /* tiles that had to be decompressed */
+	uint64_t evictions; /* tile images evicted to stay within budget */
+	uint64_t bytes; /* bytes of cached tile images */
+} grk_tile_cache_stats;
+
+typedef enum _GRK_WAVELET_STRATEGY
+{
+	GRK_WAVELET_AUTO, /* fused transform for resolutions that do not fit in cache */
+	GRK_WAVELET_TWO_PASS, /* full horizontal pass followed by full vertical pass */
+	GRK_WAVELET_FUSED /* fused line based transform, whenever resolution is large enough */
+} GRK_WAVELET_STRATEGY;
+
 /**
  * Core decompression parameters
  * */
@@ -573,6 +629,23 @@ typedef struct _grk_decompress_core_params
 	 */
 	uint16_t layers_to_decompress_;
 	GRK_TILE_CACHE_STRATEGY tileCacheStrategy;
+	/**
+	 Memory budget in bytes for GRK_TILE_CACHE_LRU strategy: when cached tile images
+	 exceed the budget, least recently used images are evicted. If zero, default budget is used
+	 */
+	uint64_t tileCacheBudget;
+	/**
+	 Inverse wavelet strategy for full tile decompression
+	 */
+	GRK_WAVELET_STRATEGY waveletStrategy;
+	/**
+	 Stream packets: when a tile has no PL markers, its blocks and wavelet are decompressed
+	 one resolution at a time, as soon as the resolution's packets have been read, rather than
+	 after all packets of the tile have been read. Only applies to multi-threaded, full tile
+	 decompression. All resolutions are reconstructed, so resolutions lost to truncation
+	 have no detail, rather than being dropped.
+	 */
+	bool streamingDecompress;
 
 	uint32_t randomAccessFlags_;
 
@@ -625,6 +698,8 @@ typedef struct _grk_decompress_params
 	on file format we are writing to
 	*****************************************************/
 	uint32_t compressionLevel;
+	/* write TIFF output as tiles following the JPEG 2000 tile grid, rather than as strips */
+	bool tiff_tiles;
 	/** Verbose mode */
 	bool verbose_;
 	int32_t deviceId;
@@ -828,6 +903,19 @@ GRK_API const char* GRK_CALLCONV grk_version(void);
  */
 GRK_API void GRK_CALLCONV grk_initialize(const char* pluginPath, uint32_t numthreads, bool verbose);
 
+/**
+ * Share an external executor with the library
+ *
+ * All tile-level and code-block-level work of every codec is scheduled on a single
+ * executor. By default, the library owns this executor; an application that already
+ * runs its own Taskflow executor can pass it here so that codecs and application
+ * tasks share the same worker threads. Must be called before any codec is created,
+ * and the executor must outlive all codecs.
+ *
+ * @param executor 	pointer to a tf::Executor, or nullptr to restore the library executor
+ */
+GRK_API void GRK_CALLCONV grk_set_executor(void* executor);
+
 /**
  * De-initialize library
  */
@@ -901,6 +989,36 @@ GRK_API void GRK_CALLCONV grk_decompress_set_default_params(grk_decompress_param
 GRK_API grk_codec* GRK_CALLCONV grk_decompress_init(grk_stream_params* stream_params,
 													grk_decompress_core_params* core_params);
 
+/**
+ * Initialize progressive decompressor, for a code stream that is received incrementally,
+ * for example over a slow network link.
+ *
+ * Bytes are passed to grk_decompress_progressive_feed as they arrive. The decompressor is
+ * then used like any other decompressor: grk_decompress_read_header succeeds once the
+ * headers have been received, and each call to grk_decompress or grk_decompress_tile
+ * reconstructs the image from all bytes received so far, at the quality and resolution
+ * that they support. Decoded code blocks are cached between calls, so only code blocks
+ * that have received new data are decoded again. Images returned by the decompressor
+ * remain valid until the next call to grk_decompress or grk_decompress_tile.
+ *
+ * @param params 	decompress core parameters
+ *
+ * @return grk_codec* if successful, otherwise NULL
+ */
+GRK_API grk_codec* GRK_CALLCONV grk_decompress_progressive_init(grk_decompress_core_params* params);
+
+/**
+ * Append received bytes to progressive decompressor's code stream
+ *
+ * @param codec 	progressive decompression codec
+ * @param data 		received bytes
+ * @param len 		number of received bytes
+ *
+ * @return true if successful
+ */
+GRK_API bool GRK_CALLCONV grk_decompress_progressive_feed(grk_codec* codec, const uint8_t* data,
+														  size_t len);
+
 /**
  * Decompress JPEG 2000 header
  *
@@ -932,6 +1050,21 @@ GRK_API grk_image* GRK_CALLCONV grk_decompress_get_tile_image(grk_codec* codec,
  */
 GRK_API grk_image* GRK_CALLCONV grk_decompress_get_composited_image(grk_codec* codec);
 
+/**
+ * Get tile cache statistics
+ *
+ * With GRK_TILE_CACHE_LRU strategy, decompress region may be changed with
+ * grk_decompress_set_window after each call to grk_decompress: tiles that are still
+ * cached are not decompressed again.
+ *
+ * @param	codec				decompression codec
+ * @param	stats				statistics
+ *
+ * @return true if successful
+ */
+GRK_API bool GRK_CALLCONV grk_decompress_get_tile_cache_stats(grk_codec* codec,
+															   grk_tile_cache_stats* stats);
+
 /**
  * Set the given area to be decompressed. This function should be called
  * right after grk_decompress_read_header is called, and before any tile header is read.
@@ -1097,6 +1230,19 @@ typedef struct _grk_cparameters
 	bool writeTLM;
 	bool verbose;
 	bool sharedMemoryInterface;
+	/* maximum number of tiles compressed but not yet written to the code stream.
+	 * Bounds peak memory for multi-tile compression; 0 selects twice the number of threads */
+	uint32_t maxTilesInFlight;
+	/* pull based input: if callback is set, image component data is ignored, and samples
+	 * are requested a strip of tile rows at a time as each tile is compressed, so peak
+	 * memory scales with the tiles in flight rather than with the image */
+	grk_io_pull_callback io_pull_callback;
+	void* io_pull_user_data;
+	/* bytes per pulled sample: 1 for 8 bit or 2 for 16 bit samples in native byte order,
+	 * signed if component is signed */
+	uint8_t io_pull_bytes_per_sample;
+	/* true if pulled samples are interleaved, otherwise each component is pulled separately */
+	bool io_pull_interleaved;
 } grk_cparameters;
 
 /**
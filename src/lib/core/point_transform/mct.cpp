@@ -30,6 +30,21 @@ namespace grk
 namespace HWY_NAMESPACE
 {
 	using namespace hwy::HWY_NAMESPACE;
+	/**
+	 * Signal that single component of single tile strip is complete.
+	 * Strip rows are converted to rows of the first component
+	 */
+	static void ingestStripComponent(const ScheduleInfo& info)
+	{
+		auto cache = info.stripCache_;
+		if(!cache->isInitialized() || cache->isMultiTile())
+			return;
+		uint32_t height =
+			info.tile->comps->getWindow()->getResWindowBufferHighestSimple().height_;
+		cache->ingestStripComponents(ExecSingleton::threadId(), info.tile,
+									 info.yBegin * info.subsampleY_,
+									 (std::min)(info.yEnd * info.subsampleY_, height), 1);
+	}
 	/**
 	 * Apply dc shift for irreversible decompressed image.
 	 * (assumes mono with no  MCT)
@@ -57,9 +72,7 @@ namespace HWY_NAMESPACE
 				auto ni = Clamp(NearestInt(Load(df, chan0 + j)) + vshift, vmin, vmax);
 				Store(ni, di, (int32_t*)(chan0 + j));
 			}
-			if(info.stripCache_->isInitialized() && !info.stripCache_->isMultiTile())
-				info.stripCache_->ingestStrip(ExecSingleton::threadId(), info.tile, info.yBegin,
-											  info.yEnd);
+			ingestStripComponent(info);
 		}
 	};
 
@@ -90,10 +103,74 @@ namespace HWY_NAMESPACE
 				auto ni = Clamp(Load(di, chan0 + j) + vshift, vmin, vmax);
 				Store(ni, di, chan0 + j);
 			}
-			if(info.stripCache_->isInitialized() && !info.stripCache_->isMultiTile())
-				info.stripCache_->ingestStrip(ExecSingleton::threadId(), info.tile, info.yBegin,
-											  info.yEnd);
+			ingestStripComponent(info);
+		}
+	};
+
+	/**
+	 * Strip destination for inverse MCT
+	 *
+	 * If strip cache holds packed unsigned 8 bit RGB, then MCT output is
+	 * interleaved directly into the strip buffer. Otherwise, the strip is
+	 * interleaved from the component planes once all components are complete.
+	 */
+	class MctStrip
+	{
+	  public:
+		explicit MctStrip(ScheduleInfo& info) : info_(info), buf_(nullptr), packedRowBytes_(0)
+		{
+			auto cache = info.stripCache_;
+			active_ = cache->isInitialized() && !cache->isMultiTile();
+			if(active_ && cache->isPackedRGB8() &&
+			   cache->getPackedRowBytes() ==
+				   3 * (uint64_t)info.tile->comps->getWindow()->getResWindowBufferHighestWidth())
+			{
+				buf_ = cache->getStripBuffer(ExecSingleton::threadId(), info.yBegin, info.yEnd);
+				packedRowBytes_ = cache->getPackedRowBytes();
+			}
+		}
+		/**
+		 * Get interleaved destination for row, or nullptr if there is none
+		 */
+		uint8_t* row(uint32_t y) const
+		{
+			return buf_ ? buf_ + (y - info_.yBegin) * packedRowBytes_ : nullptr;
+		}
+		template<class D>
+		void store(D di, Vec<D> r, Vec<D> g, Vec<D> b, uint8_t* dest, size_t count) const
+		{
+			const Rebind<uint8_t, D> du8;
+			auto r8 = DemoteTo(du8, r);
+			auto g8 = DemoteTo(du8, g);
+			auto b8 = DemoteTo(du8, b);
+			if(count == Lanes(di))
+			{
+				StoreInterleaved3(r8, g8, b8, du8, dest);
+			}
+			else
+			{
+				HWY_ALIGN uint8_t tmp[3 * HWY_MAX_BYTES / sizeof(int32_t)];
+				StoreInterleaved3(r8, g8, b8, du8, tmp);
+				memcpy(dest, tmp, 3 * count);
+			}
 		}
+		void finish(void) const
+		{
+			if(!active_)
+				return;
+			auto threadId = ExecSingleton::threadId();
+			if(buf_)
+				info_.stripCache_->serializeStrip(threadId, info_.yBegin, info_.yEnd);
+			else
+				info_.stripCache_->ingestStripComponents(threadId, info_.tile, info_.yBegin,
+														 info_.yEnd, 3);
+		}
+
+	  private:
+		ScheduleInfo& info_;
+		bool active_;
+		uint8_t* buf_;
+		uint64_t packedRowBytes_;
 	};
 
 	/**
@@ -104,10 +181,9 @@ namespace HWY_NAMESPACE
 	  public:
 		void transform(ScheduleInfo info)
 		{
-			auto highestResBufferStride =
-				info.tile->comps[info.compno].getWindow()->getResWindowBufferHighestStride();
-			auto index = (uint64_t)info.yBegin * highestResBufferStride;
-			auto chunkSize = (uint64_t)(info.yEnd - info.yBegin) * highestResBufferStride;
+			auto window = info.tile->comps[info.compno].getWindow();
+			auto stride = window->getResWindowBufferHighestStride();
+			size_t width = window->getResWindowBufferHighestWidth();
 			const std::vector<ShiftInfo>& shiftInfo = info.shiftInfo;
 			auto chan0 = info.tile->comps[0].getWindow()->getResWindowBufferHighestSimple().buf_;
 			auto chan1 = info.tile->comps[1].getWindow()->getResWindowBufferHighestSimple().buf_;
@@ -127,19 +203,29 @@ namespace HWY_NAMESPACE
 			auto maxg = Set(di, _max[1]);
 			auto maxb = Set(di, _max[2]);
 
-			size_t begin = index;
-			for(auto j = begin; j < begin + chunkSize; j += Lanes(di))
+			MctStrip strip(info);
+			const size_t N = Lanes(di);
+			for(uint32_t y = info.yBegin; y < info.yEnd; ++y)
 			{
-				auto y = Load(di, chan0 + j);
-				auto u = Load(di, chan1 + j);
-				auto v = Load(di, chan2 + j);
-				auto g = y - ShiftRight<2>(u + v);
-				auto r = v + g;
-				auto b = u + g;
-				Store(Clamp(r + vdcr, minr, maxr), di, chan0 + j);
-				Store(Clamp(g + vdcg, ming, maxg), di, chan1 + j);
-				Store(Clamp(b + vdcb, minb, maxb), di, chan2 + j);
+				auto dest = strip.row(y);
+				for(size_t x = 0; x < width; x += N)
+				{
+					auto j = (uint64_t)y * stride + x;
+					auto y0 = Load(di, chan0 + j);
+					auto u = Load(di, chan1 + j);
+					auto v = Load(di, chan2 + j);
+					auto g = y0 - ShiftRight<2>(u + v);
+					auto r = Clamp(v + g + vdcr, minr, maxr);
+					auto b = Clamp(u + g + vdcb, minb, maxb);
+					g = Clamp(g + vdcg, ming, maxg);
+					Store(r, di, chan0 + j);
+					Store(g, di, chan1 + j);
+					Store(b, di, chan2 + j);
+					if(dest)
+						strip.store(di, r, g, b, dest + 3 * x, (std::min)(N, width - x));
+				}
 			}
+			strip.finish();
 		}
 	};
 
@@ -151,10 +237,9 @@ namespace HWY_NAMESPACE
 	  public:
 		void transform(ScheduleInfo info)
 		{
-			auto highestResBufferStride =
-				info.tile->comps[info.compno].getWindow()->getResWindowBufferHighestStride();
-			auto index = (uint64_t)info.yBegin * highestResBufferStride;
-			auto chunkSize = (uint64_t)(info.yEnd - info.yBegin) * highestResBufferStride;
+			auto window = info.tile->comps[info.compno].getWindow();
+			auto stride = window->getResWindowBufferHighestStride();
+			size_t width = window->getResWindowBufferHighestWidth();
 			const std::vector<ShiftInfo>& shiftInfo = info.shiftInfo;
 			auto chan0 = info.tile->comps[0].getWindow()->getResWindowBufferHighestSimpleF().buf_;
 			auto chan1 = info.tile->comps[1].getWindow()->getResWindowBufferHighestSimpleF().buf_;
@@ -185,20 +270,32 @@ namespace HWY_NAMESPACE
 			auto vgv = Set(df, 0.71414f);
 			auto vbu = Set(df, 1.772f);
 
-			size_t begin = index;
-			for(auto j = begin; j < begin + chunkSize; j += Lanes(di))
+			MctStrip strip(info);
+			const size_t N = Lanes(di);
+			for(uint32_t y = info.yBegin; y < info.yEnd; ++y)
 			{
-				auto vy = Load(df, chan0 + j);
-				auto vu = Load(df, chan1 + j);
-				auto vv = Load(df, chan2 + j);
-				auto vr = vy + vv * vrv;
-				auto vg = vy - vu * vgu - vv * vgv;
-				auto vb = vy + vu * vbu;
-
-				Store(Clamp(NearestInt(vr) + vdcr, minr, maxr), di, c0 + j);
-				Store(Clamp(NearestInt(vg) + vdcg, ming, maxg), di, c1 + j);
-				Store(Clamp(NearestInt(vb) + vdcb, minb, maxb), di, c2 + j);
+				auto dest = strip.row(y);
+				for(size_t x = 0; x < width; x += N)
+				{
+					auto j = (uint64_t)y * stride + x;
+					auto vy = Load(df, chan0 + j);
+					auto vu = Load(df, chan1 + j);
+					auto vv = Load(df, chan2 + j);
+					auto vr = vy + vv * vrv;
+					auto vg = vy - vu * vgu - vv * vgv;
+					auto vb = vy + vu * vbu;
+
+					auto r = Clamp(NearestInt(vr) + vdcr, minr, maxr);
+					auto g = Clamp(NearestInt(vg) + vdcg, ming, maxg);
+					auto b = Clamp(NearestInt(vb) + vdcb, minb, maxb);
+					Store(r, di, c0 + j);
+					Store(g, di, c1 + j);
+					Store(b, di, c2 + j);
+					if(dest)
+						strip.store(di, r, g, b, dest + 3 * x, (std::min)(N, width - x));
+				}
 			}
+			strip.finish();
 		}
 	};
 
@@ -332,7 +429,7 @@ namespace HWY_NAMESPACE
 			}
 			if(tasks)
 			{
-				ExecSingleton::get()->run(taskflow).wait();
+				ExecSingleton::run(taskflow);
 				delete[] tasks;
 			}
 		}
@@ -399,6 +496,20 @@ HWY_EXPORT(hwy_decompress_dc_shift_rev);
 mct::mct(Tile* tile, GrkImage* image, TileCodingParams* tcp, StripCache* stripCache)
 	: tile_(tile), image_(image), tcp_(tcp), stripCache_(stripCache)
 {}
+/**
+ * Scale lines per task for vertically subsampled component, so that each
+ * task covers the same image rows, and hence the same strip, as the
+ * corresponding task for the first component
+ */
+void mct::setSubsampling(ScheduleInfo& info)
+{
+	uint32_t dy = image_->comps[info.compno].dy / image_->comps->dy;
+	if(dy > 1)
+	{
+		info.subsampleY_ = dy;
+		info.linesPerTask_ = (std::max)(info.linesPerTask_ / dy, 1U);
+	}
+}
 /***
  * decompress dc shift only - irreversible
  */
@@ -406,6 +517,7 @@ void mct::decompress_dc_shift_irrev(FlowComponent* flow, uint16_t compno)
 {
 	ScheduleInfo info(tile_, flow, stripCache_, image_->rowsPerTask);
 	info.compno = compno;
+	setSubsampling(info);
 	genShift(compno, 1, info.shiftInfo);
 	HWY_DYNAMIC_DISPATCH(hwy_decompress_dc_shift_irrev)(info);
 }
@@ -416,18 +528,17 @@ void mct::decompress_dc_shift_rev(FlowComponent* flow, uint16_t compno)
 {
 	ScheduleInfo info(tile_, flow, stripCache_, image_->rowsPerTask);
 	info.compno = compno;
+	setSubsampling(info);
 	genShift(compno, 1, info.shiftInfo);
 	HWY_DYNAMIC_DISPATCH(hwy_decompress_dc_shift_rev)(info);
 }
 
 /**
  * inverse irreversible MCT (with dc shift)
- * (vector routines are disabled)
  */
 void mct::decompress_irrev(FlowComponent* flow)
 {
 	ScheduleInfo info(tile_, flow, stripCache_, image_->rowsPerTask);
-	hwy::DisableTargets(uint32_t(~HWY_SCALAR));
 	genShift(1, info.shiftInfo);
 	HWY_DYNAMIC_DISPATCH(hwy_decompress_irrev)
 	(info);
@@ -37,7 +37,7 @@ struct ScheduleInfo
 {
 	ScheduleInfo(Tile* t, FlowComponent* flow, StripCache* stripCache, uint32_t linesPerTask)
 		: tile(t), compno(0), flow_(flow), linesPerTask_(linesPerTask), stripCache_(stripCache),
-		  yBegin(0), yEnd(0)
+		  yBegin(0), yEnd(0), subsampleY_(1)
 	{}
 	Tile* tile;
 	uint16_t compno;
@@ -47,6 +47,8 @@ struct ScheduleInfo
 	StripCache* stripCache_;
 	uint32_t yBegin;
 	uint32_t yEnd;
+	// vertical subsampling of component, relative to first component
+	uint32_t subsampleY_;
 };
 
 class mct
@@ -123,6 +125,7 @@ class mct
 	static void calculate_norms(double* pNorms, uint16_t nb_comps, float* pMatrix);
 
   private:
+	void setSubsampling(ScheduleInfo& info);
 	void genShift(uint16_t compno, int32_t sign, std::vector<ShiftInfo>& shiftInfo);
 	void genShift(int32_t sign, std::vector<ShiftInfo>& shiftInfo);
 
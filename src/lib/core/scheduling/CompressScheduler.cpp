@@ -133,7 +133,7 @@ void CompressScheduler::compress(std::vector<CompressBlockExec*>* blocks)
 			{}
 		});
 	}
-	ExecSingleton::get()->run(taskflow).wait();
+	ExecSingleton::run(taskflow);
 
 	delete[] node;
 	delete[] encodeBlocks;
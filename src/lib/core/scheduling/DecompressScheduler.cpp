@@ -36,10 +36,10 @@ void ResDecompressBlocks::release(void)
 }
 
 DecompressScheduler::DecompressScheduler(TileProcessor* tileProcessor, Tile* tile,
-										 TileCodingParams* tcp, uint8_t prec)
+										 TileCodingParams* tcp, uint8_t prec, bool pipelinePackets)
 	: Scheduler(tile), tileProcessor_(tileProcessor), tcp_(tcp), prec_(prec),
 	  numcomps_(tile->numcomps_), tileBlocks_(TileDecompressBlocks(numcomps_)),
-	  waveletReverse_(nullptr)
+	  waveletReverse_(nullptr), pipelinePackets_(pipelinePackets), packetStream_(nullptr)
 {
 	waveletReverse_ = new WaveletReverse*[numcomps_];
 	for(uint16_t compno = 0; compno < numcomps_; ++compno)
@@ -54,6 +54,19 @@ DecompressScheduler::~DecompressScheduler()
 		delete[] waveletReverse_;
 	}
 }
+void DecompressScheduler::setPacketStream(T2Decompress* t2,
+										  std::vector<std::vector<uint64_t>>&& resPacketEnd)
+{
+	packetStream_ = t2;
+	resPacketEnd_ = std::move(resPacketEnd);
+}
+void DecompressScheduler::sequencePacketStream(void)
+{
+	std::stable_sort(packetStreamFlows_.begin(), packetStreamFlows_.end(),
+					 [](const auto& a, const auto& b) { return a.first < b.first; });
+	for(size_t i = 1; i < packetStreamFlows_.size(); ++i)
+		packetStreamFlows_[i - 1].second->precede(packetStreamFlows_[i].second);
+}
 bool DecompressScheduler::schedule(uint16_t compno)
 {
 	auto tilec = tile_->comps + compno;
@@ -94,9 +107,13 @@ bool DecompressScheduler::scheduleBlocks(uint16_t compno)
 	auto tccp = tcp_->tccps + compno;
 	auto tilec = tile_->comps + compno;
 	bool wholeTileDecoding = tilec->isWholeTileDecoding();
+	auto decodedBlockCache = tileProcessor_->cp_->coding_params_.dec_.decodedBlockCache_;
+	// block flow holding each resolution's blocks
+	uint8_t resBlockFlow[GRK_J2K_MAXRLVLS];
 	uint8_t resno = 0;
 	for(; resno <= tilec->highestResolutionDecompressed; ++resno)
 	{
+		resBlockFlow[resno] = (uint8_t)blocks.size();
 		auto res = tilec->resolutions_ + resno;
 		for(uint8_t bandIndex = 0; bandIndex < res->numTileBandWindows; ++bandIndex)
 		{
@@ -126,8 +143,10 @@ bool DecompressScheduler::scheduleBlocks(uint16_t compno)
 						block->resno = resno;
 						block->roishift = tccp->roishift;
 						block->stepsize = band->stepsize;
-						block->k_msbs = (uint8_t)(band->numbps - cblk->numbps);
 						block->R_b = prec_ + gain_b[band->orientation];
+						block->tileIndex = tileProcessor_->getIndex();
+						block->compno = compno;
+						block->decodedBlockCache = decodedBlockCache;
 						resBlocks.blocks_.push_back(block);
 					}
 				}
@@ -208,6 +227,47 @@ bool DecompressScheduler::scheduleBlocks(uint16_t compno)
 		}
 		resFlowNum++;
 	}
+	// packet headers of each precinct are parsed by a task that precedes its resolution's
+	// blocks, so T1 on lower resolutions overlaps with parsing higher resolutions
+	if(pipelinePackets_)
+	{
+		auto imageFlow = imageComponentFlows_[compno];
+		for(resno = 0; resno <= tilec->highestResolutionDecompressed; ++resno)
+		{
+			auto resFlow = imageFlow->getResFlow(
+				std::min<uint8_t>(resBlockFlow[resno], (uint8_t)(imageFlow->numResFlows_ - 1)));
+			auto res = tilec->resolutions_ + resno;
+			for(const auto& pp : res->parserMap_->precinctParsers_)
+			{
+				auto parsers = pp.second;
+				resFlow->getPacketsFlow()->nextTask().work([parsers] { parsers->readPackets(); });
+			}
+		}
+	}
+	// each resolution flow reads packets up to its last packet, continuing from
+	// where the preceding packets task stopped
+	if(packetStream_)
+	{
+		auto imageFlow = imageComponentFlows_[compno];
+		std::vector<uint64_t> flowPacketEnd(imageFlow->numResFlows_, 0);
+		for(resno = 0; resno <= tilec->highestResolutionDecompressed; ++resno)
+		{
+			auto flowno =
+				std::min<uint8_t>(resBlockFlow[resno], (uint8_t)(imageFlow->numResFlows_ - 1));
+			flowPacketEnd[flowno] = std::max(flowPacketEnd[flowno], resPacketEnd_[compno][resno]);
+		}
+		for(uint8_t flowno = 0; flowno < imageFlow->numResFlows_; ++flowno)
+		{
+			auto packets = imageFlow->getResFlow(flowno)->getPacketsFlow();
+			auto t2 = packetStream_;
+			auto packetEnd = flowPacketEnd[flowno];
+			packets->nextTask().work([this, t2, packetEnd] {
+				if(!t2->streamPackets(packetEnd))
+					success = false;
+			});
+			packetStreamFlows_.push_back(std::make_pair(packetEnd, packets));
+		}
+	}
 	auto& componentBlocks = tileBlocks_[compno];
 	for(auto rb : blocks)
 		componentBlocks.push_back(rb);
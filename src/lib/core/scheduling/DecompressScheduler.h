@@ -37,11 +37,29 @@ typedef std::vector<ComponentDecompressBlocks> TileDecompressBlocks;
 class DecompressScheduler : public Scheduler
 {
   public:
+	/**
+	 * @param pipelinePackets if true, deferred packet parsers of each resolution are
+	 * scheduled ahead of that resolution's blocks, rather than run before scheduling
+	 */
 	DecompressScheduler(TileProcessor* tileProcessor, Tile* tile, TileCodingParams* tcp,
-						uint8_t prec);
+						uint8_t prec, bool pipelinePackets);
 	~DecompressScheduler();
 
 	bool schedule(uint16_t compno) override;
+	/**
+	 * Stream packets: each resolution flow gets a packets task that reads tile packets
+	 * up to and including the last packet of its resolutions, so that its blocks are
+	 * decompressed while later packets are still being read. Must be called before scheduling.
+	 *
+	 * @param t2 T2 prepared with T2Decompress::beginStreaming
+	 * @param resPacketEnd packet end for each component and resolution, from beginStreaming
+	 */
+	void setPacketStream(T2Decompress* t2, std::vector<std::vector<uint64_t>>&& resPacketEnd);
+	/**
+	 * Chain packets tasks of all components in code stream order, as packets
+	 * are read sequentially. Must be called once all components are scheduled.
+	 */
+	void sequencePacketStream(void);
 
   private:
 	bool scheduleBlocks(uint16_t compno);
@@ -54,6 +72,11 @@ class DecompressScheduler : public Scheduler
 	uint16_t numcomps_;
 	TileDecompressBlocks tileBlocks_;
 	WaveletReverse** waveletReverse_;
+	bool pipelinePackets_;
+	T2Decompress* packetStream_;
+	std::vector<std::vector<uint64_t>> resPacketEnd_;
+	// packets task of each streamed resolution flow, with its packet end
+	std::vector<std::pair<uint64_t, FlowComponent*>> packetStreamFlows_;
 };
 
 } // namespace grk
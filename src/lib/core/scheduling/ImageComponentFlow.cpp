@@ -25,10 +25,7 @@ ResFlow::ResFlow(void)
 FlowComponent* ResFlow::getPacketsFlow(void)
 {
 	if(!packets_)
-	{
 		packets_ = new FlowComponent();
-		packets_->precede(blocks_);
-	}
 
 	return packets_;
 }
@@ -38,6 +35,8 @@ void ResFlow::disableWavelet(void)
 }
 void ResFlow::graph(void)
 {
+	if(packets_)
+		packets_->precede(blocks_);
 	if(doWavelet_)
 	{
 		blocks_->precede(waveletHoriz_);
@@ -34,6 +34,9 @@ class ExecSingleton
   public:
 	static tf::Executor* instance(uint32_t numthreads)
 	{
+		auto external = external_.load(std::memory_order_acquire);
+		if(external)
+			return external;
 		static tf::Executor singleton(numthreads ? numthreads
 												 : std::thread::hardware_concurrency());
 
@@ -43,12 +46,64 @@ class ExecSingleton
 	{
 		return instance(0);
 	}
+	/**
+	 * Route all library work through an executor owned by the caller.
+	 * Passing nullptr restores the library's own executor.
+	 * The executor must outlive every codec that uses it.
+	 */
+	static void setExternal(tf::Executor* executor)
+	{
+		external_.store(executor, std::memory_order_release);
+	}
 	static void release()
 	{
-		get()->shutdown();
+		// an external executor is owned (and shut down) by the caller
+		if(!external_.load(std::memory_order_acquire))
+			get()->shutdown();
 	}
 	static uint32_t threadId(void)
 	{
-		return get()->num_workers() > 1 ? (uint32_t)ExecSingleton::get()->this_worker_id() : 0;
+		if(get()->num_workers() == 1)
+			return 0;
+		int id = get()->this_worker_id();
+
+		return id < 0 ? 0 : (uint32_t)id;
+	}
+	/**
+	 * Run a taskflow to completion. When called from one of the executor's own workers,
+	 * the worker keeps stealing tasks while it waits (co-run) instead of blocking,
+	 * so tile-level tasks can nest block-level taskflows without deadlock or
+	 * spawning extra threads.
+	 */
+	static void run(tf::Taskflow& taskflow)
+	{
+		auto executor = get();
+		if(executor->this_worker_id() >= 0)
+			executor->run_and_wait(taskflow);
+		else
+			executor->run(taskflow).wait();
 	}
+
+	/**
+	 * Wait until a predicate holds. A worker of the executor keeps executing
+	 * other tasks while it waits; any other thread sleeps on the condition variable,
+	 * which must be notified (under the mutex) whenever the predicate may have changed.
+	 */
+	template<typename P>
+	static void waitUntil(P&& predicate, std::mutex& mutex, std::condition_variable& cv)
+	{
+		auto executor = get();
+		if(executor->this_worker_id() >= 0)
+		{
+			executor->loop_until(predicate);
+		}
+		else
+		{
+			std::unique_lock<std::mutex> lk(mutex);
+			cv.wait(lk, predicate);
+		}
+	}
+
+  private:
+	static inline std::atomic<tf::Executor*> external_{nullptr};
 };
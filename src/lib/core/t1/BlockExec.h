@@ -43,15 +43,26 @@ struct BlockExec
 };
 struct DecompressBlockExec : public BlockExec
 {
-	DecompressBlockExec() : cblk(nullptr), resno(0), roishift(0) {}
+	DecompressBlockExec()
+		: cblk(nullptr), resno(0), roishift(0), tileIndex(0), compno(0), decodedBlockCache(nullptr)
+	{}
 	bool open(T1Interface* t1)
 	{
+		// block bit planes are only known once packet headers have been read,
+		// which may happen after the block was scheduled
+		k_msbs = (uint8_t)(bandNumbps - cblk->numbps);
+		if(decodedBlockCache && decodedBlockCache->restore(this))
+			return true;
 		return t1->decompress(this);
 	}
 	void close(void) {}
 	DecompressCodeblock* cblk;
 	uint8_t resno;
 	uint8_t roishift;
+	uint16_t tileIndex;
+	uint16_t compno;
+	// T1 output of blocks from previous decompressions, if any
+	DecodedBlockCache* decodedBlockCache;
 };
 struct CompressBlockExec : public BlockExec
 {
@@ -62,10 +62,11 @@ struct Layer
 };
 
 // note: block lives in canvas coordinates
+// note: block and its arrays are allocated from the tile's block arena
 struct Codeblock : public grk_buf2d<int32_t, AllocatorAligned>, public ICacheable
 {
-	Codeblock(uint16_t numLayers)
-		: numbps(0), numlenbits(0), numPassesInPacket(nullptr), numlayers_(numLayers)
+	Codeblock(uint16_t numLayers, BlockArena* arena)
+		: numbps(0), numlenbits(0), numPassesInPacket(nullptr), numlayers_(numLayers), arena_(arena)
 #ifdef DEBUG_LOSSLESS_T2
 		  ,
 		  included(false)
@@ -74,13 +75,11 @@ struct Codeblock : public grk_buf2d<int32_t, AllocatorAligned>, public ICacheabl
 	virtual ~Codeblock()
 	{
 		compressedStream.dealloc();
-		delete[] numPassesInPacket;
 	}
 	void init(void)
 	{
 		assert(!numPassesInPacket);
-		numPassesInPacket = new uint8_t[numlayers_];
-		memset(numPassesInPacket, 0, numlayers_);
+		numPassesInPacket = arena_->createArray<uint8_t>(numlayers_);
 	}
 	void setRect(grk_rect32 r)
 	{
@@ -108,6 +107,7 @@ struct Codeblock : public grk_buf2d<int32_t, AllocatorAligned>, public ICacheabl
   protected:
 	uint8_t* numPassesInPacket;
 	uint16_t numlayers_;
+	BlockArena* arena_;
 #ifdef DEBUG_LOSSLESS_T2
 	uint32_t included;
 	std::vector<PacketLengthInfo> packet_length_info;
@@ -120,26 +120,22 @@ struct Codeblock : public grk_buf2d<int32_t, AllocatorAligned>, public ICacheabl
 
 struct CompressCodeblock : public Codeblock
 {
-	CompressCodeblock(uint16_t numLayers)
-		: Codeblock(numLayers), paddedCompressedStream(nullptr), layers(nullptr), passes(nullptr),
-		  numPassesInPreviousPackets(0), numPassesTotal(0)
+	CompressCodeblock(uint16_t numLayers, BlockArena* arena)
+		: Codeblock(numLayers, arena), paddedCompressedStream(nullptr), layers(nullptr),
+		  passes(nullptr), numPassesInPreviousPackets(0), numPassesTotal(0)
 #ifdef PLUGIN_DEBUG_ENCODE
 		  ,
 		  contextStream(nullptr)
 #endif
 	{}
-	virtual ~CompressCodeblock()
-	{
-		delete[] layers;
-		delete[] passes;
-	}
+	virtual ~CompressCodeblock() = default;
 	void init()
 	{
 		Codeblock::init();
 		if(!layers)
-			layers = new Layer[numlayers_];
+			layers = arena_->createArray<Layer>(numlayers_);
 		if(!passes)
-			passes = new CodePass[3 * 32 - 2];
+			passes = arena_->createArray<CodePass>(3 * 32 - 2);
 	}
 	/**
 	 * Allocates data memory for an compressing code block.
@@ -153,14 +149,15 @@ struct CompressCodeblock : public Codeblock
 		// we add two fake zero bytes at beginning of buffer, so that mq coder
 		// can be initialized to data[-1] == actualData[1], and still point
 		// to a valid memory location
-		auto buf = new uint8_t[desired_data_size + grk_cblk_enc_compressed_data_pad_left];
+		auto buf =
+			(uint8_t*)arena_->alloc(desired_data_size + grk_cblk_enc_compressed_data_pad_left);
 		buf[0] = 0;
 		buf[1] = 0;
 
 		paddedCompressedStream = buf + grk_cblk_enc_compressed_data_pad_left;
 		compressedStream.buf = buf;
 		compressedStream.len = desired_data_size;
-		compressedStream.owns_data = true;
+		compressedStream.owns_data = false;
 
 		return true;
 	}
@@ -176,8 +173,9 @@ struct CompressCodeblock : public Codeblock
 
 struct DecompressCodeblock : public Codeblock
 {
-	DecompressCodeblock(uint16_t numLayers)
-		: Codeblock(numLayers), segs(nullptr), numSegments(0),
+	DecompressCodeblock(uint16_t numLayers, BlockArena* arena)
+		: Codeblock(numLayers, arena), seg_buffers(BlockArenaAllocator<grk_buf8*>(arena)),
+		  segs(nullptr), numSegments(0),
 #ifdef DEBUG_LOSSLESS_T2
 		  included(0),
 #endif
@@ -192,16 +190,15 @@ struct DecompressCodeblock : public Codeblock
 		if(!segs)
 		{
 			numSegmentsAllocated = 1;
-			segs = new Segment[numSegmentsAllocated];
-			numSegmentsAllocated = 1;
+			segs = arena_->createArray<Segment>(numSegmentsAllocated);
 		}
 		else if(numSegmentsAllocated > 0 && segmentIndex >= numSegmentsAllocated)
 		{
-			auto new_segs = new Segment[2 * numSegmentsAllocated];
+			// old array is reclaimed with the arena
+			auto new_segs = arena_->createArray<Segment>(2 * numSegmentsAllocated);
 			for(uint32_t i = 0; i < numSegmentsAllocated; ++i)
 				new_segs[i] = segs[i];
 			numSegmentsAllocated *= 2;
-			delete[] segs;
 			segs = new_segs;
 		}
 
@@ -220,10 +217,20 @@ struct DecompressCodeblock : public Codeblock
 		numSegments++;
 		return getCurrentSegment();
 	}
+	/**
+	 * Add buffer for segment bytes contributed by current packet
+	 *
+	 * @param buf segment bytes, not owned by block
+	 * @param len number of bytes
+	 */
+	void addSegBuffer(uint8_t* buf, size_t len)
+	{
+		seg_buffers.push_back(arena_->create<grk_buf8>(buf, len, false));
+	}
 	void cleanUpSegBuffers()
 	{
 		for(auto& b : seg_buffers)
-			delete b;
+			b->~grk_buf8();
 		seg_buffers.clear();
 		numSegments = 0;
 	}
@@ -232,6 +239,26 @@ struct DecompressCodeblock : public Codeblock
 		return std::accumulate(seg_buffers.begin(), seg_buffers.end(), (size_t)0,
 							   [](const size_t s, grk_buf8* a) { return (s + a->len); });
 	}
+	/**
+	 * Get compressed data, if segment buffers are adjacent in memory,
+	 * as is the case when code block is stored in a single packet
+	 *
+	 * @return pointer to compressed data, or nullptr if buffers are not adjacent
+	 */
+	uint8_t* getContiguousSegBuffer(void)
+	{
+		if(seg_buffers.empty())
+			return nullptr;
+		auto next = seg_buffers.front()->buf;
+		for(auto& b : seg_buffers)
+		{
+			if(b->buf != next)
+				return nullptr;
+			next = b->buf + b->len;
+		}
+
+		return seg_buffers.front()->buf;
+	}
 	bool copyToContiguousBuffer(uint8_t* buffer)
 	{
 		if(!buffer)
@@ -250,11 +277,10 @@ struct DecompressCodeblock : public Codeblock
 	void release(void)
 	{
 		cleanUpSegBuffers();
-		delete[] segs;
 		segs = nullptr;
 		grk_buf2d::dealloc();
 	}
-	std::vector<grk_buf8*> seg_buffers;
+	std::vector<grk_buf8*, BlockArenaAllocator<grk_buf8*>> seg_buffers;
 
   private:
 	Segment* segs; /* information on segments */
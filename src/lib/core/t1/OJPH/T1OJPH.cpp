@@ -22,17 +22,131 @@
 #include "T1OJPH.h"
 
 #include "grk_includes.h"
+#include <hwy/targets.h>
 
-const uint8_t grk_cblk_dec_compressed_data_pad_ht = 8;
+#undef HWY_TARGET_INCLUDE
+#define HWY_TARGET_INCLUDE "t1/OJPH/T1OJPH.cpp"
+#include <hwy/foreach_target.h>
+#include <hwy/highway.h>
+HWY_BEFORE_NAMESPACE();
+namespace ojph
+{
+namespace HWY_NAMESPACE
+{
+	using namespace hwy::HWY_NAMESPACE;
+	/**
+	 * Convert reversible code block samples to sign-magnitude,
+	 * with magnitude shifted up to bit 30
+	 */
+	static void hwy_quantize_rev(const int32_t* src, uint32_t srcStride, int32_t* dest, uint32_t w,
+								 uint32_t h, int32_t shift)
+	{
+		const HWY_FULL(int32_t) di;
+		const uint32_t N = (uint32_t)Lanes(di);
+		const auto signMask = Set(di, INT32_MIN);
+		for(uint32_t j = 0; j < h; ++j)
+		{
+			uint32_t i = 0;
+			for(; i + N <= w; i += N)
+			{
+				auto v = LoadU(di, src + i);
+				StoreU(Or(And(v, signMask), ShiftLeftSame(Abs(v), shift)), di, dest + i);
+			}
+			for(; i < w; ++i)
+			{
+				int32_t temp = src[i];
+				int32_t val = temp >= 0 ? temp : -temp;
+				int32_t sign = (int32_t)((temp >= 0) ? 0U : 0x80000000);
+				dest[i] = sign | (val << shift);
+			}
+			src += srcStride;
+			dest += w;
+		}
+	}
+	/**
+	 * Quantize irreversible code block samples and convert to sign-magnitude.
+	 * Multiplications are performed in the same order as the scalar tail,
+	 * so that results are identical
+	 */
+	static void hwy_quantize_irrev(const float* src, uint32_t srcStride, int32_t* dest, uint32_t w,
+								   uint32_t h, float invStep, int32_t shift)
+	{
+		const HWY_FULL(float) df;
+		const HWY_FULL(int32_t) di;
+		const uint32_t N = (uint32_t)Lanes(di);
+		const float scale = (float)(1 << shift);
+		const auto vInvStep = Set(df, invStep);
+		const auto vScale = Set(df, scale);
+		const auto signMask = Set(di, INT32_MIN);
+		for(uint32_t j = 0; j < h; ++j)
+		{
+			uint32_t i = 0;
+			for(; i + N <= w; i += N)
+			{
+				auto t = ConvertTo(di, Mul(Mul(LoadU(df, src + i), vInvStep), vScale));
+				StoreU(Or(And(t, signMask), Abs(t)), di, dest + i);
+			}
+			for(; i < w; ++i)
+			{
+				int32_t t = (int32_t)(src[i] * invStep * scale);
+				int32_t val = t >= 0 ? t : -t;
+				int32_t sign = t >= 0 ? 0 : (int32_t)0x80000000;
+				dest[i] = sign | val;
+			}
+			src += srcStride;
+			dest += w;
+		}
+	}
+} // namespace HWY_NAMESPACE
+} // namespace ojph
+HWY_AFTER_NAMESPACE();
+
+#if HWY_ONCE
+
+// SIMD decoders may read up to 16 bytes past the end of the MagSgn segment
+const uint8_t grk_cblk_dec_compressed_data_pad_ht = 16;
 
 namespace ojph
 {
+HWY_EXPORT(hwy_quantize_rev);
+HWY_EXPORT(hwy_quantize_irrev);
+
+/**
+ * Select fastest HT block decoder supported by this CPU
+ */
+static ht_decode_fn selectDecoder(void)
+{
+	auto targets = hwy::SupportedTargets();
+#if HWY_ARCH_X86
+	if(targets & HWY_AVX2)
+		return local::ojph_decode_codeblock_avx2;
+	if(targets & HWY_SSSE3)
+		return local::ojph_decode_codeblock_ssse3;
+#else
+	if(targets & ~(HWY_EMU128 | HWY_SCALAR))
+		return local::ojph_decode_codeblock_hwy;
+#endif
+	return local::ojph_decode_codeblock;
+}
+/**
+ * Select fastest HT block encoder supported by this CPU
+ */
+static ht_encode_fn selectEncoder(void)
+{
+	if(hwy::SupportedTargets() & ~(HWY_EMU128 | HWY_SCALAR))
+		return local::ojph_encode_codeblock_hwy;
+	return local::ojph_encode_codeblock;
+}
+
 T1OJPH::T1OJPH(bool isCompressor, [[maybe_unused]] grk::TileCodingParams* tcp, uint32_t maxCblkW,
 			   uint32_t maxCblkH)
 	: coded_data_size(isCompressor ? 0 : (uint32_t)(maxCblkW * maxCblkH * sizeof(int32_t))),
 	  coded_data(isCompressor ? nullptr : new uint8_t[coded_data_size]),
-	  unencoded_data_size(maxCblkW * maxCblkH), unencoded_data(new int32_t[unencoded_data_size]),
-	  allocator(new mem_fixed_allocator), elastic_alloc(new mem_elastic_allocator(1048576))
+	  unencoded_data_size(((maxCblkW + 3) & ~3U) * maxCblkH),
+	  unencoded_data((int32_t*)grk::grk_aligned_malloc(unencoded_data_size * sizeof(int32_t))),
+	  allocator(new mem_fixed_allocator), elastic_alloc(new mem_elastic_allocator(1048576)),
+	  decodeCodeblock_(isCompressor ? nullptr : selectDecoder()),
+	  encodeCodeblock_(isCompressor ? selectEncoder() : nullptr)
 {
 	if(!isCompressor)
 		memset(coded_data, 0, grk_cblk_dec_compressed_data_pad_ht);
@@ -40,7 +154,7 @@ T1OJPH::T1OJPH(bool isCompressor, [[maybe_unused]] grk::TileCodingParams* tcp, u
 T1OJPH::~T1OJPH()
 {
 	delete[] coded_data;
-	delete[] unencoded_data;
+	grk::grk_aligned_free(unencoded_data);
 	delete allocator;
 	delete elastic_alloc;
 }
@@ -52,45 +166,15 @@ void T1OJPH::preCompress([[maybe_unused]] grk::CompressBlockExec* block,
 	uint16_t h = (uint16_t)cblk->height();
 	uint32_t tile_width =
 		(tile->comps + block->compno)->getWindow()->getResWindowBufferHighestStride();
-	auto tileLineAdvance = tile_width - w;
-	uint32_t cblk_index = 0;
 	int32_t shift = 31 - (block->k_msbs + 1);
 
 	// convert to sign-magnitude
 	if(block->qmfbid == 1)
-	{
-		auto tiledp = block->tiledp;
-		for(auto j = 0U; j < h; ++j)
-		{
-			for(auto i = 0U; i < w; ++i)
-			{
-				int32_t temp = *tiledp++;
-				int32_t val = temp >= 0 ? temp : -temp;
-				int32_t sign = (int32_t)((temp >= 0) ? 0U : 0x80000000);
-				int32_t res = sign | (val << shift);
-				unencoded_data[cblk_index] = res;
-				cblk_index++;
-			}
-			tiledp += tileLineAdvance;
-		}
-	}
+		HWY_DYNAMIC_DISPATCH(hwy_quantize_rev)
+		(block->tiledp, tile_width, unencoded_data, w, h, shift);
 	else
-	{
-		auto tiledp = (float*)block->tiledp;
-		for(auto j = 0U; j < h; ++j)
-		{
-			for(auto i = 0U; i < w; ++i)
-			{
-				int32_t t = (int32_t)((float)*tiledp++ * block->inv_step_ht * (float)(1 << shift));
-				int32_t val = t >= 0 ? t : -t;
-				int32_t sign = t >= 0 ? 0 : (int32_t)0x80000000;
-				int32_t res = sign | val;
-				unencoded_data[cblk_index] = res;
-				cblk_index++;
-			}
-			tiledp += tileLineAdvance;
-		}
-	}
+		HWY_DYNAMIC_DISPATCH(hwy_quantize_irrev)
+		((float*)block->tiledp, tile_width, unencoded_data, w, h, block->inv_step_ht, shift);
 }
 bool T1OJPH::compress(grk::CompressBlockExec* block)
 {
@@ -105,8 +189,8 @@ bool T1OJPH::compress(grk::CompressBlockExec* block)
 	uint16_t h = (uint16_t)cblk->height();
 
 	uint32_t pass_length[2] = {0, 0};
-	ojph::local::ojph_encode_codeblock((uint32_t*)unencoded_data, block->k_msbs, 1, w, h, w,
-									   pass_length, elastic_alloc, next_coded);
+	encodeCodeblock_((uint32_t*)unencoded_data, block->k_msbs, 1, w, h, w, pass_length,
+					 elastic_alloc, next_coded);
 
 	cblk->numPassesTotal = 1;
 	cblk->passes[0].len = (uint16_t)pass_length[0];
@@ -122,9 +206,20 @@ bool T1OJPH::decompress(grk::DecompressBlockExec* block)
 	auto cblk = block->cblk;
 	if(!cblk->area())
 		return true;
-	uint16_t stride = (uint16_t)cblk->width();
+	// SIMD decoders write whole quads
+	uint16_t stride = (uint16_t)((cblk->width() + 3) & ~3U);
 	if(!cblk->seg_buffers.empty())
 	{
+		// decompress straight into tile window if quad writes stay inside the block,
+		// and SIMD decoders' aligned stores stay aligned
+		uint32_t destStride = 0;
+		auto dest = ((cblk->width() & 3) == 0 && (cblk->height() & 1) == 0)
+						? block->tilec->getInPlaceDest(block, &destStride)
+						: nullptr;
+		if(dest && ((destStride & 3) || ((size_t)dest & 15)))
+			dest = nullptr;
+		auto target = dest ? dest : unencoded_data;
+		uint32_t targetStride = dest ? destStride : stride;
 		size_t total_seg_len = 2 * grk_cblk_dec_compressed_data_pad_ht + cblk->getSegBuffersLen();
 		if(coded_data_size < total_seg_len)
 		{
@@ -153,19 +248,25 @@ bool T1OJPH::decompress(grk::DecompressBlockExec* block)
 		bool rc = false;
 		if(num_passes && offset)
 		{
-			rc = ojph::local::ojph_decode_codeblock(
-				actual_coded_data, (uint32_t*)unencoded_data, block->k_msbs, (uint32_t)num_passes,
-				(uint32_t)offset, 0, cblk->width(), cblk->height(), stride, false);
+			rc = decodeCodeblock_(actual_coded_data, (uint32_t*)target, block->k_msbs,
+								  (uint32_t)num_passes, (uint32_t)offset, 0, cblk->width(),
+								  cblk->height(), targetStride, false);
 		}
 		else
 		{
-			memset(unencoded_data, 0, stride * cblk->height() * sizeof(int32_t));
+			for(uint32_t j = 0; j < cblk->height(); ++j)
+				memset(target + (size_t)j * targetStride, 0, cblk->width() * sizeof(int32_t));
 		}
 		if(!rc)
 		{
 			grk::Logger::logger_.error("Error in HT block coder");
 			return false;
 		}
+		if(dest)
+		{
+			block->tilec->postProcessInPlace(dest, destStride, block, true);
+			return true;
+		}
 	}
 
 	block->tilec->postProcessHT(unencoded_data, block, stride);
@@ -173,3 +274,4 @@ bool T1OJPH::decompress(grk::DecompressBlockExec* block)
 	return true;
 }
 } // namespace ojph
+#endif
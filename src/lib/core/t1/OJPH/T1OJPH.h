@@ -23,9 +23,17 @@ namespace ojph
 {
 class mem_fixed_allocator;
 class mem_elastic_allocator;
+struct coded_lists;
 
 struct TileCodingParams;
 
+typedef bool (*ht_decode_fn)(uint8_t* coded_data, uint32_t* decoded_data, uint32_t missing_msbs,
+							 uint32_t num_passes, uint32_t lengths1, uint32_t lengths2,
+							 uint32_t width, uint32_t height, uint32_t stride, bool stripe_causal);
+typedef void (*ht_encode_fn)(uint32_t* buf, uint32_t missing_msbs, uint32_t num_passes,
+							 uint32_t width, uint32_t height, uint32_t stride, uint32_t* lengths,
+							 mem_elastic_allocator* elastic, coded_lists*& coded);
+
 class T1OJPH : public grk::T1Interface
 {
   public:
@@ -46,5 +54,10 @@ class T1OJPH : public grk::T1Interface
 
 	mem_fixed_allocator* allocator;
 	mem_elastic_allocator* elastic_alloc;
+
+	// HT block decoder, chosen at run time from CPU features
+	ht_decode_fn decodeCodeblock_;
+	// HT block encoder, chosen at run time from CPU features
+	ht_encode_fn encodeCodeblock_;
 };
 } // namespace ojph
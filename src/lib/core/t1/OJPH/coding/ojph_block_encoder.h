@@ -57,6 +57,14 @@ namespace ojph {
                             ui32* lengths, 
                             ojph::mem_elastic_allocator *elastic,
                             ojph::coded_lists *& coded);
+
+    // Highway-accelerated encoder; output is identical to the generic encoder
+    void
+      ojph_encode_codeblock_hwy(ui32* buf, ui32 missing_msbs, ui32 num_passes,
+                                ui32 width, ui32 height, ui32 stride,
+                                ui32* lengths,
+                                ojph::mem_elastic_allocator *elastic,
+                                ojph::coded_lists *& coded);
   }
 }
 
@@ -0,0 +1,737 @@
+//***************************************************************************/
+// This software is released under the 2-Clause BSD license, included
+// below.
+//
+// Copyright (c) 2019, Aous Naman
+// Copyright (c) 2019, Kakadu Software Pty Ltd, Australia
+// Copyright (c) 2019, The University of New South Wales, Australia
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are
+// met:
+//
+// 1. Redistributions of source code must retain the above copyright
+// notice, this list of conditions and the following disclaimer.
+//
+// 2. Redistributions in binary form must reproduce the above copyright
+// notice, this list of conditions and the following disclaimer in the
+// documentation and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+// IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+// TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+// PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+// HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+// SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+// TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+// PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+// NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+// SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//***************************************************************************/
+// This file is part of the OpenJPH software implementation.
+// File: ojph_block_encoder_hwy.cpp
+// Author: Aous Naman
+// Date: 17 September 2019
+//***************************************************************************/
+
+//***************************************************************************/
+/** @file ojph_block_encoder_hwy.cpp
+ *  @brief implements a faster HTJ2K block encoder using Highway
+ *
+ *  Exponents, MagSgn values, significance patterns (rho), quad maximum
+ *  exponents and the eps patterns of a whole row of quads are computed
+ *  with vectors.  Context formation, MEL, VLC and UVLC coding remain
+ *  sequential, but VLC and UVLC codewords of a pair of quads, and the
+ *  MagSgn codewords of a quad, are packed and emitted together.  The
+ *  output is identical to that of the generic encoder.
+ */
+
+#include <cassert>
+#include <cstring>
+#include <cstdint>
+#include <climits>
+#include "grok.h"
+#include "Logger.h"
+
+#include "ojph_mem.h"
+#include "ojph_arch.h"
+#include "ojph_block_encoder.h"
+
+// kernels use fixed size scratch rows, so scalable vector targets
+// are not compiled
+#ifndef HWY_DISABLED_TARGETS
+#define HWY_DISABLED_TARGETS (HWY_SVE | HWY_SVE2 | HWY_SVE_256 | HWY_SVE2_128 | HWY_RVV)
+#endif
+
+#undef HWY_TARGET_INCLUDE
+#define HWY_TARGET_INCLUDE "t1/OJPH/coding/ojph_block_encoder_hwy.cpp"
+#include <hwy/foreach_target.h>
+#include <hwy/highway.h>
+
+#ifndef _MSC_VER
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wconversion"
+#pragma GCC diagnostic ignored "-Wsign-conversion"
+#endif
+
+namespace ojph {
+  namespace local {
+
+    /////////////////////////////////////////////////////////////////////////
+    // tables, defined in ojph_block_encoder.cpp
+    /////////////////////////////////////////////////////////////////////////
+    extern ui16 vlc_enc_tbl0[2048];
+    extern ui16 vlc_enc_tbl1[2048];
+    extern int ulvc_cwd_pre[33];
+    extern int ulvc_cwd_pre_len[33];
+    extern int ulvc_cwd_suf[33];
+    extern int ulvc_cwd_suf_len[33];
+  }
+}
+
+HWY_BEFORE_NAMESPACE();
+namespace ojph {
+  namespace local {
+  namespace HWY_NAMESPACE {
+
+    using namespace hwy::HWY_NAMESPACE;
+
+#if HWY_TARGET == HWY_SCALAR
+    // no vectors; defer to the generic encoder
+    static void encode_codeblock(ui32* buf, ui32 missing_msbs,
+                                 ui32 num_passes, ui32 width, ui32 height,
+                                 ui32 stride, ui32* lengths,
+                                 ojph::mem_elastic_allocator *elastic,
+                                 ojph::coded_lists *& coded)
+    {
+      ojph_encode_codeblock(buf, missing_msbs, num_passes, width, height,
+                            stride, lengths, elastic, coded);
+    }
+#else
+
+    /////////////////////////////////////////////////////////////////////////
+    //
+    /////////////////////////////////////////////////////////////////////////
+    struct mel_struct {
+      //storage
+      ui8* buf;      //pointer to data buffer
+      ui32 pos;      //position of next writing within buf
+      ui32 buf_size; //size of buffer, which we must not exceed
+
+      // all these can be replaced by bytes
+      int remaining_bits; //number of empty bits in tmp
+      int tmp;            //temporary storage of coded bits
+      int run;            //number of 0 run
+      int k;              //state
+      int threshold;      //threshold where one bit must be coded
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline void
+    mel_init(mel_struct* melp, ui32 buffer_size, ui8* data)
+    {
+      melp->buf = data;
+      melp->pos = 0;
+      melp->buf_size = buffer_size;
+      melp->remaining_bits = 8;
+      melp->tmp = 0;
+      melp->run = 0;
+      melp->k = 0;
+      melp->threshold = 1; // this is 1 << mel_exp[melp->k];
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline void
+    mel_emit_bit(mel_struct* melp, int v)
+    {
+      assert(v == 0 || v == 1);
+      melp->tmp = (melp->tmp << 1) + v;
+      melp->remaining_bits--;
+      if (melp->remaining_bits == 0)
+      {
+        if (melp->pos >= melp->buf_size)
+          grk::Logger::logger_.error( "mel encoder's buffer is full");
+
+        melp->buf[melp->pos++] = (ui8)melp->tmp;
+        melp->remaining_bits = (melp->tmp == 0xFF ? 7 : 8);
+        melp->tmp = 0;
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline void
+    mel_encode(mel_struct* melp, bool bit)
+    {
+      //MEL exponent
+      static const int mel_exp[13] = {0,0,0,1,1,1,2,2,2,3,3,4,5};
+
+      if (bit == false)
+      {
+        ++melp->run;
+        if (melp->run >= melp->threshold)
+        {
+          mel_emit_bit(melp, 1);
+          melp->run = 0;
+          melp->k = ojph_min(12, melp->k + 1);
+          melp->threshold = 1 << mel_exp[melp->k];
+        }
+      }
+      else
+      {
+        mel_emit_bit(melp, 0);
+        int t = mel_exp[melp->k];
+        while (t > 0)
+          mel_emit_bit(melp, (melp->run >> --t) & 1);
+        melp->run = 0;
+        melp->k = ojph_max(0, melp->k - 1);
+        melp->threshold = 1 << mel_exp[melp->k];
+      }
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    //
+    /////////////////////////////////////////////////////////////////////////
+    struct vlc_struct {
+      //storage
+      ui8* buf;      //pointer to data buffer
+      ui32 pos;      //position of next writing within buf
+      ui32 buf_size; //size of buffer, which we must not exceed
+
+      int used_bits; //number of occupied bits in tmp
+      int tmp;       //temporary storage of coded bits
+      bool last_greater_than_8F; //true if last byte us greater than 0x8F
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline void
+    vlc_init(vlc_struct* vlcp, ui32 buffer_size, ui8* data)
+    {
+      vlcp->buf = data + buffer_size - 1; //points to last byte
+      vlcp->pos = 1;                      //locations will be all -pos
+      vlcp->buf_size = buffer_size;
+
+      vlcp->buf[0] = 0xFF;
+      vlcp->used_bits = 4;
+      vlcp->tmp = 0xF;
+      vlcp->last_greater_than_8F = true;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline void
+    vlc_encode(vlc_struct* vlcp, int cwd, int cwd_len)
+    {
+      while (cwd_len > 0)
+      {
+        if (vlcp->pos >= vlcp->buf_size)
+          grk::Logger::logger_.error( "vlc encoder's buffer is full");
+
+        int avail_bits = 8 - vlcp->last_greater_than_8F - vlcp->used_bits;
+        int t = ojph_min(avail_bits, cwd_len);
+        vlcp->tmp |= (cwd & ((1 << t) - 1)) << vlcp->used_bits;
+        vlcp->used_bits += t;
+        avail_bits -= t;
+        cwd_len -= t;
+        cwd >>= t;
+        if (avail_bits == 0)
+        {
+          if (vlcp->last_greater_than_8F && vlcp->tmp != 0x7F)
+          {
+            vlcp->last_greater_than_8F = false;
+            continue; //one empty bit remaining
+          }
+          *(vlcp->buf - vlcp->pos) = (ui8)(vlcp->tmp);
+          vlcp->pos++;
+          vlcp->last_greater_than_8F = vlcp->tmp > 0x8F;
+          vlcp->tmp = 0;
+          vlcp->used_bits = 0;
+        }
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // appends a codeword to a group of codewords that are emitted together;
+    // a group holds at most 30 bits
+    static inline void
+    vlc_append(int& cwd, int& cwd_len, int c, int len)
+    {
+      cwd |= (c & ((1 << len) - 1)) << cwd_len;
+      cwd_len += len;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    //
+    //////////////////////////////////////////////////////////////////////////
+    static inline void
+    terminate_mel_vlc(mel_struct* melp, vlc_struct* vlcp)
+    {
+      if (melp->run > 0)
+        mel_emit_bit(melp, 1);
+
+      melp->tmp = melp->tmp << melp->remaining_bits;
+      int mel_mask = (0xFF << melp->remaining_bits) & 0xFF;
+      int vlc_mask = 0xFF >> (8 - vlcp->used_bits);
+      if ((mel_mask | vlc_mask) == 0)
+        return;  //last mel byte cannot be 0xFF, since then
+                 //melp->remaining_bits would be < 8
+      if (melp->pos >= melp->buf_size)
+        grk::Logger::logger_.error( "mel encoder's buffer is full");
+      int fuse = melp->tmp | vlcp->tmp;
+      if ( ( ((fuse ^ melp->tmp) & mel_mask)
+           | ((fuse ^ vlcp->tmp) & vlc_mask) ) == 0
+          && (fuse != 0xFF) && vlcp->pos > 1)
+      {
+        melp->buf[melp->pos++] = (ui8)fuse;
+      }
+      else
+      {
+        if (vlcp->pos >= vlcp->buf_size)
+          grk::Logger::logger_.error( "vlc encoder's buffer is full");
+        melp->buf[melp->pos++] = (ui8)melp->tmp; //melp->tmp cannot be 0xFF
+        *(vlcp->buf - vlcp->pos) = (ui8)vlcp->tmp;
+        vlcp->pos++;
+      }
+    }
+
+    /////////////////////////////////////////////////////////////////////////
+    //
+    /////////////////////////////////////////////////////////////////////////
+    struct ms_struct {
+      //storage
+      ui8* buf;      //pointer to data buffer
+      ui32 pos;      //position of next writing within buf
+      ui32 buf_size; //size of buffer, which we must not exceed
+
+      int max_bits;  //maximum number of bits that can be store in next byte
+      int used_bits; //number of occupied bits in tmp
+      ui64 tmp;      //temporary storage of coded bits
+    };
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline void
+    ms_init(ms_struct* msp, ui32 buffer_size, ui8* data)
+    {
+      msp->buf = data;
+      msp->pos = 0;
+      msp->buf_size = buffer_size;
+      msp->max_bits = 8;
+      msp->used_bits = 0;
+      msp->tmp = 0;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // codeword can be up to 56 bits long, because tmp holds less than 8 bits
+    // between calls
+    static inline void
+    ms_encode(ms_struct* msp, ui64 cwd, int cwd_len)
+    {
+      msp->tmp |= cwd << msp->used_bits;
+      msp->used_bits += cwd_len;
+      while (msp->used_bits >= msp->max_bits)
+      {
+        if (msp->pos >= msp->buf_size)
+          grk::Logger::logger_.error( "magnitude sign encoder's buffer is full");
+        ui8 t = (ui8)(msp->tmp & ((1U << msp->max_bits) - 1));
+        msp->buf[msp->pos++] = t;
+        msp->tmp >>= msp->max_bits;
+        msp->used_bits -= msp->max_bits;
+        msp->max_bits = (t == 0xFF) ? 7 : 8;
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // encodes the MagSgn values of the significant samples of one quad
+    static inline void
+    ms_encode_quad(ms_struct* msp, const ui32* s, int rho, int U_q, int tuple)
+    {
+      if (rho == 0)
+        return;
+      ui64 cwd = 0;
+      int cwd_len = 0;
+      for (int i = 0; i < 4; ++i)
+      {
+        int m = ((rho >> i) & 1) * (U_q - ((tuple >> i) & 1));
+        if (cwd_len + m > 56)
+        {
+          ms_encode(msp, cwd, cwd_len);
+          cwd = 0;
+          cwd_len = 0;
+        }
+        cwd |= (ui64)(s[i] & (ui32)((1ULL << m) - 1)) << cwd_len;
+        cwd_len += m;
+      }
+      ms_encode(msp, cwd, cwd_len);
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    static inline void
+    ms_terminate(ms_struct* msp)
+    {
+      if (msp->used_bits)
+      {
+        int t = msp->max_bits - msp->used_bits; //unused bits
+        msp->tmp |= (0xFF & ((1U << t) - 1)) << msp->used_bits;
+        msp->used_bits += t;
+        if (msp->tmp != 0xFF)
+        {
+          if (msp->pos >= msp->buf_size)
+            grk::Logger::logger_.error( "magnitude sign encoder's buffer is full");
+          msp->buf[msp->pos++] = (ui8)msp->tmp;
+        }
+      }
+      else if (msp->max_bits == 7)
+        msp->pos--;
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // largest number of lanes of any target, used to size scratch rows
+    const ui32 max_lanes32 = HWY_MAX_BYTES / sizeof(ui32);
+
+    //////////////////////////////////////////////////////////////////////////
+    // exponent e = 32 - clz(2\mu_p - 1), or 0 for insignificant samples,
+    // and v_n = 2(\mu_p-1) + s_n
+    template <class D, class V>
+    static HWY_INLINE void
+    exp_magsgn(D d, V t, int p, V& e, V& s)
+    {
+      V val = ShiftRightSame(Add(t, t), p);  // 2 \mu_p + x
+      val = And(val, Set(d, ~1u));           // 2 \mu_p
+      e = Sub(Set(d, 32), LeadingZeroCount(Sub(val, Set(d, 1))));
+      e = IfThenElseZero(Ne(val, Zero(d)), e);
+      s = Add(Sub(val, Set(d, 2)), ShiftRight<31>(t));
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    // For a row of quads, formed by rows sp0 and sp1 (null for a missing
+    // second row), computes packed quad information:
+    //   bits 0-3:   rho
+    //   bits 4-7:   samples whose exponent equals e_qmax (eps candidates)
+    //   bits 8-15:  e_qmax
+    //   bits 16-23: exponent of bottom left sample
+    //   bits 24-31: exponent of bottom right sample
+    // and the MagSgn values of the 4 samples of each quad, in coding order.
+    // Samples beyond width are treated as zero.
+    static void
+    quad_row(const ui32* sp0, const ui32* sp1, ui32 width, int p,
+             ui32* qinfo, ui32* sv)
+    {
+      const HWY_FULL(ui32) d;
+      const ui32 N = (ui32)Lanes(d);
+      HWY_ALIGN ui32 tail0[2 * max_lanes32];
+      HWY_ALIGN ui32 tail1[2 * max_lanes32];
+      const auto one = Set(d, 1);
+      for (ui32 x = 0; x < width; x += 2 * N, qinfo += N, sv += 4 * N)
+      {
+        const ui32 *r0 = sp0 + x, *r1 = sp1 ? sp1 + x : nullptr;
+        if (x + 2 * N > width)
+        {
+          ui32 n = width - x;
+          memcpy(tail0, r0, n * sizeof(ui32));
+          memset(tail0 + n, 0, (2 * N - n) * sizeof(ui32));
+          r0 = tail0;
+          if (r1)
+          {
+            memcpy(tail1, r1, n * sizeof(ui32));
+            memset(tail1 + n, 0, (2 * N - n) * sizeof(ui32));
+            r1 = tail1;
+          }
+        }
+        // samples 0 and 2 of each quad are in the even and odd columns of
+        // the first row, samples 1 and 3 in those of the second row
+        auto t0 = Zero(d), t1 = Zero(d), t2 = Zero(d), t3 = Zero(d);
+        LoadInterleaved2(d, r0, t0, t2);
+        if (r1)
+          LoadInterleaved2(d, r1, t1, t3);
+        auto e0 = Zero(d), e1 = Zero(d), e2 = Zero(d), e3 = Zero(d);
+        auto s0 = Zero(d), s1 = Zero(d), s2 = Zero(d), s3 = Zero(d);
+        exp_magsgn(d, t0, p, e0, s0);
+        exp_magsgn(d, t1, p, e1, s1);
+        exp_magsgn(d, t2, p, e2, s2);
+        exp_magsgn(d, t3, p, e3, s3);
+
+        auto emax = Max(Max(e0, e1), Max(e2, e3));
+        auto rho = Or(Or(Min(e0, one), ShiftLeft<1>(Min(e1, one))),
+                      Or(ShiftLeft<2>(Min(e2, one)), ShiftLeft<3>(Min(e3, one))));
+        auto eps = Or(Or(IfThenElseZero(Eq(e0, emax), Set(d, 0x10)),
+                         IfThenElseZero(Eq(e1, emax), Set(d, 0x20))),
+                      Or(IfThenElseZero(Eq(e2, emax), Set(d, 0x40)),
+                         IfThenElseZero(Eq(e3, emax), Set(d, 0x80))));
+        auto info = Or(Or(rho, eps), ShiftLeft<8>(emax));
+        info = Or(info, Or(ShiftLeft<16>(e1), ShiftLeft<24>(e3)));
+        StoreU(info, d, qinfo);
+        StoreInterleaved4(s0, s1, s2, s3, d, sv);
+      }
+    }
+
+    //////////////////////////////////////////////////////////////////////////
+    //
+    //
+    //
+    //
+    //
+    //////////////////////////////////////////////////////////////////////////
+    static void encode_codeblock(ui32* buf, ui32 missing_msbs,
+                                 ui32 num_passes, ui32 width, ui32 height,
+                                 ui32 stride, ui32* lengths,
+                                 ojph::mem_elastic_allocator *elastic,
+                                 ojph::coded_lists *& coded)
+    {
+      // blocks narrower than a pair of quads gain nothing from vectors
+      if (width < 4)
+      {
+        ojph_encode_codeblock(buf, missing_msbs, num_passes, width, height,
+                              stride, lengths, elastic, coded);
+        return;
+      }
+
+      assert(num_passes == 1);
+      (void)num_passes;                      //currently not used
+      const int ms_size = (16384*16+14)/15;  //more than enough
+      ui8 ms_buf[ms_size];
+      const int mel_vlc_size = 3072;         //more than enough
+      ui8 mel_vlc_buf[mel_vlc_size];
+      const int mel_size = 192;
+      ui8 *mel_buf = mel_vlc_buf;
+      const int vlc_size = mel_vlc_size - mel_size;
+      ui8 *vlc_buf = mel_vlc_buf + mel_size;
+
+      mel_struct mel;
+      mel_init(&mel, mel_size, mel_buf);
+      vlc_struct vlc;
+      vlc_init(&vlc, vlc_size, vlc_buf);
+      ms_struct ms;
+      ms_init(&ms, ms_size, ms_buf);
+
+      const int p = (int)(30 - missing_msbs);
+
+      // quad information and MagSgn values for a row of up to 512 quads,
+      // rounded up to whole vectors
+      HWY_ALIGN ui32 qinfo[512 + max_lanes32];
+      HWY_ALIGN ui32 s_val[4 * (512 + max_lanes32)];
+
+      //e_val: E values for a line (these are the highest set bit)
+      //cx_val: is the context values
+      //Each byte stores the info for the 2 sample. For E, it is maximum
+      // of the two samples, while for cx, it is the OR of these two samples.
+      //The maximum is between the pixel at the bottom left of one quad
+      // and the bottom right of the earlier quad. The same is true for cx.
+      //For a 1024 pixels, we need 512 bytes, the 2 extra,
+      // one for the non-existing earlier quad, and one for beyond the
+      // the end
+      ui8 e_val[514];
+      ui8 cx_val[514];
+      ui8* lep = e_val;     lep[0] = 0;
+      ui8* lcxp = cx_val;   lcxp[0] = 0;
+
+      //initial row of quads
+      quad_row(buf, height > 1 ? buf + stride : nullptr, width, p,
+               qinfo, s_val);
+      int c_q0 = 0;
+      for (ui32 x = 0, q = 0; x < width; x += 4, q += 2)
+      {
+        ui32 qi = qinfo[q];
+        int rho0 = (int)(qi & 0xF);
+        int Uq0 = ojph_max((int)((qi >> 8) & 0xFF), 1); //kappa_q = 1
+        int u_q0 = Uq0 - 1, u_q1 = 0; //kappa_q = 1
+        int eps0 = u_q0 > 0 ? (int)((qi >> 4) & 0xF) : 0;
+        lep[0] = ojph_max(lep[0], (ui8)(qi >> 16)); lep++;
+        lep[0] = (ui8)(qi >> 24);
+        lcxp[0] = (ui8)(lcxp[0] | (ui8)((rho0 & 2) >> 1)); lcxp++;
+        lcxp[0] = (ui8)((rho0 & 8) >> 3);
+
+        int vlc_cwd = 0, vlc_len = 0;
+        ui16 tuple0 = vlc_enc_tbl0[(c_q0 << 8) + (rho0 << 4) + eps0];
+        vlc_append(vlc_cwd, vlc_len, tuple0 >> 8, (tuple0 >> 4) & 7);
+
+        if (c_q0 == 0)
+          mel_encode(&mel, rho0 != 0);
+
+        ms_encode_quad(&ms, s_val + 4 * q, rho0, Uq0, tuple0);
+
+        int rho1 = 0;
+        if (x+2 < width)
+        {
+          qi = qinfo[q + 1];
+          rho1 = (int)(qi & 0xF);
+          int c_q1 = (rho0 >> 1) | (rho0 & 1);
+          int Uq1 = ojph_max((int)((qi >> 8) & 0xFF), 1); //kappa_q = 1
+          u_q1 = Uq1 - 1; //kappa_q = 1
+          int eps1 = u_q1 > 0 ? (int)((qi >> 4) & 0xF) : 0;
+          lep[0] = ojph_max(lep[0], (ui8)(qi >> 16)); lep++;
+          lep[0] = (ui8)(qi >> 24);
+          lcxp[0] = (ui8)(lcxp[0] | (ui8)((rho1 & 2) >> 1)); lcxp++;
+          lcxp[0] = (ui8)((rho1 & 8) >> 3);
+          ui16 tuple1 = vlc_enc_tbl0[(c_q1 << 8) + (rho1 << 4) + eps1];
+          vlc_append(vlc_cwd, vlc_len, tuple1 >> 8, (tuple1 >> 4) & 7);
+
+          if (c_q1 == 0)
+            mel_encode(&mel, rho1 != 0);
+
+          ms_encode_quad(&ms, s_val + 4 * (q + 1), rho1, Uq1, tuple1);
+        }
+
+        if (u_q0 > 0 && u_q1 > 0)
+          mel_encode(&mel, ojph_min(u_q0, u_q1) > 2);
+
+        if (u_q0 > 2 && u_q1 > 2)
+        {
+          vlc_append(vlc_cwd, vlc_len, ulvc_cwd_pre[u_q0-2],
+                     ulvc_cwd_pre_len[u_q0-2]);
+          vlc_append(vlc_cwd, vlc_len, ulvc_cwd_pre[u_q1-2],
+                     ulvc_cwd_pre_len[u_q1-2]);
+          vlc_append(vlc_cwd, vlc_len, ulvc_cwd_suf[u_q0-2],
+                     ulvc_cwd_suf_len[u_q0-2]);
+          vlc_append(vlc_cwd, vlc_len, ulvc_cwd_suf[u_q1-2],
+                     ulvc_cwd_suf_len[u_q1-2]);
+        }
+        else if (u_q0 > 2 && u_q1 > 0)
+        {
+          vlc_append(vlc_cwd, vlc_len, ulvc_cwd_pre[u_q0],
+                     ulvc_cwd_pre_len[u_q0]);
+          vlc_append(vlc_cwd, vlc_len, u_q1 - 1, 1);
+          vlc_append(vlc_cwd, vlc_len, ulvc_cwd_suf[u_q0],
+                     ulvc_cwd_suf_len[u_q0]);
+        }
+        else
+        {
+          vlc_append(vlc_cwd, vlc_len, ulvc_cwd_pre[u_q0],
+                     ulvc_cwd_pre_len[u_q0]);
+          vlc_append(vlc_cwd, vlc_len, ulvc_cwd_pre[u_q1],
+                     ulvc_cwd_pre_len[u_q1]);
+          vlc_append(vlc_cwd, vlc_len, ulvc_cwd_suf[u_q0],
+                     ulvc_cwd_suf_len[u_q0]);
+          vlc_append(vlc_cwd, vlc_len, ulvc_cwd_suf[u_q1],
+                     ulvc_cwd_suf_len[u_q1]);
+        }
+        vlc_encode(&vlc, vlc_cwd, vlc_len);
+
+        //prepare for next iteration
+        c_q0 = (rho1 >> 1) | (rho1 & 1);
+      }
+
+      lep[1] = 0;
+
+      for (ui32 y = 2; y < height; y += 2)
+      {
+        lep = e_val;
+        int max_e = ojph_max(lep[0], lep[1]) - 1;
+        lep[0] = 0;
+        lcxp = cx_val;
+        c_q0 = lcxp[0] + (lcxp[1] << 2);
+        lcxp[0] = 0;
+
+        ui32 *sp = buf + y * stride;
+        quad_row(sp, y + 1 < height ? sp + stride : nullptr, width, p,
+                 qinfo, s_val);
+        for (ui32 x = 0, q = 0; x < width; x += 4, q += 2)
+        {
+          ui32 qi = qinfo[q];
+          int rho0 = (int)(qi & 0xF);
+          int kappa = (rho0 & (rho0-1)) ? ojph_max(1,max_e) : 1;
+          int Uq0 = ojph_max((int)((qi >> 8) & 0xFF), kappa);
+          int u_q0 = Uq0 - kappa, u_q1 = 0;
+          int eps0 = u_q0 > 0 ? (int)((qi >> 4) & 0xF) : 0;
+          lep[0] = ojph_max(lep[0], (ui8)(qi >> 16)); lep++;
+          max_e = ojph_max(lep[0], lep[1]) - 1;
+          lep[0] = (ui8)(qi >> 24);
+          lcxp[0] = (ui8)(lcxp[0] | (ui8)((rho0 & 2) >> 1)); lcxp++;
+          int c_q1 = lcxp[0] + (lcxp[1] << 2);
+          lcxp[0] = (ui8)((rho0 & 8) >> 3);
+
+          int vlc_cwd = 0, vlc_len = 0;
+          ui16 tuple0 = vlc_enc_tbl1[(c_q0 << 8) + (rho0 << 4) + eps0];
+          vlc_append(vlc_cwd, vlc_len, tuple0 >> 8, (tuple0 >> 4) & 7);
+
+          if (c_q0 == 0)
+            mel_encode(&mel, rho0 != 0);
+
+          ms_encode_quad(&ms, s_val + 4 * q, rho0, Uq0, tuple0);
+
+          int rho1 = 0;
+          if (x+2 < width)
+          {
+            qi = qinfo[q + 1];
+            rho1 = (int)(qi & 0xF);
+            kappa = (rho1 & (rho1-1)) ? ojph_max(1,max_e) : 1;
+            c_q1 |= ((rho0 & 4) >> 1) | ((rho0 & 8) >> 2);
+            int Uq1 = ojph_max((int)((qi >> 8) & 0xFF), kappa);
+            u_q1 = Uq1 - kappa;
+            int eps1 = u_q1 > 0 ? (int)((qi >> 4) & 0xF) : 0;
+            lep[0] = ojph_max(lep[0], (ui8)(qi >> 16)); lep++;
+            max_e = ojph_max(lep[0], lep[1]) - 1;
+            lep[0] = (ui8)(qi >> 24);
+            lcxp[0] = (ui8)(lcxp[0] | (ui8)((rho1 & 2) >> 1)); lcxp++;
+            c_q0 = lcxp[0] + (lcxp[1] << 2);
+            lcxp[0] = (ui8)((rho1 & 8) >> 3);
+            ui16 tuple1 = vlc_enc_tbl1[(c_q1 << 8) + (rho1 << 4) + eps1];
+            vlc_append(vlc_cwd, vlc_len, tuple1 >> 8, (tuple1 >> 4) & 7);
+
+            if (c_q1 == 0)
+              mel_encode(&mel, rho1 != 0);
+
+            ms_encode_quad(&ms, s_val + 4 * (q + 1), rho1, Uq1, tuple1);
+          }
+
+          vlc_append(vlc_cwd, vlc_len, ulvc_cwd_pre[u_q0],
+                     ulvc_cwd_pre_len[u_q0]);
+          vlc_append(vlc_cwd, vlc_len, ulvc_cwd_pre[u_q1],
+                     ulvc_cwd_pre_len[u_q1]);
+          vlc_append(vlc_cwd, vlc_len, ulvc_cwd_suf[u_q0],
+                     ulvc_cwd_suf_len[u_q0]);
+          vlc_append(vlc_cwd, vlc_len, ulvc_cwd_suf[u_q1],
+                     ulvc_cwd_suf_len[u_q1]);
+          vlc_encode(&vlc, vlc_cwd, vlc_len);
+
+          //prepare for next iteration
+          c_q0 |= ((rho1 & 4) >> 1) | ((rho1 & 8) >> 2);
+        }
+      }
+
+      terminate_mel_vlc(&mel, &vlc);
+      ms_terminate(&ms);
+
+      //copy to elastic
+      lengths[0] = mel.pos + vlc.pos + ms.pos;
+      elastic->get_buffer(mel.pos + vlc.pos + ms.pos, coded);
+      memcpy(coded->buf, ms.buf, ms.pos);
+      memcpy(coded->buf + ms.pos, mel.buf, mel.pos);
+      memcpy(coded->buf + ms.pos + mel.pos, vlc.buf - vlc.pos + 1, vlc.pos);
+
+      // put in the interface locator word
+      ui32 num_bytes = mel.pos + vlc.pos;
+      coded->buf[lengths[0]-1] = (ui8)(num_bytes >> 4);
+      coded->buf[lengths[0]-2] = coded->buf[lengths[0]-2] & 0xF0;
+      coded->buf[lengths[0]-2] =
+        (ui8)(coded->buf[lengths[0]-2] | (num_bytes & 0xF));
+
+      coded->avail_size -= lengths[0];
+    }
+#endif
+
+  } // namespace HWY_NAMESPACE
+  }
+}
+HWY_AFTER_NAMESPACE();
+
+#if HWY_ONCE
+namespace ojph {
+  namespace local {
+    HWY_EXPORT(encode_codeblock);
+
+    //************************************************************************/
+    void ojph_encode_codeblock_hwy(ui32* buf, ui32 missing_msbs,
+                                   ui32 num_passes, ui32 width, ui32 height,
+                                   ui32 stride, ui32* lengths,
+                                   ojph::mem_elastic_allocator *elastic,
+                                   ojph::coded_lists *& coded)
+    {
+      HWY_DYNAMIC_DISPATCH(encode_codeblock)(buf, missing_msbs, num_passes,
+        width, height, stride, lengths, elastic, coded);
+    }
+  }
+}
+#endif
+
+#ifndef _MSC_VER
+#pragma GCC diagnostic pop
+#endif
@@ -0,0 +1,190 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#include "grk_includes.h"
+
+#undef HWY_TARGET_INCLUDE
+#define HWY_TARGET_INCLUDE "t1/PostT1DecompressFilters.cpp"
+#include <hwy/foreach_target.h>
+#include <hwy/highway.h>
+HWY_BEFORE_NAMESPACE();
+namespace grk
+{
+namespace HWY_NAMESPACE
+{
+	using namespace hwy::HWY_NAMESPACE;
+
+	/**
+	 * Scalar filter, for samples that don't fill a full vector
+	 */
+	template<bool ht, bool roi, bool reversible>
+	static inline void dequantizeSample(int32_t* dest, int32_t val, int32_t thresh,
+										uint32_t roiShift, uint32_t shift, float scale)
+	{
+		if(ht)
+		{
+			uint32_t sign = (uint32_t)val & 0x80000000;
+			int32_t mag = val & 0x7FFFFFFF;
+			if(roi && mag >= thresh)
+				mag = (int32_t)((uint32_t)mag >> roiShift);
+			if(reversible)
+			{
+				int32_t shifted = mag >> shift;
+				*dest = sign ? -shifted : shifted;
+			}
+			else
+			{
+				float scaled = (float)mag * scale;
+				*(float*)dest = sign ? -scaled : scaled;
+			}
+		}
+		else
+		{
+			if(roi)
+			{
+				int32_t mag = abs(val);
+				if(mag >= thresh)
+				{
+					mag >>= roiShift;
+					val = val < 0 ? -mag : mag;
+				}
+			}
+			if(reversible)
+				*dest = val / 2;
+			else
+				*(float*)dest = (float)val * scale;
+		}
+	}
+	/**
+	 * Vector filter. Float results are returned as raw bits
+	 */
+	template<bool ht, bool roi, bool reversible, class DI, class V>
+	HWY_INLINE V dequantize(DI di, V v, V thresh, int roiShift, int shift, float scale)
+	{
+		const RebindToFloat<DI> df;
+		if(ht)
+		{
+			const auto signMask = Set(di, INT32_MIN);
+			auto sign = And(v, signMask);
+			auto mag = AndNot(signMask, v);
+			if(roi)
+				mag = IfThenElse(Ge(mag, thresh), ShiftRightSame(mag, roiShift), mag);
+			if(reversible)
+			{
+				auto shifted = ShiftRightSame(mag, shift);
+				return IfThenElse(Eq(sign, Zero(di)), shifted, Neg(shifted));
+			}
+			return Xor(BitCast(di, Mul(ConvertTo(df, mag), Set(df, scale))), sign);
+		}
+		if(roi)
+		{
+			auto mag = Abs(v);
+			mag = IfThenElse(Ge(mag, thresh), ShiftRightSame(mag, roiShift), mag);
+			v = IfNegativeThenElse(v, Neg(mag), mag);
+		}
+		// division by two, rounding towards zero
+		if(reversible)
+			return ShiftRight<1>(Sub(v, BroadcastSignBit(v)));
+
+		return BitCast(di, Mul(ConvertTo(df, v), Set(df, scale)));
+	}
+	template<bool ht, bool roi, bool reversible>
+	static void filter(int32_t* dest, uint32_t destStride, const int32_t* src, uint32_t srcStride,
+					   uint32_t w, uint32_t h, uint32_t roiShift, uint32_t shift, float scale)
+	{
+		const HWY_FULL(int32_t) di;
+		const uint32_t N = (uint32_t)Lanes(di);
+		const int32_t thresh = roi ? (int32_t)(1U << roiShift) : 0;
+		const auto vThresh = Set(di, thresh);
+		for(uint32_t j = 0; j < h; ++j)
+		{
+			uint32_t i = 0;
+			for(; i + N <= w; i += N)
+			{
+				auto v = LoadU(di, src + i);
+				StoreU(dequantize<ht, roi, reversible>(di, v, vThresh, (int)roiShift, (int)shift,
+													   scale),
+					   di, dest + i);
+			}
+			for(; i < w; ++i)
+				dequantizeSample<ht, roi, reversible>(dest + i, src[i], thresh, roiShift, shift,
+													  scale);
+			src += srcStride;
+			dest += destStride;
+		}
+	}
+	static void hwy_post_t1_decompress(bool ht, bool roi, bool reversible, int32_t* dest,
+									   uint32_t destStride, const int32_t* src,
+									   uint32_t srcStride, uint32_t w, uint32_t h,
+									   uint32_t roiShift, uint32_t shift, float scale)
+	{
+		auto fn = filter<false, false, false>;
+		if(ht)
+		{
+			if(roi)
+				fn = reversible ? filter<true, true, true> : filter<true, true, false>;
+			else
+				fn = reversible ? filter<true, false, true> : filter<true, false, false>;
+		}
+		else
+		{
+			if(roi)
+				fn = reversible ? filter<false, true, true> : filter<false, true, false>;
+			else
+				fn = reversible ? filter<false, false, true> : filter<false, false, false>;
+		}
+		fn(dest, destStride, src, srcStride, w, h, roiShift, shift, scale);
+	}
+} // namespace HWY_NAMESPACE
+} // namespace grk
+HWY_AFTER_NAMESPACE();
+
+#if HWY_ONCE
+namespace grk
+{
+HWY_EXPORT(hwy_post_t1_decompress);
+
+PostT1DecompressFilter::PostT1DecompressFilter(DecompressBlockExec* block, bool ht)
+	: ht_(ht), reversible_(block->qmfbid == 1), roiShift_(block->roishift), shift_(0),
+	  scale_(0)
+{
+	if(ht)
+	{
+		if(reversible_)
+		{
+			shift_ = 31U - (block->k_msbs + 1U);
+		}
+		else
+		{
+			assert(block->bandNumbps <= 31);
+			scale_ = block->stepsize / (float)(1u << (31 - block->bandNumbps));
+		}
+	}
+	else if(!reversible_)
+	{
+		scale_ = block->stepsize / 2;
+	}
+}
+void PostT1DecompressFilter::copy(int32_t* dest, uint32_t destStride, const int32_t* src,
+								  uint32_t srcStride, uint32_t w, uint32_t h) const
+{
+	HWY_DYNAMIC_DISPATCH(hwy_post_t1_decompress)
+	(ht_, roiShift_ != 0, reversible_, dest, destStride, src, srcStride, w, h, roiShift_, shift_,
+	 scale_);
+}
+
+} // namespace grk
+#endif
@@ -0,0 +1,49 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#pragma once
+
+namespace grk
+{
+struct DecompressBlockExec;
+
+/**
+ * Dequantize decompressed code block samples on their way to the tile window.
+ *
+ * Optional ROI shift is applied first. Reversible samples are then shifted down,
+ * and irreversible samples are scaled to float. HT samples are in sign-magnitude form.
+ */
+class PostT1DecompressFilter
+{
+  public:
+	PostT1DecompressFilter(DecompressBlockExec* block, bool ht);
+	/**
+	 * Filter w x h block of samples. src and dest may be the same buffer,
+	 * for in place filtering
+	 */
+	void copy(int32_t* dest, uint32_t destStride, const int32_t* src, uint32_t srcStride,
+			  uint32_t w, uint32_t h) const;
+
+  private:
+	bool ht_;
+	bool reversible_;
+	uint32_t roiShift_;
+	uint32_t shift_;
+	float scale_;
+};
+
+} // namespace grk
@@ -18,9 +18,10 @@
 namespace grk
 {
 
-PrecinctImpl::PrecinctImpl(bool isCompressor, grk_rect32* bounds, grk_pt32 cblk_expn)
+PrecinctImpl::PrecinctImpl(bool isCompressor, grk_rect32* bounds, grk_pt32 cblk_expn,
+						   BlockArena* arena)
 	: enc(nullptr), dec(nullptr), bounds_(*bounds), cblk_expn_(cblk_expn),
-	  isCompressor_(isCompressor), incltree(nullptr), imsbtree(nullptr)
+	  isCompressor_(isCompressor), incltree(nullptr), imsbtree(nullptr), arena_(arena)
 {
 	cblk_grid_ =
 		grk_rect32(floordivpow2(bounds->x0, cblk_expn.x), floordivpow2(bounds->y0, cblk_expn.y),
@@ -57,9 +58,9 @@ bool PrecinctImpl::initCodeBlocks(uint16_t numLayers, grk_rect32* bounds)
 	if(!numBlocks)
 		return true;
 	if(isCompressor_)
-		enc = new BlockCache<CompressCodeblock, PrecinctImpl>(numLayers, numBlocks, this);
+		enc = new BlockCache<CompressCodeblock, PrecinctImpl>(numLayers, numBlocks, this, arena_);
 	else
-		dec = new BlockCache<DecompressCodeblock, PrecinctImpl>(numLayers, numBlocks, this);
+		dec = new BlockCache<DecompressCodeblock, PrecinctImpl>(numLayers, numBlocks, this, arena_);
 
 	return true;
 }
@@ -134,7 +135,9 @@ TagTreeU8* PrecinctImpl::getIMsbTagTree(void)
 Precinct::Precinct(TileProcessor* tileProcessor, const grk_rect32& bounds, grk_pt32 cblk_expn)
 	: grk_rect32(bounds), precinctIndex(0),
 	  numLayers_(tileProcessor->getTileCodingParams()->max_layers_),
-	  impl(new PrecinctImpl(tileProcessor->isCompressor(), this, cblk_expn)), cblk_expn_(cblk_expn)
+	  impl(new PrecinctImpl(tileProcessor->isCompressor(), this, cblk_expn,
+							tileProcessor->getBlockArena())),
+	  cblk_expn_(cblk_expn)
 
 {}
 Precinct::~Precinct()
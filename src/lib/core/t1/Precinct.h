@@ -22,15 +22,20 @@ template<typename T, typename P>
 class BlockCache : public SparseCache<T>
 {
   public:
-	BlockCache(uint16_t numLayers, uint64_t maxChunkSize, P* blockInitializer)
-		: SparseCache<T>(maxChunkSize), blockInitializer_(blockInitializer), numLayers_(numLayers)
+	BlockCache(uint16_t numLayers, uint64_t maxChunkSize, P* blockInitializer, BlockArena* arena)
+		: SparseCache<T>(maxChunkSize), blockInitializer_(blockInitializer), numLayers_(numLayers),
+		  arena_(arena)
 	{}
-	virtual ~BlockCache() = default;
+	virtual ~BlockCache()
+	{
+		// blocks live in the tile arena, so they are destroyed but not deleted
+		this->releaseItems([](T* item) { item->~T(); });
+	}
 
   protected:
 	virtual T* create(uint64_t index) override
 	{
-		auto item = new T(numLayers_);
+		auto item = arena_->create<T>(numLayers_, arena_);
 		blockInitializer_->initCodeBlock(item, index);
 		return item;
 	}
@@ -38,11 +43,12 @@ class BlockCache : public SparseCache<T>
   private:
 	P* blockInitializer_;
 	uint16_t numLayers_;
+	BlockArena* arena_;
 };
 
 struct PrecinctImpl
 {
-	PrecinctImpl(bool isCompressor, grk_rect32* bounds, grk_pt32 cblk_expn);
+	PrecinctImpl(bool isCompressor, grk_rect32* bounds, grk_pt32 cblk_expn, BlockArena* arena);
 	~PrecinctImpl(void);
 	grk_rect32 getCodeBlockBounds(uint64_t cblkno);
 	bool initCodeBlocks(uint16_t numLayers, grk_rect32* bounds);
@@ -61,6 +67,7 @@ struct PrecinctImpl
   private:
 	TagTreeU16* incltree; /* inclusion tree */
 	TagTreeU8* imsbtree; /* IMSB tree */
+	BlockArena* arena_;
 };
 struct Precinct : public grk_rect32
 {
@@ -1,5 +1,4 @@
 #pragma once
 
 #include "OJPH/T1OJPH.h"
-#include "OJPH/PostT1DecompressFiltersOJPH.h"
 #include "OJPH/QuantizerOJPH.h"
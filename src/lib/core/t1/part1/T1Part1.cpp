@@ -143,21 +143,35 @@ namespace t1_part1
 	bool T1Part1::decompress(DecompressBlockExec* block)
 	{
 		auto cblk = block->cblk;
-		cblk->alloc2d(true);
-		t1->attachUncompressedData(cblk->getBuffer(), cblk->width(), cblk->height());
+		uint32_t stride = 0;
+		auto dest = (cblk->isClosed() && !cblk->seg_buffers.empty())
+						? block->tilec->getInPlaceDest(block, &stride)
+						: nullptr;
+		if(dest)
+		{
+			// decompress straight into tile window, which must be zeroed first
+			for(uint32_t j = 0; j < cblk->height(); ++j)
+				memset(dest + (uint64_t)j * stride, 0, cblk->width() * sizeof(int32_t));
+			if(!t1->attachUncompressedData(dest, cblk->width(), cblk->height(), stride))
+				return false;
+		}
+		else
+		{
+			cblk->alloc2d(true);
+			t1->attachUncompressedData(cblk->getBuffer(), cblk->width(), cblk->height());
+		}
 		if(cblk->isClosed())
 		{
 			if(!cblk->seg_buffers.empty())
 			{
-				size_t totalSegLen =
-					cblk->getSegBuffersLen() + grk_cblk_dec_compressed_data_pad_right;
-				t1->allocCompressedData(totalSegLen);
-				size_t offset = 0;
-				auto compressedData = t1->getCompressedDataBuffer();
-				for(const auto& b : cblk->seg_buffers)
+				// MQ decoder never writes to compressed data, so adjacent segment
+				// buffers are decoded in place, straight from the code stream
+				auto compressedData = cblk->getContiguousSegBuffer();
+				if(!compressedData)
 				{
-					memcpy(compressedData + offset, b->buf, b->len);
-					offset += b->len;
+					t1->allocCompressedData(cblk->getSegBuffersLen());
+					compressedData = t1->getCompressedDataBuffer();
+					cblk->copyToContiguousBuffer(compressedData);
 				}
 				bool ret = t1->decompress_cblk(cblk, compressedData, block->bandOrientation,
 											   block->cblk_sty);
@@ -167,7 +181,10 @@ namespace t1_part1
 			}
 		}
 
-		block->tilec->postProcess(t1->getUncompressedData(), block);
+		if(dest)
+			block->tilec->postProcessInPlace(dest, stride, block, false);
+		else
+			block->tilec->postProcess(t1->getUncompressedData(), block);
 		cblk->release();
 
 		return true;
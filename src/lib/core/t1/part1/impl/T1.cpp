@@ -330,6 +330,16 @@ void T1::attachUncompressedData(int32_t* data, uint32_t width, uint32_t height)
 	uncompressedData = data;
 	alloc(width, height);
 }
+bool T1::attachUncompressedData(int32_t* data, uint32_t width, uint32_t height, uint32_t stride)
+{
+	deallocUncompressedData();
+	uncompressedData = data;
+	if(!alloc(width, height))
+		return false;
+	uncompressedDataStride = stride;
+
+	return true;
+}
 bool T1::alloc(uint32_t width, uint32_t height)
 {
 	if(width == 0 || height == 0)
@@ -940,6 +950,7 @@ double T1::compress_cblk(cblk_enc* cblk, uint32_t max, uint8_t orientation, uint
 #define dec_clnpass_internal(t1, bpno, vsc, w, h, flags_stride)                                  \
 	{                                                                                            \
 		const uint32_t l_w = w;                                                                  \
+		const uint32_t l_stride = t1->uncompressedDataStride;                                    \
 		auto mqc = &(t1->coder);                                                                 \
 		auto data = t1->uncompressedData;                                                        \
 		auto flagsp = &t1->flags[flags_stride + 1];                                              \
@@ -948,7 +959,7 @@ double T1::compress_cblk(cblk_enc* cblk, uint32_t max, uint8_t orientation, uint
 		int32_t half = one >> 1;                                                                 \
 		int32_t oneplushalf = one | half;                                                        \
 		uint32_t k;                                                                              \
-		for(k = 0; k < (h & ~3u); k += 4, data += 3 * l_w, flagsp += 2)                          \
+		for(k = 0; k < (h & ~3u); k += 4, data += 4 * l_stride - l_w, flagsp += 2)               \
 		{                                                                                        \
 			for(uint32_t i = 0; i < l_w; ++i, ++data, ++flagsp)                                  \
 			{                                                                                    \
@@ -970,35 +981,35 @@ double T1::compress_cblk(cblk_enc* cblk, uint32_t max, uint8_t orientation, uint
 					{                                                                            \
 						case 0:                                                                  \
 							dec_clnpass_step_macro(false, true, _flags, flagsp, flags_stride,    \
-												   data, l_w, 0, 0, vsc);                        \
+												   data, l_stride, 0, 0, vsc);                   \
 							partial = false;                                                     \
 							/* FALLTHRU */                                                       \
 						case 1:                                                                  \
 							dec_clnpass_step_macro(false, partial, _flags, flagsp, flags_stride, \
-												   data, l_w, 1, 3, false);                      \
+												   data, l_stride, 1, 3, false);                 \
 							partial = false;                                                     \
 							/* FALLTHRU */                                                       \
 						case 2:                                                                  \
 							dec_clnpass_step_macro(false, partial, _flags, flagsp, flags_stride, \
-												   data, l_w, 2, 6, false);                      \
+												   data, l_stride, 2, 6, false);                 \
 							partial = false;                                                     \
 							/* FALLTHRU */                                                       \
 						case 3:                                                                  \
 							dec_clnpass_step_macro(false, partial, _flags, flagsp, flags_stride, \
-												   data, l_w, 3, 9, false);                      \
+												   data, l_stride, 3, 9, false);                 \
 							break;                                                               \
 					}                                                                            \
 				}                                                                                \
 				else                                                                             \
 				{                                                                                \
-					dec_clnpass_step_macro(true, false, _flags, flagsp, flags_stride, data, l_w, \
-										   0, 0, vsc);                                           \
-					dec_clnpass_step_macro(true, false, _flags, flagsp, flags_stride, data, l_w, \
-										   1, 3, false);                                         \
-					dec_clnpass_step_macro(true, false, _flags, flagsp, flags_stride, data, l_w, \
-										   2, 6, false);                                         \
-					dec_clnpass_step_macro(true, false, _flags, flagsp, flags_stride, data, l_w, \
-										   3, 9, false);                                         \
+					dec_clnpass_step_macro(true, false, _flags, flagsp, flags_stride, data,      \
+										   l_stride, 0, 0, vsc);                                 \
+					dec_clnpass_step_macro(true, false, _flags, flagsp, flags_stride, data,      \
+										   l_stride, 1, 3, false);                               \
+					dec_clnpass_step_macro(true, false, _flags, flagsp, flags_stride, data,      \
+										   l_stride, 2, 6, false);                               \
+					dec_clnpass_step_macro(true, false, _flags, flagsp, flags_stride, data,      \
+										   l_stride, 3, 9, false);                               \
 				}                                                                                \
 				*flagsp = _flags & ~(T1_PI_0 | T1_PI_1 | T1_PI_2 | T1_PI_3);                     \
 			}                                                                                    \
@@ -1008,8 +1019,8 @@ double T1::compress_cblk(cblk_enc* cblk, uint32_t max, uint8_t orientation, uint
 			for(uint32_t i = 0; i < l_w; ++i, ++flagsp, ++data)                                  \
 			{                                                                                    \
 				for(uint32_t j = 0; j < h - k; ++j)                                              \
-					dec_clnpass_step_macro(true, false, *flagsp, flagsp, w + 2U, data + j * l_w, \
-										   0, j, j * 3, vsc);                                    \
+					dec_clnpass_step_macro(true, false, *flagsp, flagsp, w + 2U,                 \
+										   data + j * l_stride, 0, j, j * 3, vsc);               \
 				*flagsp &= ~(T1_PI_0 | T1_PI_1 | T1_PI_2 | T1_PI_3);                             \
 			}                                                                                    \
 		}                                                                                        \
@@ -1098,6 +1109,7 @@ void T1::dec_sigpass_raw(int32_t bpno, int32_t cblksty)
 	int32_t one, half, oneplushalf;
 	auto flagsp = flags + 1 + (w + 2);
 	const uint32_t l_w = w;
+	const uint32_t l_stride = uncompressedDataStride;
 	auto dataPtr = uncompressedData;
 
 	one = 1 << bpno;
@@ -1105,61 +1117,62 @@ void T1::dec_sigpass_raw(int32_t bpno, int32_t cblksty)
 	oneplushalf = one | half;
 
 	uint32_t k;
-	for(k = 0; k < (h & ~3U); k += 4, flagsp += 2, dataPtr += 3 * l_w)
+	for(k = 0; k < (h & ~3U); k += 4, flagsp += 2, dataPtr += 4 * l_stride - l_w)
 	{
 		for(uint32_t i = 0; i < l_w; ++i, ++flagsp, ++dataPtr)
 		{
 			if(*flagsp != 0)
 			{
 				dec_sigpass_step_raw(flagsp, dataPtr, oneplushalf, cblksty & GRK_CBLKSTY_VSC, 0U);
-				dec_sigpass_step_raw(flagsp, dataPtr + l_w, oneplushalf, false, 3U);
-				dec_sigpass_step_raw(flagsp, dataPtr + 2 * l_w, oneplushalf, false, 6U);
-				dec_sigpass_step_raw(flagsp, dataPtr + 3 * l_w, oneplushalf, false, 9U);
+				dec_sigpass_step_raw(flagsp, dataPtr + l_stride, oneplushalf, false, 3U);
+				dec_sigpass_step_raw(flagsp, dataPtr + 2 * l_stride, oneplushalf, false, 6U);
+				dec_sigpass_step_raw(flagsp, dataPtr + 3 * l_stride, oneplushalf, false, 9U);
 			}
 		}
 	}
 	if(k < h)
 		for(uint32_t i = 0; i < l_w; ++i, ++flagsp, ++dataPtr)
 			for(uint32_t j = 0; j < h - k; ++j)
-				dec_sigpass_step_raw(flagsp, dataPtr + j * l_w, oneplushalf,
+				dec_sigpass_step_raw(flagsp, dataPtr + j * l_stride, oneplushalf,
 									 cblksty & GRK_CBLKSTY_VSC, 3 * j);
 }
-#define dec_sigpass_mqc_internal(bpno, vsc, w, h, flags_stride)                                  \
-	{                                                                                            \
-		auto dataPtr = uncompressedData;                                                         \
-		auto flagsp = &flags[(flags_stride) + 1];                                                \
-		const uint32_t l_w = w;                                                                  \
-		auto mqc = &(coder);                                                                     \
-		PUSH_MQC();                                                                              \
-		int32_t one = 1 << bpno;                                                                 \
-		int32_t half = one >> 1;                                                                 \
-		int32_t oneplushalf = one | half;                                                        \
-		uint32_t k;                                                                              \
-		for(k = 0; k < (h & ~3u); k += 4, dataPtr += 3 * l_w, flagsp += 2)                       \
-		{                                                                                        \
-			for(uint32_t i = 0; i < l_w; ++i, ++dataPtr, ++flagsp)                               \
-			{                                                                                    \
-				grk_flag _flags = *flagsp;                                                       \
-				if(_flags != 0)                                                                  \
-				{                                                                                \
-					dec_sigpass_step_mqc_macro(_flags, flagsp, flags_stride, dataPtr, l_w, 0, 0, \
-											   vsc);                                             \
-					dec_sigpass_step_mqc_macro(_flags, flagsp, flags_stride, dataPtr, l_w, 1, 3, \
-											   false);                                           \
-					dec_sigpass_step_mqc_macro(_flags, flagsp, flags_stride, dataPtr, l_w, 2, 6, \
-											   false);                                           \
-					dec_sigpass_step_mqc_macro(_flags, flagsp, flags_stride, dataPtr, l_w, 3, 9, \
-											   false);                                           \
-					*flagsp = _flags;                                                            \
-				}                                                                                \
-			}                                                                                    \
-		}                                                                                        \
-		if(k < h)                                                                                \
-			for(uint32_t i = 0; i < l_w; ++i, ++dataPtr, ++flagsp)                               \
-				for(uint32_t j = 0; j < h - k; ++j)                                              \
-					dec_sigpass_step_mqc_macro(*flagsp, flagsp, flags_stride, dataPtr + j * l_w, \
-											   0, j, 3 * j, vsc);                                \
-		POP_MQC();                                                                               \
+#define dec_sigpass_mqc_internal(bpno, vsc, w, h, flags_stride)                           \
+	{                                                                                     \
+		auto dataPtr = uncompressedData;                                                  \
+		auto flagsp = &flags[(flags_stride) + 1];                                         \
+		const uint32_t l_w = w;                                                           \
+		const uint32_t l_stride = uncompressedDataStride;                                 \
+		auto mqc = &(coder);                                                              \
+		PUSH_MQC();                                                                       \
+		int32_t one = 1 << bpno;                                                          \
+		int32_t half = one >> 1;                                                          \
+		int32_t oneplushalf = one | half;                                                 \
+		uint32_t k;                                                                       \
+		for(k = 0; k < (h & ~3u); k += 4, dataPtr += 4 * l_stride - l_w, flagsp += 2)     \
+		{                                                                                 \
+			for(uint32_t i = 0; i < l_w; ++i, ++dataPtr, ++flagsp)                        \
+			{                                                                             \
+				grk_flag _flags = *flagsp;                                                \
+				if(_flags != 0)                                                           \
+				{                                                                         \
+					dec_sigpass_step_mqc_macro(_flags, flagsp, flags_stride, dataPtr,     \
+											   l_stride, 0, 0, vsc);                      \
+					dec_sigpass_step_mqc_macro(_flags, flagsp, flags_stride, dataPtr,     \
+											   l_stride, 1, 3, false);                    \
+					dec_sigpass_step_mqc_macro(_flags, flagsp, flags_stride, dataPtr,     \
+											   l_stride, 2, 6, false);                    \
+					dec_sigpass_step_mqc_macro(_flags, flagsp, flags_stride, dataPtr,     \
+											   l_stride, 3, 9, false);                    \
+					*flagsp = _flags;                                                     \
+				}                                                                         \
+			}                                                                             \
+		}                                                                                 \
+		if(k < h)                                                                         \
+			for(uint32_t i = 0; i < l_w; ++i, ++dataPtr, ++flagsp)                        \
+				for(uint32_t j = 0; j < h - k; ++j)                                       \
+					dec_sigpass_step_mqc_macro(*flagsp, flagsp, flags_stride,             \
+											   dataPtr + j * l_stride, 0, j, 3 * j, vsc); \
+		POP_MQC();                                                                        \
 	}
 void T1::dec_sigpass_mqc(int32_t bpno, int32_t cblksty)
 {
@@ -1197,60 +1210,62 @@ void T1::dec_refpass_raw(int32_t bpno)
 	auto dataPtr = uncompressedData;
 	auto flagsp = flags + 1 + (w + 2);
 	const uint32_t l_w = w;
+	const uint32_t l_stride = uncompressedDataStride;
 
 	int32_t one = 1 << bpno;
 	int32_t poshalf = one >> 1;
 	uint32_t k;
-	for(k = 0; k < (h & ~3U); k += 4, flagsp += 2, dataPtr += 3 * l_w)
+	for(k = 0; k < (h & ~3U); k += 4, flagsp += 2, dataPtr += 4 * l_stride - l_w)
 	{
 		for(uint32_t i = 0; i < l_w; ++i, ++flagsp, ++dataPtr)
 		{
 			if(*flagsp != 0)
 			{
 				dec_refpass_step_raw(flagsp, dataPtr, poshalf, 0U);
-				dec_refpass_step_raw(flagsp, dataPtr + l_w, poshalf, 3U);
-				dec_refpass_step_raw(flagsp, dataPtr + 2 * l_w, poshalf, 6U);
-				dec_refpass_step_raw(flagsp, dataPtr + 3 * l_w, poshalf, 9U);
+				dec_refpass_step_raw(flagsp, dataPtr + l_stride, poshalf, 3U);
+				dec_refpass_step_raw(flagsp, dataPtr + 2 * l_stride, poshalf, 6U);
+				dec_refpass_step_raw(flagsp, dataPtr + 3 * l_stride, poshalf, 9U);
 			}
 		}
 	}
 	if(k < h)
 		for(uint32_t i = 0; i < l_w; ++i, ++flagsp, ++dataPtr)
 			for(uint32_t j = 0; j < h - k; ++j)
-				dec_refpass_step_raw(flagsp, dataPtr + j * l_w, poshalf, 3 * j);
+				dec_refpass_step_raw(flagsp, dataPtr + j * l_stride, poshalf, 3 * j);
 }
-#define dec_refpass_mqc_internal(bpno, w, h, flags_stride)                              \
-	{                                                                                   \
-		auto dataPtr = uncompressedData;                                                \
-		auto flagsp = flags + flags_stride + 1;                                         \
-		const uint32_t l_w = w;                                                         \
-		auto mqc = &(coder);                                                            \
-		PUSH_MQC();                                                                     \
-		int32_t one = 1 << bpno;                                                        \
-		int32_t poshalf = one >> 1;                                                     \
-		uint32_t k;                                                                     \
-		for(k = 0; k < (h & ~3u); k += 4, dataPtr += 3 * l_w, flagsp += 2)              \
-		{                                                                               \
-			for(uint32_t i = 0; i < l_w; ++i, ++dataPtr, ++flagsp)                      \
-			{                                                                           \
-				auto _flags = *flagsp;                                                  \
-				if(_flags != 0)                                                         \
-				{                                                                       \
-					dec_refpass_step_mqc_macro(_flags, dataPtr, l_w, 0, 0);             \
-					dec_refpass_step_mqc_macro(_flags, dataPtr, l_w, 1, 3);             \
-					dec_refpass_step_mqc_macro(_flags, dataPtr, l_w, 2, 6);             \
-					dec_refpass_step_mqc_macro(_flags, dataPtr, l_w, 3, 9);             \
-					*flagsp = _flags;                                                   \
-				}                                                                       \
-			}                                                                           \
-		}                                                                               \
-		if(k < h)                                                                       \
-			for(uint32_t i = 0; i < l_w; ++i, ++dataPtr, ++flagsp)                      \
-				for(uint32_t j = 0; j < h - k; ++j)                                     \
-				{                                                                       \
-					dec_refpass_step_mqc_macro(*flagsp, dataPtr + j * l_w, 0, j, j * 3) \
-				}                                                                       \
-		POP_MQC();                                                                      \
+#define dec_refpass_mqc_internal(bpno, w, h, flags_stride)                                   \
+	{                                                                                        \
+		auto dataPtr = uncompressedData;                                                     \
+		auto flagsp = flags + flags_stride + 1;                                              \
+		const uint32_t l_w = w;                                                              \
+		const uint32_t l_stride = uncompressedDataStride;                                    \
+		auto mqc = &(coder);                                                                 \
+		PUSH_MQC();                                                                          \
+		int32_t one = 1 << bpno;                                                             \
+		int32_t poshalf = one >> 1;                                                          \
+		uint32_t k;                                                                          \
+		for(k = 0; k < (h & ~3u); k += 4, dataPtr += 4 * l_stride - l_w, flagsp += 2)        \
+		{                                                                                    \
+			for(uint32_t i = 0; i < l_w; ++i, ++dataPtr, ++flagsp)                           \
+			{                                                                                \
+				auto _flags = *flagsp;                                                       \
+				if(_flags != 0)                                                              \
+				{                                                                            \
+					dec_refpass_step_mqc_macro(_flags, dataPtr, l_stride, 0, 0);             \
+					dec_refpass_step_mqc_macro(_flags, dataPtr, l_stride, 1, 3);             \
+					dec_refpass_step_mqc_macro(_flags, dataPtr, l_stride, 2, 6);             \
+					dec_refpass_step_mqc_macro(_flags, dataPtr, l_stride, 3, 9);             \
+					*flagsp = _flags;                                                        \
+				}                                                                            \
+			}                                                                                \
+		}                                                                                    \
+		if(k < h)                                                                            \
+			for(uint32_t i = 0; i < l_w; ++i, ++dataPtr, ++flagsp)                           \
+				for(uint32_t j = 0; j < h - k; ++j)                                          \
+				{                                                                            \
+					dec_refpass_step_mqc_macro(*flagsp, dataPtr + j * l_stride, 0, j, j * 3) \
+				}                                                                            \
+		POP_MQC();                                                                           \
 	}
 void T1::dec_refpass_mqc(int32_t bpno)
 {
@@ -1316,7 +1331,6 @@ bool T1::decompress_cblk(DecompressCodeblock* cblk, uint8_t* compressedData, uin
 				bpno_plus_one--;
 			}
 		}
-		mqc_finish_dec(mqc);
 	}
 	if(check_pterm)
 	{
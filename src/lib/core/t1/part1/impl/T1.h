@@ -44,6 +44,11 @@ struct T1
 
 	int32_t* getUncompressedData(void);
 	void attachUncompressedData(int32_t* data, uint32_t w, uint32_t h);
+	/**
+	 * Attach external zeroed buffer with row stride, so that code block
+	 * is decompressed in place, for example directly into tile window
+	 */
+	bool attachUncompressedData(int32_t* data, uint32_t w, uint32_t h, uint32_t stride);
 	void allocCompressedData(size_t len);
 	uint8_t* getCompressedDataBuffer(void);
 	static double getnorm(uint32_t level, uint8_t orientation, bool reversible);
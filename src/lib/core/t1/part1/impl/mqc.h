@@ -68,8 +68,6 @@ struct mqcoder
 	const mqc_state** curctx;
 	/* lut_ctxno_zc shifted by (1 << 9) * bandIndex */
 	const uint8_t* lut_ctxno_zc_orient;
-	/** Original value of the 2 bytes at end[0] and end[1] */
-	uint8_t backup[grk_cblk_dec_compressed_data_pad_right];
 #ifdef PLUGIN_DEBUG_ENCODE
 	grk_plugin_debug_mqc debug_mqc;
 #endif
@@ -102,16 +100,11 @@ void mqc_segmark_enc(mqcoder* mqc);
 /**
 Initialize the decoder for MQ decoding.
 
-mqc_finish_dec() must be absolutely called after finishing the decoding
-passes, so as to restore the bytes temporarily overwritten.
-
 @param mqc MQC handle
-@param bp Pointer to the start of the buffer from which the bytes will be read
-		  Note that OPJ_COMMON_CBLK_DATA_EXTRA bytes at the end of the buffer
-		  will be temporarily overwritten with an artificial 0xFF 0xFF marker.
-		  (they will be backuped in the mqc structure to be restored later)
-		  So bp must be at least len + OPJ_COMMON_CBLK_DATA_EXTRA large, and
-		  writable.
+@param bp Pointer to the start of the buffer from which the bytes will be read.
+		  The buffer is never written to, so it may point directly into
+		  read-only (e.g. memory mapped) code stream data. Bytes at and beyond
+		  the end of the buffer are read as an artificial 0xFF 0xFF marker.
 @param len Length of the input buffer
 */
 void mqc_init_dec(mqcoder* mqc, uint8_t* bp, uint32_t len);
@@ -119,28 +112,11 @@ void mqc_init_dec(mqcoder* mqc, uint8_t* bp, uint32_t len);
 /**
 Initialize the decoder for RAW decoding.
 
-mqc_finish_dec() must be absolutely called after finishing the decoding
-passes, so as to restore the bytes temporarily overwritten.
-
 @param mqc MQC handle
-@param bp Pointer to the start of the buffer from which the bytes will be read
-		  Note that OPJ_COMMON_CBLK_DATA_EXTRA bytes at the end of the buffer
-		  will be temporarily overwritten with an artificial 0xFF 0xFF marker.
-		  (they will be backuped in the mqc structure to be restored later)
-		  So bp must be at least len + OPJ_COMMON_CBLK_DATA_EXTRA large, and
-		  writable.
+@param bp Pointer to the start of the buffer from which the bytes will be read.
+		  As with mqc_init_dec(), the buffer is never written to.
 @param len Length of the input buffer
 */
 void mqc_raw_init_dec(mqcoder* mqc, uint8_t* bp, uint32_t len);
 
-/**
-Terminate RAW/MQC decoding
-
-This restores the bytes temporarily overwritten by mqc_init_dec()/
-mqc_raw_init_dec()
-
-@param mqc MQC handle
-*/
-void mqc_finish_dec(mqcoder* mqc);
-
 } // namespace grk
@@ -79,13 +79,6 @@ static void mqc_init_dec_common(mqcoder* mqc, uint8_t* bp, uint32_t len)
 {
 	mqc->start = bp;
 	mqc->end = bp + len;
-	/* Insert an artificial 0xFF 0xFF marker at end of the code block */
-	/* data so that the bytein routines stop on it. This saves us comparing */
-	/* the bp and end pointers */
-	/* But before inserting it, backup the bytes we will overwrite */
-	memcpy(mqc->backup, mqc->end, grk_cblk_dec_compressed_data_pad_right);
-	mqc->end[0] = 0xFF;
-	mqc->end[1] = 0xFF;
 	mqc->bp = bp;
 }
 void mqc_init_dec(mqcoder* mqc, uint8_t* bp, uint32_t len)
@@ -111,12 +104,6 @@ void mqc_raw_init_dec(mqcoder* mqc, uint8_t* bp, uint32_t len)
 	mqc->ct = 0;
 }
 
-void mqc_finish_dec(mqcoder* mqc)
-{
-	/* Restore the bytes overwritten by mqc_init_dec_common() */
-	memcpy(mqc->end, mqc->backup, grk_cblk_dec_compressed_data_pad_right);
-}
-
 void mqc_resetstates(mqcoder* mqc)
 {
 	for(uint32_t i = 0; i < MQC_NUMCTXS; i++)
@@ -62,25 +62,26 @@ static INLINE uint32_t mqc_raw_decode(mqcoder* mqc)
 {
 	if(mqc->ct == 0)
 	{
-		/* Given mqc_raw_init_dec() we know that at some point we will */
-		/* have a 0xFF 0xFF artificial marker */
+		/* bytes at and beyond end of buffer are read as an */
+		/* artificial 0xFF 0xFF marker */
+		uint32_t b = mqc->bp < mqc->end ? *mqc->bp : 0xff;
 		if(mqc->c == 0xff)
 		{
-			if(*mqc->bp > 0x8f)
+			if(b > 0x8f)
 			{
 				mqc->c = 0xff;
 				mqc->ct = 8;
 			}
 			else
 			{
-				mqc->c = *mqc->bp;
+				mqc->c = b;
 				mqc->bp++;
 				mqc->ct = 7;
 			}
 		}
 		else
 		{
-			mqc->c = *mqc->bp;
+			mqc->c = b;
 			mqc->bp++;
 			mqc->ct = 8;
 		}
@@ -90,32 +91,43 @@ static INLINE uint32_t mqc_raw_decode(mqcoder* mqc)
 	return ((uint32_t)mqc->c >> mqc->ct) & 0x01U;
 }
 
-#define bytein_dec_macro(mqc, c, ct)                                  \
-	{                                                                 \
-		/* Given mqc_init_dec() we know that at some point we will */ \
-		/* have a 0xFF 0xFF artificial marker */                      \
-		uint32_t l_c = *(mqc->bp + 1);                                \
-		if(*mqc->bp == 0xff)                                          \
-		{                                                             \
-			if(l_c > 0x8f)                                            \
-			{                                                         \
-				c += 0xff00;                                          \
-				ct = 8;                                               \
-				mqc->end_of_byte_stream_counter++;                    \
-			}                                                         \
-			else                                                      \
-			{                                                         \
-				mqc->bp++;                                            \
-				c += l_c << 9;                                        \
-				ct = 7;                                               \
-			}                                                         \
-		}                                                             \
-		else                                                          \
-		{                                                             \
-			mqc->bp++;                                                \
-			c += l_c << 8;                                            \
-			ct = 8;                                                   \
-		}                                                             \
+#define bytein_dec_macro(mqc, c, ct)                                      \
+	{                                                                     \
+		/* bytes at and beyond end of buffer are read as an */            \
+		/* artificial 0xFF 0xFF marker, so that the buffer, which */      \
+		/* may be read-only, is never written to */                       \
+		uint32_t l_b = 0xff;                                              \
+		uint32_t l_c = 0xff;                                              \
+		if(mqc->bp + 1 < mqc->end)                                        \
+		{                                                                 \
+			l_b = *mqc->bp;                                               \
+			l_c = *(mqc->bp + 1);                                         \
+		}                                                                 \
+		else if(mqc->bp < mqc->end)                                       \
+		{                                                                 \
+			l_b = *mqc->bp;                                               \
+		}                                                                 \
+		if(l_b == 0xff)                                                   \
+		{                                                                 \
+			if(l_c > 0x8f)                                                \
+			{                                                             \
+				c += 0xff00;                                              \
+				ct = 8;                                                   \
+				mqc->end_of_byte_stream_counter++;                        \
+			}                                                             \
+			else                                                          \
+			{                                                             \
+				mqc->bp++;                                                \
+				c += l_c << 9;                                            \
+				ct = 7;                                                   \
+			}                                                             \
+		}                                                                 \
+		else                                                              \
+		{                                                                 \
+			mqc->bp++;                                                    \
+			c += l_c << 8;                                                \
+			ct = 8;                                                       \
+		}                                                                 \
 	}
 
 /* For internal use of decompress_macro() */
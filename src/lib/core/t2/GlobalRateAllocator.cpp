@@ -0,0 +1,199 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "grk_includes.h"
+
+namespace grk
+{
+// SOT marker segment and SOD marker
+const uint32_t tilePartHeaderBytes = sot_marker_segment_len_minus_tile_data_len + 2;
+
+GlobalRateAllocator::GlobalRateAllocator(const std::vector<TileProcessor*>& tileProcessors)
+	: tileProcessors_(tileProcessors), tileBytes_(tileProcessors.size())
+{}
+bool GlobalRateAllocator::forEachTile(std::function<bool(TileProcessor*, size_t)> func)
+{
+	std::atomic<bool> success(true);
+	tf::Taskflow taskflow;
+	for(size_t i = 0; i < tileProcessors_.size(); ++i)
+	{
+		taskflow.emplace([this, i, &func, &success] {
+			if(!func(tileProcessors_[i], i))
+				success = false;
+		});
+	}
+	ExecSingleton::run(taskflow);
+
+	return success;
+}
+bool GlobalRateAllocator::simulate(uint16_t layno, uint16_t thresh, uint64_t* allPacketBytes)
+{
+	if(!forEachTile([this, layno, thresh](TileProcessor* tileProcessor, size_t i) {
+		   return tileProcessor->simulateLayer(layno, thresh, &tileBytes_[i]);
+	   }))
+		return false;
+	*allPacketBytes = 0;
+	for(auto bytes : tileBytes_)
+		*allPacketBytes += bytes;
+
+	return true;
+}
+bool GlobalRateAllocator::allocate(void)
+{
+	if(tileProcessors_.empty())
+		return true;
+	const double K = 1;
+	auto reference = tileProcessors_.front();
+	auto encodingParams = &reference->cp_->coding_params_.enc_;
+	auto numLayers = reference->getTileCodingParams()->max_layers_;
+
+	// 1. feasible truncation points for all tiles
+	std::vector<double> tileMaxSE(tileProcessors_.size());
+	if(!forEachTile([&tileMaxSE](TileProcessor* tileProcessor, size_t i) {
+		   tileMaxSE[i] = tileProcessor->prepareRateControl();
+		   return true;
+	   }))
+		return false;
+	double maxSE = 0;
+	double distortion = 0;
+	uint64_t numPacketsPerLayer = 0;
+	for(size_t i = 0; i < tileProcessors_.size(); ++i)
+	{
+		auto tileProcessor = tileProcessors_[i];
+		maxSE += tileMaxSE[i];
+		distortion += tileProcessor->getTile()->distortion;
+		numPacketsPerLayer += tileProcessor->getNumPacketsPerLayer();
+	}
+
+	// 2. form layers with one threshold per layer for all tiles
+	RateEstimator estimator;
+	uint16_t upperBound = USHRT_MAX;
+	// exact number of bytes in all layers formed so far, over all tiles
+	uint64_t previousBytes = 0;
+	double cumulativeDistortion = 0;
+	for(uint16_t layno = 0; layno < numLayers; layno++)
+	{
+		if(!reference->layerNeedsRateControl(layno))
+		{
+			for(auto tileProcessor : tileProcessors_)
+				tileProcessor->makeLayerFinal(layno);
+			continue;
+		}
+		estimator.reset(numPacketsPerLayer, reference->getPacketOverhead());
+		for(auto tileProcessor : tileProcessors_)
+			tileProcessor->addToRateEstimator(&estimator, layno);
+		estimator.finalize();
+		uint16_t thresh;
+		if(encodingParams->allocationByFixedQuality_)
+		{
+			double distortionTarget =
+				distortion -
+				((K * maxSE) /
+				 pow(10.0, reference->getTileCodingParams()->distortion[layno] / 10.0));
+			thresh = estimator.getThreshForDistortion(distortionTarget - cumulativeDistortion,
+													  upperBound);
+		}
+		else
+		{
+			// image-wide budget is the sum of the per-tile budgets, less the
+			// SOT and SOD markers of each tile's first tile part
+			uint64_t maxLayerLength = 0;
+			for(auto tileProcessor : tileProcessors_)
+			{
+				auto tileBytes =
+					(uint64_t)ceil(tileProcessor->getTileCodingParams()->rates[layno]);
+				if(tileBytes > tilePartHeaderBytes)
+					maxLayerLength += tileBytes - tilePartHeaderBytes;
+			}
+
+			// last threshold simulated, and its exact size
+			uint32_t simulatedThresh = USHRT_MAX + 1U;
+			uint64_t simulatedBytes = 0;
+			auto measure = [&](uint16_t t) {
+				if(!simulate(layno, t, &simulatedBytes))
+					return false;
+				simulatedThresh = t;
+				return true;
+			};
+			uint64_t layerBudget =
+				maxLayerLength > previousBytes ? maxLayerLength - previousBytes : 0;
+			thresh = estimator.getThreshForBytes(layerBudget, upperBound);
+			// 1. measure exact size at estimated threshold
+			if(!measure(thresh))
+				return false;
+			int64_t error = (int64_t)simulatedBytes - (int64_t)previousBytes -
+							(int64_t)estimator.getBytes(thresh);
+			int64_t correctedBudget = (int64_t)layerBudget - error;
+			uint16_t corrected =
+				correctedBudget > 0
+					? estimator.getThreshForBytes((uint64_t)correctedBudget, upperBound)
+					: upperBound;
+			bool fits = simulatedBytes <= maxLayerLength;
+			if(fits)
+			{
+				// 2a. estimate was conservative: spend the measured slack
+				if(corrected < thresh)
+				{
+					if(!measure(corrected))
+						return false;
+					if(simulatedBytes <= maxLayerLength)
+						thresh = corrected;
+				}
+			}
+			else if(thresh < upperBound)
+			{
+				// 2b. estimate was optimistic: remove the measured excess
+				thresh = std::max<uint16_t>(corrected, (uint16_t)(thresh + 1U));
+				if(!measure(thresh))
+					return false;
+				fits = simulatedBytes <= maxLayerLength;
+			}
+			// 3. fall back to bisection above the current threshold
+			if(!fits)
+			{
+				uint32_t lowerBound = thresh;
+				uint32_t upper = upperBound;
+				while(upper - lowerBound > 1)
+				{
+					uint32_t mid = (lowerBound + upper) >> 1;
+					if(!measure((uint16_t)mid))
+						return false;
+					if(simulatedBytes <= maxLayerLength)
+						upper = mid;
+					else
+						lowerBound = mid;
+				}
+				thresh = (uint16_t)upper;
+			}
+			if(simulatedThresh != thresh && !measure(thresh))
+				return false;
+			previousBytes = simulatedBytes;
+		}
+		for(auto tileProcessor : tileProcessors_)
+		{
+			tileProcessor->makeLayerFeasible(layno, thresh, true);
+			cumulativeDistortion += tileProcessor->getTile()->layerDistoration[layno];
+		}
+		upperBound = thresh;
+	}
+
+	// 3. PLT markers and tile lengths
+	return forEachTile(
+		[](TileProcessor* tileProcessor, size_t) { return tileProcessor->finalizeRateControl(); });
+}
+
+} // namespace grk
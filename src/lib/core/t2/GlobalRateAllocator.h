@@ -0,0 +1,59 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <vector>
+#include <functional>
+
+namespace grk
+{
+/**
+ * Image-wide PCRD rate control.
+ *
+ * Once T1 has completed for all tiles, a single slope threshold per layer
+ * is chosen for the whole image, so that the image-wide byte budget (or quality target)
+ * is met with the smallest image-wide distortion. Per-tile allocation, by contrast,
+ * gives every tile a budget proportional to its area, whatever its content.
+ */
+class GlobalRateAllocator
+{
+  public:
+	explicit GlobalRateAllocator(const std::vector<TileProcessor*>& tileProcessors);
+	/**
+	 * Form all layers for all tiles, and pre-calculate tile lengths
+	 * @return true if successful
+	 */
+	bool allocate(void);
+
+  private:
+	/**
+	 * Simulate T2 for all tiles in parallel, with layer formed at threshold
+	 * @param layno layer number
+	 * @param thresh threshold
+	 * @param allPacketBytes total bytes in all tiles, for all layers up to and including layno
+	 */
+	bool simulate(uint16_t layno, uint16_t thresh, uint64_t* allPacketBytes);
+	/**
+	 * Run function on all tiles in parallel
+	 */
+	bool forEachTile(std::function<bool(TileProcessor*, size_t)> func);
+
+	const std::vector<TileProcessor*>& tileProcessors_;
+	std::vector<uint32_t> tileBytes_;
+};
+
+} // namespace grk
@@ -407,7 +407,8 @@ void PacketParser::readData(void)
 						cblk->cleanUpSegBuffers();
 					seg->numBytesInPacket = 0;
 					seg->numpasses = 0;
-					break;
+					// data of remaining code blocks in packet lies past the end as well
+					goto finish;
 				}
 				if(seg->numBytesInPacket)
 				{
@@ -423,8 +424,7 @@ void PacketParser::readData(void)
 					// correct for truncated packet
 					if(seg->numBytesInPacket > remainingTilePartBytes_)
 						seg->numBytesInPacket = (uint32_t)remainingTilePartBytes_;
-					cblk->seg_buffers.push_back(
-						new grk_buf8(data_ + offset, seg->numBytesInPacket, false));
+					cblk->addSegBuffer(data_ + offset, seg->numBytesInPacket);
 					offset += seg->numBytesInPacket;
 					cblk->compressedStream.len += seg->numBytesInPacket;
 					seg->len += seg->numBytesInPacket;
@@ -490,6 +490,22 @@ void PrecinctPacketParsers::pushParser(PacketParser* parser)
 	parsers_[numParsers_++] = parser;
 }
 
+void PrecinctPacketParsers::readPackets(void)
+{
+	for(uint16_t j = 0; j < numParsers_; ++j)
+	{
+		try
+		{
+			parsers_[j]->readHeader();
+			parsers_[j]->readData();
+		}
+		catch([[maybe_unused]] const std::exception& ex)
+		{
+			break;
+		}
+	}
+}
+
 ParserMap::ParserMap(TileProcessor* tileProcessor) : tileProcessor_(tileProcessor) {}
 
 ParserMap::~ParserMap()
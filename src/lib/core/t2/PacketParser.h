@@ -66,6 +66,11 @@ struct PrecinctPacketParsers
 	PrecinctPacketParsers(TileProcessor* tileProcessor);
 	~PrecinctPacketParsers(void);
 	void pushParser(PacketParser* parser);
+	/**
+	 * Read headers and data of all packets in precinct, in layer order,
+	 * stopping at first corrupt packet
+	 */
+	void readPackets(void);
 	TileProcessor* tileProcessor_;
 	PacketParser** parsers_;
 	uint16_t numParsers_;
@@ -0,0 +1,159 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "grk_includes.h"
+
+namespace grk
+{
+const uint32_t numSlopes = USHRT_MAX + 1;
+
+RateEstimator::RateEstimator()
+	: bits_(numSlopes), distortion_(numSlopes), cumulativeBits_(numSlopes),
+	  cumulativeDistortion_(numSlopes), fixedBits_(0), fixedBytes_(0), minSlope_(USHRT_MAX),
+	  maxSlope_(0)
+{}
+void RateEstimator::reset(uint64_t numPackets, uint32_t packetOverhead)
+{
+	// only the range touched by the previous layer needs to be cleared
+	if(minSlope_ <= maxSlope_)
+	{
+		std::fill(bits_.begin() + minSlope_, bits_.begin() + maxSlope_ + 1, 0);
+		std::fill(distortion_.begin() + minSlope_, distortion_.begin() + maxSlope_ + 1, 0.0);
+	}
+	minSlope_ = USHRT_MAX;
+	maxSlope_ = 0;
+	fixedBits_ = 0;
+	fixedBytes_ = numPackets * packetOverhead;
+}
+/*
+ Estimate packet header bits signalling a code block contribution,
+ beyond the single inclusion bit that every block costs in every layer
+ (see Taubman and Marcellin, Section 12.5)
+ */
+uint32_t RateEstimator::headerBits(uint32_t numPasses, uint32_t len, bool firstInclusion)
+{
+	// inclusion tag tree and zero bit planes on first inclusion
+	uint32_t bits = firstInclusion ? 3 : 0;
+
+	// number of coding passes
+	if(numPasses == 1)
+		bits += 1;
+	else if(numPasses == 2)
+		bits += 2;
+	else if(numPasses <= 5)
+		bits += 4;
+	else if(numPasses <= 36)
+		bits += 9;
+	else
+		bits += 16;
+
+	// length: comma code for Lblock increment, followed by
+	// Lblock + floor(log2(numPasses)) length bits
+	uint32_t lengthBits = 3U + floorlog2(numPasses);
+	uint32_t requiredBits = len ? floorlog2(len) + 1U : 1U;
+	uint32_t increment = requiredBits > lengthBits ? requiredBits - lengthBits : 0;
+
+	return bits + increment + 1 + lengthBits + increment;
+}
+void RateEstimator::add(CompressCodeblock* cblk)
+{
+	fixedBits_++;
+	uint32_t previous = cblk->numPassesInPreviousPackets;
+	uint32_t baseRate = previous ? cblk->passes[previous - 1].rate : 0;
+	double baseDistortion = previous ? cblk->passes[previous - 1].distortiondec : 0;
+	uint64_t prevBits = 0;
+	double prevDistortion = baseDistortion;
+	for(uint32_t passno = previous; passno < cblk->numPassesTotal; ++passno)
+	{
+		auto pass = cblk->passes + passno;
+		if(!pass->slope)
+			continue;
+		uint32_t len = pass->rate - baseRate;
+		uint64_t bits = ((uint64_t)len << 3) + headerBits(passno + 1 - previous, len, previous == 0);
+		bits_[pass->slope] += bits - prevBits;
+		distortion_[pass->slope] += pass->distortiondec - prevDistortion;
+		minSlope_ = std::min(minSlope_, pass->slope);
+		maxSlope_ = std::max(maxSlope_, pass->slope);
+		prevBits = bits;
+		prevDistortion = pass->distortiondec;
+	}
+}
+void RateEstimator::finalize(void)
+{
+	uint64_t bits = 0;
+	double distortion = 0;
+	for(uint32_t t = USHRT_MAX; t > maxSlope_; --t)
+	{
+		cumulativeBits_[t] = 0;
+		cumulativeDistortion_[t] = 0;
+	}
+	if(minSlope_ > maxSlope_)
+		return;
+	for(int32_t t = maxSlope_; t >= 0; --t)
+	{
+		cumulativeBits_[(size_t)t] = bits;
+		cumulativeDistortion_[(size_t)t] = distortion;
+		bits += bits_[(size_t)t];
+		distortion += distortion_[(size_t)t];
+	}
+}
+uint64_t RateEstimator::getBytes(uint16_t thresh) const
+{
+	return fixedBytes_ + ((fixedBits_ + cumulativeBits_[thresh] + 7) >> 3);
+}
+double RateEstimator::getDistortion(uint16_t thresh) const
+{
+	return cumulativeDistortion_[thresh];
+}
+uint16_t RateEstimator::getThreshForBytes(uint64_t maxBytes, uint16_t upperBound) const
+{
+	// getBytes is non-increasing in thresh
+	if(getBytes(upperBound) > maxBytes)
+		return upperBound;
+	uint32_t lo = 0;
+	uint32_t hi = upperBound;
+	while(lo < hi)
+	{
+		uint32_t mid = (lo + hi) >> 1;
+		if(getBytes((uint16_t)mid) <= maxBytes)
+			hi = mid;
+		else
+			lo = mid + 1;
+	}
+
+	return (uint16_t)lo;
+}
+uint16_t RateEstimator::getThreshForDistortion(double target, uint16_t upperBound) const
+{
+	// getDistortion is non-increasing in thresh
+	if(getDistortion(0) < target)
+		return 0;
+	uint32_t lo = 0;
+	uint32_t hi = upperBound;
+	while(lo < hi)
+	{
+		uint32_t mid = (lo + hi + 1) >> 1;
+		if(getDistortion((uint16_t)mid) >= target)
+			lo = mid;
+		else
+			hi = mid - 1;
+	}
+
+	return (uint16_t)lo;
+}
+
+} // namespace grk
@@ -0,0 +1,85 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+#pragma once
+
+#include <vector>
+
+namespace grk
+{
+/**
+ * Cumulative rate and distortion tables, indexed by log slope threshold.
+ *
+ * The tables are built from the feasible truncation points of every code block
+ * that have not yet been assigned to a previous layer. For any threshold, they give the
+ * number of bytes (code block data plus an estimate of packet header cost) and the distortion
+ * decrease of a layer formed at that threshold, without forming the layer or running T2.
+ */
+class RateEstimator
+{
+  public:
+	RateEstimator();
+	/**
+	 * Clear all tables
+	 * @param numPackets number of packets in the layer
+	 * @param packetOverhead fixed number of bytes per packet (SOP/EPH markers and
+	 * empty packet header)
+	 */
+	void reset(uint64_t numPackets, uint32_t packetOverhead);
+	/**
+	 * Add feasible truncation points of code block, above those
+	 * already included in previous layers
+	 */
+	void add(CompressCodeblock* cblk);
+	/**
+	 * Compute cumulative tables. Must be called after all blocks have been added
+	 */
+	void finalize(void);
+	/**
+	 * Estimated number of bytes in layer formed at threshold
+	 */
+	uint64_t getBytes(uint16_t thresh) const;
+	/**
+	 * Distortion decrease of layer formed at threshold
+	 */
+	double getDistortion(uint16_t thresh) const;
+	/**
+	 * Smallest threshold (i.e. most passes included) whose estimated layer size is
+	 * no greater than maxBytes, clamped to [0,upperBound]
+	 */
+	uint16_t getThreshForBytes(uint64_t maxBytes, uint16_t upperBound) const;
+	/**
+	 * Largest threshold (i.e. fewest passes included) whose distortion decrease
+	 * reaches target, clamped to [0,upperBound]
+	 */
+	uint16_t getThreshForDistortion(double target, uint16_t upperBound) const;
+
+  private:
+	static uint32_t headerBits(uint32_t numPasses, uint32_t len, bool firstInclusion);
+
+	// bits and distortion decrease contributed by passes with slope equal to index
+	std::vector<uint64_t> bits_;
+	std::vector<double> distortion_;
+	// bits and distortion decrease contributed by passes with slope greater than index
+	std::vector<uint64_t> cumulativeBits_;
+	std::vector<double> cumulativeDistortion_;
+	uint64_t fixedBits_;
+	uint64_t fixedBytes_;
+	uint16_t minSlope_;
+	uint16_t maxSlope_;
+};
+
+} // namespace grk
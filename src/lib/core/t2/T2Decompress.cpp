@@ -22,37 +22,124 @@
 
 namespace grk
 {
-T2Decompress::T2Decompress(TileProcessor* tileProc) : tileProcessor(tileProc) {}
-
+T2Decompress::T2Decompress(TileProcessor* tileProc)
+	: tileProcessor(tileProc), packetManager_(nullptr), markers_(nullptr), src_(nullptr),
+	  tileno_(0), pino_(0), numPacketsRead_(0), stop_(false)
+{}
+T2Decompress::~T2Decompress(void)
+{
+	delete packetManager_;
+}
+void T2Decompress::begin(uint16_t tileno, SparseBuffer* src)
+{
+	delete packetManager_;
+	packetManager_ = new PacketManager(false, tileProcessor->headerImage, tileProcessor->cp_,
+									   tileno, FINAL_PASS, tileProcessor);
+	tileProcessor->packetLengthCache.rewind();
+	markers_ = tileProcessor->packetLengthCache.getMarkers();
+	if(markers_ && !markers_->isEnabled())
+		markers_ = nullptr;
+	src_ = src;
+	tileno_ = tileno;
+	pino_ = 0;
+	numPacketsRead_ = 0;
+	stop_ = false;
+}
 void T2Decompress::decompressPackets(uint16_t tile_no, SparseBuffer* src,
 									 bool* stopProcessionPackets)
 {
-	auto cp = tileProcessor->cp_;
+	begin(tile_no, src);
+	readPackets(UINT64_MAX);
+	*stopProcessionPackets = stop_;
+}
+bool T2Decompress::beginStreaming(uint16_t tileno, SparseBuffer* src,
+								  std::vector<std::vector<uint64_t>>& resPacketEnd)
+{
+	auto tile = tileProcessor->getTile();
+	resPacketEnd.assign(tile->numcomps_, std::vector<uint64_t>());
+	for(uint16_t compno = 0; compno < tile->numcomps_; ++compno)
+		resPacketEnd[compno].assign((tile->comps + compno)->numResolutionsToDecompress, 0);
 	auto tcp = tileProcessor->getTileCodingParams();
-	*stopProcessionPackets = false;
-	PacketManager packetManager(false, tileProcessor->headerImage, cp, tile_no, FINAL_PASS,
-								tileProcessor);
-	tileProcessor->packetLengthCache.rewind();
-	auto markers = tileProcessor->packetLengthCache.getMarkers();
-	if(markers && !markers->isEnabled())
-		markers = nullptr;
+	PacketManager packetManager(false, tileProcessor->headerImage, tileProcessor->cp_, tileno,
+								FINAL_PASS, tileProcessor);
+	uint64_t numPackets = 0;
 	for(uint32_t pino = 0; pino < tcp->getNumProgressions(); ++pino)
 	{
 		auto currPi = packetManager.getPacketIter(pino);
-		while(currPi->next(markers ? src : nullptr))
+		while(currPi->next(nullptr))
+		{
+			numPackets++;
+			auto compno = currPi->getCompno();
+			auto resno = currPi->getResno();
+			auto tilec = tile->comps + compno;
+			if(resno >= tilec->numResolutionsToDecompress)
+				continue;
+			resPacketEnd[compno][resno] = numPackets;
+			auto res = tilec->resolutions_ + resno;
+			for(uint32_t bandIndex = 0; bandIndex < res->numTileBandWindows; ++bandIndex)
+			{
+				auto band = res->tileBand + bandIndex;
+				if(band->empty())
+					continue;
+				if(!band->createPrecinct(tileProcessor, currPi->getPrecinctIndex(),
+										 res->precinctPartitionTopLeft, res->precinctExpn,
+										 res->precinctGridWidth, res->cblkExpn))
+					return false;
+			}
+		}
+	}
+	for(const auto& comp : resPacketEnd)
+	{
+		for(auto end : comp)
+		{
+			if(!end)
+				return false;
+		}
+	}
+	begin(tileno, src);
+
+	return true;
+}
+bool T2Decompress::streamPackets(uint64_t numPackets)
+{
+	try
+	{
+		readPackets(numPackets);
+	}
+	catch(const std::exception& ex)
+	{
+		Logger::logger_.error("Tile %u: failed to read packets: %s", tileno_, ex.what());
+		stop_ = true;
+		return false;
+	}
+
+	return true;
+}
+bool T2Decompress::isTruncated(void) const
+{
+	return stop_;
+}
+void T2Decompress::readPackets(uint64_t numPackets)
+{
+	auto tcp = tileProcessor->getTileCodingParams();
+	for(; pino_ < tcp->getNumProgressions() && !stop_; ++pino_)
+	{
+		auto currPi = packetManager_->getPacketIter(pino_);
+		while(numPacketsRead_ < numPackets && currPi->next(markers_ ? src_ : nullptr))
 		{
-			if(src->getCurrentChunkLength() == 0)
+			numPacketsRead_++;
+			if(src_->getCurrentChunkLength() == 0)
 			{
-				Logger::logger_.warn("Tile %u is truncated.", tile_no);
-				*stopProcessionPackets = true;
+				Logger::logger_.warn("Tile %u is truncated.", tileno_);
+				stop_ = true;
 				break;
 			}
 			try
 			{
 				if(!processPacket(currPi->getCompno(), currPi->getResno(),
-								  currPi->getPrecinctIndex(), currPi->getLayno(), src))
+								  currPi->getPrecinctIndex(), currPi->getLayno(), src_))
 				{
-					*stopProcessionPackets = true;
+					stop_ = true;
 					break;
 				}
 			}
@@ -61,9 +148,9 @@ void T2Decompress::decompressPackets(uint16_t tile_no, SparseBuffer* src,
 				Logger::logger_.warn(
 					"Truncated packet: tile=%u component=%02d resolution=%02d precinct=%03d "
 					"layer=%02d",
-					tile_no, currPi->getCompno(), currPi->getResno(), currPi->getPrecinctIndex(),
+					tileno_, currPi->getCompno(), currPi->getResno(), currPi->getPrecinctIndex(),
 					currPi->getLayno());
-				*stopProcessionPackets = true;
+				stop_ = true;
 				break;
 			}
 			catch([[maybe_unused]] const CorruptPacketException& cex)
@@ -74,9 +161,9 @@ void T2Decompress::decompressPackets(uint16_t tile_no, SparseBuffer* src,
 					Logger::logger_.warn(
 						"Corrupt packet: tile=%u component=%02d resolution=%02d precinct=%03d "
 						"layer=%02d",
-						tile_no, currPi->getCompno(), currPi->getResno(),
+						tileno_, currPi->getCompno(), currPi->getResno(),
 						currPi->getPrecinctIndex(), currPi->getLayno());
-					*stopProcessionPackets = true;
+					stop_ = true;
 					break;
 				}
 				else
@@ -84,13 +171,14 @@ void T2Decompress::decompressPackets(uint16_t tile_no, SparseBuffer* src,
 					Logger::logger_.warn(
 						"Corrupt packet: tile=%u component=%02d resolution=%02d precinct=%03d "
 						"layer=%02d",
-						tile_no, currPi->getCompno(), currPi->getResno(),
+						tileno_, currPi->getCompno(), currPi->getResno(),
 						currPi->getPrecinctIndex(), currPi->getLayno());
 				}
 				// ToDo: skip corrupt packet if SOP marker is present
 			}
 		}
-		if(*stopProcessionPackets)
+		// resume with this progression on next call
+		if(numPacketsRead_ == numPackets)
 			break;
 	}
 }
@@ -28,15 +28,48 @@ struct TileProcessor;
 struct T2Decompress
 {
 	T2Decompress(TileProcessor* tileProc);
-	virtual ~T2Decompress(void) = default;
+	virtual ~T2Decompress(void);
 	void decompressPackets(uint16_t tileno, SparseBuffer* src, bool* truncated);
+	/**
+	 * Prepare to stream packets, without PL markers. Packet order is walked without reading
+	 * any data, in order to find where the packets of each resolution end, and all precincts
+	 * are created up front so that their blocks can be scheduled before their packets are read.
+	 *
+	 * @param tileno tile number
+	 * @param src compressed tile data
+	 * @param resPacketEnd receives, for each component and each resolution to decompress,
+	 * the number of tile packets up to and including the last packet of that resolution
+	 * @return false if a resolution to decompress has no packets
+	 */
+	bool beginStreaming(uint16_t tileno, SparseBuffer* src,
+						std::vector<std::vector<uint64_t>>& resPacketEnd);
+	/**
+	 * Continue reading packets in code stream order, until the first numPackets packets
+	 * of the tile have been read, or the tile ends
+	 *
+	 * @param numPackets number of tile packets
+	 * @return false if packets could not be read
+	 */
+	bool streamPackets(uint64_t numPackets);
+	bool isTruncated(void) const;
 
   private:
 	TileProcessor* tileProcessor;
+	void begin(uint16_t tileno, SparseBuffer* src);
+	void readPackets(uint64_t numPackets);
 	void decompressPacket(PacketParser* parser, bool skipData);
 	bool processPacket(uint16_t compno, uint8_t resno, uint64_t precinctIndex, uint16_t layno,
 					   SparseBuffer* src);
 	void readPacketData(Resolution* res, PacketParser* parser, uint64_t precinctIndex, bool defer);
+
+	// packet iteration state, which persists between calls to streamPackets
+	PacketManager* packetManager_;
+	PLMarkerMgr* markers_;
+	SparseBuffer* src_;
+	uint16_t tileno_;
+	uint32_t pino_;
+	uint64_t numPacketsRead_;
+	bool stop_;
 };
 
 } // namespace grk
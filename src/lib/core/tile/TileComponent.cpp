@@ -19,9 +19,7 @@
  *
  */
 
-#include "PostT1DecompressFilters.h"
 #include "grk_includes.h"
-#include "htconfig.h"
 
 const bool DEBUG_TILE_COMPONENT = false;
 
@@ -352,45 +350,42 @@ ISparseCanvas* TileComponent::getRegionWindow()
 }
 void TileComponent::postProcess(int32_t* srcData, DecompressBlockExec* block)
 {
-	if(block->roishift)
-	{
-		if(block->qmfbid == 1)
-			postDecompressImpl<RoiShiftFilter<int32_t>>(srcData, block,
-														(uint16_t)block->cblk->width());
-		else
-			postDecompressImpl<RoiScaleFilter<int32_t>>(srcData, block,
-														(uint16_t)block->cblk->width());
-	}
-	else
-	{
-		if(block->qmfbid == 1)
-			postDecompressImpl<ShiftFilter<int32_t>>(srcData, block,
-													 (uint16_t)block->cblk->width());
-		else
-			postDecompressImpl<ScaleFilter<int32_t>>(srcData, block,
-													 (uint16_t)block->cblk->width());
-	}
+	if(block->decodedBlockCache)
+		block->decodedBlockCache->store(block, srcData, block->cblk->width(), false);
+	postDecompressImpl(srcData, block, (uint16_t)block->cblk->width(), false);
 }
 void TileComponent::postProcessHT(int32_t* srcData, DecompressBlockExec* block, uint16_t stride)
 {
-	if(block->roishift)
-	{
-		if(block->qmfbid == 1)
-			postDecompressImpl<ojph::RoiShiftOJPHFilter<int32_t>>(srcData, block, stride);
-		else
-			postDecompressImpl<ojph::RoiScaleOJPHFilter<int32_t>>(srcData, block, stride);
-	}
-	else
-	{
-		if(block->qmfbid == 1)
-			postDecompressImpl<ojph::ShiftOJPHFilter<int32_t>>(srcData, block, stride);
-		else
-			postDecompressImpl<ojph::ScaleOJPHFilter<int32_t>>(srcData, block, stride);
-	}
+	if(block->decodedBlockCache)
+		block->decodedBlockCache->store(block, srcData, stride, true);
+	postDecompressImpl(srcData, block, stride, true);
+}
+int32_t* TileComponent::getInPlaceDest(DecompressBlockExec* block, uint32_t* stride)
+{
+	// sparse region windows and decoded block caches need the block in its own buffer
+	if(regionWindow_ || block->decodedBlockCache)
+		return nullptr;
+	auto cblk = block->cblk;
+	uint32_t x = block->x;
+	uint32_t y = block->y;
+	window_->toRelativeCoordinates(block->resno, block->bandOrientation, x, y);
+	auto dst = window_->getCodeBlockDestWindowREL(block->resno, block->bandOrientation);
+	auto blockBounds = grk_rect32(x, y, x + cblk->width(), y + cblk->height());
+	if(!dst->getBuffer() || !blockBounds.isContainedIn(*dst))
+		return nullptr;
+	*stride = dst->stride;
+
+	return dst->getBuffer() + (uint64_t)y * dst->stride + x;
+}
+void TileComponent::postProcessInPlace(int32_t* dest, uint32_t stride, DecompressBlockExec* block,
+									   bool ht)
+{
+	auto cblk = block->cblk;
+	PostT1DecompressFilter(block, ht).copy(dest, stride, dest, stride, cblk->width(),
+										   cblk->height());
 }
-template<typename F>
 void TileComponent::postDecompressImpl(int32_t* srcData, DecompressBlockExec* block,
-									   uint16_t stride)
+									   uint16_t stride, bool ht)
 {
 	auto cblk = block->cblk;
 	bool empty = cblk->seg_buffers.empty();
@@ -402,14 +397,15 @@ void TileComponent::postDecompressImpl(int32_t* srcData, DecompressBlockExec* bl
 		grk_rect32(block->x, block->y, block->x + cblk->width(), block->y + cblk->height());
 	if(!empty)
 	{
+		auto filter = PostT1DecompressFilter(block, ht);
 		if(regionWindow_)
 		{
-			src.copyFrom<F>(src, F(block));
+			filter.copy(srcData, stride, srcData, stride, cblk->width(), cblk->height());
 		}
 		else
 		{
 			src.setRect(blockBounds);
-			window_->postProcess<F>(src, block->resno, block->bandOrientation, block);
+			window_->postProcess(src, block->resno, block->bandOrientation, filter);
 		}
 	}
 	if(regionWindow_)
@@ -41,6 +41,19 @@ struct TileComponent : public grk_rect32
 	ISparseCanvas* getRegionWindow();
 	void postProcess(int32_t* srcData, DecompressBlockExec* block);
 	void postProcessHT(int32_t* srcData, DecompressBlockExec* block, uint16_t stride);
+	/**
+	 * Get tile window destination of code block, so that block can be decompressed
+	 * in place. Returns nullptr if block must instead be decompressed into a
+	 * separate buffer and then post processed into the window
+	 *
+	 * @param block code block
+	 * @param stride returns window stride
+	 */
+	int32_t* getInPlaceDest(DecompressBlockExec* block, uint32_t* stride);
+	/**
+	 * Post process code block that was decompressed in place
+	 */
+	void postProcessInPlace(int32_t* dest, uint32_t stride, DecompressBlockExec* block, bool ht);
 
 	Resolution* resolutions_; // in canvas coordinates
 	uint8_t numresolutions;
@@ -50,8 +63,8 @@ struct TileComponent : public grk_rect32
 	Resolution* round_trip_resolutions; /* round trip resolution information */
 #endif
   private:
-	template<typename F>
-	void postDecompressImpl(int32_t* srcData, DecompressBlockExec* block, uint16_t stride);
+	void postDecompressImpl(int32_t* srcData, DecompressBlockExec* block, uint16_t stride,
+							bool ht);
 	ISparseCanvas* regionWindow_;
 	bool wholeTileDecompress;
 	bool isCompressor_;
@@ -206,13 +206,25 @@ struct TileComponentWindow : public TileComponentWindowBase<T>
 				offsety += resLower.height();
 		}
 	}
-	template<typename F>
+	/**
+	 * Get code block destination window
+	 *
+	 * @param resno resolution number
+	 * @param orientation band orientation {LL,HL,LH,HH}
+	 *
+	 */
+	const Buf2dAligned* getCodeBlockDestWindowREL(uint8_t resno, eBandOrientation orientation) const
+	{
+		return (useBufferCoordinatesForCodeblock())
+				   ? getResWindowBufferHighestREL()
+				   : getBandWindowBufferPaddedREL(resno, orientation);
+	}
 	void postProcess(Buf2dAligned& src, uint8_t resno, eBandOrientation bandOrientation,
-					 DecompressBlockExec* block)
+					 const PostT1DecompressFilter& filter)
 	{
 		grk_buf2d<int32_t, AllocatorAligned> dst;
 		dst = getCodeBlockDestWindowREL(resno, bandOrientation);
-		dst.copyFrom<F>(src, F(block));
+		dst.copyFrom(src, filter);
 	}
 
 	/**
@@ -361,6 +373,13 @@ struct TileComponentWindow : public TileComponentWindowBase<T>
 	{
 		return getResWindowBufferHighestREL()->stride;
 	}
+	/**
+	 * Get highest resolution window width
+	 */
+	uint32_t getResWindowBufferHighestWidth(void) const
+	{
+		return getResWindowBufferHighestREL()->width();
+	}
 
 	/**
 	 * Get highest resolution window
@@ -398,19 +417,6 @@ struct TileComponentWindow : public TileComponentWindowBase<T>
 	}
 
   private:
-	/**
-	 * Get code block destination window
-	 *
-	 * @param resno resolution number
-	 * @param orientation band orientation {LL,HL,LH,HH}
-	 *
-	 */
-	const Buf2dAligned* getCodeBlockDestWindowREL(uint8_t resno, eBandOrientation orientation) const
-	{
-		return (useBufferCoordinatesForCodeblock())
-				   ? getResWindowBufferHighestREL()
-				   : getBandWindowBufferPaddedREL(resno, orientation);
-	}
 	/**
 	 * Get highest resolution window
 	 *
@@ -31,7 +31,8 @@ TileProcessor::TileProcessor(uint16_t tileIndex, CodeStream* codeStream, Buffere
 	  tileIndex_(tileIndex), stream_(stream),
 	  newTilePartProgressionPosition(cp_->coding_params_.enc_.newTilePartProgressionPosition),
 	  tcp_(cp_->tcps + tileIndex_), truncated(false), image_(nullptr), isCompressor_(isCompressor),
-	  preCalculatedTileLen(0), mct_(new mct(tile, headerImage, tcp_, stripCache))
+	  preCalculatedTileLen(0), mct_(new mct(tile, headerImage, tcp_, stripCache)),
+	  stripCache_(stripCache)
 {}
 TileProcessor::~TileProcessor()
 {
@@ -151,6 +152,10 @@ bool TileProcessor::isCompressor(void)
 {
 	return isCompressor_;
 }
+BlockArena* TileProcessor::getBlockArena(void)
+{
+	return &blockArena_;
+}
 void TileProcessor::generateImage(GrkImage* src_image, Tile* src_tile)
 {
 	if(image_)
@@ -165,15 +170,18 @@ void TileProcessor::release(GRK_TILE_CACHE_STRATEGY strategy)
 {
 	// delete image in absence of tile cache strategy
 	if(strategy == GRK_TILE_CACHE_NONE)
-	{
-		if(image_)
-			grk_object_unref(&image_->obj);
-		image_ = nullptr;
-	}
+		releaseImage();
 
-	// delete tile components
+	// delete tile components, then free their code blocks in one shot
 	delete tile;
 	tile = nullptr;
+	blockArena_.release();
+}
+void TileProcessor::releaseImage(void)
+{
+	if(image_)
+		grk_object_unref(&image_->obj);
+	image_ = nullptr;
 }
 PacketTracker* TileProcessor::getPacketTracker(void)
 {
@@ -208,6 +216,15 @@ bool TileProcessor::init(void)
 	if(tcp->compressedTileData_)
 		tcp->compressedTileData_->rewind();
 
+	// tile was released after an earlier decompression: decompress it again from
+	// cached tile data
+	if(!tile)
+	{
+		tile = new Tile(headerImage->numcomps);
+		delete mct_;
+		mct_ = new mct(tile, headerImage, tcp_, stripCache_);
+	}
+
 	// generate tile bounds from tile grid coordinates
 	uint32_t tile_x = tileIndex_ % cp_->t_grid_width;
 	uint32_t tile_y = tileIndex_ / cp_->t_grid_width;
@@ -309,7 +326,7 @@ void TileProcessor::deallocBuffers()
 		tile_comp->dealloc();
 	}
 }
-bool TileProcessor::doCompress(void)
+bool TileProcessor::compressT1(void)
 {
 	uint32_t state = grk_plugin_get_debug_state();
 #ifdef PLUGIN_DEBUG_ENCODE
@@ -342,6 +359,13 @@ bool TileProcessor::doCompress(void)
 		}
 		t1_encode();
 	}
+
+	return true;
+}
+bool TileProcessor::doCompress(void)
+{
+	if(!compressT1())
+		return false;
 	// 1. create PLT marker if required
 	packetLengthCache.deleteMarkers();
 	if(cp_->coding_params_.enc_.writePLT)
@@ -362,7 +386,12 @@ bool TileProcessor::doCompress(void)
 		}
 	}
 	packetTracker_.clear();
+	preCalculateTileLen(allPacketBytes);
 
+	return true;
+}
+void TileProcessor::preCalculateTileLen(uint32_t allPacketBytes)
+{
 	if(canPreCalculateTileLen())
 	{
 		// SOT marker
@@ -383,7 +412,6 @@ bool TileProcessor::doCompress(void)
 		// calculate packets length
 		preCalculatedTileLen += allPacketBytes;
 	}
-	return true;
 }
 bool TileProcessor::canWritePocMarker(void)
 {
@@ -432,6 +460,70 @@ bool TileProcessor::isWholeTileDecompress(uint16_t compno)
 			  ((tilec->x1 - dims.x1) >> shift) == 0 && ((tilec->y1 - dims.y1) >> shift) == 0)));
 }
 
+bool TileProcessor::canPipelinePackets(uint64_t parserCount)
+{
+	// packed packet headers are read sequentially from a single buffer,
+	// and region decompression sizes its window from the parsed resolutions
+	return parserCount && ExecSingleton::get()->num_workers() > 1 && !current_plugin_tile &&
+		   !cp_->ppm_marker && !tcp_->ppt && cp_->wholeTileDecompress_;
+}
+bool TileProcessor::canStreamPackets(void)
+{
+	// with PL markers, packets are already pipelined per precinct
+	auto markers = packetLengthCache.getMarkers();
+	return cp_->coding_params_.dec_.streamingDecompress_ &&
+		   ExecSingleton::get()->num_workers() > 1 && !current_plugin_tile &&
+		   cp_->wholeTileDecompress_ && !(markers && markers->isEnabled());
+}
+void TileProcessor::prepareResolutionsForPipeline(void)
+{
+	// packets are parsed while blocks are decompressed, so the highest resolution
+	// with packets must be known before scheduling
+	for(uint16_t compno = 0; compno < headerImage->numcomps; ++compno)
+	{
+		auto tilec = tile->comps + compno;
+		for(uint8_t resno = 0; resno < tilec->numResolutionsToDecompress; ++resno)
+		{
+			auto res = tilec->resolutions_ + resno;
+			if(!res->parserMap_->precinctParsers_.empty() &&
+			   resno > tilec->highestResolutionDecompressed)
+				tilec->highestResolutionDecompressed = resno;
+		}
+	}
+}
+void TileProcessor::readDeferredPackets(uint64_t parserCount)
+{
+	auto numThreads = std::min<size_t>(ExecSingleton::get()->num_workers(), parserCount);
+	if(numThreads == 1)
+	{
+		for(uint16_t compno = 0; compno < headerImage->numcomps; ++compno)
+		{
+			auto tilec = tile->comps + compno;
+			for(uint8_t resno = 0; resno < tilec->numResolutionsToDecompress; ++resno)
+			{
+				auto res = tilec->resolutions_ + resno;
+				for(const auto& pp : res->parserMap_->precinctParsers_)
+					pp.second->readPackets();
+			}
+		}
+		return;
+	}
+	tf::Taskflow taskflow;
+	for(uint16_t compno = 0; compno < headerImage->numcomps; ++compno)
+	{
+		auto tilec = tile->comps + compno;
+		for(uint8_t resno = 0; resno < tilec->numResolutionsToDecompress; ++resno)
+		{
+			auto res = tilec->resolutions_ + resno;
+			for(const auto& pp : res->parserMap_->precinctParsers_)
+			{
+				auto parsers = pp.second;
+				taskflow.emplace([parsers] { parsers->readPackets(); });
+			}
+		}
+	}
+	ExecSingleton::run(taskflow);
+}
 bool TileProcessor::decompressT2T1(GrkImage* outputImage)
 {
 	auto tcp = getTileCodingParams();
@@ -460,16 +552,34 @@ bool TileProcessor::decompressT2T1(GrkImage* outputImage)
 		}
 	}
 	bool doT2 = !current_plugin_tile || (current_plugin_tile->decompress_flags & GRK_DECODE_T2);
+	bool pipelinePackets = false;
+	bool streamPackets = doT2 && doT1 && canStreamPackets();
+	// when streaming, T2 reads packets from T1 tasks, so it must outlive the scheduler run
+	std::unique_ptr<T2Decompress> t2;
+	std::vector<std::vector<uint64_t>> resPacketEnd;
 	if(doT2)
 	{
-		auto t2 = std::make_unique<T2Decompress>(this);
+		t2 = std::make_unique<T2Decompress>(this);
+		if(streamPackets)
+			streamPackets = t2->beginStreaming(tileIndex_, tcp->compressedTileData_, resPacketEnd);
+	}
+	if(streamPackets)
+	{
+		// packets of every resolution are present, so all resolutions will be decompressed
+		for(uint16_t compno = 0; compno < headerImage->numcomps; ++compno)
+		{
+			auto tilec = tile->comps + compno;
+			tilec->highestResolutionDecompressed = tilec->numResolutionsToDecompress - 1;
+		}
+	}
+	else if(doT2)
+	{
 		t2->decompressPackets(tileIndex_, tcp->compressedTileData_, &truncated);
 		// synch plugin with T2 data
 		// todo re-enable decompress synch
 		// decompress_synch_plugin_with_host(this);
 
-		// 1. count parsers
-		auto tile = getTile();
+		// packets with lengths signalled in PL markers are parsed later, per precinct
 		uint64_t parserCount = 0;
 		for(uint16_t compno = 0; compno < headerImage->numcomps; ++compno)
 		{
@@ -480,82 +590,20 @@ bool TileProcessor::decompressT2T1(GrkImage* outputImage)
 				parserCount += res->parserMap_->precinctParsers_.size();
 			}
 		}
-		// 2.create and populate tasks, and execute
-		if(parserCount)
-		{
-			auto numThreads = std::min<size_t>(ExecSingleton::get()->num_workers(), parserCount);
-			if(numThreads == 1)
-			{
-				for(uint16_t compno = 0; compno < headerImage->numcomps; ++compno)
-				{
-					auto tilec = tile->comps + compno;
-					for(uint8_t resno = 0; resno < tilec->numResolutionsToDecompress; ++resno)
-					{
-						auto res = tilec->resolutions_ + resno;
-						for(const auto& pp : res->parserMap_->precinctParsers_)
-						{
-							for(uint64_t j = 0; j < pp.second->numParsers_; ++j)
-							{
-								try
-								{
-									auto parser = pp.second->parsers_[j];
-									parser->readHeader();
-									parser->readData();
-								}
-								catch([[maybe_unused]] const std::exception& ex)
-								{
-									break;
-								}
-							}
-						}
-					}
-				}
-			}
-			else
-			{
-				tf::Taskflow taskflow;
-				auto numTasks = parserCount;
-				auto tasks = new tf::Task[numTasks];
-				for(uint64_t i = 0; i < numTasks; i++)
-					tasks[i] = taskflow.placeholder();
-				uint64_t i = 0;
-				for(uint16_t compno = 0; compno < headerImage->numcomps; ++compno)
-				{
-					auto tilec = tile->comps + compno;
-					for(uint8_t resno = 0; resno < tilec->numResolutionsToDecompress; ++resno)
-					{
-						auto res = tilec->resolutions_ + resno;
-						for(const auto& pp : res->parserMap_->precinctParsers_)
-						{
-							auto& ppair = pp;
-							auto decompressor = [ppair]() {
-								for(uint64_t j = 0; j < ppair.second->numParsers_; ++j)
-								{
-									try
-									{
-										auto parser = ppair.second->parsers_[j];
-										parser->readHeader();
-										parser->readData();
-									}
-									catch([[maybe_unused]] const std::exception& ex)
-									{
-										break;
-									}
-								}
-							};
-							tasks[i++].work(decompressor);
-						}
-					}
-				}
-				ExecSingleton::get()->run(taskflow).wait();
-				delete[] tasks;
-			}
-		}
+		pipelinePackets = doT1 && canPipelinePackets(parserCount);
+		if(pipelinePackets)
+			prepareResolutionsForPipeline();
+		else if(parserCount)
+			readDeferredPackets(parserCount);
 	}
 	// T1
 	if(doT1)
 	{
-		scheduler_ = new DecompressScheduler(this, tile, tcp_, headerImage->comps->prec);
+		auto decompressScheduler =
+			new DecompressScheduler(this, tile, tcp_, headerImage->comps->prec, pipelinePackets);
+		scheduler_ = decompressScheduler;
+		if(streamPackets)
+			decompressScheduler->setPacketStream(t2.get(), std::move(resPacketEnd));
 		FlowComponent* mctPostProc = nullptr;
 		// schedule MCT post processing
 		if(doPostT1 && needsMctDecompress())
@@ -616,10 +664,27 @@ bool TileProcessor::decompressT2T1(GrkImage* outputImage)
 		// sanity check on MCT scheduling
 		if(doPostT1 && mctComponentCount == 3 && mctPostProc && !mctDecompress(mctPostProc))
 			return false;
+		if(streamPackets)
+			decompressScheduler->sequencePacketStream();
 		if(!scheduler_->run())
 			return false;
+		if(streamPackets)
+			truncated = t2->isTruncated();
 		delete scheduler_;
 		scheduler_ = nullptr;
+		// custom MCT is applied to the whole tile, so strips of a single tile image
+		// can only be interleaved once it is complete
+		if(doPostT1 && mctPostProc && tcp_->mct == 2 && stripCache_ &&
+		   stripCache_->isInitialized() && !stripCache_->isMultiTile())
+		{
+			auto height = tile->comps->height();
+			for(uint32_t y = 0; y < height; y += headerImage->rowsPerTask)
+			{
+				if(!stripCache_->ingestStrip(ExecSingleton::threadId(), tile, y,
+											 (std::min)(y + headerImage->rowsPerTask, height)))
+					return false;
+			}
+		}
 	}
 	// 4. post T1
 	bool doPost =
@@ -946,7 +1011,8 @@ bool TileProcessor::preCompressTile()
 	if(!rc)
 		return false;
 	uint32_t numTiles = (uint32_t)cp_->t_grid_height * cp_->t_grid_width;
-	bool transfer_image_to_tile = (numTiles == 1);
+	auto pullSource = cp_->coding_params_.enc_.pullSource_;
+	bool transfer_image_to_tile = (numTiles == 1) && !pullSource;
 	/* if we only have one tile, then simply set tile component data equal to
 	 * image component data. Otherwise, allocate tile data and copy */
 	for(uint32_t j = 0; j < headerImage->numcomps; ++j)
@@ -961,6 +1027,8 @@ bool TileProcessor::preCompressTile()
 			return false;
 		}
 	}
+	if(pullSource)
+		return pullSource->ingest(headerImage, tile);
 	if(!transfer_image_to_tile)
 		ingestImage();
 
@@ -1142,8 +1210,11 @@ bool TileProcessor::rateAllocate(uint32_t* allPacketBytes, bool disableRateContr
 	// rate control by rate/distortion or fixed quality
 	switch(cp_->coding_params_.enc_.rateControlAlgorithm)
 	{
-		case 0:
+		case GRK_RATE_CONTROL_BISECT:
 			return pcrdBisectSimple(allPacketBytes, disableRateControl);
+		case GRK_RATE_CONTROL_PCRD_INCREMENTAL:
+		case GRK_RATE_CONTROL_PCRD_GLOBAL:
+			return pcrdIncremental(allPacketBytes, disableRateControl);
 		default:
 			return pcrdBisectFeasible(allPacketBytes, disableRateControl);
 	}
@@ -1256,19 +1327,13 @@ bool TileProcessor::makeLayerFeasible(uint32_t layno, uint16_t thresh, bool fina
 	return allocationChanged;
 }
 /*
- Hybrid rate control using bisect algorithm with optimal truncation points
+ Synchronize code blocks with plugin, and calculate feasible truncation points
+ for all code blocks. Returns maximum squared error for the tile
  */
-bool TileProcessor::pcrdBisectFeasible(uint32_t* allPacketBytes, bool disableRateControl)
+double TileProcessor::feasibleTruncation(RateInfo* rateInfo, bool single_lossless)
 {
-	bool single_lossless = tcp_->max_layers_ == 1 && !layerNeedsRateControl(0);
-	const double K = 1;
 	double maxSE = 0;
-	auto tcp = tcp_;
 	uint32_t state = grk_plugin_get_debug_state();
-	RateInfo rateInfo;
-	uint64_t numPacketsPerLayer = 0;
-	uint64_t numCodeBlocks = 0;
-	bool debug = false;
 	for(uint16_t compno = 0; compno < tile->numcomps_; compno++)
 	{
 		auto tilec = &tile->comps[compno];
@@ -1281,10 +1346,8 @@ bool TileProcessor::pcrdBisectFeasible(uint32_t* allPacketBytes, bool disableRat
 				auto band = &res->tileBand[bandIndex];
 				for(auto prc : band->precincts)
 				{
-					numPacketsPerLayer++;
 					for(uint64_t cblkno = 0; cblkno < prc->getNumCblks(); cblkno++)
 					{
-						numCodeBlocks++;
 						auto cblk = prc->getCompressedBlockPtr(cblkno);
 						uint32_t numPix = (uint32_t)cblk->area();
 						if(!(state & GRK_PLUGIN_STATE_PRE_TR1))
@@ -1297,7 +1360,7 @@ bool TileProcessor::pcrdBisectFeasible(uint32_t* allPacketBytes, bool disableRat
 						if(!single_lossless)
 						{
 							RateControl::convexHull(cblk->passes, cblk->numPassesTotal);
-							rateInfo.synch(cblk);
+							rateInfo->synch(cblk);
 							numpix += numPix;
 						}
 					} /* cbklno */
@@ -1312,6 +1375,20 @@ bool TileProcessor::pcrdBisectFeasible(uint32_t* allPacketBytes, bool disableRat
 					 (double)numpix;
 		}
 	} /* compno */
+
+	return maxSE;
+}
+/*
+ Hybrid rate control using bisect algorithm with optimal truncation points
+ */
+bool TileProcessor::pcrdBisectFeasible(uint32_t* allPacketBytes, bool disableRateControl)
+{
+	bool single_lossless = tcp_->max_layers_ == 1 && !layerNeedsRateControl(0);
+	const double K = 1;
+	auto tcp = tcp_;
+	RateInfo rateInfo;
+	bool debug = false;
+	double maxSE = feasibleTruncation(&rateInfo, single_lossless);
 	auto t2 = T2Compress(this);
 	if(single_lossless)
 	{
@@ -1404,6 +1481,231 @@ bool TileProcessor::pcrdBisectFeasible(uint32_t* allPacketBytes, bool disableRat
 	// assert(!disableRateControl || rc);
 	return rc;
 }
+/*
+ Rate control with optimal truncation points, using cumulative rate tables.
+
+ For each layer, the threshold is read off tables of bytes and distortion decrease
+ per log slope, built once from the feasible truncation points and an estimate
+ of packet header cost. Exact T2 simulation is then only used to measure the estimation
+ error and correct the threshold once; bisection is only needed if the corrected
+ threshold still does not fit.
+ */
+bool TileProcessor::pcrdIncremental(uint32_t* allPacketBytes, bool disableRateControl)
+{
+	bool single_lossless = tcp_->max_layers_ == 1 && !layerNeedsRateControl(0);
+	const double K = 1;
+	auto tcp = tcp_;
+	RateInfo rateInfo;
+	double maxSE = feasibleTruncation(&rateInfo, single_lossless);
+	auto t2 = T2Compress(this);
+	if(single_lossless)
+	{
+		makeSingleLosslessLayer();
+
+		// simulation will generate correct PLT lengths
+		// and correct tile length
+		return t2.compressPacketsSimulate(tileIndex_, 0 + 1U, allPacketBytes, UINT_MAX,
+										  newTilePartProgressionPosition,
+										  packetLengthCache.getMarkers(), true, false);
+	}
+	uint64_t numPacketsPerLayer = getNumPacketsPerLayer();
+	uint32_t packetOverhead = getPacketOverhead();
+
+	RateEstimator estimator;
+	uint16_t upperBound = USHRT_MAX;
+	uint32_t maxLayerLength = UINT_MAX;
+	// exact number of bytes in all layers formed so far
+	uint32_t previousBytes = 0;
+	double cumulativeDistortion = 0;
+	for(uint16_t layno = 0; layno < tcp->max_layers_; layno++)
+	{
+		maxLayerLength = (!disableRateControl && tcp->rates[layno] > 0.0f)
+							 ? ((uint32_t)ceil(tcp->rates[layno]))
+							 : UINT_MAX;
+		if(!layerNeedsRateControl(layno))
+		{
+			makeLayerFinal(layno);
+			continue;
+		}
+		estimator.reset(numPacketsPerLayer, packetOverhead);
+		addToRateEstimator(&estimator, layno);
+		estimator.finalize();
+		uint16_t thresh;
+		if(cp_->coding_params_.enc_.allocationByFixedQuality_)
+		{
+			double distortionTarget =
+				tile->distortion - ((K * maxSE) / pow(10.0, tcp->distortion[layno] / 10.0));
+			thresh = estimator.getThreshForDistortion(distortionTarget - cumulativeDistortion,
+													  upperBound);
+		}
+		else if(maxLayerLength == UINT_MAX)
+		{
+			thresh = 0;
+		}
+		else
+		{
+			// last threshold successfully simulated, and its exact size
+			uint32_t simulatedThresh = USHRT_MAX + 1U;
+			uint32_t simulatedBytes = 0;
+			auto fits = [&](uint16_t t, uint32_t maxBytes) {
+				makeLayerFeasible(layno, t, false);
+				if(!t2.compressPacketsSimulate(tileIndex_, (uint16_t)(layno + 1U), allPacketBytes,
+											   maxBytes, newTilePartProgressionPosition,
+											   packetLengthCache.getMarkers(), false, false))
+					return false;
+				simulatedThresh = t;
+				simulatedBytes = *allPacketBytes;
+				return true;
+			};
+			uint64_t layerBudget =
+				maxLayerLength > previousBytes ? maxLayerLength - previousBytes : 0;
+			thresh = estimator.getThreshForBytes(layerBudget, upperBound);
+			// 1. measure exact size at estimated threshold
+			bool measured = fits(thresh, UINT_MAX);
+			if(measured)
+			{
+				int64_t error = (int64_t)simulatedBytes - (int64_t)previousBytes -
+								(int64_t)estimator.getBytes(thresh);
+				int64_t correctedBudget = (int64_t)layerBudget - error;
+				uint16_t corrected =
+					correctedBudget > 0
+						? estimator.getThreshForBytes((uint64_t)correctedBudget, upperBound)
+						: upperBound;
+				if(simulatedBytes <= maxLayerLength)
+				{
+					// 2a. estimate was conservative: spend the measured slack
+					if(corrected < thresh && fits(corrected, maxLayerLength))
+						thresh = corrected;
+				}
+				else if(thresh < upperBound)
+				{
+					// 2b. estimate was optimistic: remove the measured excess
+					thresh = std::max<uint16_t>(corrected, (uint16_t)(thresh + 1U));
+					measured = fits(thresh, maxLayerLength);
+				}
+				else
+				{
+					measured = false;
+				}
+			}
+			// 3. fall back to bisection above the current threshold
+			if(!measured)
+			{
+				uint32_t lowerBound = thresh;
+				uint32_t upper = upperBound;
+				while(upper - lowerBound > 1)
+				{
+					uint32_t mid = (lowerBound + upper) >> 1;
+					if(fits((uint16_t)mid, maxLayerLength))
+						upper = mid;
+					else
+						lowerBound = mid;
+				}
+				thresh = (uint16_t)upper;
+			}
+			if(simulatedThresh != thresh)
+			{
+				if(fits(thresh, UINT_MAX))
+					previousBytes = simulatedBytes;
+			}
+			else
+			{
+				previousBytes = simulatedBytes;
+			}
+		}
+		makeLayerFeasible(layno, thresh, true);
+		cumulativeDistortion += tile->layerDistoration[layno];
+		upperBound = thresh;
+	}
+
+	// final simulation will generate correct PLT lengths
+	// and correct tile length
+	return t2.compressPacketsSimulate(tileIndex_, tcp->max_layers_, allPacketBytes, maxLayerLength,
+									  newTilePartProgressionPosition,
+									  packetLengthCache.getMarkers(), true, false);
+}
+uint64_t TileProcessor::getNumPacketsPerLayer(void)
+{
+	uint64_t numPacketsPerLayer = 0;
+	for(uint16_t compno = 0; compno < tile->numcomps_; compno++)
+	{
+		auto tilec = tile->comps + compno;
+		for(uint8_t resno = 0; resno < tilec->numresolutions; resno++)
+		{
+			auto res = tilec->resolutions_ + resno;
+			numPacketsPerLayer += (uint64_t)res->precinctGridWidth * res->precinctGridHeight;
+		}
+	}
+
+	return numPacketsPerLayer;
+}
+uint32_t TileProcessor::getPacketOverhead(void)
+{
+	uint32_t packetOverhead = 1;
+	if(tcp_->csty & J2K_CP_CSTY_SOP)
+		packetOverhead += 6;
+	if(tcp_->csty & J2K_CP_CSTY_EPH)
+		packetOverhead += 2;
+
+	return packetOverhead;
+}
+void TileProcessor::addToRateEstimator(RateEstimator* estimator, uint16_t layno)
+{
+	for(uint16_t compno = 0; compno < tile->numcomps_; compno++)
+	{
+		auto tilec = tile->comps + compno;
+		for(uint8_t resno = 0; resno < tilec->numresolutions; resno++)
+		{
+			auto res = tilec->resolutions_ + resno;
+			for(uint8_t bandIndex = 0; bandIndex < res->numTileBandWindows; bandIndex++)
+			{
+				auto band = res->tileBand + bandIndex;
+				for(auto prc : band->precincts)
+				{
+					for(uint64_t cblkno = 0; cblkno < prc->getNumCblks(); cblkno++)
+					{
+						auto cblk = prc->getCompressedBlockPtr(cblkno);
+						if(layno == 0)
+							cblk->numPassesInPreviousPackets = 0;
+						estimator->add(cblk);
+					}
+				}
+			}
+		}
+	}
+}
+double TileProcessor::prepareRateControl(void)
+{
+	RateInfo rateInfo;
+
+	return feasibleTruncation(&rateInfo, false);
+}
+bool TileProcessor::simulateLayer(uint16_t layno, uint16_t thresh, uint32_t* allPacketBytes)
+{
+	makeLayerFeasible(layno, thresh, false);
+	auto t2 = T2Compress(this);
+
+	return t2.compressPacketsSimulate(tileIndex_, (uint16_t)(layno + 1U), allPacketBytes, UINT_MAX,
+									  newTilePartProgressionPosition, nullptr, false, false);
+}
+bool TileProcessor::finalizeRateControl(void)
+{
+	packetLengthCache.deleteMarkers();
+	if(cp_->coding_params_.enc_.writePLT)
+		packetLengthCache.createMarkers(stream_);
+	// final simulation will generate correct PLT lengths
+	// and correct tile length
+	uint32_t allPacketBytes = 0;
+	auto t2 = T2Compress(this);
+	if(!t2.compressPacketsSimulate(tileIndex_, tcp_->max_layers_, &allPacketBytes, UINT_MAX,
+								   newTilePartProgressionPosition, packetLengthCache.getMarkers(),
+								   true, false))
+		return false;
+	packetTracker_.clear();
+	preCalculateTileLen(allPacketBytes);
+
+	return true;
+}
 /*
  Simple bisect algorithm to calculate optimal layer truncation points
  */
@@ -26,6 +26,9 @@
 
 namespace grk
 {
+class RateInfo;
+class RateEstimator;
+
 /*
  * Tile structure.
  *
@@ -86,6 +89,10 @@ struct TileProcessor
 	bool canWritePocMarker(void);
 	bool writeTilePartT2(uint32_t* tileBytesWritten);
 	bool doCompress(void);
+	/**
+	 * Compression up to and including T1: DC level shift, MCT, DWT and code block coding
+	 */
+	bool compressT1(void);
 	bool decompressT2T1(GrkImage* outputImage);
 	bool ingestUncompressedData(uint8_t* p_src, uint64_t src_length);
 	bool needsRateControl();
@@ -94,6 +101,7 @@ struct TileProcessor
 	void generateImage(GrkImage* src_image, Tile* src_tile);
 	GrkImage* getImage(void);
 	void release(GRK_TILE_CACHE_STRATEGY strategy);
+	void releaseImage(void);
 	void setCorruptPacket(void);
 	PacketTracker* getPacketTracker(void);
 	grk_rect32 getUnreducedTileWindow(void);
@@ -107,6 +115,10 @@ struct TileProcessor
 	Tile* getTile(void);
 	Scheduler* getScheduler(void);
 	bool isCompressor(void);
+	/**
+	 * Arena owning the tile's code blocks; freed when tile is released
+	 */
+	BlockArena* getBlockArena(void);
 
 	/** Compression Only
 	 *  true for first POC tile part, otherwise false*/
@@ -133,7 +145,46 @@ struct TileProcessor
 	uint64_t getNumDecompressedPackets(void);
 	void incNumDecompressedPackets(void);
 
+	// rate control shared with image-wide allocation (see GlobalRateAllocator)
+	bool layerNeedsRateControl(uint32_t layno);
+	void makeLayerFinal(uint32_t layno);
+	bool makeLayerFeasible(uint32_t layno, uint16_t thresh, bool finalAttempt);
+	uint64_t getNumPacketsPerLayer(void);
+	uint32_t getPacketOverhead(void);
+	/**
+	 * Add truncation points not yet assigned to a previous layer to rate estimator
+	 */
+	void addToRateEstimator(RateEstimator* estimator, uint16_t layno);
+	/**
+	 * Calculate feasible truncation points for all code blocks, after T1
+	 * @return maximum squared error for the tile
+	 */
+	double prepareRateControl(void);
+	/**
+	 * Form layer at threshold, and simulate T2 for all layers up to and including this one
+	 */
+	bool simulateLayer(uint16_t layno, uint16_t thresh, uint32_t* allPacketBytes);
+	/**
+	 * Generate PLT marker and tile length once all layers have been formed
+	 */
+	bool finalizeRateControl(void);
+
   private:
+	/**
+	 * Check if deferred packets can be parsed in the same task graph as T1,
+	 * with each resolution's packets preceding its blocks
+	 */
+	bool canPipelinePackets(uint64_t parserCount);
+	void prepareResolutionsForPipeline(void);
+	/**
+	 * Check if packets can be streamed: read in code stream order by tasks that
+	 * precede each resolution's blocks, when packet lengths are not known in advance
+	 */
+	bool canStreamPackets(void);
+	/**
+	 * Parse packets deferred by T2, concurrently across precincts
+	 */
+	void readDeferredPackets(uint64_t parserCount);
 	bool isWholeTileDecompress(uint16_t compno);
 	bool needsMctDecompress(uint16_t compno);
 	bool needsMctDecompress(void);
@@ -144,13 +195,13 @@ struct TileProcessor
 	void t1_encode();
 	bool encodeT2(uint32_t* packet_bytes_written);
 	bool rateAllocate(uint32_t* allPacketBytes, bool disableRateControl);
-	bool layerNeedsRateControl(uint32_t layno);
 	bool makeSingleLosslessLayer();
-	void makeLayerFinal(uint32_t layno);
 	bool pcrdBisectSimple(uint32_t* p_data_written, bool disableRateControl);
 	void makeLayerSimple(uint32_t layno, double thresh, bool finalAttempt);
 	bool pcrdBisectFeasible(uint32_t* p_data_written, bool disableRateControl);
-	bool makeLayerFeasible(uint32_t layno, uint16_t thresh, bool finalAttempt);
+	double feasibleTruncation(RateInfo* rateInfo, bool single_lossless);
+	bool pcrdIncremental(uint32_t* p_data_written, bool disableRateControl);
+	void preCalculateTileLen(uint32_t allPacketBytes);
 
 	Tile* tile;
 	Scheduler* scheduler_;
@@ -175,6 +226,8 @@ struct TileProcessor
 	grk_rect32 unreducedImageWindow;
 	uint32_t preCalculatedTileLen;
 	mct* mct_;
+	StripCache* stripCache_;
+	BlockArena blockArena_;
 };
 
 } // namespace grk
@@ -19,6 +19,10 @@
  *
  */
 #include "grk_includes.h"
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 namespace grk
 {
 template<typename TYPE>
@@ -31,7 +35,8 @@ BufferedStream::BufferedStream(uint8_t* buffer, size_t buffer_size, bool is_inpu
 	: user_data_(nullptr), free_user_data_fn_(nullptr), user_data_length_(0), read_fn_(nullptr),
 	  zero_copy_read_fn_(nullptr), write_fn_(nullptr), seek_fn_(nullptr),
 	  status_(is_input ? GROK_STREAM_STATUS_INPUT : GROK_STREAM_STATUS_OUTPUT), buf_(nullptr),
-	  buffered_bytes_(0), read_bytes_seekable_(0), stream_offset_(0), format_(GRK_CODEC_UNK)
+	  buffered_bytes_(0), read_bytes_seekable_(0), stream_offset_(0), format_(GRK_CODEC_UNK),
+	  mapped_(false)
 {
 	buf_ = new grk_buf8((!buffer && buffer_size) ? new uint8_t[buffer_size] : buffer, buffer_size,
 						buffer == nullptr);
@@ -358,6 +363,27 @@ uint8_t* BufferedStream::getZeroCopyPtr()
 {
 	return buf_->currPtr();
 }
+void BufferedStream::setMapped(void)
+{
+	mapped_ = true;
+}
+bool BufferedStream::supportsPrefetch(void)
+{
+	return mapped_ && supportsZeroCopy();
+}
+void BufferedStream::prefetch([[maybe_unused]] uint64_t offset, [[maybe_unused]] uint64_t len)
+{
+#ifndef _WIN32
+	if(!supportsPrefetch() || offset >= buf_->len)
+		return;
+	len = std::min(len, (uint64_t)buf_->len - offset);
+	// madvise requires a page-aligned address
+	auto pageSize = (uint64_t)sysconf(_SC_PAGESIZE);
+	auto addr = (uintptr_t)(buf_->buf + offset);
+	auto alignedAddr = addr & ~(uintptr_t)(pageSize - 1);
+	madvise((void*)alignedAddr, len + (addr - alignedAddr), MADV_WILLNEED);
+#endif
+}
 
 bool BufferedStream::read_skip(int64_t p_size)
 {
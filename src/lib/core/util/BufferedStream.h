@@ -113,6 +113,18 @@ struct BufferedStream
 	bool hasSeek();
 	bool supportsZeroCopy();
 	uint8_t* getZeroCopyPtr();
+	/**
+	 * Mark stream as backed by a memory-mapped file
+	 */
+	void setMapped(void);
+	bool supportsPrefetch(void);
+	/**
+	 * Ask the OS to asynchronously page in a region of a memory-mapped stream
+	 *
+	 * @param offset absolute stream offset
+	 * @param len number of bytes
+	 */
+	void prefetch(uint64_t offset, uint64_t len);
 
 	void setFormat(GRK_CODEC_FORMAT format);
 	GRK_CODEC_FORMAT getFormat(void);
@@ -211,6 +223,8 @@ struct BufferedStream
 	uint64_t stream_offset_;
 
 	GRK_CODEC_FORMAT format_;
+
+	bool mapped_;
 };
 
 template<typename TYPE>
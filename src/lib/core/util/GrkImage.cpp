@@ -243,7 +243,7 @@ void GrkImage::copyHeader(GrkImage* dest)
 
 	if(dest->comps)
 	{
-		all_components_data_free();
+		dest->all_components_data_free();
 		delete[] dest->comps;
 		dest->comps = nullptr;
 	}
@@ -316,20 +316,19 @@ bool GrkImage::allocData(grk_image_comp* comp, bool clear)
 
 bool GrkImage::supportsStripCache(CodingParams* cp)
 {
-	if(!cp->wholeTileDecompress_)
+	if(!cp->wholeTileDecompress_ || numcomps > grk::maxNumPackComponents)
 		return false;
 
 	if(hasMultipleTiles)
 	{
 		// packed tile width bits must be divisible by 8
-		if(((cp->t_width * numcomps * comps->prec) & 7) != 0)
+		if(((cp->t_width * decompressNumComps * comps->prec) & 7) != 0)
 			return false;
 	}
-	else
+	else if(numcomps > 1 && cp->tcps->mct == 2)
 	{
-		// only mono supported
-		if(numcomps > 1)
-			return false;
+		// custom MCT is applied to the whole tile rather than strip by strip
+		return false;
 	}
 
 	// difference between image origin y coordinate and tile origin y coordinate
@@ -339,17 +338,72 @@ bool GrkImage::supportsStripCache(CodingParams* cp)
 	if(((y0 - cp->ty0) % cp->t_height) != 0)
 		return false;
 
-	bool supportedFileFormat =
-		decompressFormat == GRK_FMT_TIF || (decompressFormat == GRK_FMT_PXM && !splitByComponent);
-	if(isSubsampled() || precision || upsample || needsConversionToRGB() || !supportedFileFormat ||
-	   (meta && (meta->color.palette || meta->color.icc_profile_buf)))
+	bool supportedFileFormat = false;
+	switch(decompressFormat)
+	{
+		case GRK_FMT_TIF:
+			supportedFileFormat = true;
+			break;
+		case GRK_FMT_PXM:
+			// signed samples are shifted by application
+			supportedFileFormat = !splitByComponent && !comps->sgnd;
+			break;
+		case GRK_FMT_PNG:
+			// 8 or 16 bit container: low precision grey is bit packed instead
+			supportedFileFormat =
+				numcomps <= 4 && !comps->sgnd && (numcomps > 1 || comps->prec >= 5);
+			break;
+		case GRK_FMT_JPG:
+			// grey, RGB or CMYK baseline samples are written as scanlines
+			supportedFileFormat =
+				numcomps <= 4 && numcomps != 2 && !comps->sgnd && comps->prec == 8;
+			break;
+		default:
+			break;
+	}
+	if(precision || upsample || needsConversionToRGB() || !supportedFileFormat ||
+	   (meta && (meta->color.palette || needsColourManagement())))
 	{
 		return false;
 	}
+	if(isSubsampled())
+		return supportsSubsampledStrips(cp);
 
 	return componentsEqual(true);
 }
 
+/**
+ * Check if subsampled image can be packed strip by strip into TIFF YCbCr units.
+ * Strip and tile boundaries must fall on unit boundaries.
+ */
+bool GrkImage::supportsSubsampledStrips(CodingParams* cp)
+{
+	if(!isTiffSubsampled() || numcomps != 3 || comps->dx != 1 || comps->dy != 1 ||
+	   comps->prec != 8 || cp->coding_params_.dec_.reduce_)
+	{
+		return false;
+	}
+	if(!componentsEqual(comps + 1, comps + 2, true) || comps[1].prec != comps->prec ||
+	   comps[1].sgnd != comps->sgnd)
+	{
+		return false;
+	}
+	uint32_t dx = comps[1].dx;
+	uint32_t dy = comps[1].dy;
+	if((x0 % dx) != 0 || (y0 % dy) != 0)
+		return false;
+	if(hasMultipleTiles)
+		return (cp->t_width % dx) == 0 && (cp->t_height % dy) == 0 && (cp->tx0 % dx) == 0 &&
+			   (cp->ty0 % dy) == 0;
+
+	return (rowsPerTask % dy) == 0;
+}
+
+bool GrkImage::isTiffSubsampled(void)
+{
+	return decompressFormat == GRK_FMT_TIF && isSubsampled() &&
+		   (color_space == GRK_CLRSPC_EYCC || color_space == GRK_CLRSPC_SYCC);
+}
 bool GrkImage::isSubsampled()
 {
 	for(uint32_t i = 0; i < numcomps; ++i)
@@ -404,17 +458,19 @@ void GrkImage::postReadHeader(CodingParams* cp)
 	decompressColourSpace = color_space;
 	if(needsConversionToRGB())
 		decompressColourSpace = GRK_CLRSPC_SRGB;
-	bool tiffSubSampled = decompressFormat == GRK_FMT_TIF && isSubsampled() &&
-						  (color_space == GRK_CLRSPC_EYCC || color_space == GRK_CLRSPC_SYCC);
-	if(tiffSubSampled)
+	if(isTiffSubsampled())
 	{
 		uint32_t chroma_subsample_x = comps[1].dx;
 		uint32_t chroma_subsample_y = comps[1].dy;
 		uint32_t units = (decompressWidth + chroma_subsample_x - 1) / chroma_subsample_x;
-		packedRowBytes =
-			(uint64_t)((((uint64_t)decompressWidth * chroma_subsample_y + units * 2U) * prec + 7U) /
-					   8U);
-		rowsPerStrip = (uint32_t)((chroma_subsample_y * 8 * 1024 * 1024) / packedRowBytes);
+		// each unit holds a block of luma samples followed by Cb and Cr samples,
+		// and each packed row covers chroma_subsample_y rows of luma
+		uint32_t unitSamples = chroma_subsample_x * chroma_subsample_y + 2U;
+		packedRowBytes = ((uint64_t)units * unitSamples * prec + 7U) / 8U;
+		// TIFF requires strip height to be a multiple of the vertical subsampling
+		rowsPerStrip = hasMultipleTiles ? ceildivpow2(cp->t_height, cp->coding_params_.dec_.reduce_)
+										: singleTileRowsPerStrip;
+		rowsPerStrip = ceildiv<uint32_t>(rowsPerStrip, chroma_subsample_y) * chroma_subsample_y;
 	}
 	else
 	{
@@ -424,6 +480,8 @@ void GrkImage::postReadHeader(CodingParams* cp)
 				packedRowBytes = (((uint64_t)ncmp * decompressWidth + 3) >> 2) << 2;
 				break;
 			case GRK_FMT_PXM:
+			case GRK_FMT_PNG:
+			case GRK_FMT_JPG:
 				packedRowBytes = grk::PlanarToInterleaved<int32_t>::getPackedBytes(
 					ncmp, decompressWidth, prec > 8 ? 16 : 8);
 				break;
@@ -964,6 +1022,66 @@ void GrkImage::transferDataFrom(const Tile* tile_src_data)
 	}
 }
 
+/**
+ * Pack subsampled YCbCr planes into TIFF YCbCr units. Each unit holds
+ * dx * dy luma samples, padded with zeros past the image edge,
+ * followed by one Cb and one Cr sample
+ *
+ * @param planes 		luma, Cb and Cr planes
+ * @param strides 		plane strides
+ * @param width 		luma width
+ * @param height 		luma height
+ * @param dx 			horizontal chroma subsampling
+ * @param dy 			vertical chroma subsampling
+ * @param dest 			destination buffer
+ * @param destStride 	destination stride, covering dy rows of luma
+ */
+static void packYCbCrUnits(int32_t const* const* planes, const uint32_t* strides, uint32_t width,
+						   uint32_t height, uint32_t dx, uint32_t dy, uint8_t* dest,
+						   uint64_t destStride)
+{
+	uint32_t units = (width + dx - 1) / dx;
+	for(uint32_t y = 0; y < height; y += dy)
+	{
+		auto luma = planes[0] + (uint64_t)y * strides[0];
+		auto cb = planes[1] + (uint64_t)(y / dy) * strides[1];
+		auto cr = planes[2] + (uint64_t)(y / dy) * strides[2];
+		auto out = dest;
+		for(uint32_t u = 0; u < units; ++u)
+		{
+			for(uint32_t j = 0; j < dy; ++j)
+			{
+				for(uint32_t i = u * dx; i < u * dx + dx; ++i)
+				{
+					bool inside = y + j < height && i < width;
+					*out++ = inside ? (uint8_t)luma[i + (uint64_t)j * strides[0]] : 0;
+				}
+			}
+			*out++ = (uint8_t)cb[u];
+			*out++ = (uint8_t)cr[u];
+		}
+		dest += destStride;
+	}
+}
+
+/**
+ * Get offset of destination window in TIFF YCbCr units
+ *
+ * @param destWin 		destination window, relative to first component
+ * @param destStride 	(out) destination stride
+ *
+ * @return offset in bytes
+ */
+uint64_t GrkImage::unitOffset(grk_rect32 destWin, uint64_t* destStride) const
+{
+	uint32_t dx = comps[1].dx;
+	uint32_t dy = comps[1].dy;
+	uint64_t unitBytes = dx * dy + 2U;
+	*destStride = (uint64_t)((comps->w + dx - 1) / dx) * unitBytes;
+
+	return (uint64_t)(destWin.y0 / dy) * *destStride + (destWin.x0 / dx) * unitBytes;
+}
+
 bool GrkImage::composite(const GrkImage* srcImg)
 {
 	return interleavedData.data_ ? compositeInterleaved(srcImg) : compositePlanar(srcImg);
@@ -998,6 +1116,23 @@ bool GrkImage::compositeInterleaved(const Tile* src, uint32_t yBegin, uint32_t y
 			return false;
 		}
 	}
+	if(isTiffSubsampled())
+	{
+		int32_t const* planes[3];
+		uint32_t strides[3];
+		for(uint16_t i = 0; i < 3; ++i)
+		{
+			auto b = (src->comps + i)->getWindow()->getResWindowBufferHighestSimple();
+			planes[i] = b.buf_ + (uint64_t)(yBegin / comps[i].dy) * b.stride_;
+			strides[i] = b.stride_;
+		}
+		uint64_t destStride;
+		auto destIndex = unitOffset(destWin, &destStride);
+		packYCbCrUnits(planes, strides, destWin.width(), destWin.height(), comps[1].dx,
+					   comps[1].dy, interleavedData.data_ + destIndex, destStride);
+
+		return true;
+	}
 	uint8_t prec = 0;
 	switch(decompressFormat)
 	{
@@ -1005,6 +1140,8 @@ bool GrkImage::compositeInterleaved(const Tile* src, uint32_t yBegin, uint32_t y
 			prec = destComp->prec;
 			break;
 		case GRK_FMT_PXM:
+		case GRK_FMT_PNG:
+		case GRK_FMT_JPG:
 			prec = destComp->prec > 8 ? 16 : 8;
 			break;
 		default:
@@ -1012,21 +1149,21 @@ bool GrkImage::compositeInterleaved(const Tile* src, uint32_t yBegin, uint32_t y
 			break;
 	}
 	auto destStride =
-		grk::PlanarToInterleaved<int32_t>::getPackedBytes(src->numcomps_, destComp->w, prec);
+		grk::PlanarToInterleaved<int32_t>::getPackedBytes(decompressNumComps, destComp->w, prec);
 	auto destx0 =
-		grk::PlanarToInterleaved<int32_t>::getPackedBytes(src->numcomps_, destWin.x0, prec);
+		grk::PlanarToInterleaved<int32_t>::getPackedBytes(decompressNumComps, destWin.x0, prec);
 	auto destIndex = (uint64_t)destWin.y0 * destStride + (uint64_t)destx0;
 	auto iter = InterleaverFactory<int32_t>::makeInterleaver(
 		prec == 16 && decompressFormat != GRK_FMT_TIF ? packer16BitBE : prec);
 	if(!iter)
 		return false;
 	int32_t const* planes[grk::maxNumPackComponents];
-	for(uint16_t i = 0; i < src->numcomps_; ++i)
+	for(uint16_t i = 0; i < decompressNumComps; ++i)
 	{
 		auto b = (src->comps + i)->getWindow()->getResWindowBufferHighestSimple();
 		planes[i] = b.buf_ + yBegin * b.stride_;
 	}
-	iter->interleave(const_cast<int32_t**>(planes), src->numcomps_,
+	iter->interleave(const_cast<int32_t**>(planes), decompressNumComps,
 					 interleavedData.data_ + destIndex, destWin.width(),
 					 srcComp->getWindow()->getResWindowBufferHighestStride(), destStride,
 					 destWin.height(), 0);
@@ -1062,6 +1199,22 @@ bool GrkImage::compositeInterleaved(const GrkImage* src)
 			return false;
 		}
 	}
+	if(isTiffSubsampled())
+	{
+		int32_t const* planes[3];
+		uint32_t strides[3];
+		for(uint16_t i = 0; i < 3; ++i)
+		{
+			planes[i] = (src->comps + i)->data;
+			strides[i] = (src->comps + i)->stride;
+		}
+		uint64_t destStride;
+		auto destIndex = unitOffset(destWin, &destStride);
+		packYCbCrUnits(planes, strides, destWin.width(), destWin.height(), comps[1].dx,
+					   comps[1].dy, interleavedData.data_ + destIndex, destStride);
+
+		return true;
+	}
 	uint8_t prec = 0;
 	switch(decompressFormat)
 	{
@@ -1069,6 +1222,8 @@ bool GrkImage::compositeInterleaved(const GrkImage* src)
 			prec = destComp->prec;
 			break;
 		case GRK_FMT_PXM:
+		case GRK_FMT_PNG:
+		case GRK_FMT_JPG:
 			prec = destComp->prec > 8 ? 16 : 8;
 			break;
 		default:
@@ -1076,17 +1231,17 @@ bool GrkImage::compositeInterleaved(const GrkImage* src)
 			break;
 	}
 	auto destStride =
-		grk::PlanarToInterleaved<int32_t>::getPackedBytes(src->numcomps, destComp->w, prec);
+		grk::PlanarToInterleaved<int32_t>::getPackedBytes(decompressNumComps, destComp->w, prec);
 	auto destx0 =
-		grk::PlanarToInterleaved<int32_t>::getPackedBytes(src->numcomps, destWin.x0, prec);
+		grk::PlanarToInterleaved<int32_t>::getPackedBytes(decompressNumComps, destWin.x0, prec);
 	auto destIndex = (uint64_t)destWin.y0 * destStride + (uint64_t)destx0;
 	auto iter = InterleaverFactory<int32_t>::makeInterleaver(prec == 16 ? packer16BitBE : prec);
 	if(!iter)
 		return false;
 	int32_t const* planes[grk::maxNumPackComponents];
-	for(uint16_t i = 0; i < src->numcomps; ++i)
+	for(uint16_t i = 0; i < decompressNumComps; ++i)
 		planes[i] = (src->comps + i)->data;
-	iter->interleave(const_cast<int32_t**>(planes), src->numcomps,
+	iter->interleave(const_cast<int32_t**>(planes), decompressNumComps,
 					 interleavedData.data_ + destIndex, destWin.width(), srcComp->stride,
 					 destStride, destWin.height(), 0);
 	delete iter;
@@ -1128,11 +1283,15 @@ bool GrkImage::compositePlanar(const GrkImage* src)
 								 compno);
 			continue;
 		}
-		size_t srcIndex = 0;
+		if(destWin.empty())
+			continue;
+		// source may extend beyond destination
+		size_t srcIndex = (size_t)(destWin.x0 + destComp->x0 - srcComp->x0) +
+						  (size_t)(destWin.y0 + destComp->y0 - srcComp->y0) * srcComp->stride;
 		auto destIndex = (size_t)destWin.x0 + (size_t)destWin.y0 * destComp->stride;
 		size_t destLineOffset = (size_t)destComp->stride - (size_t)destWin.width();
 		auto src_ptr = srcComp->data;
-		uint32_t srcLineOffset = srcComp->stride - srcComp->w;
+		uint32_t srcLineOffset = srcComp->stride - destWin.width();
 		for(uint32_t j = 0; j < destWin.height(); ++j)
 		{
 			memcpy(destComp->data + destIndex, src_ptr + srcIndex,
@@ -1146,7 +1305,7 @@ bool GrkImage::compositePlanar(const GrkImage* src)
 }
 /***
  * Generate destination window (relative to destination component bounds)
- * Assumption: source region is wholly contained inside destination component region
+ * from intersection of source region with destination component region
  */
 bool GrkImage::generateCompositeBounds(grk_rect32 src, uint16_t destCompno, grk_rect32* destWin)
 {
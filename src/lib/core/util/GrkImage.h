@@ -87,6 +87,10 @@ class GrkImage : public grk_image
 	void postReadHeader(CodingParams* cp);
 	void validateColourSpace(void);
 	bool isSubsampled();
+	/**
+	 * True if image is stored as TIFF YCbCr with subsampled chroma
+	 */
+	bool isTiffSubsampled(void);
 	bool validateZeroed(void);
 	bool applyColour(void);
 	bool apply_palette_clr(void);
@@ -106,6 +110,9 @@ class GrkImage : public grk_image
 	std::string getICCColourSpaceString(cmsColorSpaceSignature color_space);
 	bool isValidICCColourSpace(uint32_t signature);
 	bool needsConversionToRGB(void);
+	bool needsColourManagement(void);
+	bool supportsSubsampledStrips(CodingParams* cp);
+	uint64_t unitOffset(grk_rect32 destWin, uint64_t* destStride) const;
 	bool isOpacity(uint16_t compno);
 	bool compositePlanar(const GrkImage* srcImg);
 	bool generateCompositeBounds(const grk_image_comp* srcComp, uint16_t destCompno,
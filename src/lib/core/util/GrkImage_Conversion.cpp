@@ -1145,13 +1145,13 @@ bool GrkImage::validateICC(void)
 	return imagePropertiesMatchICCColourSpace;
 }
 
-/**
- * Convert to sRGB
+/***
+ * Check if ICC profile must be applied to pixels, rather than stored in output file
  */
-bool GrkImage::applyColourManagement(void)
+bool GrkImage::needsColourManagement(void)
 {
 	if(!meta || !meta->color.icc_profile_buf)
-		return true;
+		return false;
 
 	bool isTiff = decompressFormat == GRK_FMT_TIF;
 	bool canStoreCIE = isTiff && color_space == GRK_CLRSPC_DEFAULT_CIE;
@@ -1163,12 +1163,18 @@ bool GrkImage::applyColourManagement(void)
 	bool canStoreICC = (decompressFormat == GRK_FMT_TIF || decompressFormat == GRK_FMT_PNG ||
 						decompressFormat == GRK_FMT_JPG || decompressFormat == GRK_FMT_BMP);
 
-	bool shouldApplyColourManagement =
-		forceRGB || (decompressFormat != GRK_FMT_UNK && meta && meta->color.icc_profile_buf &&
-					 ((isCIE && !canStoreCIE) || !canStoreICC));
-	if(!shouldApplyColourManagement)
+	return forceRGB ||
+		   (decompressFormat != GRK_FMT_UNK && ((isCIE && !canStoreCIE) || !canStoreICC));
+}
+/**
+ * Convert to sRGB
+ */
+bool GrkImage::applyColourManagement(void)
+{
+	if(!needsColourManagement())
 		return true;
 
+	bool isCIE = color_space == GRK_CLRSPC_DEFAULT_CIE || color_space == GRK_CLRSPC_CUSTOM_CIE;
 	if(isCIE)
 	{
 		if(!forceRGB)
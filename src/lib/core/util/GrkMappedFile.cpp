@@ -239,6 +239,7 @@ grk_stream* create_mapped_file_read_stream(const char* fname)
 	// now treat mapped file like any other memory stream
 	auto streamImpl = new BufferedStream(memStream->buf, memStream->len, true);
 	streamImpl->setFormat(fmt);
+	streamImpl->setMapped();
 	auto stream = streamImpl->getWrapper();
 	grk_stream_set_user_data(stream, memStream, (grk_stream_free_user_data_fn)mem_map_free);
 	set_up_mem_stream(stream, memStream->len, true);
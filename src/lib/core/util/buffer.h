@@ -363,13 +363,7 @@ struct grk_buf2d : protected grk_buf<T, A>, public grk_rect32
 
 		T* ptr = this->buf + (inter.y0 * stride + inter.x0);
 		T* srcPtr = src->buf + ((inter.y0 - src->y0) * src->stride + inter.x0 - src->x0);
-		uint32_t len = inter.width();
-		for(uint32_t j = inter.y0; j < inter.y1; ++j)
-		{
-			filter.copy(ptr, srcPtr, len);
-			ptr += stride;
-			srcPtr += src->stride;
-		}
+		filter.copy(ptr, stride, srcPtr, src->stride, inter.width(), inter.height());
 	}
 	struct memcpy_from
 	{
@@ -0,0 +1,296 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// Highway 5/3 and 9/7 forward lifting kernels, compiled once per target by each translation
+// unit that includes this file under HWY_TARGET_INCLUDE (see WaveletFwd.cpp)
+//
+// Lines are split into low and high pass bands before lifting, so that every lifting step
+// reads one band and updates the other. The steps are then free of loop carried
+// dependencies, and each output sample sees exactly the same sequence of operations
+// as in the scalar transform: 5/3 results are bit exact, and 9/7 results are bit exact
+// as long as the compiler does not contract multiply and add into FMA
+// (see -ffp-contract=off in CMakeLists.txt)
+
+#if defined(GRK_WAVELET_FWD_INL_H_) == defined(HWY_TARGET_TOGGLE)
+#ifdef GRK_WAVELET_FWD_INL_H_
+#undef GRK_WAVELET_FWD_INL_H_
+#else
+#define GRK_WAVELET_FWD_INL_H_
+#endif
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <hwy/highway.h>
+
+HWY_BEFORE_NAMESPACE();
+namespace grk
+{
+namespace HWY_NAMESPACE
+{
+	using namespace hwy::HWY_NAMESPACE;
+
+	/**
+	 * Number of columns processed in parallel by the vertical pass
+	 */
+	static size_t hwy_fwd_num_cols(void)
+	{
+		const HWY_FULL(int32_t) di;
+		return 2 * Lanes(di);
+	}
+
+	/* 5/3 predict step: high -= (low_0 + low_1) >> 1 */
+	struct fwd_predict_53
+	{
+		int32_t operator()(int32_t h, int32_t l0, int32_t l1) const
+		{
+			return h - ((l0 + l1) >> 1);
+		}
+		template<class D, class V>
+		V operator()(D, V h, V l0, V l1) const
+		{
+			return Sub(h, ShiftRight<1>(Add(l0, l1)));
+		}
+	};
+
+	/* 5/3 update step: low += (high_0 + high_1 + 2) >> 2 */
+	struct fwd_update_53
+	{
+		int32_t operator()(int32_t l, int32_t h0, int32_t h1) const
+		{
+			return l + ((h0 + h1 + 2) >> 2);
+		}
+		template<class D, class V>
+		V operator()(D d, V l, V h0, V h1) const
+		{
+			return Add(l, ShiftRight<2>(Add(Add(h0, h1), Set(d, 2))));
+		}
+	};
+
+	/* 9/7 lifting step: dst += (src_0 + src_1) * c */
+	struct fwd_lift_97
+	{
+		explicit fwd_lift_97(float c) : c_(c) {}
+		float operator()(float v, float s0, float s1) const
+		{
+			return v + (s0 + s1) * c_;
+		}
+		template<class D, class V>
+		V operator()(D d, V v, V s0, V s1) const
+		{
+			return Add(v, Mul(Add(s0, s1), Set(d, c_)));
+		}
+		float c_;
+	};
+
+	/**
+	 * Lifting step along a split line: for 0 <= i < dstLen,
+	 *
+	 * dst[i] = op(dst[i], src[i + off], src[i + off + 1])
+	 *
+	 * where off is either 0 or -1, and src indices are clamped to [0, srcLen),
+	 * which implements whole sample symmetric extension at both ends of the line.
+	 */
+	template<class D, typename T, class Op>
+	static void hwy_fwd_lift_line(D d, T* HWY_RESTRICT dst, uint32_t dstLen,
+								  const T* HWY_RESTRICT src, uint32_t srcLen, int32_t off,
+								  const Op& op)
+	{
+		const int64_t N = (int64_t)Lanes(d);
+		const int64_t last = (int64_t)srcLen - 1;
+		auto clamped = [src, last](int64_t j) { return src[j < 0 ? 0 : (j > last ? last : j)]; };
+		// samples in [begin,end) have both neighbours inside the band
+		const int64_t begin = (std::min<int64_t>)(-off, dstLen);
+		const int64_t end = (std::max<int64_t>)(begin, (std::min<int64_t>)(dstLen, last - off));
+		int64_t i = 0;
+		for(; i < begin; ++i)
+			dst[i] = op(dst[i], clamped(i + off), clamped(i + off + 1));
+		for(; i + N <= end; i += N)
+		{
+			auto v = op(d, LoadU(d, dst + i), LoadU(d, src + i + off), LoadU(d, src + i + off + 1));
+			StoreU(v, d, dst + i);
+		}
+		for(; i < (int64_t)dstLen; ++i)
+			dst[i] = op(dst[i], clamped(i + off), clamped(i + off + 1));
+	}
+
+	/**
+	 * Lifting step across width parallel split columns, stored as one band row
+	 * per line. width is a multiple of the number of lanes.
+	 */
+	template<class D, typename T, class Op>
+	static void hwy_fwd_lift_cols(D d, T* HWY_RESTRICT dst, uint32_t dstLen,
+								  const T* HWY_RESTRICT src, uint32_t srcLen, int32_t off,
+								  uint32_t width, const Op& op)
+	{
+		const size_t N = Lanes(d);
+		const int64_t last = (int64_t)srcLen - 1;
+		for(int64_t i = 0; i < (int64_t)dstLen; ++i)
+		{
+			int64_t j0 = std::clamp<int64_t>(i + off, 0, last);
+			int64_t j1 = std::clamp<int64_t>(i + off + 1, 0, last);
+			auto dstRow = dst + (size_t)i * width;
+			auto src0 = src + (size_t)j0 * width;
+			auto src1 = src + (size_t)j1 * width;
+			for(size_t k = 0; k < width; k += N)
+				Store(op(d, Load(d, dstRow + k), Load(d, src0 + k), Load(d, src1 + k)), d,
+					  dstRow + k);
+		}
+	}
+
+	/* scale len samples by c */
+	template<class D>
+	static void hwy_fwd_scale(D d, float* HWY_RESTRICT data, size_t len, float c)
+	{
+		const size_t N = Lanes(d);
+		const auto vc = Set(d, c);
+		size_t i = 0;
+		for(; i + N <= len; i += N)
+			StoreU(Mul(LoadU(d, data + i), vc), d, data + i);
+		for(; i < len; ++i)
+			data[i] *= c;
+	}
+
+	/**
+	 * Split line of len samples into low band at dest[0, sn) followed by high band
+	 * at dest[sn, len). For even lines, low band samples sit at even positions.
+	 */
+	template<class D, typename T>
+	static void hwy_fwd_split_line(D d, const T* HWY_RESTRICT src, T* HWY_RESTRICT dest,
+								   uint32_t len, bool even)
+	{
+		const uint32_t sn = (len + (even ? 1 : 0)) >> 1;
+		const size_t N = Lanes(d);
+		T* HWY_RESTRICT evenDest = even ? dest : dest + sn;
+		T* HWY_RESTRICT oddDest = even ? dest + sn : dest;
+		size_t i = 0;
+		for(; 2 * (i + N) <= len; i += N)
+		{
+			Vec<D> ev, od;
+			LoadInterleaved2(d, src + 2 * i, ev, od);
+			StoreU(ev, d, evenDest + i);
+			StoreU(od, d, oddDest + i);
+		}
+		for(; 2 * i < len; ++i)
+		{
+			evenDest[i] = src[2 * i];
+			if(2 * i + 1 < len)
+				oddDest[i] = src[2 * i + 1];
+		}
+	}
+
+	/**
+	 * Forward 5/3 transform of one row of width samples, in place. Transformed row
+	 * holds low band followed by high band. tmp holds at least width samples.
+	 */
+	static void hwy_fwd_h_53(int32_t* row, int32_t* tmp, uint32_t width, bool even)
+	{
+		if(width == 1)
+		{
+			if(!even)
+				row[0] *= 2;
+			return;
+		}
+		const HWY_FULL(int32_t) di;
+		const uint32_t sn = (width + (even ? 1 : 0)) >> 1;
+		const uint32_t dn = width - sn;
+		hwy_fwd_split_line(di, row, tmp, width, even);
+		hwy_fwd_lift_line(di, tmp + sn, dn, tmp, sn, even ? 0 : -1, fwd_predict_53());
+		hwy_fwd_lift_line(di, tmp, sn, tmp + sn, dn, even ? -1 : 0, fwd_update_53());
+		memcpy(row, tmp, width * sizeof(int32_t));
+	}
+
+	/**
+	 * Forward 5/3 transform of width parallel columns of height samples,
+	 * which have already been split into sn low band rows followed by
+	 * dn high band rows of width samples each
+	 */
+	static void hwy_fwd_v_53(int32_t* buf, uint32_t sn, uint32_t dn, bool even, uint32_t width)
+	{
+		const HWY_FULL(int32_t) di;
+		if(sn + dn == 1)
+		{
+			if(!even)
+			{
+				for(size_t k = 0; k < width; k += Lanes(di))
+					Store(Add(Load(di, buf + k), Load(di, buf + k)), di, buf + k);
+			}
+			return;
+		}
+		auto bandH = buf + (size_t)sn * width;
+		hwy_fwd_lift_cols(di, bandH, dn, buf, sn, even ? 0 : -1, width, fwd_predict_53());
+		hwy_fwd_lift_cols(di, buf, sn, bandH, dn, even ? -1 : 0, width, fwd_update_53());
+	}
+
+	/* From table F.4 from the standard */
+	static const float fwd_alpha = -1.586134342f;
+	static const float fwd_beta = -0.052980118f;
+	static const float fwd_gamma = 0.882911075f;
+	static const float fwd_delta = 0.443506852f;
+	static const float fwd_K = 1.230174105f;
+	static const float fwd_invK = (float)(1.0 / 1.230174105);
+
+	/**
+	 * Forward 9/7 transform of one row of width samples, in place. Transformed row
+	 * holds low band followed by high band. tmp holds at least width samples.
+	 */
+	static void hwy_fwd_h_97(float* row, float* tmp, uint32_t width, bool even)
+	{
+		if(width == 1)
+			return;
+		const HWY_FULL(float) df;
+		const uint32_t sn = (width + (even ? 1 : 0)) >> 1;
+		const uint32_t dn = width - sn;
+		const int32_t offH = even ? 0 : -1;
+		const int32_t offL = even ? -1 : 0;
+		auto bandH = tmp + sn;
+		hwy_fwd_split_line(df, row, tmp, width, even);
+		hwy_fwd_lift_line(df, bandH, dn, tmp, sn, offH, fwd_lift_97(fwd_alpha));
+		hwy_fwd_lift_line(df, tmp, sn, bandH, dn, offL, fwd_lift_97(fwd_beta));
+		hwy_fwd_lift_line(df, bandH, dn, tmp, sn, offH, fwd_lift_97(fwd_gamma));
+		hwy_fwd_lift_line(df, tmp, sn, bandH, dn, offL, fwd_lift_97(fwd_delta));
+		hwy_fwd_scale(df, tmp, sn, fwd_invK);
+		hwy_fwd_scale(df, bandH, dn, fwd_K);
+		memcpy(row, tmp, width * sizeof(float));
+	}
+
+	/**
+	 * Forward 9/7 transform of width parallel columns of height samples,
+	 * which have already been split into sn low band rows followed by
+	 * dn high band rows of width samples each
+	 */
+	static void hwy_fwd_v_97(float* buf, uint32_t sn, uint32_t dn, bool even, uint32_t width)
+	{
+		if(sn + dn == 1)
+			return;
+		const HWY_FULL(float) df;
+		const int32_t offH = even ? 0 : -1;
+		const int32_t offL = even ? -1 : 0;
+		auto bandH = buf + (size_t)sn * width;
+		hwy_fwd_lift_cols(df, bandH, dn, buf, sn, offH, width, fwd_lift_97(fwd_alpha));
+		hwy_fwd_lift_cols(df, buf, sn, bandH, dn, offL, width, fwd_lift_97(fwd_beta));
+		hwy_fwd_lift_cols(df, bandH, dn, buf, sn, offH, width, fwd_lift_97(fwd_gamma));
+		hwy_fwd_lift_cols(df, buf, sn, bandH, dn, offL, width, fwd_lift_97(fwd_delta));
+		hwy_fwd_scale(df, buf, (size_t)sn * width, fwd_invK);
+		hwy_fwd_scale(df, bandH, (size_t)dn * width, fwd_K);
+	}
+
+} // namespace HWY_NAMESPACE
+} // namespace grk
+HWY_AFTER_NAMESPACE();
+
+#endif
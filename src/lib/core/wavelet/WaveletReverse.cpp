@@ -28,6 +28,7 @@
 #define HWY_TARGET_INCLUDE "wavelet/WaveletReverse.cpp"
 #include <hwy/foreach_target.h>
 #include <hwy/highway.h>
+#include "WaveletReverse97-inl.h"
 HWY_BEFORE_NAMESPACE();
 namespace grk
 {
@@ -227,6 +228,52 @@ namespace HWY_NAMESPACE
 		hwy_decompress_v_final_memcpy_53(buf, total_height, dest, strideDest);
 	}
 
+	/**
+	 * Vertical 5/3 lifting step on one row of the fused transform: low rows are
+	 * updated from neighbouring high rows, and high rows from neighbouring low rows
+	 */
+	static void hwy_lift_row_53(int32_t* cur, const int32_t* prev, const int32_t* next,
+								uint32_t len, bool low)
+	{
+		const HWY_FULL(int32_t) di;
+		const size_t N = Lanes(di);
+		size_t i = 0;
+		if(low)
+		{
+			const auto two = Set(di, 2);
+			for(; i + N <= len; i += N)
+				StoreU(LoadU(di, cur + i) -
+						   ShiftRight<2>(LoadU(di, prev + i) + LoadU(di, next + i) + two),
+					   di, cur + i);
+			for(; i < len; ++i)
+				cur[i] -= (prev[i] + next[i] + 2) >> 2;
+		}
+		else
+		{
+			for(; i + N <= len; i += N)
+				StoreU(LoadU(di, cur + i) +
+						   ShiftRight<1>(LoadU(di, prev + i) + LoadU(di, next + i)),
+					   di, cur + i);
+			for(; i < len; ++i)
+				cur[i] += (prev[i] + next[i]) >> 1;
+		}
+	}
+	/**
+	 * Vertical 9/7 lifting step on one row of the fused transform
+	 */
+	static void hwy_lift_row_97(float* cur, const float* prev, const float* next, uint32_t len,
+								float c)
+	{
+		const HWY_FULL(float) df;
+		const size_t N = Lanes(df);
+		const auto vc = Set(df, c);
+		size_t i = 0;
+		for(; i + N <= len; i += N)
+			StoreU(Add(LoadU(df, cur + i), Mul(Add(LoadU(df, prev + i), LoadU(df, next + i)), vc)),
+				   df, cur + i);
+		for(; i < len; ++i)
+			cur[i] = cur[i] + (prev[i] + next[i]) * c;
+	}
 } // namespace HWY_NAMESPACE
 } // namespace grk
 HWY_AFTER_NAMESPACE();
@@ -237,6 +284,11 @@ namespace grk
 HWY_EXPORT(hwy_num_lanes);
 HWY_EXPORT(hwy_decompress_v_parity_even_mcols_53);
 HWY_EXPORT(hwy_decompress_v_parity_odd_mcols_53);
+HWY_EXPORT(hwy_num_lanes_97);
+HWY_EXPORT(hwy_decompress_step1_97);
+HWY_EXPORT(hwy_decompress_step2_97);
+HWY_EXPORT(hwy_lift_row_53);
+HWY_EXPORT(hwy_lift_row_97);
 /* <summary>                             */
 /* Determine maximum computed resolution level for inverse wavelet transform */
 /* </summary>                            */
@@ -270,249 +322,123 @@ static const float dwt_delta = -0.443506852f; /*  -3633 */
 static const float K = 1.230174105f; /*  10078 */
 static const float twice_invK = 1.625732422f;
 
-// #undef __SSE__
-
-#ifdef __SSE__
-void WaveletReverse::decompress_step1_sse_97(Params97 d, const __m128 c)
+// Notes:
+// 1. line buffer 0 offset == dwt->win_l.x0
+// 2. dwt->memL and dwt->memH are only set for partial decode
+// 3. offsets are in line buffer elements, each holding width floats
+template<typename T>
+Params97 WaveletReverse::makeParams97(dwt_data<T>* dwt, bool isBandL, bool step1, uint32_t width)
 {
-	// process 4 floats at a time
-	auto mmData = (__m128*)d.data;
-	uint32_t i;
-	for(i = 0; i + 3 < d.len; i += 4, mmData += 8)
-	{
-		mmData[0] = _mm_mul_ps(mmData[0], c);
-		mmData[2] = _mm_mul_ps(mmData[2], c);
-		mmData[4] = _mm_mul_ps(mmData[4], c);
-		mmData[6] = _mm_mul_ps(mmData[6], c);
-	}
-	for(; i < d.len; ++i, mmData += 2)
-		mmData[0] = _mm_mul_ps(mmData[0], c);
-}
-#endif
+	Params97 rc;
+	// band_0 specifies absolute start of line buffer
+	int64_t band_0 = isBandL ? dwt->win_l.x0 : dwt->win_h.x0;
+	int64_t band_1 = isBandL ? dwt->win_l.x1 : dwt->win_h.x1;
+	auto memPartial = isBandL ? dwt->memL : dwt->memH;
+	int64_t parityOffset = isBandL ? dwt->parity : !dwt->parity;
+	int64_t lenMax = isBandL
+						 ? (std::min<int64_t>)(dwt->sn_full, (int64_t)dwt->dn_full - parityOffset)
+						 : (std::min<int64_t>)(dwt->dn_full, (int64_t)dwt->sn_full - parityOffset);
+	if(lenMax < 0)
+		lenMax = 0;
+	assert(lenMax >= band_0);
+	lenMax -= band_0;
+	rc.data = (float*)(memPartial ? memPartial : dwt->mem);
 
-void WaveletReverse::decompress_step1_97(const Params97& d, const float c)
-{
-#ifdef __SSE__
-	decompress_step1_sse_97(d, _mm_set1_ps(c));
-#else
-	float* GRK_RESTRICT fw = (float*)d.data;
+	assert(!memPartial || (dwt->win_l.x1 <= dwt->sn_full && dwt->win_h.x1 <= dwt->dn_full));
+	assert(band_1 >= band_0);
 
-	for(uint32_t i = 0; i < d.len; ++i, fw += 8)
+	rc.data += (parityOffset + band_0 - dwt->win_l.x0) * width;
+	rc.len = (uint32_t)(band_1 - band_0);
+	if(!step1)
 	{
-		fw[0] *= c;
-		fw[1] *= c;
-		fw[2] *= c;
-		fw[3] *= c;
-		;
+		rc.data += width;
+		rc.dataPrev = parityOffset ? rc.data - 2 * width : rc.data;
+		rc.lenMax = (uint32_t)lenMax;
 	}
-#endif
-}
-
-#ifdef __SSE__
-static void decompress_step2_sse_97(const Params97& d, __m128 c)
-{
-	__m128* GRK_RESTRICT vec_data = (__m128*)d.data;
-
-	uint32_t imax = (std::min<uint32_t>)(d.len, d.lenMax);
-
-	// initial tmp1 value is only necessary when
-	// absolute start of line is at 0
-	auto tmp1 = ((__m128*)d.dataPrev)[0];
-	uint32_t i = 0;
-	for(; i + 3 < imax; i += 4)
-	{
-		auto tmp2 = vec_data[-1];
-		auto tmp3 = vec_data[0];
-		auto tmp4 = vec_data[1];
-		auto tmp5 = vec_data[2];
-		auto tmp6 = vec_data[3];
-		auto tmp7 = vec_data[4];
-		auto tmp8 = vec_data[5];
-		auto tmp9 = vec_data[6];
-		vec_data[-1] = _mm_add_ps(tmp2, _mm_mul_ps(_mm_add_ps(tmp1, tmp3), c));
-		vec_data[1] = _mm_add_ps(tmp4, _mm_mul_ps(_mm_add_ps(tmp3, tmp5), c));
-		vec_data[3] = _mm_add_ps(tmp6, _mm_mul_ps(_mm_add_ps(tmp5, tmp7), c));
-		vec_data[5] = _mm_add_ps(tmp8, _mm_mul_ps(_mm_add_ps(tmp7, tmp9), c));
-		tmp1 = tmp9;
-		vec_data += 8;
-	}
-
-	for(; i < imax; ++i)
-	{
-		auto tmp2 = vec_data[-1];
-		auto tmp3 = vec_data[0];
-		vec_data[-1] = _mm_add_ps(tmp2, _mm_mul_ps(_mm_add_ps(tmp1, tmp3), c));
-		tmp1 = tmp3;
-		vec_data += 2;
-	}
-	if(d.lenMax < d.len)
-	{
-		assert(d.lenMax + 1 == d.len);
-		c = _mm_add_ps(c, c);
-		c = _mm_mul_ps(c, vec_data[-2]);
-		vec_data[-1] = _mm_add_ps(vec_data[-1], c);
+	if(memPartial)
+	{
+		assert((uint64_t)rc.data >= (uint64_t)dwt->allocatedMem);
+		assert((uint64_t)rc.data <= (uint64_t)dwt->allocatedMem + dwt->lenBytes_);
 	}
-}
-#endif
 
-static void decompress_step2_97(const Params97& d, float c)
-{
-#ifdef __SSE__
-	decompress_step2_sse_97(d, _mm_set1_ps(c));
-#else
-
-	float* dataPrev = (float*)d.dataPrev;
-	float* data = (float*)d.data;
-
-	uint32_t imax = (std::min<uint32_t>)(d.len, d.lenMax);
-	for(uint32_t i = 0; i < imax; ++i)
-	{
-		float tmp1_1 = dataPrev[0];
-		float tmp1_2 = dataPrev[1];
-		float tmp1_3 = dataPrev[2];
-		float tmp1_4 = dataPrev[3];
-		float tmp2_1 = data[-4];
-		float tmp2_2 = data[-3];
-		float tmp2_3 = data[-2];
-		float tmp2_4 = data[-1];
-		float tmp3_1 = data[0];
-		float tmp3_2 = data[1];
-		float tmp3_3 = data[2];
-		float tmp3_4 = data[3];
-		data[-4] = tmp2_1 + ((tmp1_1 + tmp3_1) * c);
-		data[-3] = tmp2_2 + ((tmp1_2 + tmp3_2) * c);
-		data[-2] = tmp2_3 + ((tmp1_3 + tmp3_3) * c);
-		data[-1] = tmp2_4 + ((tmp1_4 + tmp3_4) * c);
-		dataPrev = data;
-		data += 8;
-	}
-	if(d.lenMax < d.len)
-	{
-		assert(d.lenMax + 1 == d.len);
-		c += c;
-		data[-4] = data[-4] + dataPrev[0] * c;
-		data[-3] = data[-3] + dataPrev[1] * c;
-		data[-2] = data[-2] + dataPrev[2] * c;
-		data[-1] = data[-1] + dataPrev[3] * c;
-	}
-#endif
+	return rc;
 }
 /* <summary>                             */
 /* Inverse 9-7 wavelet transform in 1-D. */
 /* </summary>                            */
-void WaveletReverse::decompress_step_97(dwt_data<vec4f>* GRK_RESTRICT dwt)
+template<typename T>
+void WaveletReverse::decompress_step_97(dwt_data<T>* GRK_RESTRICT dwt, uint32_t width)
 {
 	if((!dwt->parity && dwt->dn_full == 0 && dwt->sn_full <= 1) ||
 	   (dwt->parity && dwt->sn_full == 0 && dwt->dn_full >= 1))
 		return;
 
-	decompress_step1_97(makeParams97(dwt, true, true), K);
-	decompress_step1_97(makeParams97(dwt, false, true), twice_invK);
-	decompress_step2_97(makeParams97(dwt, true, false), dwt_delta);
-	decompress_step2_97(makeParams97(dwt, false, false), dwt_gamma);
-	decompress_step2_97(makeParams97(dwt, true, false), dwt_beta);
-	decompress_step2_97(makeParams97(dwt, false, false), dwt_alpha);
+	auto step1 = [width](const Params97& d, float c) {
+		HWY_DYNAMIC_DISPATCH(hwy_decompress_step1_97)(d.data, d.len, width, c);
+	};
+	auto step2 = [width](const Params97& d, float c) {
+		HWY_DYNAMIC_DISPATCH(hwy_decompress_step2_97)
+		(d.dataPrev, d.data, d.len, d.lenMax, width, c);
+	};
+	step1(makeParams97(dwt, true, true, width), K);
+	step1(makeParams97(dwt, false, true, width), twice_invK);
+	step2(makeParams97(dwt, true, false, width), dwt_delta);
+	step2(makeParams97(dwt, false, false, width), dwt_gamma);
+	step2(makeParams97(dwt, true, false, width), dwt_beta);
+	step2(makeParams97(dwt, false, false, width), dwt_alpha);
 }
-void WaveletReverse::interleave_h_97(dwt_data<vec4f>* GRK_RESTRICT dwt,
+void WaveletReverse::interleave_h_97(dwt_data<float>* GRK_RESTRICT dwt,
 									 grk_buf2d_simple<float> winL, grk_buf2d_simple<float> winH,
 									 uint32_t remaining_height)
 {
-	float* GRK_RESTRICT bi = (float*)(dwt->mem + dwt->parity);
+	const uint32_t width = lanes97_;
+	const uint32_t rows = (std::min<uint32_t>)(remaining_height, width);
+	float* GRK_RESTRICT bi = dwt->mem + dwt->parity * width;
 	uint32_t x0 = dwt->win_l.x0;
 	uint32_t x1 = dwt->win_l.x1;
-	const size_t vec4f_elts = vec4f::NUM_ELTS;
 	for(uint32_t k = 0; k < 2; ++k)
 	{
 		auto band = (k == 0) ? winL.buf_ : winH.buf_;
 		uint32_t stride = (k == 0) ? winL.stride_ : winH.stride_;
-		if(remaining_height >= vec4f_elts && ((size_t)band & 0x0f) == 0 &&
-		   ((size_t)bi & 0x0f) == 0 && (stride & 0x0f) == 0)
+		for(uint32_t i = x0; i < x1; ++i, bi += width * 2)
 		{
-			/* Fast code path */
-			for(uint32_t i = x0; i < x1; ++i, bi += vec4f_elts * 2)
-			{
-				uint32_t j = i;
-				bi[0] = band[j];
-				j += stride;
-				bi[1] = band[j];
-				j += stride;
-				bi[2] = band[j];
-				j += stride;
-				bi[3] = band[j];
-			}
+			size_t j = i;
+			for(uint32_t r = 0; r < rows; ++r, j += stride)
+				bi[r] = band[j];
 		}
-		else
-		{
-			/* Slow code path */
-			for(uint32_t i = x0; i < x1; ++i, bi += vec4f_elts * 2)
-			{
-				uint32_t j = i;
-				bi[0] = band[j];
-				j += stride;
-				if(remaining_height == 1)
-					continue;
-				bi[1] = band[j];
-				j += stride;
-				if(remaining_height == 2)
-					continue;
-				bi[2] = band[j];
-				j += stride;
-				if(remaining_height == 3)
-					continue;
-				bi[3] = band[j];
-			}
-		}
-		bi = (float*)(dwt->mem + 1 - dwt->parity);
+		bi = dwt->mem + (1 - dwt->parity) * width;
 		x0 = dwt->win_h.x0;
 		x1 = dwt->win_h.x1;
 	}
 }
-void WaveletReverse::decompress_h_strip_97(dwt_data<vec4f>* GRK_RESTRICT horiz,
+void WaveletReverse::decompress_h_strip_97(dwt_data<float>* GRK_RESTRICT horiz,
 										   const uint32_t resHeight, grk_buf2d_simple<float> winL,
 										   grk_buf2d_simple<float> winH,
 										   grk_buf2d_simple<float> winDest)
 {
+	const uint32_t width = lanes97_;
 	float* GRK_RESTRICT dest = winDest.buf_;
-	const uint32_t strideDest = winDest.stride_;
-	uint32_t j;
-	const size_t vec4f_elts = vec4f::NUM_ELTS;
-	for(j = 0; j < (resHeight & (uint32_t)(~(vec4f_elts - 1))); j += vec4f_elts)
-	{
-		interleave_h_97(horiz, winL, winH, resHeight - j);
-		decompress_step_97(horiz);
-		for(uint32_t k = 0; k < horiz->sn_full + horiz->dn_full; k++)
+	const size_t strideDest = winDest.stride_;
+	const uint32_t total = horiz->sn_full + horiz->dn_full;
+	for(uint32_t j = 0; j < resHeight; j += width)
+	{
+		uint32_t rows = (std::min<uint32_t>)(resHeight - j, width);
+		interleave_h_97(horiz, winL, winH, rows);
+		decompress_step_97(horiz, width);
+		for(uint32_t r = 0; r < rows; ++r)
 		{
-			dest[k] = horiz->mem[k].val[0];
-			dest[k + (size_t)strideDest] = horiz->mem[k].val[1];
-			dest[k + (size_t)strideDest * 2] = horiz->mem[k].val[2];
-			dest[k + (size_t)strideDest * 3] = horiz->mem[k].val[3];
-		}
-		winL.buf_ += winL.stride_ << 2;
-		winH.buf_ += winH.stride_ << 2;
-		dest += strideDest << 2;
-	}
-	if(j < resHeight)
-	{
-		interleave_h_97(horiz, winL, winH, resHeight - j);
-		decompress_step_97(horiz);
-		for(uint32_t k = 0; k < horiz->sn_full + horiz->dn_full; k++)
-		{
-			switch(resHeight - j)
-			{
-				case 3:
-					dest[k + (strideDest << 1)] = horiz->mem[k].val[2];
-				/* FALLTHRU */
-				case 2:
-					dest[k + strideDest] = horiz->mem[k].val[1];
-				/* FALLTHRU */
-				case 1:
-					dest[k] = horiz->mem[k].val[0];
-			}
+			auto destRow = dest + r * strideDest;
+			auto src = horiz->mem + r;
+			for(uint32_t k = 0; k < total; k++, src += width)
+				destRow[k] = *src;
 		}
+		winL.buf_ += (size_t)winL.stride_ * width;
+		winH.buf_ += (size_t)winH.stride_ * width;
+		dest += strideDest * width;
 	}
 }
 bool WaveletReverse::decompress_h_97(uint8_t res, uint32_t numThreads, size_t dataLength,
-									 dwt_data<vec4f>& GRK_RESTRICT horiz, const uint32_t resHeight,
+									 dwt_data<float>& GRK_RESTRICT horiz, const uint32_t resHeight,
 									 grk_buf2d_simple<float> winL, grk_buf2d_simple<float> winH,
 									 grk_buf2d_simple<float> winDest)
 {
@@ -539,7 +465,7 @@ bool WaveletReverse::decompress_h_97(uint8_t res, uint32_t numThreads, size_t da
 		{
 			auto indexMin = j * incrPerJob;
 			auto indexMax = (j < (numTasks - 1U) ? (j + 1U) * incrPerJob : resHeight) - indexMin;
-			auto myhoriz = new dwt_data<vec4f>(horiz);
+			auto myhoriz = new dwt_data<float>(horiz);
 			if(!myhoriz->alloc(dataLength))
 			{
 				Logger::logger_.error("Out of memory");
@@ -556,62 +482,52 @@ bool WaveletReverse::decompress_h_97(uint8_t res, uint32_t numThreads, size_t da
 	}
 	return true;
 }
-void WaveletReverse::interleave_v_97(dwt_data<vec4f>* GRK_RESTRICT dwt,
+void WaveletReverse::interleave_v_97(dwt_data<float>* GRK_RESTRICT dwt,
 									 grk_buf2d_simple<float> winL, grk_buf2d_simple<float> winH,
 									 uint32_t nb_elts_read)
 {
-	auto bi = dwt->mem + dwt->parity;
+	const uint32_t width = lanes97_;
+	auto bi = dwt->mem + dwt->parity * width;
 	auto band = winL.buf_ + dwt->win_l.x0 * winL.stride_;
-	for(uint32_t i = dwt->win_l.x0; i < dwt->win_l.x1; ++i, bi += 2)
+	for(uint32_t i = dwt->win_l.x0; i < dwt->win_l.x1; ++i, bi += 2 * width)
 	{
-		memcpy((float*)bi, band, nb_elts_read * sizeof(float));
+		memcpy(bi, band, nb_elts_read * sizeof(float));
 		band += winL.stride_;
 	}
-	bi = dwt->mem + 1 - dwt->parity;
+	bi = dwt->mem + (1 - dwt->parity) * width;
 	band = winH.buf_ + dwt->win_h.x0 * winH.stride_;
-	for(uint32_t i = dwt->win_h.x0; i < dwt->win_h.x1; ++i, bi += 2)
+	for(uint32_t i = dwt->win_h.x0; i < dwt->win_h.x1; ++i, bi += 2 * width)
 	{
-		memcpy((float*)bi, band, nb_elts_read * sizeof(float));
+		memcpy(bi, band, nb_elts_read * sizeof(float));
 		band += winH.stride_;
 	}
 }
-void WaveletReverse::decompress_v_strip_97(dwt_data<vec4f>* GRK_RESTRICT vert,
+void WaveletReverse::decompress_v_strip_97(dwt_data<float>* GRK_RESTRICT vert,
 										   const uint32_t resWidth, const uint32_t resHeight,
 										   grk_buf2d_simple<float> winL,
 										   grk_buf2d_simple<float> winH,
 										   grk_buf2d_simple<float> winDest)
 {
-	uint32_t j;
-	const size_t vec4f_elts = vec4f::NUM_ELTS;
-	for(j = 0; j < (resWidth & (uint32_t) ~(vec4f_elts - 1)); j += vec4f_elts)
+	const uint32_t width = lanes97_;
+	for(uint32_t j = 0; j < resWidth; j += width)
 	{
-		interleave_v_97(vert, winL, winH, vec4f_elts);
-		decompress_step_97(vert);
+		uint32_t cols = (std::min<uint32_t>)(resWidth - j, width);
+		interleave_v_97(vert, winL, winH, cols);
+		decompress_step_97(vert, width);
 		auto destPtr = winDest.buf_;
-		for(uint32_t k = 0; k < resHeight; ++k)
+		auto src = vert->mem;
+		for(uint32_t k = 0; k < resHeight; ++k, src += width)
 		{
-			memcpy(destPtr, vert->mem + k, sizeof(vec4f));
-			destPtr += winDest.stride_;
-		}
-		winL.buf_ += vec4f_elts;
-		winH.buf_ += vec4f_elts;
-		winDest.buf_ += vec4f_elts;
-	}
-	if(j < resWidth)
-	{
-		j = resWidth & (vec4f_elts - 1);
-		interleave_v_97(vert, winL, winH, j);
-		decompress_step_97(vert);
-		auto destPtr = winDest.buf_;
-		for(uint32_t k = 0; k < resHeight; ++k)
-		{
-			memcpy(destPtr, vert->mem + k, j * sizeof(float));
+			memcpy(destPtr, src, cols * sizeof(float));
 			destPtr += winDest.stride_;
 		}
+		winL.buf_ += width;
+		winH.buf_ += width;
+		winDest.buf_ += width;
 	}
 }
 bool WaveletReverse::decompress_v_97(uint8_t res, uint32_t numThreads, size_t dataLength,
-									 dwt_data<vec4f>& GRK_RESTRICT vert, const uint32_t resWidth,
+									 dwt_data<float>& GRK_RESTRICT vert, const uint32_t resWidth,
 									 const uint32_t resHeight, grk_buf2d_simple<float> winL,
 									 grk_buf2d_simple<float> winH, grk_buf2d_simple<float> winDest)
 {
@@ -638,7 +554,7 @@ bool WaveletReverse::decompress_v_97(uint8_t res, uint32_t numThreads, size_t da
 		{
 			auto indexMin = j * incrPerJob;
 			auto indexMax = (j < (numTasks - 1U) ? (j + 1U) * incrPerJob : resWidth) - indexMin;
-			auto myvert = new dwt_data<vec4f>(vert);
+			auto myvert = new dwt_data<float>(vert);
 			if(!myvert->alloc(dataLength))
 			{
 				Logger::logger_.error("Out of memory");
@@ -671,7 +587,8 @@ bool WaveletReverse::decompress_tile_97(void)
 	uint32_t resWidth = tr->width();
 	uint32_t resHeight = tr->height();
 
-	size_t dataLength = max_resolution(tr, numres_);
+	// each line buffer element holds one sample from each of lanes97_ lines
+	size_t dataLength = (size_t)max_resolution(tr, numres_) * lanes97_;
 	if(!horizF_.alloc(dataLength))
 	{
 		Logger::logger_.error("decompress_tile_97: out of memory");
@@ -692,6 +609,16 @@ bool WaveletReverse::decompress_tile_97(void)
 		horizF_.parity = tr->x0 & 1;
 		horizF_.win_l = grk_line32(0, horizF_.sn_full);
 		horizF_.win_h = grk_line32(0, horizF_.dn_full);
+		vertF_.dn_full = resHeight - vertF_.sn_full;
+		vertF_.parity = tr->y0 & 1;
+		vertF_.win_l = grk_line32(0, vertF_.sn_full);
+		vertF_.win_h = grk_line32(0, vertF_.dn_full);
+		if(canFuse<float>(res))
+		{
+			if(!decompress_fused(res, horizF_, vertF_, 4))
+				return false;
+			continue;
+		}
 		auto winSplitL = buf->getResWindowBufferSplitSimpleF(res, SPLIT_L);
 		auto winSplitH = buf->getResWindowBufferSplitSimpleF(res, SPLIT_H);
 		if(!decompress_h_97(res, numThreads, dataLength, horizF_, vertF_.sn_full,
@@ -702,10 +629,6 @@ bool WaveletReverse::decompress_tile_97(void)
 							buf->getBandWindowBufferPaddedSimpleF(res, BAND_ORIENT_LH),
 							buf->getBandWindowBufferPaddedSimpleF(res, BAND_ORIENT_HH), winSplitH))
 			return false;
-		vertF_.dn_full = resHeight - vertF_.sn_full;
-		vertF_.parity = tr->y0 & 1;
-		vertF_.win_l = grk_line32(0, vertF_.sn_full);
-		vertF_.win_h = grk_line32(0, vertF_.dn_full);
 		if(!decompress_v_97(res, numThreads, dataLength, vertF_, resWidth, resHeight, winSplitL,
 							winSplitH, buf->getResWindowBufferSimpleF(res)))
 			return false;
@@ -1206,6 +1129,12 @@ bool WaveletReverse::decompress_tile_53(void)
 		horiz_.parity = tileCompRes->x0 & 1;
 		vert_.dn_full = resHeight - vert_.sn_full;
 		vert_.parity = tileCompRes->y0 & 1;
+		if(canFuse<int32_t>(res))
+		{
+			if(!decompress_fused(res, horiz_, vert_, 2))
+				return false;
+			continue;
+		}
 		if(!decompress_h_53(res, buf, resHeight, dataLength))
 			return false;
 		if(!decompress_v_53(res, buf, resWidth, dataLength))
@@ -1215,6 +1144,346 @@ bool WaveletReverse::decompress_tile_53(void)
 	return true;
 }
 
+/**************************************************************************************
+ *
+ * Fused 5/3 or 9/7 Inverse Wavelet
+ *
+ * The two pass transform runs a horizontal pass over the whole resolution, followed
+ * by a vertical pass, so a large resolution is streamed through memory twice.
+ * The fused transform runs both passes over strips of rows held in a small ring
+ * buffer: vertical lifting steps advance as soon as the horizontal pass has
+ * produced their input rows, and finished rows are written straight back to the
+ * resolution buffer.
+ *
+ * Each round is split into two phases, with a barrier in between:
+ *
+ * 1. horizontal pass : tasks split the newly loaded rows
+ * 2. vertical pass : tasks split the columns
+ *
+ *************************************************************************************/
+
+// in GRK_WAVELET_AUTO mode, resolutions smaller than this use the two pass transform
+const uint64_t fusedMinBytes = 4 * 1024 * 1024;
+// target size of ring buffer
+const size_t fusedRingBytes = 1024 * 1024;
+// minimum resolution height for fused transform
+const uint32_t fusedMinHeight = 8;
+// column slices are aligned to 64 bytes
+const uint32_t fusedColAlign = 16;
+
+static const float fusedSteps97[4] = {dwt_delta, dwt_gamma, dwt_beta, dwt_alpha};
+
+template<typename T>
+bool WaveletReverse::canFuse(uint8_t res)
+{
+	auto strategy = tileProcessor_->cp_->coding_params_.dec_.waveletStrategy_;
+	if(strategy == GRK_WAVELET_TWO_PASS)
+		return false;
+	auto tr = tilec_->resolutions_ + res;
+	uint32_t resWidth = tr->width();
+	uint32_t resHeight = tr->height();
+	if(resWidth == 0 || resHeight < fusedMinHeight)
+		return false;
+	if(strategy == GRK_WAVELET_AUTO && (uint64_t)resWidth * resHeight * sizeof(T) < fusedMinBytes)
+		return false;
+
+	// transform runs in place, so band windows must be laid out inside resolution window
+	auto buf = tilec_->getWindow();
+	grk_buf2d_simple<T> winLL, winHL, winLH, winHH, winDest;
+	if constexpr(std::is_same<T, float>::value)
+	{
+		winLL = buf->getResWindowBufferSimpleF(res - 1U);
+		winHL = buf->getBandWindowBufferPaddedSimpleF(res, BAND_ORIENT_HL);
+		winLH = buf->getBandWindowBufferPaddedSimpleF(res, BAND_ORIENT_LH);
+		winHH = buf->getBandWindowBufferPaddedSimpleF(res, BAND_ORIENT_HH);
+		winDest = buf->getResWindowBufferSimpleF(res);
+	}
+	else
+	{
+		winLL = buf->getResWindowBufferSimple(res - 1U);
+		winHL = buf->getBandWindowBufferPaddedSimple(res, BAND_ORIENT_HL);
+		winLH = buf->getBandWindowBufferPaddedSimple(res, BAND_ORIENT_LH);
+		winHH = buf->getBandWindowBufferPaddedSimple(res, BAND_ORIENT_HH);
+		winDest = buf->getResWindowBufferSimple(res);
+	}
+	const uint32_t stride = winDest.stride_;
+	if(winLL.stride_ != stride || winHL.stride_ != stride || winLH.stride_ != stride ||
+	   winHH.stride_ != stride)
+		return false;
+	const uint32_t snH = (tr - 1)->width();
+	const uint32_t sn = (tr - 1)->height();
+
+	return winLL.buf_ == winDest.buf_ && winHL.buf_ == winDest.buf_ + snH &&
+		   winLH.buf_ == winDest.buf_ + (size_t)sn * stride && winHH.buf_ == winLH.buf_ + snH;
+}
+
+template<typename T>
+bool WaveletReverse::decompress_fused(uint8_t res, const dwt_data<T>& horiz,
+									  const dwt_data<T>& vert, uint32_t numSteps)
+{
+	constexpr bool is97 = std::is_same<T, float>::value;
+	auto tr = tilec_->resolutions_ + res;
+	auto buf = tilec_->getWindow();
+	auto level = new FusedLevel<T>();
+	if constexpr(is97)
+	{
+		fusedF_.push_back(level);
+		level->buf_ = buf->getResWindowBufferSimpleF(res).buf_;
+	}
+	else
+	{
+		fused_.push_back(level);
+		level->buf_ = buf->getResWindowBufferSimple(res).buf_;
+	}
+	level->stride_ = buf->getResWindowBufferREL(res)->stride;
+	level->width_ = tr->width();
+	level->height_ = tr->height();
+	level->sn_ = vert.sn_full;
+	level->parity_ = vert.parity;
+	level->snH_ = horiz.sn_full;
+	level->numSteps_ = numSteps;
+	const uint32_t resHeight = level->height_;
+	const uint32_t numThreads = (uint32_t)ExecSingleton::get()->num_workers();
+	// 9/7 horizontal pass transforms lanes97_ rows at a time
+	const uint32_t group = is97 ? lanes97_ : 1;
+	level->ringStride_ =
+		(size_t)((level->width_ + fusedColAlign - 1) / fusedColAlign) * fusedColAlign;
+	uint32_t rowsPerRound = (uint32_t)(fusedRingBytes / (level->ringStride_ * sizeof(T)));
+	rowsPerRound = (std::max<uint32_t>)(rowsPerRound, 2 * numSteps);
+	rowsPerRound = (std::max<uint32_t>)(rowsPerRound, numThreads * group);
+	rowsPerRound = (rowsPerRound + group - 1) / group * group;
+	rowsPerRound = (std::min<uint32_t>)(rowsPerRound, resHeight);
+	// rows from previous round are kept for the lagging lifting steps
+	level->ringRows_ = rowsPerRound + numSteps + 2;
+
+	// plan rounds, and assign side store slots to raw rows that will be
+	// overwritten by output rows before they have been loaded
+	level->slot_.assign(resHeight, -1);
+	std::vector<uint32_t> freeSlots;
+	uint32_t done[5] = {0, 0, 0, 0, 0};
+	while(done[numSteps] < resHeight)
+	{
+		FusedRound round;
+		round.load0_ = done[0];
+		done[0] = (std::min<uint32_t>)(resHeight, done[0] + rowsPerRound);
+		round.load1_ = done[0];
+		for(uint32_t row = round.load0_; row < round.load1_; ++row)
+		{
+			if(level->slot_[row] >= 0)
+				freeSlots.push_back((uint32_t)level->slot_[row]);
+		}
+		// lifting step s on a row needs both neighbours to have completed step s - 1
+		for(uint32_t s = 1; s <= numSteps; ++s)
+		{
+			round.stepBegin_[s - 1] = done[s];
+			if(done[s - 1] == resHeight)
+				done[s] = resHeight;
+			else if(done[s - 1] > done[s] + 1)
+				done[s] = done[s - 1] - 1;
+			round.stepEnd_[s - 1] = done[s];
+		}
+		round.out0_ = round.stepBegin_[numSteps - 1];
+		round.out1_ = done[numSteps];
+		for(uint32_t k = round.out0_; k < round.out1_; ++k)
+		{
+			// interleaved row whose raw samples are stored in buffer row k
+			uint32_t row =
+				k < level->sn_ ? 2 * k + level->parity_ : 2 * (k - level->sn_) + 1 - level->parity_;
+			if(row < done[0])
+				continue;
+			uint32_t slot;
+			if(freeSlots.empty())
+			{
+				slot = level->numSlots_++;
+			}
+			else
+			{
+				slot = freeSlots.back();
+				freeSlots.pop_back();
+			}
+			level->slot_[row] = (int32_t)slot;
+			round.saves_.emplace_back(k, slot);
+		}
+		level->rounds_.push_back(std::move(round));
+	}
+
+	// allocate ring buffer, side store and line buffers
+	size_t ringLen = level->ringRows_ * level->ringStride_ * sizeof(T);
+	level->ring_ = (T*)grk_aligned_malloc(ringLen);
+	if(!level->ring_)
+	{
+		Logger::logger_.error("decompress_fused: out of memory");
+		return false;
+	}
+	// lifting runs over padding columns as well, so they must hold valid samples
+	memset(level->ring_, 0, ringLen);
+	if(level->numSlots_)
+	{
+		level->side_ =
+			(T*)grk_aligned_malloc(level->numSlots_ * level->ringStride_ * sizeof(T));
+		if(!level->side_)
+		{
+			Logger::logger_.error("decompress_fused: out of memory");
+			return false;
+		}
+	}
+	const size_t dataLength = (size_t)level->width_ * group;
+	const uint32_t numLoadTasks =
+		numThreads == 1 ? 1 : (std::min<uint32_t>)(numThreads, rowsPerRound / group);
+	for(uint32_t t = 0; t < numLoadTasks; ++t)
+	{
+		auto h = new dwt_data<T>(horiz);
+		level->horiz_.push_back(h);
+		if(!h->alloc(dataLength))
+		{
+			Logger::logger_.error("decompress_fused: out of memory");
+			return false;
+		}
+	}
+	if(numThreads == 1)
+	{
+		for(const auto& round : level->rounds_)
+		{
+			fused_load(level, round.load0_, round.load1_, level->horiz_[0]);
+			fused_lift(level, round, 0, level->width_);
+		}
+		level->release();
+
+		return true;
+	}
+
+	auto imageComponentFlow = scheduler_->getImageComponentFlow(compno_);
+	if(!imageComponentFlow)
+	{
+		Logger::logger_.warn("Missing image component flow");
+		return false;
+	}
+	auto flow = imageComponentFlow->getResFlow(res - 1)->waveletHoriz_;
+	const uint32_t width = level->width_;
+	tf::Task prev;
+	for(const auto& round : level->rounds_)
+	{
+		auto r = &round;
+		auto loaded = flow->nextTask();
+		uint32_t rows = round.load1_ - round.load0_;
+		uint32_t numTasks = (std::min<uint32_t>)(numLoadTasks, (rows + group - 1) / group);
+		uint32_t rowsPerTask = ((rows + numTasks - 1) / numTasks + group - 1) / group * group;
+		for(uint32_t t = 0; t < numTasks; ++t)
+		{
+			uint32_t rowMin = round.load0_ + t * rowsPerTask;
+			if(rowMin >= round.load1_)
+				break;
+			uint32_t rowMax = (std::min<uint32_t>)(round.load1_, rowMin + rowsPerTask);
+			auto h = level->horiz_[t];
+			auto task = flow->nextTask().work(
+				[this, level, rowMin, rowMax, h] { fused_load(level, rowMin, rowMax, h); });
+			if(!prev.empty())
+				prev.precede(task);
+			task.precede(loaded);
+		}
+		auto lifted = flow->nextTask();
+		numTasks = (std::min<uint32_t>)(numThreads, (width + fusedColAlign - 1) / fusedColAlign);
+		uint32_t colsPerTask =
+			((width + numTasks - 1) / numTasks + fusedColAlign - 1) / fusedColAlign * fusedColAlign;
+		for(uint32_t t = 0; t < numTasks; ++t)
+		{
+			uint32_t colMin = t * colsPerTask;
+			if(colMin >= width)
+				break;
+			uint32_t colMax = (std::min<uint32_t>)(width, colMin + colsPerTask);
+			auto task = flow->nextTask().work(
+				[this, level, r, colMin, colMax] { fused_lift(level, *r, colMin, colMax); });
+			loaded.precede(task);
+			task.precede(lifted);
+		}
+		prev = lifted;
+	}
+	prev.precede(flow->nextTask().work([level] { level->release(); }));
+
+	return true;
+}
+
+template<typename T>
+void WaveletReverse::fused_load(FusedLevel<T>* level, uint32_t rowMin, uint32_t rowMax,
+								dwt_data<T>* horiz)
+{
+	if constexpr(std::is_same<T, float>::value)
+	{
+		const uint32_t width = lanes97_;
+		for(uint32_t row = rowMin; row < rowMax; row += width)
+		{
+			uint32_t numRows = (std::min<uint32_t>)(width, rowMax - row);
+			for(uint32_t r = 0; r < numRows; ++r)
+			{
+				auto src = level->rawRow(row + r);
+				auto bi = horiz->mem + horiz->parity * width + r;
+				for(uint32_t i = 0; i < horiz->sn_full; ++i, bi += 2 * width)
+					*bi = src[i];
+				src += horiz->sn_full;
+				bi = horiz->mem + (1 - horiz->parity) * width + r;
+				for(uint32_t i = 0; i < horiz->dn_full; ++i, bi += 2 * width)
+					*bi = src[i];
+			}
+			decompress_step_97(horiz, width);
+			// first vertical lifting step scales low and high rows
+			for(uint32_t r = 0; r < numRows; ++r)
+			{
+				auto dest = level->ringRow(row + r);
+				auto src = horiz->mem + r;
+				const float scale = level->isLow(row + r) ? K : twice_invK;
+				for(uint32_t k = 0; k < level->width_; k++, src += width)
+					dest[k] = *src * scale;
+			}
+		}
+	}
+	else
+	{
+		for(uint32_t row = rowMin; row < rowMax; ++row)
+		{
+			auto src = level->rawRow(row);
+			decompress_h_53(horiz, src, src + level->snH_, level->ringRow(row));
+		}
+	}
+}
+
+template<typename T>
+void WaveletReverse::fused_lift(FusedLevel<T>* level, const FusedRound& round, uint32_t colMin,
+								uint32_t colMax)
+{
+	const uint32_t resHeight = level->height_;
+	// ring rows are padded, so lifting can run over whole vectors
+	const uint32_t liftCols =
+		(uint32_t)(std::min<size_t>)(level->ringStride_,
+									 (colMax + fusedColAlign - 1) / fusedColAlign * fusedColAlign) -
+		colMin;
+	for(uint32_t s = 0; s < level->numSteps_; ++s)
+	{
+		// steps alternate between low and high rows, starting with low rows
+		bool low = (s & 1) == 0;
+		uint32_t row = round.stepBegin_[s];
+		if(level->isLow(row) != low)
+			row++;
+		for(; row < round.stepEnd_[s]; row += 2)
+		{
+			auto cur = level->ringRow(row) + colMin;
+			// symmetric extension at resolution boundaries
+			auto prev = level->ringRow(row ? row - 1 : 1) + colMin;
+			auto next = level->ringRow(row + 1 < resHeight ? row + 1 : resHeight - 2) + colMin;
+			if constexpr(std::is_same<T, float>::value)
+				HWY_DYNAMIC_DISPATCH(hwy_lift_row_97)(cur, prev, next, liftCols, fusedSteps97[s]);
+			else
+				HWY_DYNAMIC_DISPATCH(hwy_lift_row_53)(cur, prev, next, liftCols, low);
+		}
+	}
+	const size_t len = (colMax - colMin) * sizeof(T);
+	for(const auto& save : round.saves_)
+		memcpy(level->side_ + (size_t)save.second * level->ringStride_ + colMin,
+			   level->buf_ + (size_t)save.first * level->stride_ + colMin, len);
+	for(uint32_t row = round.out0_; row < round.out1_; ++row)
+		memcpy(level->buf_ + (size_t)row * level->stride_ + colMin, level->ringRow(row) + colMin,
+			   len);
+}
+
 /*************************************************************************************
  *
  * Partial 5/3 or 9/7 Inverse Wavelet
@@ -1661,53 +1930,13 @@ class Partial97 : public PartialInterleaver<T, FILTER_WIDTH, VERT_PASS_WIDTH>
   public:
 	void decompress_h(dwt_data<T>* dwt)
 	{
-		WaveletReverse::decompress_step_97(dwt);
+		WaveletReverse::decompress_step_97(dwt, (uint32_t)(sizeof(T) / sizeof(float)));
 	}
 	void decompress_v(dwt_data<T>* dwt)
 	{
-		WaveletReverse::decompress_step_97(dwt);
-	}
-};
-// Notes:
-// 1. line buffer 0 offset == dwt->win_l.x0
-// 2. dwt->memL and dwt->memH are only set for partial decode
-Params97 WaveletReverse::makeParams97(dwt_data<vec4f>* dwt, bool isBandL, bool step1)
-{
-	Params97 rc;
-	// band_0 specifies absolute start of line buffer
-	int64_t band_0 = isBandL ? dwt->win_l.x0 : dwt->win_h.x0;
-	int64_t band_1 = isBandL ? dwt->win_l.x1 : dwt->win_h.x1;
-	auto memPartial = isBandL ? dwt->memL : dwt->memH;
-	int64_t parityOffset = isBandL ? dwt->parity : !dwt->parity;
-	int64_t lenMax = isBandL
-						 ? (std::min<int64_t>)(dwt->sn_full, (int64_t)dwt->dn_full - parityOffset)
-						 : (std::min<int64_t>)(dwt->dn_full, (int64_t)dwt->sn_full - parityOffset);
-	if(lenMax < 0)
-		lenMax = 0;
-	assert(lenMax >= band_0);
-	lenMax -= band_0;
-	rc.data = memPartial ? memPartial : dwt->mem;
-
-	assert(!memPartial || (dwt->win_l.x1 <= dwt->sn_full && dwt->win_h.x1 <= dwt->dn_full));
-	assert(band_1 >= band_0);
-
-	rc.data += parityOffset + band_0 - dwt->win_l.x0;
-	rc.len = (uint32_t)(band_1 - band_0);
-	if(!step1)
-	{
-		rc.data += 1;
-		rc.dataPrev = parityOffset ? rc.data - 2 : rc.data;
-		rc.lenMax = (uint32_t)lenMax;
-	}
-	if(memPartial)
-	{
-		assert((uint64_t)rc.data >= (uint64_t)dwt->allocatedMem);
-		assert((uint64_t)rc.data <= (uint64_t)dwt->allocatedMem + dwt->lenBytes_);
+		WaveletReverse::decompress_step_97(dwt, (uint32_t)(sizeof(T) / sizeof(float)));
 	}
-
-	return rc;
 };
-
 template<uint32_t FILTER_WIDTH>
 struct PartialBandInfo
 {
@@ -2025,7 +2254,8 @@ bool WaveletReverse::decompress_partial_tile(ISparseCanvas* sa,
 WaveletReverse::WaveletReverse(TileProcessor* tileProcessor, TileComponent* tilec, uint16_t compno,
 							   grk_rect32 unreducedWindow, uint8_t numres, uint8_t qmfbid)
 	: tileProcessor_(tileProcessor), scheduler_(tileProcessor->getScheduler()), tilec_(tilec),
-	  compno_(compno), unreducedWindow_(unreducedWindow), numres_(numres), qmfbid_(qmfbid)
+	  compno_(compno), unreducedWindow_(unreducedWindow), numres_(numres), qmfbid_(qmfbid),
+	  lanes97_((uint32_t)HWY_DYNAMIC_DISPATCH(hwy_num_lanes_97)())
 {}
 WaveletReverse::~WaveletReverse(void)
 {
@@ -2033,6 +2263,10 @@ WaveletReverse::~WaveletReverse(void)
 		delete t;
 	for(const auto& t : tasksF_)
 		delete t;
+	for(const auto& f : fused_)
+		delete f;
+	for(const auto& f : fusedF_)
+		delete f;
 }
 bool WaveletReverse::decompress(void)
 {
@@ -130,12 +130,106 @@ struct dwt_data
 struct Params97
 {
 	Params97(void) : dataPrev(nullptr), data(nullptr), len(0), lenMax(0) {}
-	vec4f* dataPrev;
-	vec4f* data;
+	float* dataPrev;
+	float* data;
 	uint32_t len;
 	uint32_t lenMax;
 };
 
+/**
+ * One round of the fused inverse wavelet transform. Rows are interleaved
+ * (vertically reconstructed) row numbers.
+ *
+ * 1. rows [load0_,load1_) are transformed horizontally into the ring buffer
+ * 2. vertical lifting step s advances over rows [stepBegin_[s],stepEnd_[s])
+ * 3. raw rows that are about to be overwritten, but are still needed, are saved
+ * 4. finished rows [out0_,out1_) are written back to the resolution buffer
+ */
+struct FusedRound
+{
+	uint32_t load0_;
+	uint32_t load1_;
+	uint32_t stepBegin_[4];
+	uint32_t stepEnd_[4];
+	uint32_t out0_;
+	uint32_t out1_;
+	// (resolution buffer row, side store slot) pairs
+	std::vector<std::pair<uint32_t, uint32_t>> saves_;
+};
+
+/**
+ * Fused inverse wavelet transform of one resolution.
+ *
+ * The resolution is reconstructed in place, a strip of rows at a time: rows produced
+ * by the horizontal pass are consumed by the vertical lifting steps while they are
+ * still in cache, instead of streaming the whole resolution through memory twice.
+ * Since output row k overwrites buffer row k, raw band rows that are overwritten before
+ * they have been read are first copied to a side store, which peaks at around
+ * one quarter of the resolution.
+ */
+template<typename T>
+struct FusedLevel
+{
+	FusedLevel(void)
+		: buf_(nullptr), stride_(0), width_(0), height_(0), sn_(0), parity_(0), snH_(0),
+		  numSteps_(0), ringRows_(0), ringStride_(0), ring_(nullptr), side_(nullptr),
+		  numSlots_(0)
+	{}
+	~FusedLevel(void)
+	{
+		release();
+	}
+	void release(void)
+	{
+		grk_aligned_free(ring_);
+		ring_ = nullptr;
+		grk_aligned_free(side_);
+		side_ = nullptr;
+		for(auto& h : horiz_)
+			delete h;
+		horiz_.clear();
+	}
+	bool isLow(uint32_t row) const
+	{
+		return (row & 1) == parity_;
+	}
+	T* ringRow(uint32_t row) const
+	{
+		return ring_ + (size_t)(row % ringRows_) * ringStride_;
+	}
+	/**
+	 * Raw row holding L and H band samples for interleaved row
+	 */
+	T* rawRow(uint32_t row) const
+	{
+		if(slot_[row] >= 0)
+			return side_ + (size_t)slot_[row] * ringStride_;
+		return buf_ + (size_t)((row >> 1) + (isLow(row) ? 0 : sn_)) * stride_;
+	}
+
+	T* buf_;
+	size_t stride_;
+	uint32_t width_;
+	uint32_t height_;
+	// number of low pass rows
+	uint32_t sn_;
+	// vertical parity
+	uint32_t parity_;
+	// number of low pass columns
+	uint32_t snH_;
+	uint32_t numSteps_;
+	uint32_t ringRows_;
+	size_t ringStride_;
+	T* ring_;
+	T* side_;
+	uint32_t numSlots_;
+	// side store slot for each interleaved row, or -1 if row is read from resolution buffer
+	std::vector<int32_t> slot_;
+	std::vector<FusedRound> rounds_;
+	// one horizontal line buffer per task
+	std::vector<dwt_data<T>*> horiz_;
+};
+
 class WaveletReverse
 {
   public:
@@ -144,32 +238,35 @@ class WaveletReverse
 	~WaveletReverse(void);
 	bool decompress(void);
 
-	static void decompress_step_97(dwt_data<vec4f>* GRK_RESTRICT dwt);
+	/**
+	 * Inverse 9/7 transform of interleaved line buffer
+	 * @param dwt line buffer, where each element holds one sample from each of width lines
+	 * @param width number of parallel lines, either a multiple of the number of SIMD lanes or 4
+	 */
+	template<typename T>
+	static void decompress_step_97(dwt_data<T>* GRK_RESTRICT dwt, uint32_t width);
 
   private:
 	template<typename T, uint32_t FILTER_WIDTH, uint32_t VERT_PASS_WIDTH, typename D>
 	bool decompress_partial_tile(ISparseCanvas* sa, std::vector<TaskInfo<T, dwt_data<T>>*>& tasks);
-	static void decompress_step1_97(const Params97& d, const float c);
-#ifdef __SSE__
-	static void decompress_step1_sse_97(Params97 d, const __m128 c);
-#endif
-	static Params97 makeParams97(dwt_data<vec4f>* dwt, bool isBandL, bool step1);
-	void interleave_h_97(dwt_data<vec4f>* GRK_RESTRICT dwt, grk_buf2d_simple<float> winL,
+	template<typename T>
+	static Params97 makeParams97(dwt_data<T>* dwt, bool isBandL, bool step1, uint32_t width);
+	void interleave_h_97(dwt_data<float>* GRK_RESTRICT dwt, grk_buf2d_simple<float> winL,
 						 grk_buf2d_simple<float> winH, uint32_t remaining_height);
-	void decompress_h_strip_97(dwt_data<vec4f>* GRK_RESTRICT horiz, const uint32_t resHeight,
+	void decompress_h_strip_97(dwt_data<float>* GRK_RESTRICT horiz, const uint32_t resHeight,
 							   grk_buf2d_simple<float> winL, grk_buf2d_simple<float> winH,
 							   grk_buf2d_simple<float> winDest);
 	bool decompress_h_97(uint8_t res, uint32_t numThreads, size_t dataLength,
-						 dwt_data<vec4f>& GRK_RESTRICT horiz, const uint32_t resHeight,
+						 dwt_data<float>& GRK_RESTRICT horiz, const uint32_t resHeight,
 						 grk_buf2d_simple<float> winL, grk_buf2d_simple<float> winH,
 						 grk_buf2d_simple<float> winDest);
-	void interleave_v_97(dwt_data<vec4f>* GRK_RESTRICT dwt, grk_buf2d_simple<float> winL,
+	void interleave_v_97(dwt_data<float>* GRK_RESTRICT dwt, grk_buf2d_simple<float> winL,
 						 grk_buf2d_simple<float> winH, uint32_t nb_elts_read);
-	void decompress_v_strip_97(dwt_data<vec4f>* GRK_RESTRICT vert, const uint32_t resWidth,
+	void decompress_v_strip_97(dwt_data<float>* GRK_RESTRICT vert, const uint32_t resWidth,
 							   const uint32_t resHeight, grk_buf2d_simple<float> winL,
 							   grk_buf2d_simple<float> winH, grk_buf2d_simple<float> winDest);
 	bool decompress_v_97(uint8_t res, uint32_t numThreads, size_t dataLength,
-						 dwt_data<vec4f>& GRK_RESTRICT vert, const uint32_t resWidth,
+						 dwt_data<float>& GRK_RESTRICT vert, const uint32_t resWidth,
 						 const uint32_t resHeight, grk_buf2d_simple<float> winL,
 						 grk_buf2d_simple<float> winH, grk_buf2d_simple<float> winDest);
 	bool decompress_tile_97(void);
@@ -203,6 +300,17 @@ class WaveletReverse
 	bool decompress_v_53(uint8_t res, TileComponentWindow<int32_t>* buf, uint32_t resWidth,
 						 size_t dataLength);
 	bool decompress_tile_53(void);
+	template<typename T>
+	bool canFuse(uint8_t res);
+	template<typename T>
+	bool decompress_fused(uint8_t res, const dwt_data<T>& horiz, const dwt_data<T>& vert,
+						  uint32_t numSteps);
+	template<typename T>
+	void fused_load(FusedLevel<T>* level, uint32_t rowMin, uint32_t rowMax,
+					dwt_data<T>* horiz);
+	template<typename T>
+	void fused_lift(FusedLevel<T>* level, const FusedRound& round, uint32_t colMin,
+					uint32_t colMax);
 
 	TileProcessor* tileProcessor_;
 	Scheduler* scheduler_;
@@ -215,11 +323,16 @@ class WaveletReverse
 	dwt_data<int32_t> horiz_;
 	dwt_data<int32_t> vert_;
 
-	dwt_data<vec4f> horizF_;
-	dwt_data<vec4f> vertF_;
+	// number of lines processed in parallel by full tile 9/7 transform
+	uint32_t lanes97_;
+	dwt_data<float> horizF_;
+	dwt_data<float> vertF_;
 
 	std::vector<TaskInfo<vec4f, dwt_data<vec4f>>*> tasksF_;
 	std::vector<TaskInfo<int32_t, dwt_data<int32_t>>*> tasks_;
+
+	std::vector<FusedLevel<int32_t>*> fused_;
+	std::vector<FusedLevel<float>*> fusedF_;
 };
 
 } // namespace grk
@@ -0,0 +1,143 @@
+/*
+ *    Copyright (C) 2016-2023 Grok Image Compression Inc.
+ *
+ *    This source code is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This source code is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// Highway 9/7 inverse lifting kernels, compiled once per target by each translation unit
+// that includes this file under HWY_TARGET_INCLUDE (see WaveletReverse.cpp)
+
+#if defined(GRK_WAVELET_REVERSE_97_INL_H_) == defined(HWY_TARGET_TOGGLE)
+#ifdef GRK_WAVELET_REVERSE_97_INL_H_
+#undef GRK_WAVELET_REVERSE_97_INL_H_
+#else
+#define GRK_WAVELET_REVERSE_97_INL_H_
+#endif
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <hwy/highway.h>
+
+HWY_BEFORE_NAMESPACE();
+namespace grk
+{
+namespace HWY_NAMESPACE
+{
+	using namespace hwy::HWY_NAMESPACE;
+
+	/**
+	 * Number of lines processed in parallel by the 9/7 transform
+	 */
+	static size_t hwy_num_lanes_97(void)
+	{
+		const HWY_FULL(float) df;
+		return Lanes(df);
+	}
+
+	/*
+	 9/7 lifting steps operate on interleaved line buffers, where each element holds
+	 one sample from each of width parallel lines. width is a multiple of the
+	 number of lanes: full tile decompression uses the full vector width, while
+	 partial decompression uses four lines.
+	 */
+	template<class D>
+	static void hwy_decompress_step1_97_impl(D d, float* data, uint32_t len, uint32_t width,
+											 float c)
+	{
+		const auto vc = Set(d, c);
+		const size_t N = Lanes(d);
+		if(width == N)
+		{
+			for(uint32_t i = 0; i < len; ++i, data += 2 * N)
+				Store(Mul(Load(d, data), vc), d, data);
+			return;
+		}
+		for(uint32_t i = 0; i < len; ++i, data += 2 * width)
+		{
+			for(size_t k = 0; k < width; k += N)
+				Store(Mul(Load(d, data + k), vc), d, data + k);
+		}
+	}
+	template<class D>
+	static void hwy_decompress_step2_97_impl(D d, const float* dataPrev, float* data,
+											 uint32_t len, uint32_t lenMax, uint32_t width,
+											 float c)
+	{
+		const auto vc = Set(d, c);
+		const size_t N = Lanes(d);
+		uint32_t imax = (std::min<uint32_t>)(len, lenMax);
+		if(width == N)
+		{
+			// single vector per element: carry previous even element in register
+			auto prev = Load(d, dataPrev);
+			for(uint32_t i = 0; i < imax; ++i, data += 2 * N)
+			{
+				auto cur = Load(d, data);
+				Store(Add(Load(d, data - N), Mul(Add(prev, cur), vc)), d, data - N);
+				prev = cur;
+			}
+			if(lenMax < len)
+			{
+				assert(lenMax + 1 == len);
+				Store(Add(Load(d, data - N), Mul(Add(vc, vc), prev)), d, data - N);
+			}
+			return;
+		}
+		for(uint32_t i = 0; i < imax; ++i)
+		{
+			for(size_t k = 0; k < width; k += N)
+			{
+				auto odd = data - width + k;
+				Store(Add(Load(d, odd), Mul(Add(Load(d, dataPrev + k), Load(d, data + k)), vc)), d,
+					  odd);
+			}
+			dataPrev = data;
+			data += 2 * width;
+		}
+		if(lenMax < len)
+		{
+			assert(lenMax + 1 == len);
+			const auto vc2 = Add(vc, vc);
+			for(size_t k = 0; k < width; k += N)
+			{
+				auto odd = data - width + k;
+				Store(Add(Load(d, odd), Mul(vc2, Load(d, dataPrev + k))), d, odd);
+			}
+		}
+	}
+	static void hwy_decompress_step1_97(float* data, uint32_t len, uint32_t width, float c)
+	{
+		const HWY_FULL(float) df;
+		if(width % Lanes(df) == 0)
+			hwy_decompress_step1_97_impl(df, data, len, width, c);
+		else
+			hwy_decompress_step1_97_impl(CappedTag<float, 4>(), data, len, width, c);
+	}
+	static void hwy_decompress_step2_97(const float* dataPrev, float* data, uint32_t len,
+										uint32_t lenMax, uint32_t width, float c)
+	{
+		const HWY_FULL(float) df;
+		if(width % Lanes(df) == 0)
+			hwy_decompress_step2_97_impl(df, dataPrev, data, len, lenMax, width, c);
+		else
+			hwy_decompress_step2_97_impl(CappedTag<float, 4>(), dataPrev, data, len, lenMax,
+										 width, c);
+	}
+
+} // namespace HWY_NAMESPACE
+} // namespace grk
+HWY_AFTER_NAMESPACE();
+
+#endif